@@ -19,6 +19,8 @@
 
 // Utilities
 #include <RiftForged/Utilities/Logger/Logger.h>
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h>
+#include <RiftForged/Utilities/Threadpool/Threadpool.h>
 // AssetLoader is used internally by TerrainManager, so not directly included here
 // #include <RiftForged/Utilities/AssetLoader.h>
 
@@ -39,11 +41,19 @@ int main() {
     RiftForged::Utilities::Logger::Init();
     RF_CORE_INFO("Logger Initialized.");
 
+    // Partition the machine's cores between the thread groups before any subsystem creates threads.
+    // The IOCP workers, PhysX dispatcher and task pool all size and pin themselves from this plan.
+    RiftForged::Utilities::Threading::ThreadPlacement::Configure();
+
     const unsigned short SERVER_PORT = 12345;
     const std::string LISTEN_IP_ADDRESS = "0.0.0.0";
-    const size_t GAME_LOGIC_THREAD_POOL_SIZE = 12; // Example: 12 threads for the game logic pool
     const std::chrono::milliseconds GAME_TICK_INTERVAL_MS(5); // Approx 60 TPS
 
+    // Game logic workers: one per TaskPool CPU, each pinned to its own CPU of that group.
+    RiftForged::Utilities::Threading::TaskThreadPool gameLogicThreadPool(
+        RiftForged::Utilities::Threading::ThreadGroup::TaskPool);
+    RF_CORE_INFO("Game logic thread pool started with {} workers.", gameLogicThreadPool.getThreadCount());
+
     // --- Declare only strictly necessary components for this test ---
     RiftForged::Physics::PhysicsEngine physicsEngine;
     RiftForged::Core::TerrainManager terrainManager;
@@ -144,6 +154,9 @@ int main() {
         auto last_frame_time = std::chrono::high_resolution_clock::now();
 
         RF_CORE_INFO("Starting simplified physics/terrain simulation loop...");
+        // This thread drives the simulation tick; keep it off the cores given to PhysX and the IO workers.
+        RiftForged::Utilities::Threading::ThreadPlacement::PinCurrentThread(
+            RiftForged::Utilities::Threading::ThreadGroup::Simulation, 0);
         while (simulation_running) {
             auto current_time = std::chrono::high_resolution_clock::now();
             physicsEngine.StepSimulation(fixed_delta_time);
@@ -188,6 +201,7 @@ int main() {
     // --- Graceful Shutdown Sequence ---
     RF_CORE_INFO("MAIN: Initiating graceful server shutdown (physics test mode)...");
 
+    gameLogicThreadPool.stop(); // Join the workers before the subsystems they may use go away
     physicsEngine.Shutdown(); // Explicitly shutdown physics engine
     RF_CORE_INFO("MAIN: Flushing and shutting down logger...");
     RiftForged::Utilities::Logger::FlushAll();
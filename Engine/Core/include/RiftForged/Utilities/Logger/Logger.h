@@ -84,8 +84,10 @@ namespace RiftForged {
 #define RF_COMBAT_CRITICAL(...) if (RiftForged::Utilities::Logger::GetCoreLogger()) { RiftForged::Utilities::Logger::GetCoreLogger()->critical(__VA_ARGS__); }
 
 // Network Logger Macros
-#define RF_NETWORK_TRACE(...) if (RiftForged::Utilities::Logger::GetNetworkLogger()) { RiftForged::Utilities::Logger::GetNetworkLogger()->trace(__VA_ARGS__); }
-#define RF_NETWORK_DEBUG(...) if (RiftForged::Utilities::Logger::GetNetworkLogger()) { RiftForged::Utilities::Logger::GetNetworkLogger()->debug(__VA_ARGS__); }
+// TRACE and DEBUG sit on the per-datagram path: check the level first so their arguments
+// (endpoint strings and the like) are not built for a line that would be dropped.
+#define RF_NETWORK_TRACE(...) if (RiftForged::Utilities::Logger::GetNetworkLogger() && RiftForged::Utilities::Logger::GetNetworkLogger()->should_log(spdlog::level::trace)) { RiftForged::Utilities::Logger::GetNetworkLogger()->trace(__VA_ARGS__); }
+#define RF_NETWORK_DEBUG(...) if (RiftForged::Utilities::Logger::GetNetworkLogger() && RiftForged::Utilities::Logger::GetNetworkLogger()->should_log(spdlog::level::debug)) { RiftForged::Utilities::Logger::GetNetworkLogger()->debug(__VA_ARGS__); }
 #define RF_NETWORK_INFO(...)  if (RiftForged::Utilities::Logger::GetNetworkLogger()) { RiftForged::Utilities::Logger::GetNetworkLogger()->info(__VA_ARGS__); }
 #define RF_NETWORK_WARN(...)  if (RiftForged::Utilities::Logger::GetNetworkLogger()) { RiftForged::Utilities::Logger::GetNetworkLogger()->warn(__VA_ARGS__); }
 #define RF_NETWORK_ERROR(...) if (RiftForged::Utilities::Logger::GetNetworkLogger()) { RiftForged::Utilities::Logger::GetNetworkLogger()->error(__VA_ARGS__); }
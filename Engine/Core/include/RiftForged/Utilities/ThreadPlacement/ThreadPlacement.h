@@ -0,0 +1,100 @@
+﻿// Copyright (C) 2023 RiftForged
+// Description: CPU topology discovery and per-subsystem core assignment. Every long-lived thread
+// group (network IO, simulation, PhysX workers, the task pool) asks this layer how many threads to
+// run and which cores they belong on, instead of guessing from hardware_concurrency().
+
+#pragma once
+
+#include <vector>       // For std::vector
+#include <string>       // For std::string
+#include <mutex>        // For std::mutex
+#include <atomic>       // For std::atomic
+#include <cstdint>      // For uint32_t
+
+namespace RiftForged {
+    namespace Utilities {
+        namespace Threading {
+
+            // One schedulable CPU as the OS numbers it.
+            struct LogicalProcessor {
+                uint32_t osIndex = 0;        // Linux CPU number; on Windows processorGroup * 64 + groupBit.
+                uint16_t processorGroup = 0; // Windows processor group (always 0 on Linux).
+                uint8_t groupBit = 0;        // Bit within the processor group's affinity mask.
+                uint32_t coreId = 0;         // Dense physical core id; SMT siblings share it.
+                uint32_t numaNode = 0;
+            };
+
+            struct CpuTopology {
+                // Only CPUs this process may run on (cgroup/affinity restrictions are honoured).
+                std::vector<LogicalProcessor> logicalProcessors;
+                uint32_t physicalCoreCount = 0;
+                uint32_t numaNodeCount = 0;
+
+                // Reads sysfs on Linux and GetLogicalProcessorInformationEx on Windows. Falls back to
+                // hardware_concurrency() CPUs, one per core, if neither is available.
+                static CpuTopology Detect();
+            };
+
+            // The thread groups that get their own cores.
+            enum class ThreadGroup : uint32_t {
+                NetworkIO = 0,   // UDPSocketAsync / UDPSocketLinux workers
+                Simulation,      // Shard simulation / main tick threads
+                Physics,         // PhysX CPU dispatcher workers
+                TaskPool,        // TaskThreadPool workers
+                Count
+            };
+
+            struct ThreadPlacementConfig {
+                // Physical cores per group. 0 = share out whatever the explicit requests leave.
+                uint32_t networkIOCores = 0;
+                uint32_t simulationCores = 1;
+                uint32_t physicsCores = 0;
+                uint32_t taskPoolCores = 0;
+                uint32_t reservedCores = 1;   // Lowest cores left to the OS, logging and other untracked threads.
+                bool useSmtSiblings = true;   // One thread per logical CPU of each assigned core; false = one per physical core.
+                bool shareCores = false;      // Every group gets every usable core (no partitioning); for small dev machines.
+                bool pinThreads = true;       // false = only size the groups, never touch affinity.
+            };
+
+            // Process-wide placement plan. Call Configure() once at startup, before any subsystem
+            // creates its threads; queries made before that configure with the defaults.
+            //
+            // Usable cores are ordered by NUMA node and handed out as contiguous slices, so a group
+            // stays on one node when it fits. Groups never share a physical core unless shareCores is
+            // set or the machine has fewer usable cores than groups (logged as a warning).
+            class ThreadPlacement {
+            public:
+                static void Configure(const ThreadPlacementConfig& config = ThreadPlacementConfig{});
+                static bool IsConfigured();
+
+                static const CpuTopology& GetTopology();
+
+                // Number of threads the group should run (its CPU count), at least 1.
+                static uint32_t GetThreadCount(ThreadGroup group);
+
+                // The logical CPUs assigned to the group, in thread-index order.
+                static std::vector<LogicalProcessor> GetCpus(ThreadGroup group);
+
+                // Pins the calling thread to CPU (threadIndex % GetThreadCount(group)) of the group.
+                static bool PinCurrentThread(ThreadGroup group, uint32_t threadIndex);
+
+                // Allows the calling thread on any CPU of the group (for threads created by third-party code).
+                static bool RestrictCurrentThreadToGroup(ThreadGroup group);
+
+                static const char* GetGroupName(ThreadGroup group);
+
+            private:
+                static void EnsureConfigured();
+                static void BuildPlan();
+                static bool ApplyAffinity(const std::vector<LogicalProcessor>& cpus);
+
+                static std::mutex s_mutex;
+                static std::atomic<bool> s_isConfigured;
+                static ThreadPlacementConfig s_config;
+                static CpuTopology s_topology;
+                static std::vector<LogicalProcessor> s_groupCpus[static_cast<size_t>(ThreadGroup::Count)];
+            };
+
+        }
+    }
+}
@@ -13,6 +13,9 @@
 #include <atomic>       // For std::atomic
 #include <string>       // For std::string in thread naming
 #include <stdexcept>    // For std::runtime_error
+#include <optional>     // For the optional placement group
+
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h> // For ThreadGroup-based sizing and pinning
 
 // Platform-specific includes for thread naming
 #if defined(__linux__) || defined(__APPLE__)
@@ -34,6 +37,9 @@ namespace RiftForged {
                 // Defaults to the number of hardware concurrency units if numThreads is 0
                 explicit TaskThreadPool(size_t numThreads = 0);
 
+                // Constructor: Sizes the pool from ThreadPlacement and pins worker i to the group's i-th CPU
+                explicit TaskThreadPool(ThreadGroup placementGroup);
+
                 // Destructor: Gracefully shuts down the thread pool
                 ~TaskThreadPool();
 
@@ -61,7 +67,10 @@ namespace RiftForged {
 
             private:
                 // Worker function that each thread will execute
-                void worker_loop();
+                void worker_loop(size_t workerIndex);
+
+                // Starts threadCount_ workers
+                void start_workers();
 
                 std::vector<std::thread> workers_;
                 std::deque<std::function<void()>> tasks_; // Changed from std::queue to std::deque
@@ -72,6 +81,7 @@ namespace RiftForged {
                 std::atomic<bool> paused_{ false };    // New: Flag to signal threads to pause, initialized
 
                 size_t threadCount_; // Store the number of threads
+                std::optional<ThreadGroup> placementGroup_; // Set when workers are pinned via ThreadPlacement
             };
 
             // --- Template Implementation for enqueue ---
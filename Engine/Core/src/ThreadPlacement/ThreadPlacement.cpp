@@ -0,0 +1,363 @@
+﻿// Copyright (C) 2023 RiftForged
+// Description: Implements CPU topology discovery and the per-group core assignment.
+
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h>
+#include <RiftForged/Utilities/Logger/Logger.h>
+
+#include <algorithm>    // For std::sort, std::min
+#include <map>          // For core/NUMA id densification
+#include <thread>       // For std::thread::hardware_concurrency
+#include <string>       // For std::to_string
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>    // For GetLogicalProcessorInformationEx, SetThreadGroupAffinity
+#elif defined(__linux__)
+#include <fstream>      // For reading sysfs
+#include <filesystem>   // For the cpuN/nodeM sysfs links
+#include <cstring>      // For strerror
+#include <pthread.h>    // For pthread_setaffinity_np
+#include <sched.h>      // For sched_getaffinity, cpu_set_t
+#endif
+
+namespace RiftForged {
+    namespace Utilities {
+        namespace Threading {
+
+            std::mutex ThreadPlacement::s_mutex;
+            std::atomic<bool> ThreadPlacement::s_isConfigured{ false };
+            ThreadPlacementConfig ThreadPlacement::s_config;
+            CpuTopology ThreadPlacement::s_topology;
+            std::vector<LogicalProcessor> ThreadPlacement::s_groupCpus[static_cast<size_t>(ThreadGroup::Count)];
+
+            namespace {
+                CpuTopology FallbackTopology() {
+                    CpuTopology topology;
+                    unsigned int count = std::thread::hardware_concurrency();
+                    if (count == 0) count = 4;
+                    for (unsigned int i = 0; i < count; ++i) {
+                        LogicalProcessor cpu;
+                        cpu.osIndex = i;
+                        cpu.processorGroup = static_cast<uint16_t>(i / 64);
+                        cpu.groupBit = static_cast<uint8_t>(i % 64);
+                        cpu.coreId = i;
+                        topology.logicalProcessors.push_back(cpu);
+                    }
+                    topology.physicalCoreCount = count;
+                    topology.numaNodeCount = 1;
+                    return topology;
+                }
+
+#if defined(__linux__)
+                int ReadSysfsInt(const std::string& path, int fallback) {
+                    std::ifstream file(path);
+                    int value = fallback;
+                    if (!(file >> value)) {
+                        return fallback;
+                    }
+                    return value;
+                }
+#endif
+
+                std::string DescribeCpus(const std::vector<LogicalProcessor>& cpus) {
+                    std::string text;
+                    for (const LogicalProcessor& cpu : cpus) {
+                        if (!text.empty()) text += ",";
+                        text += std::to_string(cpu.osIndex);
+                    }
+                    return text;
+                }
+            }
+
+            CpuTopology CpuTopology::Detect() {
+                CpuTopology topology;
+#if defined(_WIN32)
+                DWORD length = 0;
+                GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+                if (length == 0) {
+                    return FallbackTopology();
+                }
+                std::vector<uint8_t> buffer(length);
+                auto* first = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data());
+                if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) {
+                    return FallbackTopology();
+                }
+
+                struct NumaMask { WORD group; KAFFINITY mask; uint32_t node; };
+                std::vector<NumaMask> numaMasks;
+                uint32_t nextCoreId = 0;
+                for (DWORD offset = 0; offset < length;) {
+                    auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+                    if (info->Relationship == RelationProcessorCore) {
+                        for (WORD g = 0; g < info->Processor.GroupCount; ++g) {
+                            const GROUP_AFFINITY& groupMask = info->Processor.GroupMask[g];
+                            for (uint8_t bit = 0; bit < 64; ++bit) {
+                                if (groupMask.Mask & (static_cast<KAFFINITY>(1) << bit)) {
+                                    LogicalProcessor cpu;
+                                    cpu.processorGroup = groupMask.Group;
+                                    cpu.groupBit = bit;
+                                    cpu.osIndex = static_cast<uint32_t>(groupMask.Group) * 64 + bit;
+                                    cpu.coreId = nextCoreId;
+                                    topology.logicalProcessors.push_back(cpu);
+                                }
+                            }
+                        }
+                        ++nextCoreId;
+                    }
+                    else if (info->Relationship == RelationNumaNode) {
+                        numaMasks.push_back({ info->NumaNode.GroupMask.Group, info->NumaNode.GroupMask.Mask, info->NumaNode.NodeNumber });
+                    }
+                    offset += info->Size;
+                }
+                for (LogicalProcessor& cpu : topology.logicalProcessors) {
+                    for (const NumaMask& numa : numaMasks) {
+                        if (numa.group == cpu.processorGroup && (numa.mask & (static_cast<KAFFINITY>(1) << cpu.groupBit))) {
+                            cpu.numaNode = numa.node;
+                            break;
+                        }
+                    }
+                }
+#elif defined(__linux__)
+                cpu_set_t allowed;
+                CPU_ZERO(&allowed);
+                if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+                    return FallbackTopology();
+                }
+                std::map<std::pair<int, int>, uint32_t> coreIds; // (package, core_id) -> dense id
+                for (int cpuIndex = 0; cpuIndex < CPU_SETSIZE; ++cpuIndex) {
+                    if (!CPU_ISSET(cpuIndex, &allowed)) {
+                        continue;
+                    }
+                    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpuIndex);
+                    const int package = ReadSysfsInt(base + "/topology/physical_package_id", 0);
+                    const int core = ReadSysfsInt(base + "/topology/core_id", cpuIndex);
+
+                    LogicalProcessor cpu;
+                    cpu.osIndex = static_cast<uint32_t>(cpuIndex);
+                    auto inserted = coreIds.emplace(std::make_pair(package, core), static_cast<uint32_t>(coreIds.size()));
+                    cpu.coreId = inserted.first->second;
+
+                    std::error_code ec;
+                    for (const auto& entry : std::filesystem::directory_iterator(base, ec)) {
+                        const std::string name = entry.path().filename().string();
+                        if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                            name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                            cpu.numaNode = static_cast<uint32_t>(std::stoul(name.substr(4)));
+                            break;
+                        }
+                    }
+                    topology.logicalProcessors.push_back(cpu);
+                }
+#endif
+                if (topology.logicalProcessors.empty()) {
+                    return FallbackTopology();
+                }
+
+                std::map<uint32_t, bool> cores;
+                std::map<uint32_t, bool> nodes;
+                for (const LogicalProcessor& cpu : topology.logicalProcessors) {
+                    cores[cpu.coreId] = true;
+                    nodes[cpu.numaNode] = true;
+                }
+                topology.physicalCoreCount = static_cast<uint32_t>(cores.size());
+                topology.numaNodeCount = static_cast<uint32_t>(nodes.size());
+                return topology;
+            }
+
+            void ThreadPlacement::Configure(const ThreadPlacementConfig& config) {
+                std::lock_guard<std::mutex> lock(s_mutex);
+                s_config = config;
+                s_topology = CpuTopology::Detect();
+                BuildPlan();
+                s_isConfigured.store(true, std::memory_order_release);
+            }
+
+            bool ThreadPlacement::IsConfigured() {
+                return s_isConfigured.load(std::memory_order_acquire);
+            }
+
+            void ThreadPlacement::EnsureConfigured() {
+                if (s_isConfigured.load(std::memory_order_acquire)) {
+                    return;
+                }
+                std::lock_guard<std::mutex> lock(s_mutex);
+                if (!s_isConfigured.load(std::memory_order_relaxed)) {
+                    s_topology = CpuTopology::Detect();
+                    BuildPlan();
+                    s_isConfigured.store(true, std::memory_order_release);
+                }
+            }
+
+            const CpuTopology& ThreadPlacement::GetTopology() {
+                EnsureConfigured();
+                return s_topology;
+            }
+
+            const char* ThreadPlacement::GetGroupName(ThreadGroup group) {
+                switch (group) {
+                case ThreadGroup::NetworkIO:  return "NetworkIO";
+                case ThreadGroup::Simulation: return "Simulation";
+                case ThreadGroup::Physics:    return "Physics";
+                case ThreadGroup::TaskPool:   return "TaskPool";
+                default:                      return "Unknown";
+                }
+            }
+
+            // Caller holds s_mutex.
+            void ThreadPlacement::BuildPlan() {
+                const size_t groupCount = static_cast<size_t>(ThreadGroup::Count);
+
+                // Physical cores, ordered by NUMA node then core id; each entry lists its SMT siblings.
+                std::vector<LogicalProcessor> sorted = s_topology.logicalProcessors;
+                std::sort(sorted.begin(), sorted.end(), [](const LogicalProcessor& a, const LogicalProcessor& b) {
+                    if (a.numaNode != b.numaNode) return a.numaNode < b.numaNode;
+                    if (a.coreId != b.coreId) return a.coreId < b.coreId;
+                    return a.osIndex < b.osIndex;
+                    });
+                std::vector<std::vector<LogicalProcessor>> cores;
+                for (const LogicalProcessor& cpu : sorted) {
+                    if (cores.empty() || cores.back().front().coreId != cpu.coreId) {
+                        cores.emplace_back();
+                    }
+                    if (s_config.useSmtSiblings || cores.back().empty()) {
+                        cores.back().push_back(cpu);
+                    }
+                }
+
+                uint32_t requested[groupCount] = {
+                    s_config.networkIOCores, s_config.simulationCores, s_config.physicsCores, s_config.taskPoolCores };
+                uint32_t explicitTotal = 0;
+                uint32_t autoGroups = 0;
+                for (uint32_t request : requested) {
+                    explicitTotal += request;
+                    if (request == 0) ++autoGroups;
+                }
+                const uint32_t minimumNeeded = explicitTotal + autoGroups;
+
+                // Give up reserved cores before making groups overlap.
+                size_t reserved = std::min<size_t>(s_config.reservedCores, cores.size() > 1 ? cores.size() - 1 : 0);
+                if (!s_config.shareCores && cores.size() - reserved < minimumNeeded) {
+                    reserved = cores.size() > minimumNeeded ? cores.size() - minimumNeeded : 0;
+                }
+                const std::vector<std::vector<LogicalProcessor>> usable(cores.begin() + reserved, cores.end());
+                const uint32_t usableCount = static_cast<uint32_t>(usable.size());
+
+                for (size_t g = 0; g < groupCount; ++g) {
+                    s_groupCpus[g].clear();
+                }
+
+                if (s_config.shareCores) {
+                    for (size_t g = 0; g < groupCount; ++g) {
+                        for (const auto& core : usable) {
+                            s_groupCpus[g].insert(s_groupCpus[g].end(), core.begin(), core.end());
+                        }
+                    }
+                }
+                else {
+                    if (usableCount < minimumNeeded) {
+                        RF_CORE_WARN("ThreadPlacement: {} usable cores for {} requested; thread groups will share cores.",
+                            usableCount, minimumNeeded);
+                    }
+                    // Auto-sized groups split what the explicit requests leave; TaskPool (or the last
+                    // auto group) takes the remainder.
+                    const uint32_t leftover = usableCount > explicitTotal ? usableCount - explicitTotal : 0;
+                    const uint32_t autoShare = autoGroups > 0 ? std::max<uint32_t>(1, leftover / autoGroups) : 0;
+                    uint32_t autoRemainder = (autoGroups > 0 && leftover > autoShare * autoGroups) ? leftover - autoShare * autoGroups : 0;
+                    size_t lastAutoGroup = groupCount;
+                    for (size_t g = 0; g < groupCount; ++g) {
+                        if (requested[g] == 0) lastAutoGroup = g;
+                    }
+
+                    uint32_t cursor = 0;
+                    for (size_t g = 0; g < groupCount; ++g) {
+                        uint32_t coreCount = requested[g] != 0 ? requested[g] : autoShare;
+                        if (g == lastAutoGroup) {
+                            coreCount += autoRemainder;
+                            autoRemainder = 0;
+                        }
+                        for (uint32_t c = 0; c < coreCount; ++c) {
+                            const auto& core = usable[(cursor + c) % usableCount];
+                            s_groupCpus[g].insert(s_groupCpus[g].end(), core.begin(), core.end());
+                        }
+                        cursor = (cursor + coreCount) % usableCount;
+                    }
+                }
+
+                RF_CORE_INFO("ThreadPlacement: {} logical CPUs, {} physical cores, {} NUMA node(s); {} core(s) reserved.",
+                    s_topology.logicalProcessors.size(), s_topology.physicalCoreCount, s_topology.numaNodeCount, reserved);
+                for (size_t g = 0; g < groupCount; ++g) {
+                    RF_CORE_INFO("ThreadPlacement: {} -> {} thread(s) on CPUs [{}]{}.",
+                        GetGroupName(static_cast<ThreadGroup>(g)), s_groupCpus[g].size(), DescribeCpus(s_groupCpus[g]),
+                        s_config.pinThreads ? "" : " (not pinned)");
+                }
+            }
+
+            uint32_t ThreadPlacement::GetThreadCount(ThreadGroup group) {
+                EnsureConfigured();
+                const size_t count = s_groupCpus[static_cast<size_t>(group)].size();
+                return count > 0 ? static_cast<uint32_t>(count) : 1u;
+            }
+
+            std::vector<LogicalProcessor> ThreadPlacement::GetCpus(ThreadGroup group) {
+                EnsureConfigured();
+                return s_groupCpus[static_cast<size_t>(group)];
+            }
+
+            bool ThreadPlacement::PinCurrentThread(ThreadGroup group, uint32_t threadIndex) {
+                EnsureConfigured();
+                const std::vector<LogicalProcessor>& cpus = s_groupCpus[static_cast<size_t>(group)];
+                if (!s_config.pinThreads || cpus.empty()) {
+                    return false;
+                }
+                return ApplyAffinity({ cpus[threadIndex % cpus.size()] });
+            }
+
+            bool ThreadPlacement::RestrictCurrentThreadToGroup(ThreadGroup group) {
+                EnsureConfigured();
+                const std::vector<LogicalProcessor>& cpus = s_groupCpus[static_cast<size_t>(group)];
+                if (!s_config.pinThreads || cpus.empty()) {
+                    return false;
+                }
+                return ApplyAffinity(cpus);
+            }
+
+            bool ThreadPlacement::ApplyAffinity(const std::vector<LogicalProcessor>& cpus) {
+#if defined(_WIN32)
+                // A Windows thread can only be affinitized within one processor group; use the first CPU's.
+                GROUP_AFFINITY affinity{};
+                affinity.Group = cpus.front().processorGroup;
+                for (const LogicalProcessor& cpu : cpus) {
+                    if (cpu.processorGroup == affinity.Group) {
+                        affinity.Mask |= static_cast<KAFFINITY>(1) << cpu.groupBit;
+                    }
+                }
+                if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr)) {
+                    RF_CORE_WARN("ThreadPlacement: SetThreadGroupAffinity failed (group {}, mask {:#x}). WinError: {}",
+                        affinity.Group, static_cast<uint64_t>(affinity.Mask), GetLastError());
+                    return false;
+                }
+                return true;
+#elif defined(__linux__)
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                for (const LogicalProcessor& cpu : cpus) {
+                    CPU_SET(cpu.osIndex, &cpuSet);
+                }
+                const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+                if (ret != 0) {
+                    RF_CORE_WARN("ThreadPlacement: pthread_setaffinity_np to CPUs [{}] failed: {}", DescribeCpus(cpus), std::strerror(ret));
+                    return false;
+                }
+                return true;
+#else
+                (void)cpus;
+                return false;
+#endif
+            }
+
+        }
+    }
+}
@@ -32,10 +32,22 @@ namespace RiftForged {
                     threadCount_ = numThreads;
                 }
 
+                start_workers();
+            }
+
+            // Constructor for a pool placed on a ThreadPlacement group
+            TaskThreadPool::TaskThreadPool(ThreadGroup placementGroup)
+                : threadCount_(ThreadPlacement::GetThreadCount(placementGroup)),
+                placementGroup_(placementGroup)
+            {
+                start_workers();
+            }
+
+            void TaskThreadPool::start_workers() {
                 workers_.reserve(threadCount_); // Pre-allocate memory
                 for (size_t i = 0; i < threadCount_; ++i) {
                     // Improvement #2: Cleaner thread creation
-                    workers_.emplace_back(&TaskThreadPool::worker_loop, this);
+                    workers_.emplace_back(&TaskThreadPool::worker_loop, this, i);
                 }
             }
 
@@ -92,7 +104,11 @@ namespace RiftForged {
             }
 
             // Worker function that each thread will execute
-            void TaskThreadPool::worker_loop() {
+            void TaskThreadPool::worker_loop(size_t workerIndex) {
+                if (placementGroup_) {
+                    ThreadPlacement::PinCurrentThread(*placementGroup_, static_cast<uint32_t>(workerIndex));
+                }
+
                 // Improvement #6: Thread Naming
 #if defined(__linux__)
                 pthread_setname_np(pthread_self(), "PoolWorker");
@@ -11,6 +11,7 @@ namespace RiftForged {
     namespace Networking {
         class MessageDispatcher;
         class NetworkEndpoint;
+        struct VerifiedC2SMessage;
     }
     namespace Server {
         class GameServerEngine;
@@ -26,16 +27,12 @@ namespace RiftForged {
                 RiftForged::Server::GameServerEngine& gameServerEngine);
 
             /**
-             * @brief Processes a raw network datagram.
+             * @brief Processes a client message verified by the network layer.
              * This is the entry point from the network layer. This function's sole
-             * responsibility is to translate the raw bytes into a clean GameCommand
-             * and pass it to the MessageDispatcher.
+             * responsibility is to translate the message into a clean GameCommand
+             * and pass it to the MessageDispatcher. The FlatBuffer is not verified again.
              */
-            void ProcessIncomingPacket(
-                const Networking::NetworkEndpoint& sender_endpoint,
-                const uint8_t* data,
-                uint16_t size
-            );
+            void ProcessIncomingPacket(const Networking::VerifiedC2SMessage& message);
 
         private:
             MessageDispatcher& m_messageDispatcher;
@@ -5,6 +5,7 @@
 #include <RiftForged/Server/ServerEngine/ServerEngine.h>
 #include <RiftForged/GameLogic/PlayerManager/PlayerManager.h>
 #include <RiftForged/Utilities/Logger/Logger.h>
+#include <RiftForged/Network/VerifiedC2SMessage/VerifiedC2SMessage.h> // Verified once by UDPPacketHandler
 #include <RiftForged/Utilities/MathUtils/MathUtils.h> // For your math types
 
 // This class is the ONLY place in the dispatch pipeline that includes the raw C2S message definitions.
@@ -24,30 +25,19 @@ namespace RiftForged {
             RF_NETWORK_INFO("PacketProcessor: Constructed.");
         }
 
-        void PacketProcessor::ProcessIncomingPacket(
-            const Networking::NetworkEndpoint& sender_endpoint,
-            const uint8_t* data,
-            uint16_t size)
+        void PacketProcessor::ProcessIncomingPacket(const Networking::VerifiedC2SMessage& message)
         {
-            // --- Step 1: Verify the FlatBuffer ---
-            // This logic is the same as your old MessageDispatcher, ensuring data integrity.
-            flatbuffers::Verifier verifier(data, size);
-            if (!Networking::UDP::C2S::VerifyRoot_C2S_UDP_MessageBuffer(verifier)) {
-                RF_NETWORK_WARN("PacketProcessor: Packet from {} failed FlatBuffer verification.", sender_endpoint.ToString());
-                return;
-            }
-            const auto* root_message = Networking::UDP::C2S::GetRoot_C2S_UDP_Message(data);
-            if (!root_message || !root_message->payload()) {
-                RF_NETWORK_WARN("PacketProcessor: Packet from {} has no payload.", sender_endpoint.ToString());
-                return;
-            }
+            // --- Step 1: Unpack the FlatBuffer ---
+            // VerifyC2SMessage already ran the verifier and checked for a payload; it is not run again.
+            const Networking::NetworkEndpoint& sender_endpoint = message.sender;
+            const auto* root_message = message.root;
 
             // --- Step 2: Identify the Player ---
             // We get the PlayerID from the PlayerManager. This is a critical session management step.
             auto& playerManager = m_gameServerEngine.GetPlayerManager();
             std::optional<GameLogic::Commands::PlayerID> maybePlayerID;
 
-            const auto payload_type = root_message->payload_type();
+            const auto payload_type = message.payloadType;
 
             // JoinRequest is special: the player does not have an ID yet.
             // We will assign a temporary or invalid ID for the command, but the handler will know what to do.
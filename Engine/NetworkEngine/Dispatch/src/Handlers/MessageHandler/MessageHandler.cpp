@@ -1,12 +1,17 @@
 ﻿// File: MessageHandlers.cpp
 // RiftForged Game Development Team
 // Copyright (c) 2023-2025 RiftForged Game Development Team
+//
+// Not built. The Networking::MessageDispatcher declared by "MessageDispatcher.h" and the
+// UDP::C2S handler classes it takes were replaced by Dispatch::MessageDispatcher (GameCommands)
+// and are not in the tree; no CMake target compiles Dispatch/src. Verified client messages reach
+// game code through IMessageHandler::ProcessApplicationMessage (Network/include/IMessageHandler)
+// instead. Kept for the C2SDispatchTable registrations it shows.
 
 #include "MessageDispatcher.h"
 #include <optional>
 
 // FlatBuffer related includes
-#include "flatbuffers/flatbuffers.h" // For flatbuffers::Verifier, GetRoot, etc.
 #include "../FlatBuffers/Versioning/V0.0.5/riftforged_c2s_udp_messages_generated.h"
 #include "../FlatBuffers/Versioning/V0.0.5/riftforged_common_types_generated.h"
 // This includes RiftForged::Networking::UDP::C2S::C2S_UDP_Payload,
@@ -16,6 +21,8 @@
 #include "../FlatBuffers/Versioning/V0.0.5/riftforged_s2c_udp_messages_generated.h" // Assuming this path
 
 #include "NetworkEndpoint.h"
+#include "VerifiedC2SMessage.h"     // For VerifiedC2SMessage (verified once by UDPPacketHandler)
+#include "C2SDispatchTable.h"       // For C2SDispatchTable, indexed by the C2S_UDP_Payload discriminator
 #include "NetworkCommon.h"          // For S2C_Response (now using FB S2C payload type)
 #include "../GameEngine/ActivePlayer.h" // For ActivePlayer struct
 #include "../Utilities/Logger.h"        // For RF_NETWORK_... macros
@@ -33,7 +40,8 @@
 namespace RiftForged {
     namespace Networking {
 
-        // Constructor implementation
+        // Constructor implementation. Each handler is bound to its message type here; supporting a
+        // new message type is one more RegisterHandler line.
         MessageDispatcher::MessageDispatcher(
             UDP::C2S::MovementMessageHandler& movementHandler,
             UDP::C2S::RiftStepMessageHandler& riftStepHandler,
@@ -44,175 +52,44 @@ namespace RiftForged {
             UDP::C2S::JoinRequestMessageHandler& joinRequestHandler,
             RiftForged::Utilities::Threading::TaskThreadPool* taskPool
         )
-            : m_movementHandler(movementHandler),
-            m_riftStepHandler(riftStepHandler),
-            m_abilityHandler(abilityHandler),   
-            m_pingHandler(pingHandler),
-            m_turnHandler(turnHandler),
-            m_basicAttackHandler(basicAttackHandler),
-            m_joinRequestHandler(joinRequestHandler),
-            m_taskThreadPool(taskPool)
+            : m_taskThreadPool(taskPool)
         {
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(movementHandler);
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_TurnIntentMsg>(turnHandler);
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_BasicAttackIntentMsg>(basicAttackHandler);
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_RiftStepActivationMsg>(riftStepHandler);
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_UseAbilityMsg>(abilityHandler);
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_PingMsg>(pingHandler);
+            // The JoinRequestMessageHandler creates the player, so it is called without one.
+            m_handlerTable.RegisterHandler<UDP::C2S::C2S_JoinRequestMsg>(joinRequestHandler, false);
             RF_NETWORK_INFO("MessageDispatcher: Initialized with all handlers.");
         }
 
-        // Dispatch an incoming C2S FlatBuffer message to the appropriate handler.
+        // Dispatch an incoming C2S message to the appropriate handler. The FlatBuffer was verified
+        // by UDPPacketHandler before it got here and is not verified again.
         std::optional<S2C_Response> MessageDispatcher::DispatchC2SMessage(
-            const uint8_t* flatbuffer_payload_ptr,
-            uint16_t flatbuffer_payload_size,
-            const NetworkEndpoint& sender_endpoint,
+            const VerifiedC2SMessage& message,
             RiftForged::GameLogic::ActivePlayer* player) {
 
-            // --- FlatBuffer Payload Validation ---
-            // Perform a basic size check: a FlatBuffer should at least contain its size prefix (4 bytes)
-            // and the root table's vtable offset (another 4 bytes).
-            if (flatbuffer_payload_size < sizeof(uint32_t) * 2) {
-                RF_NETWORK_WARN("MessageDispatcher: FlatBuffer payload size too small (%u bytes) from [%s]. Discarding.",
-                    flatbuffer_payload_size, sender_endpoint.ToString());
-                return std::nullopt;
-            }
-
-            // Use the FlatBuffer Verifier to ensure the buffer's integrity and validity.
-            flatbuffers::Verifier verifier(flatbuffer_payload_ptr, static_cast<size_t>(flatbuffer_payload_size));
-            if (!RiftForged::Networking::UDP::C2S::VerifyRoot_C2S_UDP_MessageBuffer(verifier)) {
-                RF_NETWORK_WARN("MessageDispatcher: Invalid Root_C2S_UDP_Message FlatBuffer from [%s]. Size: %u. Discarding.",
-                    sender_endpoint.ToString(), flatbuffer_payload_size);
-                return std::nullopt;
-            }
-
-            // Get the root message. This provides a view into the FlatBuffer data without deserializing.
-            auto root_message = RiftForged::Networking::UDP::C2S::GetRoot_C2S_UDP_Message(flatbuffer_payload_ptr);
-            if (!root_message || !root_message->payload()) {
-                // If GetRoot returned null, or the payload union itself is null (e.g., payload_type is NONE)
-                RF_NETWORK_WARN("MessageDispatcher: Root_C2S_UDP_Message or its payload union is null from [%s]. Type: %s. Discarding.",
-                    sender_endpoint.ToString(), UDP::C2S::EnumNameC2S_UDP_Payload(root_message ? root_message->payload_type() : UDP::C2S::C2S_UDP_Payload_NONE));
-                return std::nullopt;
-            }
-
-            // The true message type is extracted from the FlatBuffer's internal union discriminator.
-            UDP::C2S::C2S_UDP_Payload payload_type_from_union = root_message->payload_type();
-            std::optional<S2C_Response> handler_response = std::nullopt;
-
-            RF_NETWORK_TRACE("MessageDispatcher: Dispatching FlatBuffer UnionType: %s (%d) from [%s]",
-                UDP::C2S::EnumNameC2S_UDP_Payload(payload_type_from_union),
-                static_cast<int>(payload_type_from_union),
-                sender_endpoint.ToString()
-            );
-
-            // --- Special handling for JoinRequest: It's the only message type that might arrive before a player is established. ---
-            if (payload_type_from_union == UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_JoinRequest) {
-                auto msg = root_message->payload_as_JoinRequest();
-                if (msg) {
-                    // The JoinRequestMessageHandler is responsible for creating and associating the player.
-                    // It can accept a nullptr 'player' and return an S2C_Response to indicate success/failure.
-                    handler_response = m_joinRequestHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_JoinRequest failed (null message table) for [%s]", sender_endpoint.ToString());
-                }
-                // Always return after handling JoinRequest, regardless of whether a player was associated yet.
-                // The response (or lack thereof) will be handled by UDPPacketHandler.
-                return handler_response;
-            }
+            const NetworkEndpoint& sender_endpoint = message.sender;
+            const UDP::C2S::C2S_UDP_Payload payload_type_from_union = message.payloadType;
 
-            // --- For all other message types, a player must exist. ---
-            if (!player) {
+            // One table index and one indirect call. Only the failure paths log: the log arguments
+            // (endpoint strings in particular) are built even when the level is disabled.
+            C2SDispatchStatus status = C2SDispatchStatus::Dispatched;
+            std::optional<S2C_Response> handler_response = m_handlerTable.Dispatch(message, player, status);
+            if (status == C2SDispatchStatus::PlayerRequired) {
                 RF_NETWORK_ERROR("MessageDispatcher: Null player object provided for dispatch from %s for payload type %s. Discarding message.",
                     sender_endpoint.ToString(), UDP::C2S::EnumNameC2S_UDP_Payload(payload_type_from_union));
                 return std::nullopt;
             }
-
-            // Dispatch based on the FlatBuffer's payload type for messages requiring an active player.
-            switch (payload_type_from_union) {
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_MovementInput: {
-                auto msg = root_message->payload_as_MovementInput();
-                if (msg) {
-                    handler_response = m_movementHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_MovementInput failed (null message table) for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_TurnIntent: {
-                auto msg = root_message->payload_as_TurnIntent();
-                if (msg) {
-                    handler_response = m_turnHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_TurnIntent failed for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_BasicAttackIntent: {
-                auto msg = root_message->payload_as_BasicAttackIntent();
-                if (msg) {
-                    handler_response = m_basicAttackHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_BasicAttackIntent failed for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_RiftStepActivation: {
-                auto msg = root_message->payload_as_RiftStepActivation();
-                if (msg) {
-                    handler_response = m_riftStepHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_RiftStepActivation failed for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_UseAbility: {
-                auto msg = root_message->payload_as_UseAbility();
-                if (msg) {
-                    handler_response = m_abilityHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_UseAbility failed for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload::C2S_UDP_Payload_Ping: {
-                auto msg = root_message->payload_as_Ping();
-                if (msg) {
-                    handler_response = m_pingHandler.Process(sender_endpoint, player, msg);
-                }
-                else {
-                    RF_NETWORK_WARN("Dispatcher: Payload_as_Ping failed for [%s]", sender_endpoint.ToString());
-                }
-                break;
-            }
-            case UDP::C2S::C2S_UDP_Payload_NONE: {
-                // This case indicates that the FlatBuffer's root union is explicitly NONE.
-                // This might happen if a client sends an empty Root_C2S_UDP_Message.
-                RF_NETWORK_WARN("MessageDispatcher: FlatBuffer Root_C2S_UDP_Message payload type is NONE from [%s]. Discarding.",
-                    sender_endpoint.ToString());
-                break;
-            }
-            default:
-                // Fallback for any unhandled FlatBuffer payload types.
+            if (status == C2SDispatchStatus::NoHandler) {
                 RF_NETWORK_WARN("MessageDispatcher: Unknown or unhandled FlatBuffer C2S_UDP_Payload type: %s (%d) from [%s]. Discarding.",
                     UDP::C2S::EnumNameC2S_UDP_Payload(payload_type_from_union),
                     static_cast<int>(payload_type_from_union), sender_endpoint.ToString());
-                break;
+                return std::nullopt;
             }
 
-            // Log the response from the handler.
-            if (handler_response.has_value()) {
-                RF_NETWORK_DEBUG("MessageDispatcher: Handler for %s returned S2C_Response. Recipient: [%s], Broadcast: %s, ResponseMsgType: %s",
-                    UDP::C2S::EnumNameC2S_UDP_Payload(payload_type_from_union), // Log the *incoming* C2S FlatBuffer type
-                    handler_response->specific_recipient.ToString(),
-                    handler_response->broadcast ? "true" : "false",
-                    // Use the S2C FlatBuffers enum name for the *outgoing* response type.
-                    UDP::S2C::EnumNameS2C_UDP_Payload(handler_response->flatbuffer_payload_type));
-            }
-            else {
-                RF_NETWORK_TRACE("MessageDispatcher: No S2C_Response from handler for %s from [%s]",
-                    UDP::C2S::EnumNameC2S_UDP_Payload(payload_type_from_union),
-                    sender_endpoint.ToString());
-            }
             return handler_response;
         }
 
@@ -5,6 +5,7 @@
 #include <RiftForged/Server/ServerEngine/ServerEngine.h>
 #include <RiftForged/GameLogic/PlayerManager/PlayerManager.h>
 #include <RiftForged/Utilities/Logger/Logger.h>
+#include <RiftForged/Network/VerifiedC2SMessage/VerifiedC2SMessage.h> // Verified once by UDPPacketHandler
 
 // This class is now the ONLY place in the dispatch pipeline that includes the raw message definitions.
 #include <RiftForged/Dispatch/GeneratedProtocols/V0.0.5/riftforged_c2s_udp_messages_generated.h>
@@ -26,23 +27,13 @@ namespace RiftForged {
             RF_NETWORK_INFO("PacketProcessor: Initialized.");
         }
 
-        void PacketProcessor::ProcessIncomingPacket(
-            const Networking::NetworkEndpoint& sender_endpoint,
-            const uint8_t* data,
-            uint16_t size)
+        void PacketProcessor::ProcessIncomingPacket(const Networking::VerifiedC2SMessage& message)
         {
-            // --- 1. Verify and unpack the root FlatBuffer message ---
-            flatbuffers::Verifier verifier(data, size);
-            if (!Networking::UDP::C2S::VerifyRoot_C2S_UDP_MessageBuffer(verifier)) {
-                RF_NETWORK_WARN("PacketProcessor: Incoming packet from {} failed verification. Discarding.", sender_endpoint.ToString());
-                return;
-            }
-            const auto* root_message = Networking::UDP::C2S::GetRoot_C2S_UDP_Message(data);
-            if (!root_message || !root_message->payload()) {
-                RF_NETWORK_WARN("PacketProcessor: Packet from {} has no payload. Discarding.", sender_endpoint.ToString());
-                return;
-            }
-            const auto payload_type = root_message->payload_type();
+            // --- 1. Unpack the root FlatBuffer message ---
+            // VerifyC2SMessage already ran the verifier and checked for a payload; it is not run again.
+            const Networking::NetworkEndpoint& sender_endpoint = message.sender;
+            const auto* root_message = message.root;
+            const auto payload_type = message.payloadType;
 
             // --- 2. Get the PlayerID for the sender ---
             // The PlayerManager is now our source for identity, not the NetworkEndpoint itself.
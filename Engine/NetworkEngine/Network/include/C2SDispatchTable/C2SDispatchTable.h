@@ -0,0 +1,93 @@
+﻿// File: C2SDispatchTable.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Handler table for client messages, indexed directly by the C2S_UDP_Payload union
+// discriminator and filled by RegisterHandler<T>().
+
+#pragma once
+
+#include "NetworkCommon.h"      // For S2C_Response
+#include "VerifiedC2SMessage.h" // For VerifiedC2SMessage, C2S_UDP_Payload, C2S_UDP_PayloadTraits
+
+#include <array>    // For std::array
+#include <cstdint>  // For uint8_t, size_t
+#include <optional> // For std::optional
+
+namespace RiftForged {
+    namespace GameLogic { struct ActivePlayer; }
+
+    namespace Networking {
+
+        enum class C2SDispatchStatus : uint8_t {
+            Dispatched,
+            NoHandler,      // Nothing registered for the payload type (or it is newer than this build)
+            PlayerRequired  // The handler needs a player and the session has none yet
+        };
+
+        // C2SDispatchTable routes a verified client message to the handler registered for its
+        // payload type. Each entry holds the handler and a thunk generated for its (message type,
+        // handler type) pair, so the call into Handler::Process is bound at compile time and a
+        // dispatch is one array index plus one indirect call.
+        //
+        // A handler is any object with
+        //     std::optional<S2C_Response> Process(const NetworkEndpoint&, GameLogic::ActivePlayer*, const T*);
+        // for the FlatBuffers message table T it is registered for. Supporting a new message type
+        // is one RegisterHandler<T>() line; the union traits generated by flatc supply its index.
+        //
+        // Filled during startup and read-only afterwards, so Dispatch is safe from any thread.
+        // Handlers are not owned and must outlive the table.
+        class C2SDispatchTable {
+        public:
+            /**
+             * @brief Binds 'handler' to message table T, replacing any earlier registration.
+             * @param requiresPlayer False only for messages sent before a player exists (JoinRequest).
+             */
+            template<typename T, typename Handler>
+            void RegisterHandler(Handler& handler, bool requiresPlayer = true) {
+                constexpr UDP::C2S::C2S_UDP_Payload payloadType = UDP::C2S::C2S_UDP_PayloadTraits<T>::enum_value;
+                static_assert(payloadType != UDP::C2S::C2S_UDP_Payload_NONE, "T is not a member of the C2S_UDP_Payload union");
+                m_entries[payloadType] = Entry{ &Invoke<T, Handler>, &handler, requiresPlayer };
+            }
+
+            bool IsRegistered(UDP::C2S::C2S_UDP_Payload payloadType) const {
+                return payloadType <= UDP::C2S::C2S_UDP_Payload_MAX && m_entries[payloadType].thunk != nullptr;
+            }
+
+            // Calls the registered handler; 'out_status' says why nothing was called.
+            std::optional<S2C_Response> Dispatch(const VerifiedC2SMessage& message,
+                GameLogic::ActivePlayer* player,
+                C2SDispatchStatus& out_status) const {
+                // The verifier accepts union types it does not know, so the index is checked here.
+                if (!IsRegistered(message.payloadType)) {
+                    out_status = C2SDispatchStatus::NoHandler;
+                    return std::nullopt;
+                }
+                const Entry& entry = m_entries[message.payloadType];
+                if (entry.requiresPlayer && !player) {
+                    out_status = C2SDispatchStatus::PlayerRequired;
+                    return std::nullopt;
+                }
+                out_status = C2SDispatchStatus::Dispatched;
+                return entry.thunk(entry.handler, message, player);
+            }
+
+        private:
+            using Thunk = std::optional<S2C_Response>(*)(void* handler, const VerifiedC2SMessage& message, GameLogic::ActivePlayer* player);
+
+            struct Entry {
+                Thunk thunk = nullptr;
+                void* handler = nullptr;
+                bool requiresPlayer = true;
+            };
+
+            // The payload type matched T when the entry was chosen, so payload_as<T>() cannot fail.
+            template<typename T, typename Handler>
+            static std::optional<S2C_Response> Invoke(void* handler, const VerifiedC2SMessage& message, GameLogic::ActivePlayer* player) {
+                return static_cast<Handler*>(handler)->Process(message.sender, player, message.PayloadAs<T>());
+            }
+
+            std::array<Entry, static_cast<size_t>(UDP::C2S::C2S_UDP_Payload_MAX) + 1> m_entries{};
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,106 @@
+﻿// File: CongestionController.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Per-connection AIMD congestion window and send pacer. Decides how many bytes of
+// reliable data may be in flight and spreads datagrams over time instead of bursting a tick.
+
+#pragma once
+
+#include "MessageCoalescing.h" // For COALESCED_DATAGRAM_MAX_SIZE
+
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdint>  // For uint32_t, uint64_t
+
+// Datagram size the window is measured in.
+const uint32_t CONGESTION_MAX_DATAGRAM_SIZE = COALESCED_DATAGRAM_MAX_SIZE;
+const uint32_t CONGESTION_INITIAL_WINDOW_BYTES = 10 * CONGESTION_MAX_DATAGRAM_SIZE;
+const uint32_t CONGESTION_MIN_WINDOW_BYTES = 2 * CONGESTION_MAX_DATAGRAM_SIZE;
+const uint32_t CONGESTION_MAX_WINDOW_BYTES = 1024 * 1024;
+// Pacing rate = gain * cwnd / SRTT, so a full window drains a little faster than one RTT.
+const float CONGESTION_PACING_GAIN = 1.25f;
+// Bytes the pacer lets out back to back before spacing datagrams.
+const uint32_t CONGESTION_PACING_BURST_BYTES = 4 * CONGESTION_MAX_DATAGRAM_SIZE;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Snapshot of one connection's congestion state.
+        struct CongestionStats {
+            uint32_t congestionWindowBytes = 0;
+            uint32_t slowStartThresholdBytes = 0;
+            uint32_t bytesInFlight = 0;
+            float pacingRateBytesPerSecond = 0.0f;
+            uint64_t lossEvents = 0;     // Window reductions (at most one per round trip)
+            uint64_t timeoutEvents = 0;  // Reductions caused by an RTO rather than a detected gap
+            uint64_t sendsDeferred = 0;  // Times the assembler held data back for the window or pacer
+        };
+
+        // CongestionController implements a Reno-style AIMD window in bytes: slow start doubles the
+        // window per round trip up to ssthresh, congestion avoidance then adds one datagram per
+        // window acknowledged. A loss halves the window once per round trip (losses of packets sent
+        // before the reduction do not reduce it again); an RTO also collapses it to the minimum.
+        //
+        // Only reliable packets count against the window, since only they are acknowledged. Every
+        // datagram, reliable or not (including retransmissions), spends pacer tokens, which refill
+        // at CONGESTION_PACING_GAIN * cwnd / SRTT.
+        //
+        // Not thread-safe; ReliableConnectionState::internalStateMutex guards it.
+        class CongestionController {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            CongestionController() { Reset(); }
+
+            void Reset();
+
+            /**
+             * @brief Whether a datagram of 'bytes' may be sent now.
+             * @param countsAgainstWindow True for new reliable data.
+             * @param out_retryTime If refused, receives when the pacer will allow it, or
+             * time_point::max() if the window is full (an acknowledgement must arrive first).
+             */
+            bool CanSend(uint32_t bytes, bool countsAgainstWindow, Clock::time_point now, float smoothedRTT_ms,
+                Clock::time_point* out_retryTime);
+
+            // A datagram left: spends pacer tokens and, if 'inFlight', adds it to the bytes in flight.
+            void OnPacketSent(uint32_t bytes, bool inFlight, Clock::time_point now, float smoothedRTT_ms);
+
+            // A reliable packet of 'bytes' was acknowledged.
+            void OnPacketAcked(uint32_t bytes);
+
+            /**
+             * @brief A reliable packet was declared lost.
+             * @param lostSequence Its sequence number; losses older than the last reduction are ignored.
+             * @param nextSequence The next sequence number to be sent (end of the new recovery epoch).
+             * @param timeout True if found by RTO expiry.
+             */
+            void OnPacketLost(uint32_t lostSequence, uint32_t nextSequence, bool timeout);
+
+            // A reliable packet was given up on (max retries); it no longer occupies the window.
+            void OnPacketAbandoned(uint32_t bytes);
+
+            void NoteSendDeferred() { ++m_sendsDeferred; }
+
+            CongestionStats GetStats(float smoothedRTT_ms) const;
+
+        private:
+            float PacingRate(float smoothedRTT_ms) const;
+            void RefillTokens(Clock::time_point now, float smoothedRTT_ms);
+
+            uint32_t m_congestionWindow = 0;
+            uint32_t m_slowStartThreshold = 0;
+            uint32_t m_bytesInFlight = 0;
+            uint32_t m_bytesAckedInAvoidance = 0; // Acked bytes not yet turned into window growth
+            uint32_t m_recoveryEndSequence = 0;
+            bool m_inRecovery = false;
+
+            float m_pacingTokens = 0.0f;
+            Clock::time_point m_lastRefill;
+
+            uint64_t m_lossEvents = 0;
+            uint64_t m_timeoutEvents = 0;
+            uint64_t m_sendsDeferred = 0;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
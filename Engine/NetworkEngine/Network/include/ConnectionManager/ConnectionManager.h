@@ -0,0 +1,509 @@
+﻿// File: ConnectionManager.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: The transport half of the UDP packet handler: the cookie handshake, client
+// sessions, reliability, delivery channels, coalescing, compression, inbound rate limits,
+// telemetry and the reliability timer thread. Application payloads it releases are handed to
+// DispatchApplicationPayload, which a subclass (UDPPacketHandler) implements; nothing here knows
+// the message schema.
+
+#pragma once
+
+#include "INetworkIOEvents.h"      // Implements this interface to receive events from the INetworkIO
+#include "NetworkEndpoint.h"       // For representing remote client addresses
+#include "GamePacketHeader.h"      // Defines GamePacketHeader structure
+#include "UDPReliabilityProtocol.h"// Defines ReliableConnectionState and associated reliability logic/types
+#include "PacketBufferPool.h"      // Pooled, shared payload buffers for outgoing packets
+#include "TimerWheel.h"            // Retransmit / ACK / stale deadlines
+#include "SessionTable.h"          // Connection ID -> session, plus the endpoint index
+#include "HandshakeCookie.h"       // Stateless join cookies
+#include "MessageCoalescing.h"     // Several messages per datagram
+#include "DeliveryChannel.h"       // Per-channel ordering of sends
+#include "PayloadCompression.h"    // Optional zstd payload compression
+#include "InboundRateLimiter.h"    // Per-connection inbound token buckets
+#include "ConnectionTelemetry.h"   // Connection quality counters and RTT histograms
+
+#include <string>
+#include <vector>
+#include <memory>      // For std::shared_ptr
+#include <mutex>       // For std::mutex
+#include <condition_variable> // For waking the reliability thread when an earlier timer is armed
+#include <thread>      // For std::thread (reliability thread)
+#include <atomic>      // For std::atomic_bool
+#include <chrono>      // For std::chrono::steady_clock
+#include <span>        // For std::span (batched receive)
+#include <array>       // For std::array (per-class rate limits)
+#include <map>         // For std::map (telemetry of closed connections by shard)
+#include <fstream>     // For std::ofstream (telemetry dump)
+
+namespace RiftForged {
+    namespace Networking {
+        class INetworkIO;          // Interface to the underlying network transport (e.g., UDPSocketAsync)
+        struct OverlappedIOContext; // Defined in OverlappedIOContext.h, passed by INetworkIOEvents
+        class PacketCaptureWriter; // Optional recorder for inbound datagrams (PacketCapture.h)
+    }
+}
+
+// Longest the reliability thread sleeps when no timer is due. Its only periodic work is flushing
+// sends queued outside a tick; retransmits, ACKs and expiry run from the timer wheel.
+const int RELIABILITY_THREAD_SLEEP_MS_PKT = 20;
+// DEFAULT_RTO_MS_PKT and DEFAULT_MAX_RETRIES_PKT are defined/used in UDPReliabilityProtocol.h
+const int STALE_CONNECTION_TIMEOUT_SECONDS_PKT = 60; // Duration of inactivity before a connection is considered stale.
+
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Counters for the join handshake and for datagrams dropped before any state was touched.
+        struct HandshakeStats {
+            uint64_t challengesSent = 0;     // Cookies issued in reply to connect requests
+            uint64_t handshakesAccepted = 0; // Connect responses with a valid cookie
+            uint64_t cookiesRejected = 0;    // Connect responses with a forged, expired or misaddressed cookie
+            uint64_t rebindsRejected = 0;    // Claims of another address's connection ID without a valid secret proof
+            uint64_t rebindConflicts = 0;    // Proven rebinds to an address another session already uses
+            uint64_t unknownSourceDrops = 0; // Non-handshake datagrams from addresses without a session
+            uint64_t malformedDrops = 0;     // Too short, wrong protocol ID or unexpected handshake step
+        };
+
+        class ConnectionManager : public INetworkIOEvents {
+        public:
+            /**
+             * @brief Constructor for ConnectionManager.
+             * @param networkIO A pointer to an INetworkIO compliant object (e.g., UDPSocketAsync instance)
+             * which this manager will use to send raw data.
+             */
+            explicit ConnectionManager(INetworkIO* networkIO);
+
+            // Subclasses must call Stop() in their own destructor: the reliability thread calls
+            // OnConnectionsDropped, which must not run once the subclass is gone.
+            ~ConnectionManager() override;
+
+            // Disable copy and assignment to prevent accidental copying of state
+            ConnectionManager(const ConnectionManager&) = delete;
+            ConnectionManager& operator=(const ConnectionManager&) = delete;
+
+            /**
+             * @brief Starts the reliability management thread. Splits the session table into one
+             * shard per INetworkIO receive shard, so call it after the INetworkIO has been initialized.
+             * @return True if successfully started, false otherwise.
+             */
+            bool Start();
+
+            /**
+             * @brief Stops the reliability management thread and drops every session.
+             */
+            void Stop();
+
+            // --- INetworkIOEvents Implementation ---
+            // These methods are called by the INetworkIO layer.
+
+            /**
+             * @brief Called by the INetworkIO when a raw datagram is received.
+             * This is the main entry point for incoming packets. This method will
+             * parse the GamePacketHeader, run reliability checks, and hand every application
+             * payload it releases to DispatchApplicationPayload.
+             */
+            void OnRawDataReceived(const NetworkEndpoint& sender,
+                const uint8_t* data,
+                uint32_t size,
+                OverlappedIOContext* context) override;
+
+            /**
+             * @brief Called by the network IO layer with every datagram one wakeup produced.
+             * Processes them in order, then flushes all resulting sends with a single FlushSendQueue.
+             */
+            void OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) override;
+
+            /**
+             * @brief Called by the INetworkIO when an asynchronous send operation completes.
+             */
+            void OnSendCompleted(OverlappedIOContext* context,
+                bool success,
+                uint32_t bytesSent) override;
+
+            /**
+             * @brief Called by the INetworkIO when a non-operation-specific network error occurs.
+             */
+            void OnNetworkError(const std::string& errorMessage, int errorCode = 0) override;
+
+            void SetNetworkIO(INetworkIO* networkIO) {
+                m_networkIO = networkIO;
+            }
+
+            /**
+             * @brief Records every inbound datagram (before any validation) to 'writer'. Pass nullptr
+             * to stop recording. The writer must outlive its registration.
+             */
+            void SetPacketCaptureWriter(PacketCaptureWriter* writer) {
+                m_captureWriter.store(writer, std::memory_order_release);
+            }
+
+            // --- Public Sending Interface ---
+            // These methods are called by higher layers (e.g., MessageHandler responses, game systems)
+            // to send data to clients. Messages are staged per connection and leave the machine on the
+            // next flush: after each receive batch, every reliability pass, or an explicit FlushOutgoing().
+            // At flush time each connection's staged messages are packed into as few MTU-sized datagrams
+            // as possible, sharing one header and one set of ACK fields (see MessageCoalescing.h).
+            // Reliable messages too large for one datagram (up to REASSEMBLY_ARENA_SIZE) are sent as
+            // fragments and reassembled by the peer. Messages sent with additionalFlags go out alone,
+            // immediately prepared.
+            // Staged messages are also subject to the connection's CongestionController: reliable data
+            // waits while the congestion window is full, and every datagram is paced at a rate derived
+            // from the window and SRTT. Deferred messages stay staged and leave on a later flush.
+            // Every message travels on a DeliveryChannel with its own sequencing: SendReliablePacket and
+            // SendUnreliablePacket use the unordered channels, SendOnChannel any of them.
+            // 'payloadType' is the application's message type; it is carried in coalesced frames.
+
+            /**
+             * @brief Assembles and flushes every message staged since the last flush. Call once per
+             * server tick after game systems have issued their sends so the whole tick goes out in one batch.
+             */
+            void FlushOutgoing();
+
+            /**
+             * @brief Sends a message reliably to a specific recipient. The buffer is shared, not
+             * copied: sending one PacketBufferRef to many recipients serializes the message once, and
+             * retransmissions reuse it as well.
+             * @param recipient The target client endpoint (its current or join address).
+             * @param additionalFlags Any extra flags for the GamePacketHeader (e.g., IS_HEARTBEAT).
+             * @return True if the packet was successfully staged or queued for sending, false otherwise.
+             */
+            bool SendReliablePacket(const NetworkEndpoint& recipient,
+                uint8_t payloadType,
+                const PacketBufferRef& payload,
+                uint8_t additionalFlags = 0);
+
+            /**
+             * @brief Sends a message unreliably to a specific recipient.
+             * Adds basic packet headers but does not queue for retransmission.
+             * @return True if the packet was successfully staged or queued for sending, false otherwise.
+             */
+            bool SendUnreliablePacket(const NetworkEndpoint& recipient,
+                uint8_t payloadType,
+                const PacketBufferRef& payload,
+                uint8_t additionalFlags = 0);
+
+            /**
+             * @brief Stages a message on a specific delivery channel; reliability and ordering follow
+             * the channel's ChannelMode. Use DeliveryChannel::GameplayEvents only where the order of
+             * messages matters: a loss there holds back every later message on that channel.
+             * @return True if the message was staged, false otherwise.
+             */
+            bool SendOnChannel(const NetworkEndpoint& recipient,
+                DeliveryChannel channel,
+                uint8_t payloadType,
+                const PacketBufferRef& payload);
+
+            /**
+             * @brief Copies a serialized message into a pooled buffer once, for sending to several
+             * recipients.
+             */
+            PacketBufferRef AcquirePayloadBuffer(const uint8_t* data, uint32_t size);
+
+            /**
+             * @brief Sends an ACK-only packet, typically triggered by the reliability protocol.
+             * @param recipient The endpoint to send the ACK to.
+             * @param connectionState The reliability state for the connection, containing ACK info.
+             * @return True if the ACK packet was sent, false otherwise.
+             */
+            bool SendAckPacket(const NetworkEndpoint& recipient, ReliableConnectionState& connectionState);
+
+            /**
+             * @brief Records the player (and shard) behind a client's session once it has joined, so
+             * later packets from it resolve the player from the session.
+             * @param endpoint The endpoint the client joined from.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool BindPlayerToConnection(const NetworkEndpoint& endpoint, uint64_t playerId, uint32_t shardIndex = 0);
+
+            HandshakeStats GetHandshakeStats() const;
+
+            // Number of client sessions, summed over every shard.
+            size_t GetSessionCount();
+
+            /**
+             * @brief Current address of the session with 'connectionId' (after any rebind).
+             * @return False if there is no such session.
+             */
+            bool GetConnectionEndpoint(uint32_t connectionId, NetworkEndpoint& out_endpoint);
+
+            /**
+             * @brief Snapshot of a client's congestion window, bytes in flight and pacing rate.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool GetConnectionCongestionStats(const NetworkEndpoint& endpoint, CongestionStats& out_stats);
+
+            /**
+             * @brief Timeout, fast and spurious fast retransmissions for a client; the spurious share
+             * guides FAST_RETRANSMIT_PACKET_THRESHOLD.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool GetConnectionRetransmitStats(const NetworkEndpoint& endpoint, RetransmitStats& out_stats);
+
+            /**
+             * @brief Loads the zstd dictionary (trained offline from captured traffic) used for payload
+             * compression. Clients must load the same file. Call before Start().
+             */
+            bool LoadCompressionDictionary(const std::string& path);
+
+            // CPU time payload compression may use per second across all clients; 0 disables it for
+            // new connections and stops it on existing ones.
+            void SetCompressionCpuBudget(uint32_t microsecondsPerSecond);
+
+            CompressionStats GetCompressionStats() const;
+
+            /**
+             * @brief Bytes a client's payloads took before and after compression, and how often
+             * compression was skipped for the CPU budget.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool GetConnectionCompressionStats(const NetworkEndpoint& endpoint, CompressionStats& out_stats);
+
+            // --- Inbound Rate Limiting ---
+            // Every client has a token bucket for its datagrams and one per InboundRateClass of
+            // message. Datagrams are checked right after the session lookup, before they are
+            // acknowledged, and unreliable messages by the subclass before it parses them
+            // (AdmitInboundMessage), so whatever a client sends beyond its limits is dropped and
+            // counted for a bounded cost. Reliable messages are bounded by the datagram bucket only:
+            // by the time they are dispatched they have been acknowledged, and a drop would lose them.
+
+            /**
+             * @brief Sets the limit of 'rateClass' for connections created from now on. Call before Start();
+             * receive threads read the limits without a lock.
+             */
+            void SetInboundRateLimit(InboundRateClass rateClass, const InboundRateLimit& limit);
+
+            // Drops by the rate limiter, summed over all clients (including ones already gone).
+            InboundRateLimitStats GetInboundRateLimitStats() const;
+
+            /**
+             * @brief Datagrams and messages of one client dropped by the rate limiter.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool GetConnectionRateLimitStats(const NetworkEndpoint& endpoint, InboundRateLimitStats& out_stats);
+
+            // --- Connection Telemetry ---
+            // Every connection counts its traffic, retransmissions, duplicates and reordering and
+            // keeps an RTT histogram (see ConnectionTelemetry.h). Reading them never takes a
+            // connection's lock, so snapshots are safe to take at any rate.
+
+            /**
+             * @brief Totals per shard over live connections and those already closed. Connections
+             * not yet bound to a shard count towards shard 0.
+             */
+            TelemetrySnapshot GetTelemetrySnapshot();
+
+            /**
+             * @brief Counters and RTT histogram of one client.
+             * @return False if there is no session for 'endpoint'.
+             */
+            bool GetConnectionTelemetry(const NetworkEndpoint& endpoint, ConnectionTelemetrySnapshot& out_telemetry);
+
+            /**
+             * @brief Appends a snapshot to 'path' every 'interval', one JSON object per shard and line
+             * (see AppendTelemetryJsonLines), written by the reliability thread. Replaces any dump
+             * already running.
+             * @return False if the file cannot be opened.
+             */
+            bool StartTelemetryDump(const std::string& path,
+                std::chrono::seconds interval = std::chrono::seconds(TELEMETRY_DEFAULT_DUMP_INTERVAL_SECONDS));
+
+            // Writes a last snapshot and closes the dump file. Stop() calls it.
+            void StopTelemetryDump();
+
+        protected:
+            /**
+             * @brief Handles one application message released by the reliability protocol, on the
+             * receive thread that read it. Sends it makes are flushed with the rest of the batch.
+             * @param session A copy of the client's session; changes to it are not written back
+             * (see SetSessionPlayerId).
+             * @param reliable The message arrived reliably and has already been acknowledged.
+             */
+            virtual void DispatchApplicationPayload(const NetworkEndpoint& sender,
+                ConnectionSession& session,
+                const uint8_t* payload,
+                uint32_t payloadSize,
+                bool reliable) = 0;
+
+            /**
+             * @brief Called on the reliability thread, outside every lock, with the join addresses of
+             * sessions that timed out or exhausted their retransmissions.
+             */
+            virtual void OnConnectionsDropped(const std::vector<NetworkEndpoint>& /*joinEndpoints*/) {}
+
+            // Charges one unreliable message of 'rateClass' to the client; false (and counted) if over
+            // its limit. Reliable messages are always admitted and not charged.
+            bool AdmitInboundMessage(ConnectionSession& session, InboundRateClass rateClass, bool reliable);
+
+            // Stores a newly resolved player ID in 'session' and in the live session it was copied from.
+            void SetSessionPlayerId(ConnectionSession& session, uint64_t playerId);
+
+        private:
+            // --- Internal Reliability Protocol Methods ---
+
+            void ReliabilityManagementThread(); // Runs expired reliability timers: retransmissions, timeouts, pending ACKs.
+
+            // One armed deadline of one connection. The session is looked up by ID when the timer
+            // fires, so it sends to the client's current address even if that changed meanwhile.
+            struct ReliabilityTimer {
+                std::weak_ptr<ReliableConnectionState> state;
+                uint32_t connectionId;
+                ReliabilityTimerKind kind;
+                std::chrono::steady_clock::time_point deadline;
+            };
+
+            // The sessions created by one INetworkIO receive shard and the lock that guards them.
+            struct SessionShard {
+                SessionTable sessions;
+                std::mutex mutex;
+
+                SessionShard(uint32_t shardIndex, uint32_t shardBits)
+                    : sessions(MAX_CONNECTION_SESSIONS, shardIndex, shardBits) {}
+            };
+
+            /**
+             * @brief Arms 'kind' for the connection unless an earlier deadline is already armed.
+             * Safe from any thread; wakes the reliability thread if it is sleeping past 'deadline'.
+             */
+            void ArmReliabilityTimer(const std::shared_ptr<ReliableConnectionState>& state,
+                ReliabilityTimerKind kind,
+                std::chrono::steady_clock::time_point deadline);
+
+            // Arms the retransmit timer one RTO from now (after a reliable send).
+            void ArmRetransmitTimer(const std::shared_ptr<ReliableConnectionState>& state);
+
+            // Handles one expired timer on the reliability thread. Sends are queued; connections to
+            // drop are appended to 'droppedEndpoints' for notification outside any lock.
+            void HandleReliabilityTimer(const ReliabilityTimer& timer,
+                std::chrono::steady_clock::time_point currentTime,
+                std::vector<NetworkEndpoint>& droppedEndpoints);
+
+            // Removes the session if 'state' is still the one registered under 'connectionId'. On
+            // success 'out_joinEndpoint' receives the address game code knows the client by.
+            bool RemoveSession(uint32_t connectionId, const std::shared_ptr<ReliableConnectionState>& state,
+                NetworkEndpoint& out_joinEndpoint);
+
+            // Current address of the session 'state' belongs to; false if the session is gone.
+            bool GetSessionEndpoint(const std::shared_ptr<ReliableConnectionState>& state, NetworkEndpoint& out_endpoint);
+
+            // Finds the session for an incoming non-handshake packet, by the header's connection ID or
+            // else by address in the table of the receiving 'ioShard', and copies it into
+            // 'out_session'. Never creates one: returns false for addresses without a session and for
+            // a known ID arriving from an address it has not handshaked from.
+            bool ResolveIncomingSession(const NetworkEndpoint& sender, uint32_t connectionId, uint32_t ioShard,
+                ConnectionSession& out_session);
+
+            // Steps 1 and 3 of the join handshake (see GamePacketHeader.h). Only a connect response
+            // carrying a valid cookie creates a session (in the table of 'ioShard') or moves one to a
+            // new address.
+            void HandleHandshakePacket(const NetworkEndpoint& sender,
+                uint32_t ioShard,
+                const GamePacketHeader& header,
+                const uint8_t* payload,
+                uint32_t payloadSize);
+
+            // Header/reliability/dispatch processing for one datagram received on 'ioShard'. Sends are
+            // queued, not flushed.
+            void ProcessIncomingDatagram(const NetworkEndpoint& sender,
+                const uint8_t* data,
+                uint32_t size,
+                OverlappedIOContext* context,
+                uint32_t ioShard);
+
+            // Dispatches a payload released by the reliability protocol, one message per frame if 'coalesced'.
+            void DispatchRelayedPayload(const NetworkEndpoint& sender,
+                ConnectionSession& session,
+                const uint8_t* payload,
+                uint32_t payloadSize,
+                bool coalesced,
+                bool reliable);
+
+            // Stages a message on the connection and puts the connection on the assembly list.
+            bool StageOutgoingMessage(const std::shared_ptr<ReliableConnectionState>& state,
+                uint8_t payloadType,
+                const PacketBufferRef& payload,
+                DeliveryChannel channel);
+
+            // Packs the staged messages of every connection on the assembly list into datagrams and
+            // queues them on the INetworkIO. Runs before every FlushSendQueue().
+            void AssembleOutgoing();
+
+            // Gets or creates the reliability state for the session reached through 'endpoint' (its
+            // current or join address). 'out_destination' receives the address to send to.
+            std::shared_ptr<ReliableConnectionState> GetOrCreateReliabilityState(const NetworkEndpoint& endpoint, NetworkEndpoint& out_destination);
+
+            // Creates a session for 'endpoint' in 'shard'. Caller holds shard.mutex and has checked that
+            // no other shard knows 'endpoint'.
+            ConnectionSession* CreateSessionLocked(SessionShard& shard, const NetworkEndpoint& endpoint);
+
+            // Replaces the session shards with one per INetworkIO receive shard. Only while stopped.
+            void ResizeSessionShards();
+
+            // Shard whose table issued 'connectionId', or nullptr if no shard could have.
+            SessionShard* GetSessionShardForConnection(uint32_t connectionId);
+
+            // Shard the INetworkIO receive shard 'ioShard' creates sessions in.
+            SessionShard& GetSessionShardForIO(uint32_t ioShard) {
+                return *m_sessionShards[ioShard % m_sessionShards.size()];
+            }
+
+            // Reliability state of the session reached through 'endpoint' (current or join address),
+            // looked up in every shard; nullptr if there is none.
+            std::shared_ptr<ReliableConnectionState> FindSessionStateByEndpoint(const NetworkEndpoint& endpoint);
+
+            // Appends a snapshot to the dump file if one is open and its interval has passed.
+            void DumpTelemetryIfDue(std::chrono::steady_clock::time_point now);
+
+            // Appends a snapshot to the dump file. Caller holds m_telemetryDumpMutex.
+            void WriteTelemetryDumpLocked();
+
+            INetworkIO* m_networkIO = nullptr;
+            HandshakeCookieGenerator m_cookieGenerator;
+            std::atomic<uint64_t> m_challengesSent{ 0 };
+            std::atomic<uint64_t> m_handshakesAccepted{ 0 };
+            std::atomic<uint64_t> m_cookiesRejected{ 0 };
+            std::atomic<uint64_t> m_rebindsRejected{ 0 };
+            std::atomic<uint64_t> m_rebindConflicts{ 0 };
+            std::atomic<uint64_t> m_unknownSourceDrops{ 0 };
+            std::atomic<uint64_t> m_malformedDrops{ 0 };
+            std::atomic<PacketCaptureWriter*> m_captureWriter{ nullptr }; // Inbound traffic recorder, if capturing
+            PacketBufferPool m_payloadPool; // Outgoing payloads, shared by the send queue, retransmit list and broadcasts
+            PayloadCompressor m_payloadCompressor; // Shared by every session; declared before m_sessionShards so it outlives them
+            std::array<InboundRateLimit, INBOUND_RATE_CLASS_COUNT> m_inboundRateLimits; // For new sessions; set before Start()
+            std::array<std::atomic<uint64_t>, INBOUND_RATE_CLASS_COUNT> m_rateLimitedDrops{};
+
+            // Connections with staged messages. A connection is listed once until assembly drains it.
+            std::vector<std::shared_ptr<ReliableConnectionState>> m_outboundAssemblyList;
+            std::vector<std::shared_ptr<ReliableConnectionState>> m_outboundAssemblyScratch; // Guarded by m_outboundAssemblyRunMutex
+            std::vector<OutgoingPacket> m_outboundPacketScratch;                             // Guarded by m_outboundAssemblyRunMutex
+            std::mutex m_outboundAssemblyMutex;    // Protects m_outboundAssemblyList
+            std::mutex m_outboundAssemblyRunMutex; // Serializes AssembleOutgoing() between receive and reliability threads
+
+            std::atomic<bool> m_isRunning;     // Controls the reliability thread loop
+
+            // Client sessions, split by the INetworkIO receive shard that created them so receive
+            // threads never contend for one lock. Sized by Start(); the vector itself is only changed
+            // while stopped. A connection ID names its shard (GetConnectionIdShard); an address is
+            // looked up in the receiving shard's table on the packet path and in every table elsewhere.
+            std::vector<std::unique_ptr<SessionShard>> m_sessionShards;
+            uint32_t m_sessionShardBits = 0;
+            std::mutex m_closedTelemetryMutex;   // Protects m_closedConnectionTelemetry; taken after a shard lock, never before
+            // Final counters of removed sessions, by game shard, so shard totals never go backwards.
+            std::map<uint32_t, ConnectionTelemetrySnapshot> m_closedConnectionTelemetry;
+
+            std::mutex m_telemetryDumpMutex;     // Protects the three members below
+            std::ofstream m_telemetryDumpFile;
+            std::chrono::steady_clock::duration m_telemetryDumpInterval{};
+            std::chrono::steady_clock::time_point m_nextTelemetryDump = std::chrono::steady_clock::time_point::max();
+            std::thread m_reliabilityThread;     // Thread dedicated to reliability tasks
+
+            // Reliability timers. Work per wakeup is proportional to the timers that expired, not to
+            // the number of connections.
+            TimerWheel<ReliabilityTimer> m_timerWheel;
+            std::mutex m_timerMutex;                     // Protects m_timerWheel and m_timerThreadWakeTime
+            std::condition_variable m_timerCondition;    // Signalled when an earlier deadline is armed or on Stop()
+            std::chrono::steady_clock::time_point m_timerThreadWakeTime = std::chrono::steady_clock::time_point::max();
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,149 @@
+﻿// File: ConnectionTable.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Open-addressing hash table keyed by NetworkEndpoint. A lookup is one probe sequence
+// over a flat slot array using the endpoint's precomputed hash; lookups never allocate.
+
+#pragma once
+
+#include "NetworkEndpoint.h" // Key type and its precomputed hash
+
+#include <cstdint>          // For uint32_t
+#include <utility>          // For std::pair, std::move
+#include <vector>           // For std::vector
+
+// Slots allocated up front by a default-constructed ConnectionTable.
+const uint32_t CONNECTION_TABLE_DEFAULT_CAPACITY = 1024;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // ConnectionTable maps NetworkEndpoint -> V with linear probing over a power-of-two slot
+        // array kept at most 7/8 full. Erase uses backward-shift
+        // deletion, so there are no tombstones and probe sequences stay short under churn.
+        //
+        // Pointers returned by Find()/FindOrInsert() stay valid until the next insert or erase.
+        // Not thread-safe; the owner serializes access.
+        template <typename V>
+        class ConnectionTable {
+        public:
+            explicit ConnectionTable(uint32_t initialCapacity = CONNECTION_TABLE_DEFAULT_CAPACITY) {
+                m_slots.resize(RoundUpToPowerOfTwo(initialCapacity < 8 ? 8 : initialCapacity));
+                m_mask = static_cast<uint32_t>(m_slots.size()) - 1;
+            }
+
+            V* Find(const NetworkEndpoint& key) {
+                for (uint32_t index = key.Hash() & m_mask;; index = (index + 1) & m_mask) {
+                    Slot& slot = m_slots[index];
+                    if (!slot.occupied) return nullptr;
+                    if (slot.key == key) return &slot.value;
+                }
+            }
+
+            const V* Find(const NetworkEndpoint& key) const {
+                return const_cast<ConnectionTable*>(this)->Find(key);
+            }
+
+            /**
+             * @brief Returns the value for 'key', default-constructing it if absent.
+             * @return The value and whether it was inserted by this call.
+             */
+            std::pair<V*, bool> FindOrInsert(const NetworkEndpoint& key) {
+                if ((m_size + 1) * 8 > m_slots.size() * 7) {
+                    Rehash(static_cast<uint32_t>(m_slots.size()) * 2);
+                }
+                uint32_t index = key.Hash() & m_mask;
+                for (;; index = (index + 1) & m_mask) {
+                    Slot& slot = m_slots[index];
+                    if (!slot.occupied) break;
+                    if (slot.key == key) return { &slot.value, false };
+                }
+                Slot& slot = m_slots[index];
+                slot.key = key;
+                slot.value = V();
+                slot.occupied = true;
+                ++m_size;
+                return { &slot.value, true };
+            }
+
+            bool Erase(const NetworkEndpoint& key) {
+                uint32_t index = key.Hash() & m_mask;
+                for (;; index = (index + 1) & m_mask) {
+                    if (!m_slots[index].occupied) return false;
+                    if (m_slots[index].key == key) break;
+                }
+                // Backward shift: pull later members of the cluster into the hole when their home
+                // slot does not lie strictly between the hole and their current position.
+                uint32_t hole = index;
+                for (uint32_t next = (hole + 1) & m_mask; m_slots[next].occupied; next = (next + 1) & m_mask) {
+                    const uint32_t home = m_slots[next].key.Hash() & m_mask;
+                    if (((next - home) & m_mask) >= ((next - hole) & m_mask)) {
+                        m_slots[hole].key = m_slots[next].key;
+                        m_slots[hole].value = std::move(m_slots[next].value);
+                        hole = next;
+                    }
+                }
+                m_slots[hole].occupied = false;
+                m_slots[hole].value = V(); // Release whatever the value holds.
+                --m_size;
+                return true;
+            }
+
+            // Calls fn(const NetworkEndpoint&, V&) for every entry. fn must not insert or erase.
+            template <typename Fn>
+            void ForEach(Fn&& fn) {
+                for (Slot& slot : m_slots) {
+                    if (slot.occupied) fn(slot.key, slot.value);
+                }
+            }
+
+            // Keeps the slot array; only the entries are dropped.
+            void Clear() {
+                for (Slot& slot : m_slots) {
+                    if (slot.occupied) {
+                        slot.occupied = false;
+                        slot.value = V();
+                    }
+                }
+                m_size = 0;
+            }
+
+            size_t Size() const { return m_size; }
+            bool Empty() const { return m_size == 0; }
+            size_t Capacity() const { return m_slots.size(); }
+
+        private:
+            struct Slot {
+                NetworkEndpoint key;
+                V value{};
+                bool occupied = false;
+            };
+
+            static uint32_t RoundUpToPowerOfTwo(uint32_t value) {
+                uint32_t result = 1;
+                while (result < value) result <<= 1;
+                return result;
+            }
+
+            void Rehash(uint32_t newCapacity) {
+                std::vector<Slot> fresh(newCapacity); // Allocated first: the table is untouched if this throws.
+                const uint32_t mask = newCapacity - 1;
+                for (Slot& slot : m_slots) {
+                    if (!slot.occupied) continue;
+                    uint32_t index = slot.key.Hash() & mask;
+                    while (fresh[index].occupied) index = (index + 1) & mask;
+                    fresh[index].key = slot.key;
+                    fresh[index].value = std::move(slot.value);
+                    fresh[index].occupied = true;
+                }
+                m_slots.swap(fresh);
+                m_mask = mask;
+            }
+
+            std::vector<Slot> m_slots;
+            uint32_t m_mask = 0;
+            size_t m_size = 0;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
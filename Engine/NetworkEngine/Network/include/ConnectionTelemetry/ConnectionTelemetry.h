@@ -0,0 +1,101 @@
+﻿// File: ConnectionTelemetry.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Lock-free connection quality counters (traffic, retransmits, duplicates, reordering)
+// and a fixed-bucket RTT histogram, kept per connection and aggregated per shard for snapshots
+// and periodic dumps.
+
+#pragma once
+
+#include <array>    // For std::array
+#include <atomic>   // For std::atomic
+#include <chrono>   // For std::chrono::system_clock
+#include <cstdint>  // For uint32_t, uint64_t
+#include <string>   // For std::string
+#include <vector>   // For std::vector
+
+// Exclusive upper bounds, in milliseconds, of the RTT histogram buckets. Samples at or above the
+// last bound go into one more, open-ended bucket.
+constexpr std::array<uint32_t, 11> RTT_HISTOGRAM_BUCKET_BOUNDS_MS = { 10, 20, 30, 50, 75, 100, 150, 200, 300, 500, 1000 };
+const uint32_t RTT_HISTOGRAM_BUCKET_COUNT = static_cast<uint32_t>(RTT_HISTOGRAM_BUCKET_BOUNDS_MS.size()) + 1;
+// Interval of the telemetry file dump when none is given.
+const uint32_t TELEMETRY_DEFAULT_DUMP_INTERVAL_SECONDS = 60;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Counter values of one connection, or the sum over many (see Accumulate).
+        struct ConnectionTelemetrySnapshot {
+            uint64_t packetsSent = 0;        // Datagrams prepared, retransmissions excluded
+            uint64_t bytesSent = 0;
+            uint64_t packetsReceived = 0;    // Datagrams that reached the reliability layer
+            uint64_t bytesReceived = 0;
+            uint64_t retransmits = 0;        // Timeout and fast retransmissions
+            uint64_t packetsAbandoned = 0;   // Reliable packets given up after MAX_PACKET_RETRIES
+            uint64_t duplicatesReceived = 0; // Reliable packets already received (or too old to tell)
+            uint64_t outOfOrderReceived = 0; // Packets that arrived after a newer one of the same stream
+            std::array<uint64_t, RTT_HISTOGRAM_BUCKET_COUNT> rttHistogram{};
+
+            void Accumulate(const ConnectionTelemetrySnapshot& other);
+
+            uint64_t RttSamples() const;
+
+            // Retransmissions per packet sent; 0 before anything was sent.
+            double RetransmitRatio() const;
+
+            // Upper bound of the bucket holding the 'percentile' (0-100) sample, in milliseconds.
+            // Samples in the open-ended bucket report its lower bound. 0 without samples.
+            uint32_t EstimateRttPercentileMs(double percentile) const;
+        };
+
+        // Counters of one connection. Updated by the reliability protocol while it holds the
+        // connection's lock, but read without it: every counter is a relaxed atomic, so snapshots
+        // never contend with traffic. Counters cover the connection's whole lifetime.
+        class ConnectionTelemetry {
+        public:
+            void OnPacketSent(uint32_t bytes) {
+                m_packetsSent.fetch_add(1, std::memory_order_relaxed);
+                m_bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+            }
+            void OnPacketReceived(uint32_t bytes) {
+                m_packetsReceived.fetch_add(1, std::memory_order_relaxed);
+                m_bytesReceived.fetch_add(bytes, std::memory_order_relaxed);
+            }
+            void OnRetransmit() { m_retransmits.fetch_add(1, std::memory_order_relaxed); }
+            void OnPacketAbandoned() { m_packetsAbandoned.fetch_add(1, std::memory_order_relaxed); }
+            void OnDuplicateReceived() { m_duplicatesReceived.fetch_add(1, std::memory_order_relaxed); }
+            void OnOutOfOrderReceived() { m_outOfOrderReceived.fetch_add(1, std::memory_order_relaxed); }
+            void OnRttSample(float sampleMs);
+
+            ConnectionTelemetrySnapshot Snapshot() const;
+
+        private:
+            std::atomic<uint64_t> m_packetsSent{ 0 };
+            std::atomic<uint64_t> m_bytesSent{ 0 };
+            std::atomic<uint64_t> m_packetsReceived{ 0 };
+            std::atomic<uint64_t> m_bytesReceived{ 0 };
+            std::atomic<uint64_t> m_retransmits{ 0 };
+            std::atomic<uint64_t> m_packetsAbandoned{ 0 };
+            std::atomic<uint64_t> m_duplicatesReceived{ 0 };
+            std::atomic<uint64_t> m_outOfOrderReceived{ 0 };
+            std::array<std::atomic<uint64_t>, RTT_HISTOGRAM_BUCKET_COUNT> m_rttHistogram{};
+        };
+
+        // Totals of the connections bound to one shard (see UDPPacketHandler::BindPlayerToConnection),
+        // including connections already closed, so successive snapshots can be differenced.
+        struct ShardTelemetry {
+            uint32_t shardIndex = 0;
+            uint32_t activeConnections = 0;
+            ConnectionTelemetrySnapshot totals;
+        };
+
+        struct TelemetrySnapshot {
+            std::chrono::system_clock::time_point captureTime;
+            std::vector<ShardTelemetry> shards; // Ascending shardIndex; only shards that had connections
+        };
+
+        // Appends one JSON object per shard, one per line, to 'out'.
+        void AppendTelemetryJsonLines(const TelemetrySnapshot& snapshot, std::string& out);
+
+    } // namespace Networking
+} // namespace RiftForged
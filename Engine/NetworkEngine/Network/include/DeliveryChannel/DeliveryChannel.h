@@ -0,0 +1,134 @@
+﻿// File: DeliveryChannel.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Delivery channels carried in GamePacketHeader::channelId, their sequencing modes,
+// and the per-channel receive state that enforces them.
+
+#pragma once
+
+#include "GamePacketHeader.h" // For GamePacketFlag
+
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t
+#include <memory>   // For std::unique_ptr
+#include <vector>   // For std::vector
+
+// Datagrams an ordered channel may receive ahead of the next one it can deliver. Later ones are
+// left unacknowledged, so the sender retransmits them once the gap has been filled.
+const uint32_t ORDERED_CHANNEL_REORDER_WINDOW = 256;
+
+namespace RiftForged {
+    namespace Networking {
+
+        enum class ChannelMode : uint8_t {
+            ReliableOrdered,     // Retransmitted; delivered strictly in send order within the channel
+            ReliableUnordered,   // Retransmitted; delivered as soon as it arrives
+            UnreliableSequenced, // Not retransmitted; anything older than the newest delivered is dropped
+            Unreliable           // Not retransmitted; delivered as it arrives
+        };
+
+        // Channel IDs. Each channel keeps its own sequence space, so a gap on one never holds back
+        // another. Packing order follows the ID, reliable channels first.
+        enum class DeliveryChannel : uint8_t {
+            GameplayEvents = 0,  // ReliableOrdered: events whose order matters (combat, spawns)
+            Reliable = 1,        // ReliableUnordered: default for SendReliablePacket
+            EntityState = 2,     // UnreliableSequenced: snapshots that supersede earlier ones
+            Unreliable = 3,      // Unreliable: default for SendUnreliablePacket
+            Count
+        };
+
+        const uint32_t DELIVERY_CHANNEL_COUNT = static_cast<uint32_t>(DeliveryChannel::Count);
+
+        constexpr ChannelMode GetChannelMode(DeliveryChannel channel) {
+            switch (channel) {
+            case DeliveryChannel::GameplayEvents: return ChannelMode::ReliableOrdered;
+            case DeliveryChannel::Reliable:       return ChannelMode::ReliableUnordered;
+            case DeliveryChannel::EntityState:    return ChannelMode::UnreliableSequenced;
+            default:                              return ChannelMode::Unreliable;
+            }
+        }
+
+        constexpr bool IsReliableChannel(DeliveryChannel channel) {
+            return GetChannelMode(channel) == ChannelMode::ReliableOrdered || GetChannelMode(channel) == ChannelMode::ReliableUnordered;
+        }
+
+        // Channel for packets prepared without one: the unordered channel matching IS_RELIABLE.
+        inline DeliveryChannel GetDefaultChannel(uint8_t packetFlags) {
+            return HasFlag(packetFlags, GamePacketFlag::IS_RELIABLE) ? DeliveryChannel::Reliable : DeliveryChannel::Unreliable;
+        }
+
+        // Only packets that carry application data are channel-sequenced; ACK-only, heartbeat and
+        // handshake packets leave channelId and channelSequence at 0.
+        inline bool IsChannelDataPacket(uint8_t packetFlags) {
+            return !HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY) && !HasFlag(packetFlags, GamePacketFlag::IS_HEARTBEAT) &&
+                !IsHandshakePacket(packetFlags);
+        }
+
+        // True if channel sequence 'a' is newer than 'b', allowing for 16-bit wrap-around.
+        inline bool IsChannelSequenceNewer(uint16_t a, uint16_t b) {
+            return static_cast<int16_t>(static_cast<uint16_t>(a - b)) > 0;
+        }
+
+        enum class OrderedArrival : uint8_t {
+            Duplicate,  // Already delivered
+            InOrder,    // The next one to deliver
+            Early,      // Inside the reorder window; must be stored until the gap fills
+            TooFarAhead // Beyond the reorder window; must not be acknowledged
+        };
+
+        // Restores send order on a ReliableOrdered channel. Datagrams that arrive early are copied
+        // into a ring of ORDERED_CHANNEL_REORDER_WINDOW slots (allocated on first use, so channels
+        // that never reorder never allocate) and handed out by PopReady() once their turn comes.
+        //
+        // Not thread-safe; ReliableConnectionState::internalStateMutex guards it.
+        class OrderedChannelReceiver {
+        public:
+            OrderedArrival Classify(uint16_t channelSequence) const;
+
+            // Marks the next expected datagram delivered (it was InOrder and handed out directly).
+            void Advance() { ++m_nextExpected; }
+
+            /**
+             * @brief Allocates the reorder ring if it is not allocated yet.
+             * Call before acknowledging an Early datagram: if it fails, the datagram is left
+             * unacknowledged and retransmitted instead of being lost with its sequence marked received.
+             * @return False if the allocation failed.
+             */
+            bool Reserve();
+
+            /**
+             * @brief Keeps an Early datagram until its turn. Requires a successful Reserve(). 'data'
+             * may be null when the datagram has nothing to deliver itself (an incomplete fragment);
+             * its turn is then skipped.
+             */
+            void Store(uint16_t channelSequence, const uint8_t* data, uint32_t size, bool coalesced);
+
+            /**
+             * @brief Hands out the next stored datagram if its turn has come. The payload is swapped
+             * into 'out_payload', so the caller's buffer is recycled as the slot's next buffer.
+             */
+            bool PopReady(std::vector<uint8_t>& out_payload, bool& out_coalesced);
+
+            void Clear();
+
+        private:
+            struct Slot {
+                bool arrived = false;
+                bool coalesced = false;
+                std::vector<uint8_t> payload; // Empty: nothing to deliver for this turn
+            };
+
+            Slot& SlotFor(uint16_t channelSequence) { return m_slots[channelSequence % ORDERED_CHANNEL_REORDER_WINDOW]; }
+
+            uint16_t m_nextExpected = 0;
+            std::unique_ptr<Slot[]> m_slots;
+        };
+
+        // Receive-side state of one channel; only the part matching its mode is used.
+        struct ChannelReceiveState {
+            OrderedChannelReceiver ordered;  // ReliableOrdered
+            uint16_t newestSequence = 0;     // UnreliableSequenced
+            bool hasNewestSequence = false;  // UnreliableSequenced
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,133 @@
+﻿// File: FragmentReassembly.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Splitting of reliable messages larger than one datagram into fragments
+// (GamePacketFlag::IS_FRAGMENT), and their reassembly into a per-connection arena.
+
+#pragma once
+
+#include "GamePacketHeader.h"  // For GetGamePacketHeaderSize
+#include "MessageCoalescing.h" // For GetCoalescedPayloadMaxSize (fragments fill a datagram)
+
+#include <array>    // For std::array
+#include <atomic>   // For std::atomic (process-wide arena budget)
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstddef>  // For size_t
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t, uint64_t
+#include <memory>   // For std::unique_ptr
+
+// Most fragments one message may be split into (sizes the per-message bitmap).
+const uint32_t MAX_FRAGMENTS_PER_MESSAGE = 256;
+// Bytes of reassembly arena per connection; also the largest message that can be fragmented.
+const uint32_t REASSEMBLY_ARENA_SIZE = 256 * 1024;
+// Fragmented messages one connection may have partially received at once.
+const uint32_t REASSEMBLY_MAX_CONCURRENT_MESSAGES = 4;
+// A partially received message with no new fragment for this long is discarded.
+const uint32_t REASSEMBLY_TIMEOUT_SECONDS = 10;
+// Arena memory all connections together may hold. Connections that would exceed it refuse
+// fragments (which are then retransmitted) until other arenas are released.
+const uint64_t REASSEMBLY_TOTAL_MEMORY_CAP = 64ull * 1024 * 1024;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Precedes the data of every IS_FRAGMENT packet, after the GamePacketHeader.
+#pragma pack(push, 1)
+        struct FragmentHeader {
+            uint16_t messageId = 0;     // Per-connection counter; identifies the message being rebuilt
+            uint16_t fragmentIndex = 0; // 0-based position; data lands at fragmentIndex * GetFragmentDataMaxSize()
+            uint16_t fragmentCount = 0; // Fragments in the message (at least 2)
+            uint32_t messageSize = 0;   // Bytes in the reassembled message
+        };
+#pragma pack(pop)
+
+        // Message bytes carried by every fragment except possibly the last.
+        constexpr uint32_t GetFragmentDataMaxSize() {
+            return GetCoalescedPayloadMaxSize() - static_cast<uint32_t>(sizeof(FragmentHeader));
+        }
+
+        constexpr uint32_t GetFragmentCount(uint32_t messageSize) {
+            return (messageSize + GetFragmentDataMaxSize() - 1) / GetFragmentDataMaxSize();
+        }
+
+        // True if a reliable message of 'messageSize' bytes must be fragmented and can be.
+        constexpr bool NeedsFragmentation(uint32_t messageSize) {
+            return messageSize > GetCoalescedPayloadMaxSize() && messageSize <= REASSEMBLY_ARENA_SIZE;
+        }
+
+        enum class FragmentAcceptResult : uint8_t {
+            Rejected,  // Malformed, or no room right now: do not acknowledge the packet.
+            Stored,    // Copied into the arena; the message is still incomplete.
+            Completed  // Last missing fragment; the whole message is available.
+        };
+
+        // FragmentReassembler rebuilds fragmented messages in place: each message gets a contiguous
+        // region of one arena, every fragment is copied once to its final offset, and a bitmap
+        // records which fragments have arrived. A completed message is handed out as a pointer into
+        // the arena and keeps its region until Release(), so it can be dispatched without copying.
+        //
+        // The arena is allocated when a message starts arriving and freed once no message occupies
+        // it, so only connections in the middle of a reassembly count against
+        // REASSEMBLY_TOTAL_MEMORY_CAP; idle connections hold none of it.
+        //
+        // Not thread-safe; ReliableConnectionState::internalStateMutex guards it.
+        class FragmentReassembler {
+        public:
+            FragmentReassembler() = default;
+            ~FragmentReassembler();
+
+            FragmentReassembler(const FragmentReassembler&) = delete;
+            FragmentReassembler& operator=(const FragmentReassembler&) = delete;
+
+            /**
+             * @brief Stores one fragment. On Completed, 'out_message'/'out_messageSize' describe the
+             * whole message, which stays valid until Release(out_message).
+             */
+            FragmentAcceptResult Accept(const FragmentHeader& header,
+                const uint8_t* data,
+                uint32_t dataSize,
+                std::chrono::steady_clock::time_point now,
+                const uint8_t** out_message,
+                uint32_t* out_messageSize);
+
+            // Frees the region of a message returned by a Completed Accept().
+            void Release(const uint8_t* message);
+
+            // Drops every message, complete or not, and frees the arena.
+            void Clear();
+
+            // Arena bytes currently held by all connections.
+            static uint64_t GetTotalArenaBytes();
+
+            // Fragments refused by all connections because REASSEMBLY_TOTAL_MEMORY_CAP was reached.
+            static uint64_t GetCapRefusalCount();
+
+        private:
+            struct Slot {
+                bool inUse = false;
+                bool complete = false;
+                uint16_t messageId = 0;
+                uint16_t fragmentCount = 0;
+                uint16_t receivedCount = 0;
+                uint32_t offset = 0;
+                uint32_t size = 0;
+                std::chrono::steady_clock::time_point lastArrival;
+                std::array<uint64_t, MAX_FRAGMENTS_PER_MESSAGE / 64> receivedBitmap{};
+            };
+
+            bool EnsureArena();
+            void ReleaseArenaIfIdle();
+            Slot* FindSlot(uint16_t messageId);
+            // Claims a slot and the lowest arena gap of 'size' bytes; nullptr if none is free.
+            Slot* AllocateSlot(uint32_t size);
+            void ExpireStale(std::chrono::steady_clock::time_point now);
+
+            std::unique_ptr<uint8_t[]> m_arena;
+            std::array<Slot, REASSEMBLY_MAX_CONCURRENT_MESSAGES> m_slots{};
+
+            static std::atomic<uint64_t> s_totalArenaBytes;
+            static std::atomic<uint64_t> s_capRefusals;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,93 @@
+﻿// File: GamePacketHeader.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Wire header that precedes every UDP payload: protocol version, reliability
+// sequence/ACK fields, delivery channel and the server-assigned connection ID.
+
+#pragma once
+
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t
+#include <cstddef>  // For size_t
+
+namespace RiftForged {
+    namespace Networking {
+
+        using SequenceNumber = uint32_t;
+
+        // Bumped whenever the header layout changes; peers with another value are ignored.
+        // 0x0006 added connectionId; 0x0007 added the cookie handshake flags; 0x0008 added IS_COALESCED;
+        // 0x0009 added IS_FRAGMENT; 0x000A added handshake capabilities and selective ack blocks;
+        // 0x000B added channelId and channelSequence; 0x000C added payloadEncoding.
+        const uint32_t CURRENT_PROTOCOL_ID_VERSION = 0x000C;
+
+        // Connection IDs are assigned by the server when it accepts a handshake and are carried in
+        // every server->client header. Clients echo the last one they received; until then they
+        // send INVALID_CONNECTION_ID.
+        //
+        // Handshake (no server state exists until step 3):
+        //   1. C->S IS_CONNECT_REQUEST, payload padded to at least HANDSHAKE_CHALLENGE_SIZE bytes
+        //   2. S->C IS_CONNECT_CHALLENGE, payload = cookie | the requester's address as the server
+        //      saw it (see HandshakeCookie.h)
+        //   3. C->S IS_CONNECT_RESPONSE, payload = cookie, optionally followed by a u8 of requested
+        //      CONNECTION_CAPABILITY_ bits. To keep an existing session from a new address the client
+        //      sets header.connectionId and must follow the capabilities with its rebind proof
+        //      (ComputeSessionRebindProof); without a valid proof the session is not moved.
+        //   4. S->C IS_CONNECT_RESPONSE, payload = u8 of granted capabilities | session secret
+        //      (SESSION_SECRET_SIZE); header.connectionId = the session's ID
+        // Other traffic from an address without a session is dropped unread.
+        const uint32_t INVALID_CONNECTION_ID = 0;
+
+        // Optional protocol features, negotiated per connection in handshake steps 3 and 4.
+        const uint8_t CONNECTION_CAPABILITY_SELECTIVE_ACKS = 1 << 0; // ACK-only packets carry a SelectiveAckBlock
+        const uint8_t CONNECTION_CAPABILITY_COMPRESSION = 1 << 1;    // Payloads may be PayloadEncoding::Zstd
+        const uint8_t SUPPORTED_CONNECTION_CAPABILITIES = CONNECTION_CAPABILITY_SELECTIVE_ACKS | CONNECTION_CAPABILITY_COMPRESSION;
+
+        // How the payload bytes after the header are encoded (see PayloadCompression.h). Every flag
+        // bit is taken, so the encoding has its own header byte.
+        enum class PayloadEncoding : uint8_t {
+            Raw = 0,
+            Zstd = 1 // One zstd frame, compressed with the shared dictionary if one is loaded
+        };
+
+        enum class GamePacketFlag : uint8_t {
+            NONE = 0,
+            IS_RELIABLE = 1 << 0,  // Sequenced and retransmitted until acknowledged
+            IS_ACK_ONLY = 1 << 1,  // Carries ACK fields only; no application payload
+            IS_HEARTBEAT = 1 << 2, // Keep-alive; no application payload
+            IS_CONNECT_REQUEST = 1 << 3,   // Handshake step 1
+            IS_CONNECT_CHALLENGE = 1 << 4, // Handshake step 2
+            IS_CONNECT_RESPONSE = 1 << 5,  // Handshake steps 3 and 4
+            IS_COALESCED = 1 << 6,         // Payload is a sequence of framed messages (MessageCoalescing.h)
+            IS_FRAGMENT = 1 << 7           // Reliable; payload is a FragmentHeader plus one piece of a larger message
+        };
+
+        inline bool HasFlag(uint8_t flags, GamePacketFlag flag) {
+            return (flags & static_cast<uint8_t>(flag)) != 0;
+        }
+
+        inline bool IsHandshakePacket(uint8_t flags) {
+            return HasFlag(flags, GamePacketFlag::IS_CONNECT_REQUEST) ||
+                HasFlag(flags, GamePacketFlag::IS_CONNECT_CHALLENGE) ||
+                HasFlag(flags, GamePacketFlag::IS_CONNECT_RESPONSE);
+        }
+
+#pragma pack(push, 1)
+        struct GamePacketHeader {
+            uint32_t protocolId = CURRENT_PROTOCOL_ID_VERSION;
+            uint8_t flags = 0;
+            uint8_t channelId = 0;                         // DeliveryChannel of the payload; see DeliveryChannel.h
+            uint8_t payloadEncoding = 0;                   // PayloadEncoding of the payload
+            uint32_t connectionId = INVALID_CONNECTION_ID; // Session slot + generation; see SessionTable.h
+            SequenceNumber sequenceNumber = 0;             // 0 for unreliable packets
+            uint16_t channelSequence = 0;                  // Per-channel send order of data packets
+            SequenceNumber ackNumber = 0;                  // Highest sequence received from the peer
+            uint32_t ackBitfield = 0;                      // Bit n set: ackNumber - (n + 1) received
+        };
+#pragma pack(pop)
+
+        constexpr size_t GetGamePacketHeaderSize() {
+            return sizeof(GamePacketHeader);
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,93 @@
+﻿// File: HandshakeCookie.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Stateless join cookies. The server answers a connect request with a cookie that
+// authenticates the requester's address and the issue time; only a connect response echoing a
+// valid cookie may create per-client state, so spoofed sources never allocate anything.
+// Also the session secret and the rebind proof that lets a client keep its session when its
+// address changes.
+
+#pragma once
+
+#include "NetworkEndpoint.h" // For the address the cookie is bound to
+
+#include <array>    // For std::array
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdint>  // For uint8_t, uint32_t, uint64_t
+
+// Wire size of a cookie: u32 issue time (seconds) | u64 MAC.
+const uint32_t HANDSHAKE_COOKIE_SIZE = 12;
+// How long a client has to echo a cookie after it was issued.
+const uint32_t HANDSHAKE_COOKIE_LIFETIME_SECONDS = 10;
+// Requester address as the server saw it, echoed after the cookie in a challenge:
+// u8 family (4 or 6) | u16 port (LE) | 16 address bytes (network order; IPv4 uses the first 4).
+const uint32_t HANDSHAKE_OBSERVED_ENDPOINT_SIZE = 19;
+// Challenge payload size; connect requests must be padded to at least this (no amplification).
+const uint32_t HANDSHAKE_CHALLENGE_SIZE = HANDSHAKE_COOKIE_SIZE + HANDSHAKE_OBSERVED_ENDPOINT_SIZE;
+// Per-session secret the server hands out in its accept.
+const uint32_t SESSION_SECRET_SIZE = 16;
+// Rebind proof a client appends to a connect response naming an existing connection ID.
+const uint32_t SESSION_REBIND_PROOF_SIZE = 8;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // HandshakeCookieGenerator issues and checks cookies with SipHash-2-4 keyed by a random
+        // 128-bit secret drawn at construction. The MAC covers the endpoint (address, port, family)
+        // and the issue time, so a cookie is only valid for the address it was sent to and only
+        // for HANDSHAKE_COOKIE_LIFETIME_SECONDS. Nothing is stored per cookie.
+        //
+        // The key never changes after construction, so both operations are safe from any thread.
+        class HandshakeCookieGenerator {
+        public:
+            using Cookie = std::array<uint8_t, HANDSHAKE_COOKIE_SIZE>;
+
+            HandshakeCookieGenerator();
+
+            Cookie Generate(const NetworkEndpoint& endpoint, std::chrono::steady_clock::time_point now) const;
+
+            /**
+             * @brief Checks a cookie echoed by 'endpoint'.
+             * @return True if it was issued to 'endpoint' by this generator and has not expired.
+             */
+            bool Validate(const NetworkEndpoint& endpoint, const uint8_t* cookie, uint32_t cookieSize,
+                std::chrono::steady_clock::time_point now) const;
+
+        private:
+            uint32_t ToSeconds(std::chrono::steady_clock::time_point now) const;
+            uint64_t ComputeMac(const NetworkEndpoint& endpoint, uint32_t issuedAt) const;
+
+            uint64_t m_key0 = 0;
+            uint64_t m_key1 = 0;
+            std::chrono::steady_clock::time_point m_epoch;
+        };
+
+        // Writes/reads the HANDSHAKE_OBSERVED_ENDPOINT_SIZE bytes that follow the cookie in a challenge.
+        void WriteObservedEndpoint(const NetworkEndpoint& endpoint, uint8_t* out);
+        bool ReadObservedEndpoint(const uint8_t* data, uint32_t size, NetworkEndpoint& out_endpoint);
+
+        // A connection ID only routes packets; the session secret is what proves a client owns its
+        // session. It is drawn from the OS CSPRNG when the session is created and sent to the client
+        // only in the accept, i.e. only to the address that just proved itself with a cookie.
+        //
+        // To move its session to a new address the client sends a connect response from there with
+        // the proof: SipHash-2-4, keyed by the secret, over the connection ID, the new address (as the
+        // challenge reported it) and the fresh cookie. The cookie ties the proof to one address and
+        // HANDSHAKE_COOKIE_LIFETIME_SECONDS, so a captured proof cannot be replayed from elsewhere.
+        using SessionSecret = std::array<uint8_t, SESSION_SECRET_SIZE>;
+        using SessionRebindProof = std::array<uint8_t, SESSION_REBIND_PROOF_SIZE>;
+
+        SessionSecret GenerateSessionSecret();
+
+        SessionRebindProof ComputeSessionRebindProof(const SessionSecret& secret, uint32_t connectionId,
+            const NetworkEndpoint& newEndpoint, const uint8_t* cookie);
+
+        /**
+         * @brief Checks a rebind proof in constant time.
+         * @param cookie The HANDSHAKE_COOKIE_SIZE cookie the proof was sent with (already validated).
+         */
+        bool ValidateSessionRebindProof(const SessionSecret& secret, uint32_t connectionId,
+            const NetworkEndpoint& newEndpoint, const uint8_t* cookie, const uint8_t* proof, uint32_t proofSize);
+
+    } // namespace Networking
+} // namespace RiftForged
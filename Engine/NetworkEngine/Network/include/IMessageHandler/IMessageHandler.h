@@ -0,0 +1,35 @@
+﻿// File: IMessageHandler.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: The interface UDPPacketHandler hands verified client messages to. The game's
+// PacketProcessor implements it and routes each message through its C2SDispatchTable.
+
+#pragma once
+
+#include "NetworkCommon.h"      // For S2C_Response
+#include "VerifiedC2SMessage.h" // For VerifiedC2SMessage
+
+#include <optional> // For std::optional
+
+namespace RiftForged {
+    namespace GameLogic { struct ActivePlayer; }
+
+    namespace Networking {
+
+        class IMessageHandler {
+        public:
+            virtual ~IMessageHandler() = default;
+
+            /**
+             * @brief Handles one client message, on the receive thread that read it.
+             * @param message Verified by UDPPacketHandler; implementations must not verify it again.
+             * Valid only for the duration of the call.
+             * @param player The sender's player, or null before one is bound (JoinRequest).
+             * @return A response to send, routed by its payload type.
+             */
+            virtual std::optional<S2C_Response> ProcessApplicationMessage(const VerifiedC2SMessage& message,
+                RiftForged::GameLogic::ActivePlayer* player) = 0;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -3,8 +3,10 @@
 
 #include <RiftForged/Network/NetworkEndpoint/NetworkEndpoint.h>
 #include <RiftForged/Network/OverlappedIOContext/OverlappedIOContext.h>
+#include <RiftForged/Network/PacketBufferPool/PacketBufferPool.h>
 #include <string>
 #include <cstdint>
+#include <cstring>
 #include <vector>
 
 namespace RiftForged {
@@ -12,6 +14,27 @@ namespace RiftForged {
 
         class INetworkIOEvents; // Forward declaration
 
+        // Counters describing how well the transport is batching. Snapshot values; implementations
+        // keep them in relaxed atomics and copy them out in GetIOStats().
+        struct NetworkIOStats {
+            uint64_t receiveSyscalls = 0;   // recvmmsg/recvmsg calls, io_uring waits or GQCS(Ex) wakeups that yielded data.
+            uint64_t datagramsReceived = 0;
+            uint64_t sendSyscalls = 0;      // sendmmsg/sendmsg/WSASendTo calls.
+            uint64_t datagramsSent = 0;
+            uint64_t receiveContextExhaustions = 0; // Receive posts skipped because the context pool was empty.
+            uint64_t sendContextExhaustions = 0;    // Sends dropped because the context pool was empty.
+            uint64_t sendBackpressureStalls = 0;    // Flushes (or direct sends) stopped by a full socket send buffer.
+            uint64_t sendQueueOverflows = 0;        // Queued sends refused because the backlog was full.
+            uint64_t sendErrors = 0;                // Datagrams the kernel rejected for any other reason.
+
+            double DatagramsPerReceiveSyscall() const {
+                return receiveSyscalls ? static_cast<double>(datagramsReceived) / static_cast<double>(receiveSyscalls) : 0.0;
+            }
+            double DatagramsPerSendSyscall() const {
+                return sendSyscalls ? static_cast<double>(datagramsSent) / static_cast<double>(sendSyscalls) : 0.0;
+            }
+        };
+
         class INetworkIO {
         public:
             virtual ~INetworkIO() = default;
@@ -45,6 +68,49 @@ namespace RiftForged {
              */
             virtual bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) = 0;
 
+            /**
+             * @brief Queues raw data for the next FlushSendQueue() call. The data is copied, so the
+             * caller's buffer may be reused immediately. Transports without a batched send path
+             * send immediately.
+             * @return True if the datagram was queued (or sent), false otherwise.
+             */
+            virtual bool QueueSendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+                return SendData(recipient, data, size);
+            }
+
+            /**
+             * @brief Queues one datagram made of a per-connection header followed by a shared payload.
+             * The header is copied; the payload is referenced, so one serialized message can be queued
+             * for many recipients (and kept for retransmission) without copying it per datagram.
+             * Transports with a scatter-gather send path hold the reference until the datagram is
+             * handed to the kernel; the default concatenates into a scratch buffer and calls QueueSendData.
+             * @return True if the datagram was queued (or sent), false otherwise.
+             */
+            virtual bool QueueSendGather(const NetworkEndpoint& recipient, const uint8_t* header, uint32_t headerSize, const PacketBufferRef& payload) {
+                thread_local std::vector<uint8_t> scratch;
+                scratch.resize(static_cast<size_t>(headerSize) + payload.Size());
+                if (headerSize > 0) std::memcpy(scratch.data(), header, headerSize);
+                if (payload.Size() > 0) std::memcpy(scratch.data() + headerSize, payload.Data(), payload.Size());
+                return QueueSendData(recipient, scratch.data(), static_cast<uint32_t>(scratch.size()));
+            }
+
+            /**
+             * @brief Hands every datagram queued by QueueSendData to the kernel in as few calls as possible.
+             * Intended to be called once per tick / per receive batch.
+             */
+            virtual void FlushSendQueue() {}
+
+            /**
+             * @brief Returns the transport's batching counters. Transports that do not track them return zeros.
+             */
+            virtual NetworkIOStats GetIOStats() const { return {}; }
+
+            /**
+             * @brief Number of independent receive shards (socket + receive thread). Datagrams carry
+             * their shard in ReceivedDatagram::ioShard. Single-socket transports report 1.
+             */
+            virtual uint32_t GetIOShardCount() const { return 1; }
+
             /**
              * @brief Checks if the network IO layer is currently running.
              * @return True if running, false otherwise.
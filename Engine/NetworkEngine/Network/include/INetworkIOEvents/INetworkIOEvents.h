@@ -5,10 +5,24 @@
 #include <RiftForged/Network/OverlappedIOContext/OverlappedIOContext.h>
 #include <cstdint>
 #include <string>
+#include <span>
 
 namespace RiftForged {
     namespace Networking {
 
+        // One datagram of a batch handed up by INetworkIO::OnRawDataBatchReceived.
+        // 'data' points into the receive context's buffer and is only valid for the duration of the callback.
+        struct ReceivedDatagram {
+            NetworkEndpoint sender;
+            const uint8_t* data = nullptr;
+            uint32_t size = 0;
+            OverlappedIOContext* context = nullptr;
+            // Receive shard (socket + thread) that produced the datagram, in [0, INetworkIO::GetIOShardCount()).
+            // With SO_REUSEPORT sharding the kernel hashes the flow, so a given sender keeps landing on
+            // the same shard for as long as the socket set is unchanged.
+            uint32_t ioShard = 0;
+        };
+
         class INetworkIOEvents {
         public:
             virtual ~INetworkIOEvents() = default;
@@ -27,6 +41,18 @@ namespace RiftForged {
                 uint32_t size,
                 OverlappedIOContext* context) = 0;
 
+            /**
+             * @brief Called by the INetworkIO layer when a single wakeup produced several datagrams.
+             * @param datagrams The datagrams in arrival order. Buffers are reused once this returns.
+             * The default forwards each datagram to OnRawDataReceived; handlers override it to
+             * amortize per-call work (e.g. flushing queued sends once per batch).
+             */
+            virtual void OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) {
+                for (const ReceivedDatagram& datagram : datagrams) {
+                    OnRawDataReceived(datagram.sender, datagram.data, datagram.size, datagram.context);
+                }
+            }
+
             /**
              * @brief Called by the INetworkIO layer when an asynchronous send operation completes.
              * @param context The OverlappedIOContext associated with this send operation.
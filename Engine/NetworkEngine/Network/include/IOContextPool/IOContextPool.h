@@ -0,0 +1,95 @@
+﻿// File: IOContextPool.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Fixed-size, lock-free pool of OverlappedIOContext objects whose buffers live in
+// one contiguous, cache-line aligned slab. Shared by the IOCP and Linux UDP transports.
+
+#pragma once
+
+#include <atomic>           // For std::atomic
+#include <cstdint>          // For uint32_t, uint64_t
+#include <memory>           // For std::unique_ptr
+#include <vector>           // For std::vector
+
+#include "OverlappedIOContext.h"  // Defines OverlappedIOContext struct
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Snapshot of an IOContextPool's counters.
+        struct IOContextPoolStats {
+            uint32_t capacity = 0;      // Total contexts owned by the pool.
+            uint32_t inUse = 0;         // Contexts currently acquired.
+            uint64_t acquires = 0;      // Successful Acquire() calls.
+            uint64_t exhaustions = 0;   // Acquire() calls that found the pool empty.
+        };
+
+        // IOContextPool preallocates every context and buffer up front; Acquire/Return never touch
+        // the heap or a mutex. The free list is a Treiber stack of indices whose head carries a
+        // 32-bit modification tag next to the index, so a single 64-bit CAS is ABA-safe.
+        //
+        // Buffers are carved from one slab at a stride rounded up to a cache line, so neighbouring
+        // contexts completing on different threads never share a line.
+        class IOContextPool {
+        public:
+            static constexpr size_t CACHE_LINE_SIZE = 64;
+
+            IOContextPool() = default;
+            ~IOContextPool();
+
+            IOContextPool(const IOContextPool&) = delete;
+            IOContextPool& operator=(const IOContextPool&) = delete;
+
+            /**
+             * @brief Allocates the slab and all contexts. Must not be called while contexts are acquired.
+             * @param opType Operation type every context starts out with.
+             * @param contextCount Number of contexts (and buffers) in the pool.
+             * @param bufferSize Usable bytes per buffer.
+             * @return True on success, false if the allocation failed.
+             */
+            bool Initialize(IOOperationType opType, uint32_t contextCount, uint32_t bufferSize);
+
+            // Frees the slab and all contexts. Callers must ensure no context is still in flight.
+            void Clear();
+
+            /**
+             * @brief Pops a free context. Lock-free; safe from any thread.
+             * @return A context, or nullptr if the pool is exhausted (counted in IOContextPoolStats::exhaustions).
+             */
+            OverlappedIOContext* Acquire();
+
+            /**
+             * @brief Pushes a context previously returned by Acquire() back onto the free list.
+             */
+            void Return(OverlappedIOContext* pContext);
+
+            // True if the context was handed out by this pool.
+            bool Owns(const OverlappedIOContext* pContext) const;
+
+            uint32_t GetCapacity() const { return m_capacity; }
+            uint32_t GetBufferSize() const { return m_bufferSize; }
+
+            IOContextPoolStats GetStats() const;
+
+        private:
+            static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+            static uint64_t PackHead(uint32_t tag, uint32_t index) { return (static_cast<uint64_t>(tag) << 32) | index; }
+            static uint32_t HeadIndex(uint64_t head) { return static_cast<uint32_t>(head & 0xFFFFFFFFu); }
+            static uint32_t HeadTag(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+
+            std::vector<OverlappedIOContext> m_contexts;     // Reserved once; never reallocated after Initialize.
+            std::unique_ptr<std::atomic<uint32_t>[]> m_next; // Free-list links, indexed like m_contexts.
+            char* m_slab = nullptr;                          // Cache-line aligned buffer storage.
+            size_t m_bufferStride = 0;
+            uint32_t m_capacity = 0;
+            uint32_t m_bufferSize = 0;
+
+            alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head{ PackHead(0, INVALID_INDEX) };
+            alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> m_inUse{ 0 };
+            std::atomic<uint64_t> m_acquires{ 0 };
+            std::atomic<uint64_t> m_exhaustions{ 0 };
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,172 @@
+﻿// File: ImpairedNetworkIO.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: INetworkIO decorator that injects latency, jitter, bursty loss, reordering and
+// duplication between a real transport (UDPSocketAsync, UDPSocketLinux, LoopbackNetworkIO) and
+// UDPPacketHandler. All randomness comes from explicit seeds so runs are reproducible.
+
+#pragma once
+
+#include <string>           // For std::string
+#include <vector>           // For std::vector
+#include <queue>            // For std::priority_queue
+#include <thread>           // For std::thread
+#include <atomic>           // For std::atomic
+#include <mutex>            // For std::mutex
+#include <condition_variable> // For std::condition_variable
+#include <random>           // For std::mt19937_64
+#include <chrono>           // For std::chrono::steady_clock
+#include <cstdint>          // For uint64_t
+
+// Project-specific includes
+#include "INetworkIO.h"           // Definition of the interface we are implementing and wrapping
+#include "INetworkIOEvents.h"     // We sit between the inner transport and the real event handler
+#include "NetworkEndpoint.h"      // Defines NetworkEndpoint struct
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Shape of the per-packet delay added on top of the real transport.
+        enum class DelayDistribution {
+            Constant,    // Always baseDelayMs.
+            Uniform,     // baseDelayMs +/- jitterMs.
+            Normal,      // Mean baseDelayMs, standard deviation jitterMs (clamped at 0).
+            Exponential  // baseDelayMs plus an exponential tail with mean jitterMs (long-tail spikes).
+        };
+
+        // Impairments applied to one direction of traffic.
+        struct NetworkImpairmentProfile {
+            DelayDistribution delayDistribution = DelayDistribution::Constant;
+            double baseDelayMs = 0.0;
+            double jitterMs = 0.0;
+
+            // Two-state Gilbert-Elliott loss model. Setting only lossProbabilityGood gives plain
+            // independent loss; the transition probabilities create loss bursts.
+            double lossProbabilityGood = 0.0;   // Per-packet loss while in the good state.
+            double lossProbabilityBad = 0.0;    // Per-packet loss while in the bad (burst) state.
+            double goodToBadProbability = 0.0;  // Per-packet chance of entering a burst.
+            double badToGoodProbability = 1.0;  // Per-packet chance of leaving a burst.
+
+            double reorderProbability = 0.0;    // Chance a packet is held back so later packets overtake it.
+            double reorderExtraDelayMs = 20.0;  // Extra hold applied to reordered packets.
+
+            double duplicateProbability = 0.0;  // Chance a packet is delivered twice.
+
+            bool IsPassThrough() const {
+                return baseDelayMs <= 0.0 && jitterMs <= 0.0 &&
+                    lossProbabilityGood <= 0.0 && goodToBadProbability <= 0.0 &&
+                    reorderProbability <= 0.0 && duplicateProbability <= 0.0;
+            }
+        };
+
+        // Full configuration for an ImpairedNetworkIO instance.
+        struct NetworkImpairmentConfig {
+            NetworkImpairmentProfile inbound;   // Applied to datagrams received from the inner transport.
+            NetworkImpairmentProfile outbound;  // Applied to datagrams sent through SendData/QueueSendData.
+            uint64_t seed = 0x5EED5EED5EED5EEDull;
+        };
+
+        // Counters for one direction.
+        struct ImpairmentDirectionStats {
+            uint64_t packets = 0;      // Datagrams that entered the impairment stage.
+            uint64_t dropped = 0;
+            uint64_t duplicated = 0;
+            uint64_t reordered = 0;
+            uint64_t burstEntries = 0; // Good -> bad state transitions.
+        };
+
+        struct ImpairmentStats {
+            ImpairmentDirectionStats inbound;
+            ImpairmentDirectionStats outbound;
+        };
+
+        // ImpairedNetworkIO wraps an inner INetworkIO. It registers itself as the inner transport's
+        // event handler, applies the inbound profile to everything received and forwards survivors
+        // to the real handler; sends are impaired with the outbound profile before reaching the
+        // inner transport. Delayed datagrams wait in a time-ordered queue served by one scheduler
+        // thread, which delivers everything due in one OnRawDataBatchReceived call.
+        //
+        // Each direction has its own seeded RNG, so for the same seed and the same input sequence
+        // the drop/duplicate/reorder decisions and sampled delays repeat exactly. Release times are
+        // still measured on the wall clock.
+        class ImpairedNetworkIO : public INetworkIO, public INetworkIOEvents {
+        public:
+            /**
+             * @param innerIO The real transport. Not owned; must outlive this object.
+             * @param config Impairment profiles and RNG seed.
+             */
+            ImpairedNetworkIO(INetworkIO* innerIO, const NetworkImpairmentConfig& config);
+            ~ImpairedNetworkIO() override;
+
+            ImpairedNetworkIO(const ImpairedNetworkIO&) = delete;
+            ImpairedNetworkIO& operator=(const ImpairedNetworkIO&) = delete;
+
+            // --- INetworkIO Interface Implementation ---
+            bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+            bool Start() override;
+            void Stop() override;
+            bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+            bool QueueSendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+            void FlushSendQueue() override;
+            bool IsRunning() const override;
+            NetworkIOStats GetIOStats() const override { return m_innerIO->GetIOStats(); }
+            uint32_t GetIOShardCount() const override { return m_innerIO->GetIOShardCount(); }
+
+            // --- INetworkIOEvents Implementation (called by the inner transport) ---
+            void OnRawDataReceived(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size, OverlappedIOContext* context) override;
+            void OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) override;
+            void OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) override;
+            void OnNetworkError(const std::string& errorMessage, int errorCode = 0) override;
+
+            ImpairmentStats GetImpairmentStats() const;
+
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            // RNG and Gilbert-Elliott state for one direction. Guarded by m_directionMutex.
+            struct DirectionState {
+                NetworkImpairmentProfile profile;
+                std::mt19937_64 rng;
+                bool inBadState = false;
+                ImpairmentDirectionStats stats;
+            };
+
+            struct ScheduledDatagram {
+                Clock::time_point due;
+                uint64_t order;             // Tie-breaker so equal due times keep submission order.
+                bool inbound;
+                uint32_t ioShard;
+                NetworkEndpoint peer;       // Sender for inbound, recipient for outbound.
+                std::vector<uint8_t> data;
+            };
+            struct LaterDueFirst {
+                bool operator()(const ScheduledDatagram& a, const ScheduledDatagram& b) const {
+                    return a.due != b.due ? a.due > b.due : a.order > b.order;
+                }
+            };
+
+            // Runs the profile for one datagram and schedules 0, 1 or 2 copies. Returns the number scheduled.
+            int ImpairAndSchedule(DirectionState& direction, bool inbound, const NetworkEndpoint& peer,
+                uint32_t ioShard, const uint8_t* data, uint32_t size);
+
+            double SampleDelayMs(DirectionState& direction);
+            void SchedulerThread();
+
+            INetworkIO* m_innerIO;
+            INetworkIOEvents* m_eventHandler;
+
+            mutable std::mutex m_directionMutex;
+            DirectionState m_inbound;
+            DirectionState m_outbound;
+
+            std::mutex m_scheduleMutex;
+            std::condition_variable m_scheduleCondition;
+            std::priority_queue<ScheduledDatagram, std::vector<ScheduledDatagram>, LaterDueFirst> m_schedule;
+            uint64_t m_nextOrder = 0;
+
+            std::atomic<bool> m_isRunning;
+            std::thread m_schedulerThread;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,97 @@
+﻿// File: InboundRateLimiter.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Per-connection token buckets that bound how many datagrams, and how many messages
+// of each class, a client may have processed per second. Checked on the IO thread before any
+// reliability or FlatBuffer work, so excess traffic is dropped for the cost of a lookup and a CAS.
+
+#pragma once
+
+#include <array>    // For std::array
+#include <atomic>   // For std::atomic
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdint>  // For uint8_t, uint32_t, int64_t, uint64_t
+
+// Default limits per connection. Clients send input at the simulation tick rate (60 Hz); the
+// rates leave twice that, and the bursts absorb a second or so of packets bunched up by jitter.
+const uint32_t INBOUND_DATAGRAM_RATE_PER_SECOND = 400;  // Every datagram, including ACK-only ones
+const uint32_t INBOUND_DATAGRAM_BURST = 100;
+const uint32_t INBOUND_MOVEMENT_RATE_PER_SECOND = 120;
+const uint32_t INBOUND_MOVEMENT_BURST = 60;
+const uint32_t INBOUND_ACTION_RATE_PER_SECOND = 30;
+const uint32_t INBOUND_ACTION_BURST = 15;
+const uint32_t INBOUND_CONTROL_RATE_PER_SECOND = 10;
+const uint32_t INBOUND_CONTROL_BURST = 10;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // What a bucket limits. Datagram is checked once per datagram before the reliability layer
+        // sees it; the others once per application message before it is verified and dispatched.
+        enum class InboundRateClass : uint8_t {
+            Datagram = 0,
+            Movement = 1,  // MovementInput, TurnIntent
+            Action = 2,    // RiftStepActivation, BasicAttackIntent, UseAbility
+            Control = 3,   // Ping, JoinRequest, and anything that does not parse as a known type
+            Count
+        };
+
+        const uint32_t INBOUND_RATE_CLASS_COUNT = static_cast<uint32_t>(InboundRateClass::Count);
+
+        // Sustained rate and burst of one bucket. A rate of 0 disables the limit.
+        struct InboundRateLimit {
+            uint32_t ratePerSecond = 0;
+            uint32_t burst = 1;
+        };
+
+        constexpr InboundRateLimit GetDefaultInboundRateLimit(InboundRateClass rateClass) {
+            switch (rateClass) {
+            case InboundRateClass::Datagram: return { INBOUND_DATAGRAM_RATE_PER_SECOND, INBOUND_DATAGRAM_BURST };
+            case InboundRateClass::Movement: return { INBOUND_MOVEMENT_RATE_PER_SECOND, INBOUND_MOVEMENT_BURST };
+            case InboundRateClass::Action:   return { INBOUND_ACTION_RATE_PER_SECOND, INBOUND_ACTION_BURST };
+            default:                         return { INBOUND_CONTROL_RATE_PER_SECOND, INBOUND_CONTROL_BURST };
+            }
+        }
+
+        // Dropped datagrams / messages, indexed by InboundRateClass.
+        struct InboundRateLimitStats {
+            std::array<uint64_t, INBOUND_RATE_CLASS_COUNT> dropped{};
+        };
+
+        // Token bucket kept as a single timestamp (GCRA): the time at which the bucket would be full
+        // again. Taking a token pushes it one emission interval (1 / rate) later; a token is available
+        // while it is at most (burst - 1) intervals ahead of now. This is exactly a bucket of 'burst'
+        // tokens refilled at 'rate', but it is one atomic, so TryConsume is lock-free.
+        class TokenBucket {
+        public:
+            // Not synchronized with TryConsume; call before the bucket is shared.
+            void Configure(const InboundRateLimit& limit);
+
+            bool TryConsume(std::chrono::steady_clock::time_point now);
+
+        private:
+            int64_t m_emissionIntervalNanos = 0;  // 0: unlimited
+            int64_t m_burstToleranceNanos = 0;
+            std::atomic<int64_t> m_fullAtNanos{ 0 };
+        };
+
+        // The buckets of one connection, plus its drop counters. Admit may be called from any thread.
+        class InboundRateLimiter {
+        public:
+            InboundRateLimiter();
+
+            // Not synchronized with Admit; call before the owning connection is shared.
+            void Configure(const std::array<InboundRateLimit, INBOUND_RATE_CLASS_COUNT>& limits);
+
+            // Takes a token from the bucket of 'rateClass'. False (counted as a drop) if it is empty.
+            bool Admit(InboundRateClass rateClass, std::chrono::steady_clock::time_point now);
+
+            InboundRateLimitStats GetStats() const;
+
+        private:
+            std::array<TokenBucket, INBOUND_RATE_CLASS_COUNT> m_buckets;
+            std::array<std::atomic<uint64_t>, INBOUND_RATE_CLASS_COUNT> m_dropped{};
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,162 @@
+﻿// File: LoopbackNetworkIO.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Memory-backed INetworkIO. Any number of LoopbackNetworkIO instances (a server and
+// fake clients) attach to one LoopbackNetworkHub and exchange datagrams without sockets.
+
+#pragma once
+
+#include <string>           // For std::string
+#include <vector>           // For std::vector
+#include <map>              // For std::map
+#include <thread>           // For std::thread
+#include <atomic>           // For std::atomic
+#include <mutex>            // For std::mutex
+#include <shared_mutex>     // For std::shared_mutex
+#include <condition_variable> // For std::condition_variable
+#include <memory>           // For std::shared_ptr, std::unique_ptr
+#include <cstdint>          // For uint8_t, uint32_t
+
+// Project-specific includes
+#include "INetworkIO.h"           // Definition of the interface we are implementing
+#include "INetworkIOEvents.h"     // For ReceivedDatagram
+#include "NetworkEndpoint.h"      // Defines NetworkEndpoint struct
+
+// Largest datagram a loopback queue slot can hold. Sends above this are rejected, like an oversized sendto.
+const uint32_t LOOPBACK_MAX_DATAGRAM_SIZE = 2048;
+// Default per-endpoint inbound queue depth (must be a power of two).
+const uint32_t LOOPBACK_DEFAULT_QUEUE_CAPACITY = 4096;
+// Max datagrams handed to OnRawDataBatchReceived per delivery.
+const uint32_t LOOPBACK_DELIVERY_BATCH_SIZE = 64;
+
+namespace RiftForged {
+    namespace Networking {
+
+        class LoopbackNetworkIO;
+
+        // How received datagrams reach the event handler.
+        enum class LoopbackDeliveryMode {
+            Thread, // A per-instance delivery thread drains the inbound queue (behaves like a socket worker).
+            Manual  // Nothing runs in the background; the owner calls Poll() (deterministic benchmarks/tests).
+        };
+
+        // Routes datagrams between attached LoopbackNetworkIO instances by NetworkEndpoint.
+        // An instance bound to "0.0.0.0:port" receives anything addressed to that port that has no
+        // exact-match binding, mirroring a wildcard socket bind.
+        class LoopbackNetworkHub {
+        public:
+            LoopbackNetworkHub() = default;
+            LoopbackNetworkHub(const LoopbackNetworkHub&) = delete;
+            LoopbackNetworkHub& operator=(const LoopbackNetworkHub&) = delete;
+
+            // Fails (returns false) if the endpoint is already bound, like EADDRINUSE.
+            bool Attach(const NetworkEndpoint& endpoint, LoopbackNetworkIO* io);
+            void Detach(const NetworkEndpoint& endpoint, LoopbackNetworkIO* io);
+
+            /**
+             * @brief Delivers a datagram to whoever is bound to 'recipient'.
+             * @return False only if the recipient exists but its queue is full. Datagrams to unbound
+             * endpoints are dropped silently (counted), exactly as UDP would.
+             */
+            bool Route(const NetworkEndpoint& sender, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size);
+
+            uint64_t GetUnroutableCount() const { return m_unroutable.load(std::memory_order_relaxed); }
+
+        private:
+            std::map<NetworkEndpoint, LoopbackNetworkIO*> m_bindings;
+            mutable std::shared_mutex m_bindingsMutex; // Shared on the send path, exclusive for Attach/Detach.
+            std::atomic<uint64_t> m_unroutable{ 0 };
+        };
+
+        // LoopbackNetworkIO implements INetworkIO on top of a LoopbackNetworkHub.
+        //
+        // Each instance owns a bounded multi-producer/single-consumer ring of fixed-size slots.
+        // Producers (any thread calling SendData on any attached instance) claim a slot with one
+        // CAS, copy the datagram in and publish it through the slot's sequence number. The single
+        // consumer (delivery thread or Poll caller) hands runs of published slots to the event
+        // handler in place, without copying, and releases them after the callback returns.
+        class LoopbackNetworkIO : public INetworkIO {
+        public:
+            /**
+             * @param hub The hub shared by every endpoint that should be able to reach this one.
+             * @param deliveryMode Thread or Manual delivery, see LoopbackDeliveryMode.
+             * @param queueCapacity Inbound ring depth; rounded up to a power of two.
+             */
+            explicit LoopbackNetworkIO(std::shared_ptr<LoopbackNetworkHub> hub,
+                LoopbackDeliveryMode deliveryMode = LoopbackDeliveryMode::Thread,
+                uint32_t queueCapacity = LOOPBACK_DEFAULT_QUEUE_CAPACITY);
+
+            ~LoopbackNetworkIO() override;
+
+            LoopbackNetworkIO(const LoopbackNetworkIO&) = delete;
+            LoopbackNetworkIO& operator=(const LoopbackNetworkIO&) = delete;
+
+            // --- INetworkIO Interface Implementation ---
+
+            // Binds listenIp:listenPort on the hub.
+            bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+            bool Start() override;
+            void Stop() override;
+
+            // Copies the datagram into the recipient's queue. OnSendCompleted is reported before returning.
+            bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+
+            bool IsRunning() const override;
+            NetworkIOStats GetIOStats() const override;
+
+            /**
+             * @brief Manual mode: delivers up to maxDatagrams queued datagrams on the calling thread.
+             * Must not be called concurrently with itself or while a delivery thread is running.
+             * @return Number of datagrams delivered.
+             */
+            size_t Poll(size_t maxDatagrams = static_cast<size_t>(-1));
+
+            // Datagrams dropped because this instance's inbound queue was full.
+            uint64_t GetQueueFullDrops() const { return m_queueFullDrops.load(std::memory_order_relaxed); }
+
+            const NetworkEndpoint& GetLocalEndpoint() const { return m_localEndpoint; }
+
+        private:
+            friend class LoopbackNetworkHub;
+
+            struct Slot {
+                std::atomic<uint64_t> sequence{ 0 };
+                NetworkEndpoint sender;
+                uint32_t size = 0;
+                uint8_t data[LOOPBACK_MAX_DATAGRAM_SIZE];
+            };
+
+            // Producer side, called by the hub. False if the ring is full.
+            bool Enqueue(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size);
+
+            // Consumer side: delivers one batch of at most maxDatagrams. Returns the count delivered.
+            size_t DeliverBatch(size_t maxDatagrams);
+
+            void DeliveryThread();
+
+            std::shared_ptr<LoopbackNetworkHub> m_hub;
+            LoopbackDeliveryMode m_deliveryMode;
+            INetworkIOEvents* m_eventHandler;
+            NetworkEndpoint m_localEndpoint;
+            bool m_attached;
+
+            std::unique_ptr<Slot[]> m_slots;
+            uint64_t m_mask;
+            alignas(64) std::atomic<uint64_t> m_enqueuePos{ 0 }; // Shared by producers.
+            alignas(64) uint64_t m_dequeuePos = 0;               // Owned by the single consumer.
+            std::vector<ReceivedDatagram> m_deliveryBatch;
+
+            std::atomic<bool> m_isRunning;
+            std::thread m_deliveryThread;
+            std::mutex m_wakeMutex;
+            std::condition_variable m_wakeCondition;
+            std::atomic<bool> m_consumerSleeping{ false };
+
+            std::atomic<uint64_t> m_deliveries{ 0 };
+            std::atomic<uint64_t> m_datagramsReceived{ 0 };
+            std::atomic<uint64_t> m_datagramsSent{ 0 };
+            std::atomic<uint64_t> m_queueFullDrops{ 0 };
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
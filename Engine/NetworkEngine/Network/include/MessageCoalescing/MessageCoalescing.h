@@ -0,0 +1,110 @@
+﻿// File: MessageCoalescing.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Framing for datagrams that carry several application messages behind one
+// GamePacketHeader (GamePacketFlag::IS_COALESCED).
+
+#pragma once
+
+#include "GamePacketHeader.h" // For GetGamePacketHeaderSize
+
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t
+#include <cstring>  // For std::memcpy
+
+// Largest datagram the outbound assembler builds. Stays under common path MTUs (1280 for IPv6
+// minus IP/UDP headers and tunnel overhead) so coalesced packets are never IP-fragmented.
+const uint32_t COALESCED_DATAGRAM_MAX_SIZE = 1200;
+// Frame header: u16 message length (little-endian) | u8 payload type.
+const uint32_t COALESCED_FRAME_HEADER_SIZE = 3;
+// Messages staged per connection before sends are refused (the reliable window may be full).
+const uint32_t MAX_PENDING_OUTBOUND_MESSAGES = 4096;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Payload bytes available behind the header of a coalesced datagram.
+        constexpr uint32_t GetCoalescedPayloadMaxSize() {
+            return COALESCED_DATAGRAM_MAX_SIZE - static_cast<uint32_t>(GetGamePacketHeaderSize());
+        }
+
+        // Bytes a message of 'messageSize' occupies inside a coalesced payload.
+        constexpr uint32_t GetCoalescedFrameSize(uint32_t messageSize) {
+            return COALESCED_FRAME_HEADER_SIZE + messageSize;
+        }
+
+        /**
+         * @brief Appends one framed message at 'offset' and advances it.
+         * @return False (and writes nothing) if the frame does not fit in 'capacity'.
+         */
+        inline bool AppendCoalescedFrame(uint8_t* buffer, uint32_t capacity, uint32_t& offset,
+            uint8_t payloadType, const uint8_t* message, uint32_t messageSize) {
+            if (messageSize > UINT16_MAX || offset > capacity || capacity - offset < GetCoalescedFrameSize(messageSize)) {
+                return false;
+            }
+            uint8_t* frame = buffer + offset;
+            frame[0] = static_cast<uint8_t>(messageSize);
+            frame[1] = static_cast<uint8_t>(messageSize >> 8);
+            frame[2] = payloadType;
+            if (messageSize > 0) {
+                std::memcpy(frame + COALESCED_FRAME_HEADER_SIZE, message, messageSize);
+            }
+            offset += GetCoalescedFrameSize(messageSize);
+            return true;
+        }
+
+        // Walks the frames of a coalesced payload in order. Stops at the first frame that runs past
+        // the end; ValidateCoalescedPayload() tells whether the whole payload was well formed.
+        class CoalescedFrameReader {
+        public:
+            CoalescedFrameReader(const uint8_t* payload, uint32_t size)
+                : m_payload(payload), m_size(payload ? size : 0) {
+            }
+
+            /**
+             * @brief Reads the next frame. 'out_message' points into the payload; nothing is copied.
+             * @return False at the end of the payload or on a truncated frame.
+             */
+            bool Next(uint8_t& out_payloadType, const uint8_t*& out_message, uint32_t& out_messageSize) {
+                if (m_size - m_offset < COALESCED_FRAME_HEADER_SIZE) {
+                    return false;
+                }
+                const uint8_t* frame = m_payload + m_offset;
+                const uint32_t messageSize = static_cast<uint32_t>(frame[0]) | (static_cast<uint32_t>(frame[1]) << 8);
+                if (m_size - m_offset - COALESCED_FRAME_HEADER_SIZE < messageSize) {
+                    return false;
+                }
+                out_payloadType = frame[2];
+                out_message = frame + COALESCED_FRAME_HEADER_SIZE;
+                out_messageSize = messageSize;
+                m_offset += GetCoalescedFrameSize(messageSize);
+                return true;
+            }
+
+            // True once every byte has been consumed by complete frames.
+            bool AtEnd() const { return m_offset == m_size; }
+
+        private:
+            const uint8_t* m_payload;
+            uint32_t m_size;
+            uint32_t m_offset = 0;
+        };
+
+        // True if 'payload' is a non-empty sequence of complete, non-empty frames with no trailing bytes.
+        inline bool ValidateCoalescedPayload(const uint8_t* payload, uint32_t size) {
+            if (!payload || size == 0) {
+                return false;
+            }
+            CoalescedFrameReader reader(payload, size);
+            uint8_t payloadType = 0;
+            const uint8_t* message = nullptr;
+            uint32_t messageSize = 0;
+            while (reader.Next(payloadType, message, messageSize)) {
+                if (messageSize == 0) {
+                    return false;
+                }
+            }
+            return reader.AtEnd();
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -1,45 +1,128 @@
-﻿#pragma once
-#include <string>
-#include <cstdint> // For uint16_t
+﻿// File: NetworkEndpoint.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Fixed-size binary remote address (IPv4/IPv6 + port) with a precomputed hash, used
+// as the key for every per-connection lookup on the packet path.
 
-// Forward declare a system-specific address structure if needed, or use general fields
-// For Winsock, this would eventually wrap something like sockaddr_in.
-// For simplicity here, we'll store IP as string and port.
+#pragma once
+
+#include <array>    // For std::array
+#include <cstdint>  // For uint8_t, uint16_t, uint32_t, uint64_t
+#include <cstring>  // For std::memcpy
+#include <string>   // For std::string (parsing and formatting only)
 
 namespace RiftForged {
     namespace Networking {
 
+        // NetworkEndpoint is trivially copyable and never allocates. Transports build it straight
+        // from the socket address; text is only parsed or produced for configuration and logging.
+        // The hash is computed once at construction, so the fields are read-only afterwards.
+        // IPv4-mapped IPv6 addresses (::ffff:a.b.c.d) are stored as IPv4 so both spellings of the
+        // same peer compare equal.
         struct NetworkEndpoint {
-            std::string ipAddress;
-            uint16_t port;
-            // You might also store a unique ID for this endpoint if assigned by ClientManager
+            enum class Family : uint8_t {
+                None = 0, // Default-constructed or unparsable address
+                IPv4 = 4,
+                IPv6 = 6
+            };
 
-            NetworkEndpoint(const std::string& ip = "", uint16_t p = 0)
-                : ipAddress(ip), port(p) {
-            }
+            NetworkEndpoint() = default;
+
+            // Parses a dotted IPv4 or textual IPv6 address; leaves the family at None on failure.
+            NetworkEndpoint(const std::string& ip, uint16_t p = 0);
 
-            // For logging or map keys
-            std::string ToString() const {
-                return ipAddress + ":" + std::to_string(port);
+            // 'networkOrderAddress' as found in sockaddr_in::sin_addr; 'hostOrderPort' already converted by ntohs().
+            static NetworkEndpoint FromIPv4(uint32_t networkOrderAddress, uint16_t hostOrderPort) {
+                NetworkEndpoint endpoint;
+                std::memcpy(endpoint.m_address.data(), &networkOrderAddress, sizeof(networkOrderAddress));
+                endpoint.m_port = hostOrderPort;
+                endpoint.m_family = Family::IPv4;
+                endpoint.m_hash = endpoint.ComputeHash();
+                return endpoint;
             }
 
-            bool operator<(const NetworkEndpoint& other) const {
-                if (ipAddress < other.ipAddress) {
-                    return true;
-                }
-                if (ipAddress > other.ipAddress) {
-                    return false;
+            // 'bytes' as found in sockaddr_in6::sin6_addr.
+            static NetworkEndpoint FromIPv6(const uint8_t(&bytes)[16], uint16_t hostOrderPort) {
+                static constexpr uint8_t mappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+                if (std::memcmp(bytes, mappedPrefix, sizeof(mappedPrefix)) == 0) {
+                    uint32_t ipv4 = 0;
+                    std::memcpy(&ipv4, bytes + 12, sizeof(ipv4));
+                    return FromIPv4(ipv4, hostOrderPort);
                 }
-                // IP addresses are equal, compare ports
-                return port < other.port;
+                NetworkEndpoint endpoint;
+                std::memcpy(endpoint.m_address.data(), bytes, 16);
+                endpoint.m_port = hostOrderPort;
+                endpoint.m_family = Family::IPv6;
+                endpoint.m_hash = endpoint.ComputeHash();
+                return endpoint;
             }
 
-            // Equality for comparisons, map keys etc.
+            Family GetFamily() const { return m_family; }
+            bool IsIPv4() const { return m_family == Family::IPv4; }
+            bool IsIPv6() const { return m_family == Family::IPv6; }
+            // True when both an address and a non-zero port are set, i.e. the endpoint can be sent to.
+            bool IsValid() const { return m_family != Family::None && m_port != 0; }
+
+            uint16_t GetPort() const { return m_port; }
+            // Address bytes in network order: 4 significant bytes for IPv4, 16 for IPv6.
+            const std::array<uint8_t, 16>& GetAddressBytes() const { return m_address; }
+            // Only meaningful for IPv4 endpoints; ready to store in sockaddr_in::sin_addr.
+            uint32_t GetIPv4NetworkOrder() const {
+                uint32_t ipv4 = 0;
+                std::memcpy(&ipv4, m_address.data(), sizeof(ipv4));
+                return ipv4;
+            }
+
+            uint32_t Hash() const { return m_hash; }
+
+            // Address without the port ("10.0.0.1", "2001:db8::1"); empty for Family::None.
+            std::string IpToString() const;
+            // For logging: "10.0.0.1:7777", "[2001:db8::1]:7777".
+            std::string ToString() const;
+
             bool operator==(const NetworkEndpoint& other) const {
-                return ipAddress == other.ipAddress && port == other.port;
+                return m_hash == other.m_hash && m_port == other.m_port &&
+                    m_family == other.m_family && m_address == other.m_address;
             }
-            // Add operator< if used as a key in std::map without a custom comparator
+
+            bool operator!=(const NetworkEndpoint& other) const {
+                return !(*this == other);
+            }
+
+            // Strict weak ordering for ordered containers; not meaningful beyond that.
+            bool operator<(const NetworkEndpoint& other) const {
+                if (m_family != other.m_family) return m_family < other.m_family;
+                if (m_address != other.m_address) return m_address < other.m_address;
+                return m_port < other.m_port;
+            }
+
+        private:
+            uint32_t ComputeHash() const {
+                // Two 64-bit lanes of address plus port/family, folded with a murmur3-style finalizer.
+                uint64_t lo = 0;
+                uint64_t hi = 0;
+                std::memcpy(&lo, m_address.data(), sizeof(lo));
+                std::memcpy(&hi, m_address.data() + 8, sizeof(hi));
+                uint64_t h = lo ^ (hi * 0x9E3779B97F4A7C15ull) ^
+                    ((static_cast<uint64_t>(m_port) << 8 | static_cast<uint64_t>(m_family)) * 0xC2B2AE3D27D4EB4Full);
+                h ^= h >> 33;
+                h *= 0xFF51AFD7ED558CCDull;
+                h ^= h >> 33;
+                h *= 0xC4CEB9FE1A85EC53ull;
+                h ^= h >> 33;
+                return static_cast<uint32_t>(h);
+            }
+
+            std::array<uint8_t, 16> m_address{}; // Network order; unused bytes stay zero.
+            uint16_t m_port = 0;                  // Host order.
+            Family m_family = Family::None;
+            uint32_t m_hash = 0;
+        };
+
+        // Hasher for std::unordered_* containers keyed by NetworkEndpoint.
+        struct NetworkEndpointHash {
+            size_t operator()(const NetworkEndpoint& endpoint) const { return endpoint.Hash(); }
         };
 
     } // namespace Networking
-} // namespace RiftForged
\ No newline at end of file
+} // namespace RiftForged
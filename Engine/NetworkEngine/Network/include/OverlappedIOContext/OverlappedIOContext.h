@@ -1,13 +1,20 @@
 ﻿// File: OverlappedIOContext.h
 #pragma once
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
 #include <Winsock2.h> // For OVERLAPPED, WSABUF, sockaddr_in
-#include <vector>     // For std::vector
-#include <cstring>    // For ZeroMemory
+#else
+#include <sys/socket.h> // For msghdr, socklen_t
+#include <sys/uio.h>    // For iovec
+#include <netinet/in.h> // For sockaddr_in
+#endif
+#include <span>       // For std::span (buffer view into a pool slab)
+#include <cstdint>    // For uint32_t
+#include <cstring>    // For ZeroMemory / memset
 
 // It's good practice to define constants used by these types here,
 // or make them configurable if they are not globally fixed.
@@ -22,16 +29,22 @@ namespace RiftForged {
             Send
         };
 
+        // Contexts do not own their buffer: 'buffer' views storage owned by an IOContextPool slab
+        // (or, for synchronous sends, the caller's data). 'poolIndex' identifies the pool slot.
+        constexpr uint32_t IO_CONTEXT_NO_POOL_INDEX = 0xFFFFFFFFu;
+
+#ifdef _WIN32
         struct OverlappedIOContext {
             OVERLAPPED      overlapped;
             IOOperationType operationType;
             WSABUF          wsaBuf;
-            std::vector<char> buffer; // char is fine for raw buffer
+            std::span<char> buffer; // char is fine for raw buffer
             sockaddr_in     remoteAddrNative;
             int             remoteAddrNativeLen;
+            uint32_t        poolIndex = IO_CONTEXT_NO_POOL_INDEX;
 
-            OverlappedIOContext(IOOperationType opType, size_t bufferSize = DEFAULT_IOCP_UDP_BUFFER_SIZE)
-                : operationType(opType), buffer(bufferSize), remoteAddrNativeLen(sizeof(sockaddr_in)) {
+            OverlappedIOContext(IOOperationType opType, std::span<char> storage = {})
+                : operationType(opType), buffer(storage), remoteAddrNativeLen(sizeof(sockaddr_in)) {
                 ZeroMemory(&overlapped, sizeof(OVERLAPPED));
                 ZeroMemory(&remoteAddrNative, sizeof(sockaddr_in));
                 wsaBuf.buf = buffer.data();
@@ -46,7 +59,65 @@ namespace RiftForged {
                 wsaBuf.buf = buffer.data();
                 wsaBuf.len = static_cast<ULONG>(buffer.size());
             }
+
+            // Prepares a pooled context for a WSASendTo of 'length' bytes already copied into 'buffer'.
+            void ResetForSend(size_t length) {
+                ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+                ZeroMemory(&remoteAddrNative, sizeof(sockaddr_in));
+                operationType = IOOperationType::Send;
+                remoteAddrNativeLen = sizeof(sockaddr_in);
+                wsaBuf.buf = buffer.data();
+                wsaBuf.len = static_cast<ULONG>(length);
+            }
         };
+#else
+        // Linux counterpart of the IOCP context. There is no OVERLAPPED here; instead the
+        // context carries the msghdr/iovec pair that recvmsg/sendmsg (or an io_uring SQE)
+        // fill in, so the same pointer can be handed to INetworkIOEvents on both platforms.
+        struct OverlappedIOContext {
+            IOOperationType operationType;
+            iovec           ioVec;
+            msghdr          msgHeader;
+            std::span<char> buffer;
+            sockaddr_in     remoteAddrNative;
+            socklen_t       remoteAddrNativeLen;
+            uint32_t        poolIndex = IO_CONTEXT_NO_POOL_INDEX;
+
+            OverlappedIOContext(IOOperationType opType, std::span<char> storage = {})
+                : operationType(opType), buffer(storage), remoteAddrNativeLen(sizeof(sockaddr_in)) {
+                std::memset(&remoteAddrNative, 0, sizeof(sockaddr_in));
+                BindMessageHeader(buffer.size());
+            }
+
+            void ResetForReceive() {
+                std::memset(&remoteAddrNative, 0, sizeof(sockaddr_in));
+                operationType = IOOperationType::Recv;
+                remoteAddrNativeLen = sizeof(sockaddr_in);
+                BindMessageHeader(buffer.size());
+            }
+
+            // Prepares a pooled context for a sendmsg of 'length' bytes already copied into 'buffer'.
+            void ResetForSend(size_t length) {
+                std::memset(&remoteAddrNative, 0, sizeof(sockaddr_in));
+                operationType = IOOperationType::Send;
+                remoteAddrNativeLen = sizeof(sockaddr_in);
+                BindMessageHeader(length);
+            }
+
+            // Points msgHeader at this context's address and buffer. 'length' lets a send
+            // context describe only the bytes actually copied into the buffer.
+            // msgHeader/ioVec point into this object, so contexts must not be moved once bound.
+            void BindMessageHeader(size_t length) {
+                ioVec.iov_base = buffer.data();
+                ioVec.iov_len = length;
+                std::memset(&msgHeader, 0, sizeof(msghdr));
+                msgHeader.msg_name = &remoteAddrNative;
+                msgHeader.msg_namelen = remoteAddrNativeLen;
+                msgHeader.msg_iov = &ioVec;
+                msgHeader.msg_iovlen = 1;
+            }
+        };
+#endif
 
     } // namespace Networking
-} // namespace RiftForged
\ No newline at end of file
+} // namespace RiftForged
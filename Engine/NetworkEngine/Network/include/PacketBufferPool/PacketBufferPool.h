@@ -0,0 +1,113 @@
+﻿// File: PacketBufferPool.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Pooled, reference-counted buffers for serialized outgoing payloads. One payload is
+// shared by the send queue, the retransmission list and every recipient of a broadcast; only the
+// small per-connection GamePacketHeader is written separately and gathered at send time.
+
+#pragma once
+
+#include <atomic>           // For std::atomic
+#include <cstdint>          // For uint8_t, uint32_t, uint64_t
+#include <memory>           // For std::shared_ptr, std::unique_ptr
+#include <mutex>            // For std::mutex
+#include <vector>           // For std::vector
+
+// Usable bytes in a pooled buffer. Covers any payload that fits a single MTU-sized datagram;
+// larger requests get a one-off heap buffer that is freed instead of pooled.
+const uint32_t PACKET_BUFFER_DEFAULT_CAPACITY = 1500;
+// Free buffers kept by a pool before released ones are freed instead of recycled.
+const uint32_t PACKET_BUFFER_DEFAULT_MAX_POOLED = 4096;
+
+namespace RiftForged {
+    namespace Networking {
+
+        struct PacketBuffer;
+        struct PacketBufferPoolCore;
+
+        // Handle to a pooled buffer. Copying shares the buffer (one atomic increment); the buffer
+        // goes back to its pool when the last handle is destroyed. Handles may be released from any
+        // thread, including after the owning PacketBufferPool has been destroyed.
+        //
+        // The contents are written once by whoever acquired the buffer and are read-only after the
+        // first copy of the handle is made; MutableData()/SetSize() must not be used on a shared buffer.
+        class PacketBufferRef {
+        public:
+            PacketBufferRef() = default;
+            PacketBufferRef(const PacketBufferRef& other);
+            PacketBufferRef(PacketBufferRef&& other) noexcept;
+            PacketBufferRef& operator=(const PacketBufferRef& other);
+            PacketBufferRef& operator=(PacketBufferRef&& other) noexcept;
+            ~PacketBufferRef();
+
+            const uint8_t* Data() const;
+            uint32_t Size() const;
+            uint32_t Capacity() const;
+
+            // Writable view for the acquiring thread, before the handle is shared.
+            uint8_t* MutableData();
+            // Sets the payload length; clamped to Capacity().
+            void SetSize(uint32_t size);
+
+            // Number of handles sharing the buffer (0 for an empty handle). Diagnostic only.
+            uint32_t UseCount() const;
+
+            void Reset();
+            explicit operator bool() const { return m_buffer != nullptr; }
+
+        private:
+            friend struct PacketBufferPoolCore;
+            explicit PacketBufferRef(PacketBuffer* buffer) : m_buffer(buffer) {}
+
+            PacketBuffer* m_buffer = nullptr;
+        };
+
+        // Snapshot of a PacketBufferPool's counters.
+        struct PacketBufferPoolStats {
+            uint64_t acquires = 0;          // Successful Acquire()/CopyFrom() calls.
+            uint64_t allocations = 0;       // Pooled buffers created because the free list was empty.
+            uint64_t oversizeAllocations = 0; // One-off buffers for requests above the pooled capacity.
+            uint32_t freeBuffers = 0;       // Buffers currently waiting on the free list.
+            uint32_t outstanding = 0;       // Buffers currently referenced by at least one handle.
+        };
+
+        // PacketBufferPool hands out fixed-capacity buffers and recycles them when their last
+        // PacketBufferRef goes away. The free list is a short mutex-guarded stack: buffers are
+        // acquired once per serialized message (not per recipient or per retransmission), so
+        // contention is far lower than on the per-datagram paths that use IOContextPool.
+        class PacketBufferPool {
+        public:
+            /**
+             * @param bufferCapacity Usable bytes per pooled buffer.
+             * @param maxPooled Free buffers retained for reuse; extra releases are freed.
+             * @param preallocate Buffers created up front so the first ticks do not allocate.
+             */
+            explicit PacketBufferPool(uint32_t bufferCapacity = PACKET_BUFFER_DEFAULT_CAPACITY,
+                uint32_t maxPooled = PACKET_BUFFER_DEFAULT_MAX_POOLED,
+                uint32_t preallocate = 0);
+
+            // Frees the free list. Buffers still referenced are freed by their last handle.
+            ~PacketBufferPool();
+
+            PacketBufferPool(const PacketBufferPool&) = delete;
+            PacketBufferPool& operator=(const PacketBufferPool&) = delete;
+
+            /**
+             * @brief Returns an unshared buffer with Size() == size, ready to be written through MutableData().
+             * @return An empty handle only if the allocation failed.
+             */
+            PacketBufferRef Acquire(uint32_t size);
+
+            // Acquire() followed by a copy of 'size' bytes from 'data'.
+            PacketBufferRef CopyFrom(const uint8_t* data, uint32_t size);
+
+            uint32_t GetBufferCapacity() const;
+
+            PacketBufferPoolStats GetStats() const;
+
+        private:
+            std::shared_ptr<PacketBufferPoolCore> m_core; // Outlives the pool while buffers are referenced.
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,110 @@
+﻿// File: PayloadCompression.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Optional zstd compression of datagram payloads for connections that negotiated
+// CONNECTION_CAPABILITY_COMPRESSION, using a dictionary trained offline from captured traffic.
+
+#pragma once
+
+#include "PacketBufferPool.h" // For PacketBufferPool, PacketBufferRef
+
+#include <atomic>   // For std::atomic
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdint>  // For uint8_t, uint32_t, uint64_t
+#include <memory>   // For std::unique_ptr
+#include <string>   // For std::string
+
+// Payloads smaller than this are sent as they are: the zstd frame header would eat most of the gain.
+const uint32_t PAYLOAD_COMPRESSION_MIN_SIZE = 96;
+// zstd level; low levels keep per-datagram cost in the low microseconds.
+const int PAYLOAD_COMPRESSION_LEVEL = 3;
+// Default CPU time compression may spend per second, across all connections.
+const uint32_t PAYLOAD_COMPRESSION_DEFAULT_BUDGET_US_PER_SECOND = 50000;
+// Largest payload a compressed datagram may expand to.
+const uint32_t PAYLOAD_COMPRESSION_MAX_DECOMPRESSED_SIZE = 65535;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Compression counters, kept per connection and for the whole compressor.
+        struct CompressionStats {
+            uint64_t packetsCompressed = 0;       // Sent with PayloadEncoding::Zstd
+            uint64_t packetsIncompressible = 0;   // Tried, but the result was not smaller
+            uint64_t packetsSkippedForBudget = 0; // Sent raw because the CPU budget was spent
+            uint64_t bytesBeforeCompression = 0;  // Payload bytes of the compressed packets...
+            uint64_t bytesAfterCompression = 0;   // ...and what they were sent as
+            uint64_t packetsDecompressed = 0;
+            uint64_t decompressionFailures = 0;   // Corrupt frames or a dictionary mismatch; dropped
+        };
+
+        enum class CompressResult : uint8_t {
+            Compressed,
+            TooSmall,        // Below PAYLOAD_COMPRESSION_MIN_SIZE
+            Incompressible,  // The frame would not have been smaller
+            OverBudget,      // The CPU budget for this second is spent
+            Unavailable      // Built without zstd, or disabled with a zero budget
+        };
+
+        // PayloadCompressor compresses whole datagram payloads into single zstd frames. The
+        // dictionary is produced offline (zstd --train over payloads extracted from PacketCapture
+        // recordings) and must be the same file on both ends; without one plain zstd is used.
+        //
+        // Compression stops for the rest of the current second once it has spent the configured
+        // CPU budget, so a loaded server sends raw payloads instead of falling behind.
+        //
+        // zstd support is compiled in only when <zstd.h> is available; otherwise IsAvailable() is
+        // false, the capability is never granted and every payload is sent raw.
+        //
+        // Compress and Decompress are safe from any thread (zstd contexts are per thread).
+        // LoadDictionary must be called before traffic starts.
+        class PayloadCompressor {
+        public:
+            PayloadCompressor();
+            ~PayloadCompressor();
+
+            PayloadCompressor(const PayloadCompressor&) = delete;
+            PayloadCompressor& operator=(const PayloadCompressor&) = delete;
+
+            bool IsAvailable() const;
+
+            // Loads a zstd dictionary file. Returns false (and keeps the previous one) on failure.
+            bool LoadDictionary(const std::string& path);
+
+            // CPU time compression may use per second; 0 disables compression.
+            void SetCpuBudget(uint32_t microsecondsPerSecond);
+
+            /**
+             * @brief Compresses 'size' bytes into a buffer from 'pool'.
+             * @param out_payload Receives the frame if the result is Compressed.
+             */
+            CompressResult Compress(const uint8_t* data, uint32_t size, PacketBufferPool& pool, PacketBufferRef& out_payload);
+
+            /**
+             * @brief Decompresses one frame into a buffer owned by the calling thread, valid until
+             * that thread's next Decompress call.
+             */
+            bool Decompress(const uint8_t* data, uint32_t size, const uint8_t** out_data, uint32_t* out_size);
+
+            CompressionStats GetStats() const;
+
+        private:
+            struct Dictionary;
+
+            bool HasBudgetLeft(std::chrono::steady_clock::time_point now, uint32_t budgetMicrosPerSecond);
+
+            std::unique_ptr<Dictionary> m_dictionary;
+            std::atomic<uint32_t> m_budgetMicrosPerSecond{ PAYLOAD_COMPRESSION_DEFAULT_BUDGET_US_PER_SECOND };
+            std::atomic<int64_t> m_budgetWindowStart{ 0 };  // steady_clock ticks of the current second
+            std::atomic<uint64_t> m_budgetSpentNanos{ 0 };  // CPU time spent in the current second
+
+            std::atomic<uint64_t> m_packetsCompressed{ 0 };
+            std::atomic<uint64_t> m_packetsIncompressible{ 0 };
+            std::atomic<uint64_t> m_packetsSkippedForBudget{ 0 };
+            std::atomic<uint64_t> m_bytesBeforeCompression{ 0 };
+            std::atomic<uint64_t> m_bytesAfterCompression{ 0 };
+            std::atomic<uint64_t> m_packetsDecompressed{ 0 };
+            std::atomic<uint64_t> m_decompressionFailures{ 0 };
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -7,7 +7,6 @@
 #include <cstdint>   // For uint32_t, uint16_t, uint8_t
 #include <vector>    // For std::vector
 #include <chrono>    // For std::chrono::steady_clock
-#include <list>      // For std::list
 #include <mutex>     // For std::mutex
 #include <algorithm> // For std::min and std::max
 #include <cmath>     // For std::abs
@@ -16,6 +15,14 @@
 // Or if SequenceNumber is a primitive, this might not be strictly needed here but good for context.
 // Assuming SequenceNumber is defined in GamePacketHeader.h or is a basic type.
 #include "GamePacketHeader.h" // For SequenceNumber type
+#include "PacketBufferPool.h" // For PacketBufferRef (payloads shared with the send queue)
+#include "FragmentReassembly.h" // For FragmentReassembler
+#include "CongestionController.h" // For CongestionController (send window and pacing)
+#include "SelectiveAck.h" // For ReceivedSequenceWindow
+#include "DeliveryChannel.h" // For DELIVERY_CHANNEL_COUNT, ChannelReceiveState
+#include "PayloadCompression.h" // For PayloadCompressor, CompressionStats
+#include "InboundRateLimiter.h" // For InboundRateLimiter
+#include "ConnectionTelemetry.h" // For ConnectionTelemetry
 
 namespace RiftForged {
     namespace Networking {
@@ -31,7 +38,7 @@ namespace RiftForged {
             const uint8_t* packetPayloadData,
             uint16_t packetPayloadLength,
             const uint8_t** out_payloadToProcess,
-            uint16_t* out_payloadSize);
+            uint32_t* out_payloadSize);
 
         // RTT calculation constants (based on RFC 6298 recommendations)
         const float RTT_ALPHA = 0.125f; // Factor for SRTT (g)
@@ -45,33 +52,228 @@ namespace RiftForged {
         // Global maximum retries for a reliable packet before considering the connection dropped.
         const int MAX_PACKET_RETRIES = 10;
 
+        // Timers the owner of a connection arms for it (see UDPPacketHandler's timer wheel).
+        enum class ReliabilityTimerKind : uint8_t {
+            Retransmit,      // Earliest RTO deadline among unacknowledged packets.
+            AckFlush,        // When a pending ACK must go out on its own.
+            StaleConnection, // When the connection may be considered idle.
+            PacedSend,       // When the pacer next lets staged messages out.
+            Count
+        };
+
+        // Reliable packets that may be awaiting acknowledgement per connection (must be a power of two).
+        // A send that would need a slot still held by an unacknowledged packet is refused.
+        const uint32_t RELIABLE_SEND_WINDOW_SIZE = 1024;
+
+        // Slots a connection's SentPacketRing allocates on its first reliable send. The ring doubles
+        // (up to RELIABLE_SEND_WINDOW_SIZE) only when the in-flight span outgrows it, so an idle or
+        // lightly used connection does not carry the full window.
+        const uint32_t SENT_PACKET_RING_INITIAL_CAPACITY = 32;
+
+        // Every header acknowledges the receiver's highest sequence plus the 32 before it; older
+        // sequences are only acknowledged by selective ack blocks, which not every peer sends. So
+        // fragments are only sent while the in-flight span stays below that range.
+        const uint32_t FRAGMENT_SEND_WINDOW_SIZE = 32;
+
+        // A reliable packet is fast-retransmitted (once, without waiting for its RTO) when a packet
+        // sent this many sequence numbers after it has been acknowledged.
+        const uint32_t FAST_RETRANSMIT_PACKET_THRESHOLD = 3;
+
+        // The header is kept by value and the payload by reference: a retransmission re-sends the
+        // same payload buffer the original send (and any other broadcast recipient) used.
+        struct SentPacketInfo {
+            SequenceNumber sequenceNumber = 0;
+            std::chrono::steady_clock::time_point timeSent;
+            GamePacketHeader header;
+            PacketBufferRef payload;
+            int retries = 0;
+            bool isAckOnly = false;
+            bool fastRetransmitted = false;
+
+            SentPacketInfo() = default;
+            SentPacketInfo(SequenceNumber seq, const GamePacketHeader& packetHeader, const PacketBufferRef& packetPayload, bool ackOnlyFlag)
+                : sequenceNumber(seq),
+                timeSent(std::chrono::steady_clock::now()),
+                header(packetHeader),
+                payload(packetPayload),
+                retries(0),
+                isAckOnly(ackOnlyFlag) {
+            }
+        };
+
+        // Unacknowledged reliable packets, stored in a ring indexed by sequence number.
+        // Sequence numbers are assigned in order, so slot (seq % capacity) belongs to exactly one
+        // in-flight packet and Find/Remove are O(1); acknowledging a header's ackNumber plus its
+        // 32-bit ackBitfield costs 33 slot probes however many packets are outstanding.
+        // In-flight packets span [oldest, next); iteration walks that span in sequence order.
+        // The slots are allocated on the first Insert and grow with the in-flight span (see
+        // SENT_PACKET_RING_INITIAL_CAPACITY); CAPACITY is the most the window may ever hold.
+        class SentPacketRing {
+        public:
+            static constexpr uint32_t CAPACITY = RELIABLE_SEND_WINDOW_SIZE;
+            static_assert((CAPACITY & (CAPACITY - 1)) == 0, "RELIABLE_SEND_WINDOW_SIZE must be a power of two");
+            static_assert((SENT_PACKET_RING_INITIAL_CAPACITY & (SENT_PACKET_RING_INITIAL_CAPACITY - 1)) == 0 &&
+                SENT_PACKET_RING_INITIAL_CAPACITY <= CAPACITY, "SENT_PACKET_RING_INITIAL_CAPACITY must be a power of two no larger than the window");
+
+            // True if 'seq' can be inserted without overwriting an unacknowledged packet.
+            bool CanInsert(SequenceNumber seq) const {
+                return m_count == 0 || static_cast<SequenceNumber>(seq - m_oldest) < CAPACITY;
+            }
+
+            // Stores a packet; 'seq' must be newer than every packet inserted before it.
+            // Returns nullptr (and stores nothing) if the window is full.
+            SentPacketInfo* Insert(SequenceNumber seq, const GamePacketHeader& header, const PacketBufferRef& payload, bool ackOnly) {
+                if (!CanInsert(seq)) {
+                    return nullptr;
+                }
+                const uint32_t spanAfterInsert = m_count == 0 ? 1 : static_cast<uint32_t>(static_cast<SequenceNumber>(seq - m_oldest)) + 1;
+                if (spanAfterInsert > m_slots.size()) {
+                    Grow(spanAfterInsert);
+                }
+                Slot& slot = m_slots[SlotIndex(seq)];
+                slot.info = SentPacketInfo(seq, header, payload, ackOnly);
+                slot.inUse = true;
+                if (m_count == 0) {
+                    m_oldest = seq;
+                }
+                m_next = static_cast<SequenceNumber>(seq + 1);
+                ++m_count;
+                return &slot.info;
+            }
+
+            SentPacketInfo* Find(SequenceNumber seq) {
+                if (m_count == 0) return nullptr;
+                Slot& slot = m_slots[SlotIndex(seq)];
+                return (slot.inUse && slot.info.sequenceNumber == seq) ? &slot.info : nullptr;
+            }
+
+            // Releases the packet (and its payload reference). Returns false if 'seq' was not in flight.
+            bool Remove(SequenceNumber seq) {
+                if (m_count == 0) return false;
+                Slot& slot = m_slots[SlotIndex(seq)];
+                if (!slot.inUse || slot.info.sequenceNumber != seq) {
+                    return false;
+                }
+                slot.inUse = false;
+                slot.info.payload.Reset();
+                --m_count;
+                // Advance past acknowledged slots so iteration and CanInsert track the real window.
+                if (m_count == 0) {
+                    m_oldest = m_next;
+                }
+                else {
+                    while (!m_slots[SlotIndex(m_oldest)].inUse) {
+                        m_oldest = static_cast<SequenceNumber>(m_oldest + 1);
+                    }
+                }
+                return true;
+            }
+
+            // Calls fn(SentPacketInfo&) for every in-flight packet, oldest first. fn must not insert or remove.
+            template <typename Fn>
+            void ForEach(Fn&& fn) {
+                if (m_count == 0) return;
+                for (SequenceNumber seq = m_oldest; seq != m_next; seq = static_cast<SequenceNumber>(seq + 1)) {
+                    Slot& slot = m_slots[SlotIndex(seq)];
+                    if (slot.inUse) {
+                        fn(slot.info);
+                    }
+                }
+            }
+
+            // Same as ForEach, but stops at the first packet whose sequence number is not before 'end'.
+            template <typename Fn>
+            void ForEachBefore(SequenceNumber end, Fn&& fn) {
+                if (m_count == 0) return;
+                for (SequenceNumber seq = m_oldest; seq != m_next && static_cast<int32_t>(seq - end) < 0; seq = static_cast<SequenceNumber>(seq + 1)) {
+                    Slot& slot = m_slots[SlotIndex(seq)];
+                    if (slot.inUse) {
+                        fn(slot.info);
+                    }
+                }
+            }
+
+            // Drops every packet and gives the slots back; the next Insert allocates afresh.
+            void Clear() {
+                std::vector<Slot>().swap(m_slots);
+                m_count = 0;
+                m_oldest = m_next;
+            }
+
+            size_t Size() const { return m_count; }
+            bool Empty() const { return m_count == 0; }
+            // Sequence numbers from the oldest in-flight packet to the newest inserted, inclusive.
+            uint32_t Span() const { return m_count == 0 ? 0 : static_cast<uint32_t>(m_next - m_oldest); }
+            // Slots currently allocated (0 before the first Insert and after Clear).
+            uint32_t AllocatedSlots() const { return static_cast<uint32_t>(m_slots.size()); }
+
+        private:
+            struct Slot {
+                SentPacketInfo info;
+                bool inUse = false;
+            };
+
+            uint32_t SlotIndex(SequenceNumber seq) const { return static_cast<uint32_t>(seq) & (static_cast<uint32_t>(m_slots.size()) - 1); }
+
+            // Reallocates to the smallest power of two holding 'span' sequence numbers and moves the
+            // in-flight packets to their slots under the new mask.
+            void Grow(uint32_t span) {
+                uint32_t newCapacity = m_slots.empty() ? SENT_PACKET_RING_INITIAL_CAPACITY : static_cast<uint32_t>(m_slots.size());
+                while (newCapacity < span) {
+                    newCapacity *= 2;
+                }
+                std::vector<Slot> grown(newCapacity);
+                for (Slot& slot : m_slots) {
+                    if (slot.inUse) {
+                        grown[static_cast<uint32_t>(slot.info.sequenceNumber) & (newCapacity - 1)] = std::move(slot);
+                    }
+                }
+                m_slots.swap(grown);
+            }
+
+            std::vector<Slot> m_slots;
+            SequenceNumber m_oldest = 0; // Oldest sequence number that may still be in flight.
+            SequenceNumber m_next = 0;   // One past the newest inserted sequence number.
+            size_t m_count = 0;
+        };
+
+
+        // Why reliable packets were sent again. A fast retransmit is counted as spurious when its
+        // acknowledgement arrives less than half an SRTT after the resend, i.e. the ACK was for the
+        // original, which had only been reordered or delayed.
+        struct RetransmitStats {
+            uint64_t timeoutRetransmits = 0;
+            uint64_t fastRetransmits = 0;
+            uint64_t spuriousFastRetransmits = 0;
+        };
 
         struct ReliableConnectionState {
             mutable std::mutex internalStateMutex;
 
+            // Server-assigned ID stamped into every outgoing header. Set once when the session is
+            // created and kept across Reset().
+            uint32_t connectionId = INVALID_CONNECTION_ID;
+
             SequenceNumber nextOutgoingSequenceNumber = 1;
 
-            struct SentPacketInfo {
-                SequenceNumber sequenceNumber;
-                std::chrono::steady_clock::time_point timeSent;
-                std::vector<uint8_t> packetData;
-                int retries = 0;
-                bool isAckOnly = false;
-
-                SentPacketInfo(SequenceNumber seq, const std::vector<uint8_t>& data, bool ackOnlyFlag)
-                    : sequenceNumber(seq),
-                    timeSent(std::chrono::steady_clock::now()),
-                    packetData(data),
-                    retries(0),
-                    isAckOnly(ackOnlyFlag) {
-                }
-            };
-            std::list<SentPacketInfo> unacknowledgedSentPackets;
+            using SentPacketInfo = Networking::SentPacketInfo;
+            SentPacketRing unacknowledgedSentPackets;
+            // Newest of our sequence numbers the remote has acknowledged (0 before the first ACK).
+            SequenceNumber largestAckedSequence = 0;
+            // Set when largestAckedSequence advances; GetPacketsForFastRetransmission then looks for gaps.
+            bool fastRetransmitCheckPending = false;
+            RetransmitStats retransmitStats;
 
             SequenceNumber highestReceivedSequenceNumberFromRemote = 0;
-            uint32_t receivedSequenceBitfield = 0;
+            uint32_t receivedSequenceBitfield = 0; // Low 32 bits of receivedSequenceWindow, as sent in headers
+            ReceivedSequenceWindow receivedSequenceWindow;
 
             bool hasPendingAckToSend = false;
+            // CONNECTION_CAPABILITY_ bits granted in the handshake; kept across Reset().
+            uint8_t capabilities = 0;
+            // Set when the receive window has a gap the header's 32 bits may not cover: the next
+            // ACK-only packet carries a SelectiveAckBlock even if data piggybacked the header ACK.
+            bool hasPendingSelectiveAck = false;
             std::chrono::steady_clock::time_point lastPacketSentTimeToRemote;
             std::chrono::steady_clock::time_point lastPacketReceivedTimeFromRemote;
 
@@ -83,24 +285,44 @@ namespace RiftForged {
             bool connectionDroppedByMaxRetries;
             bool isConnected;
 
-            struct IncomingFragmentBuffer {
-                SequenceNumber fragmentStartSequenceNumber = 0;
-                uint16_t totalFragments = 0;
-                uint16_t receivedFragmentCount = 0;
-                std::vector<std::vector<uint8_t>> fragments;
-                std::chrono::steady_clock::time_point lastFragmentArrivalTime;
-                bool awaitingFragments = false;
-
-                void Reset() {
-                    fragmentStartSequenceNumber = 0;
-                    totalFragments = 0;
-                    receivedFragmentCount = 0;
-                    fragments.clear();
-                    lastFragmentArrivalTime = std::chrono::steady_clock::time_point::min();
-                    awaitingFragments = false;
-                }
+            // Deadline currently armed for each ReliabilityTimerKind, time_point::max() if none. An
+            // expiring timer whose deadline no longer matches was superseded and is ignored.
+            std::array<std::chrono::steady_clock::time_point, static_cast<size_t>(ReliabilityTimerKind::Count)> armedTimerDeadlines;
+
+            // Messages staged during a tick, packed into coalesced datagrams by BuildCoalescedPackets.
+            struct PendingOutboundMessage {
+                PacketBufferRef payload;
+                uint8_t payloadType = 0;
+                uint16_t fragmentMessageId = 0;  // Assigned when the first fragment is sent
+                uint16_t nextFragmentIndex = 0;  // Fragments already sent, for messages sent in pieces
             };
-            IncomingFragmentBuffer incomingFragmentBuffer;
+            // Indexed by DeliveryChannel; each channel is packed into its own datagrams.
+            std::array<std::vector<PendingOutboundMessage>, DELIVERY_CHANNEL_COUNT> pendingMessages;
+            bool outboundAssemblyQueued = false; // True while the owner has this connection on its assembly list.
+            uint16_t nextFragmentMessageId = 0;
+
+            // Next channelSequence to stamp on a data packet, per DeliveryChannel.
+            std::array<uint16_t, DELIVERY_CHANNEL_COUNT> nextChannelSequence{};
+            // Ordering / staleness state of what the remote sent on each DeliveryChannel.
+            std::array<ChannelReceiveState, DELIVERY_CHANNEL_COUNT> channelReceiveStates;
+
+            // Partially received fragmented messages from the remote.
+            FragmentReassembler fragmentReassembler;
+
+            // Limits reliable bytes in flight and spaces out the datagrams BuildCoalescedPackets emits.
+            CongestionController congestionController;
+
+            // Shared compressor used when CONNECTION_CAPABILITY_COMPRESSION was granted. Set by the
+            // owner before the state is shared and kept across Reset(); it must outlive the state.
+            PayloadCompressor* payloadCompressor = nullptr;
+            CompressionStats compressionStats;
+
+            // Inbound limits for this client. Configured by the owner before the state is shared, kept
+            // across Reset(), and used without internalStateMutex (it is lock-free).
+            InboundRateLimiter inboundRateLimiter;
+
+            // Quality counters and RTT histogram for telemetry. Lock-free to read; kept across Reset().
+            ConnectionTelemetry telemetry;
 
         private:
             // This version does the actual work and ASSUMES internalStateMutex is ALREADY HELD by the caller.
@@ -131,6 +353,7 @@ namespace RiftForged {
                 isFirstRTTSample(true),
                 connectionDroppedByMaxRetries(false),
                 isConnected(true) {
+                armedTimerDeadlines.fill(std::chrono::steady_clock::time_point::max());
                 if (retransmissionTimeout_ms < MIN_RTO_MS) retransmissionTimeout_ms = MIN_RTO_MS;
                 if (retransmissionTimeout_ms > MAX_RTO_MS) retransmissionTimeout_ms = MAX_RTO_MS;
             }
@@ -138,16 +361,33 @@ namespace RiftForged {
             void Reset() {
                 std::lock_guard<std::mutex> lock(internalStateMutex);
                 nextOutgoingSequenceNumber = 1;
-                unacknowledgedSentPackets.clear();
+                unacknowledgedSentPackets.Clear();
+                largestAckedSequence = 0;
+                fastRetransmitCheckPending = false;
+                retransmitStats = RetransmitStats();
                 highestReceivedSequenceNumberFromRemote = 0;
                 receivedSequenceBitfield = 0;
+                receivedSequenceWindow.Clear();
                 hasPendingAckToSend = false;
+                hasPendingSelectiveAck = false;
                 lastPacketSentTimeToRemote = std::chrono::steady_clock::time_point::min();
                 lastPacketReceivedTimeFromRemote = std::chrono::steady_clock::time_point::min();
                 isFirstRTTSample = true;
                 connectionDroppedByMaxRetries = false;
                 isConnected = true; // Or false, depending on desired reset state
-                incomingFragmentBuffer.Reset();
+                fragmentReassembler.Clear();
+                nextFragmentMessageId = 0;
+                congestionController.Reset();
+                compressionStats = CompressionStats();
+                for (auto& pending : pendingMessages) {
+                    pending.clear();
+                }
+                nextChannelSequence.fill(0);
+                for (ChannelReceiveState& channelState : channelReceiveStates) {
+                    channelState.ordered.Clear();
+                    channelState.hasNewestSequence = false;
+                }
+                armedTimerDeadlines.fill(std::chrono::steady_clock::time_point::max());
                 smoothedRTT_ms = DEFAULT_INITIAL_RTT_MS;
                 rttVariance_ms = DEFAULT_INITIAL_RTT_MS / 2.0f;
                 retransmissionTimeout_ms = DEFAULT_INITIAL_RTT_MS * 2.0f;
@@ -160,6 +400,31 @@ namespace RiftForged {
                 ApplyRTTSampleUnlocked(sampleRTT_ms);
             }
 
+            float GetRetransmissionTimeoutMs() const {
+                std::lock_guard<std::mutex> lock(internalStateMutex);
+                return retransmissionTimeout_ms;
+            }
+
+            void SetCapabilities(uint8_t grantedCapabilities) {
+                std::lock_guard<std::mutex> lock(internalStateMutex);
+                capabilities = grantedCapabilities;
+            }
+
+            RetransmitStats GetRetransmitStats() const {
+                std::lock_guard<std::mutex> lock(internalStateMutex);
+                return retransmitStats;
+            }
+
+            CompressionStats GetCompressionStats() const {
+                std::lock_guard<std::mutex> lock(internalStateMutex);
+                return compressionStats;
+            }
+
+            CongestionStats GetCongestionStats() const {
+                std::lock_guard<std::mutex> lock(internalStateMutex);
+                return congestionController.GetStats(smoothedRTT_ms);
+            }
+
             bool ShouldDropPacket(int retries) const {
                 return retries >= MAX_PACKET_RETRIES;
             }
@@ -167,12 +432,7 @@ namespace RiftForged {
 #ifdef _DEBUG
             void ForceAcknowledgePacket(SequenceNumber seq) {
                 std::lock_guard<std::mutex> lock(internalStateMutex);
-                for (auto it = unacknowledgedSentPackets.begin(); it != unacknowledgedSentPackets.end(); ++it) {
-                    if (it->sequenceNumber == seq) {
-                        unacknowledgedSentPackets.erase(it);
-                        return;
-                    }
-                }
+                unacknowledgedSentPackets.Remove(seq);
             }
 #endif
             // Friend declaration to allow ProcessIncomingPacketHeader to call ApplyRTTSampleUnlocked
@@ -182,7 +442,7 @@ namespace RiftForged {
                 const uint8_t* packetPayloadData,
                 uint16_t packetPayloadLength,
                 const uint8_t** out_payloadToProcess,
-                uint16_t* out_payloadSize);
+                uint32_t* out_payloadSize);
         };
 
     } // namespace Networking
@@ -0,0 +1,124 @@
+﻿// File: SelectiveAck.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Receive window of SELECTIVE_ACK_WINDOW_BITS sequence numbers and the selective
+// acknowledgement block that reports it to peers which negotiated CONNECTION_CAPABILITY_SELECTIVE_ACKS.
+
+#pragma once
+
+#include "GamePacketHeader.h" // For SequenceNumber
+
+#include <array>    // For std::array
+#include <bit>      // For std::countr_zero
+#include <cstdint>  // For uint32_t, uint64_t
+
+// Sequence numbers behind the newest received that the receiver remembers and can acknowledge.
+// The header's ackBitfield reports the 32 most recent; a selective ack block reports all of them.
+const uint32_t SELECTIVE_ACK_WINDOW_BITS = 256;
+const uint32_t SELECTIVE_ACK_WINDOW_WORDS = SELECTIVE_ACK_WINDOW_BITS / 64;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Payload of an IS_ACK_ONLY packet on a connection with CONNECTION_CAPABILITY_SELECTIVE_ACKS.
+        // It names its own base sequence, so it stays truthful if the packet is retransmitted
+        // after the header's ACK fields were rewritten.
+#pragma pack(push, 1)
+        struct SelectiveAckBlock {
+            SequenceNumber highestReceived = 0;
+            uint64_t receivedBits[SELECTIVE_ACK_WINDOW_WORDS] = {}; // Bit n set: highestReceived - (n + 1) received
+        };
+#pragma pack(pop)
+
+        // Bit n records whether sequence (highest - (n + 1)) has been received, for n below
+        // SELECTIVE_ACK_WINDOW_BITS. The low 32 bits are exactly the header's ackBitfield.
+        class ReceivedSequenceWindow {
+        public:
+            // The newest sequence moved 'distance' ahead of 'previousHighest'.
+            void Advance(uint32_t distance, SequenceNumber previousHighest) {
+                ShiftLeft(distance);
+                if (previousHighest != 0 && distance <= SELECTIVE_ACK_WINDOW_BITS) {
+                    Set(distance); // The old newest is now 'distance' behind.
+                }
+            }
+
+            // 'distance' is 1..SELECTIVE_ACK_WINDOW_BITS behind the newest sequence.
+            bool Test(uint32_t distance) const {
+                const uint32_t bit = distance - 1;
+                return (m_words[bit / 64] >> (bit % 64)) & 1ull;
+            }
+
+            void Set(uint32_t distance) {
+                const uint32_t bit = distance - 1;
+                m_words[bit / 64] |= 1ull << (bit % 64);
+            }
+
+            uint32_t Low32() const { return static_cast<uint32_t>(m_words[0]); }
+
+            /**
+             * @brief True if a sequence between 1 and 'highest' - 1 that still lies inside the window
+             * has not arrived, i.e. the peer may be waiting on acknowledgements the header cannot carry.
+             */
+            bool HasGap(SequenceNumber highest) const {
+                const uint32_t tracked = highest > SELECTIVE_ACK_WINDOW_BITS ? SELECTIVE_ACK_WINDOW_BITS
+                    : (highest > 0 ? highest - 1 : 0);
+                for (uint32_t word = 0; word * 64 < tracked; ++word) {
+                    const uint32_t bitsInWord = tracked - word * 64 >= 64 ? 64 : tracked - word * 64;
+                    const uint64_t mask = bitsInWord == 64 ? ~0ull : ((1ull << bitsInWord) - 1);
+                    if ((m_words[word] & mask) != mask) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void ToBlock(SequenceNumber highest, SelectiveAckBlock& out_block) const {
+                out_block.highestReceived = highest;
+                for (uint32_t i = 0; i < SELECTIVE_ACK_WINDOW_WORDS; ++i) {
+                    out_block.receivedBits[i] = m_words[i];
+                }
+            }
+
+            void Clear() { m_words.fill(0); }
+
+        private:
+            // Moves every bit 'count' places toward older distances.
+            void ShiftLeft(uint32_t count) {
+                if (count >= SELECTIVE_ACK_WINDOW_BITS) {
+                    m_words.fill(0);
+                    return;
+                }
+                const uint32_t wordShift = count / 64;
+                const uint32_t bitShift = count % 64;
+                for (uint32_t i = SELECTIVE_ACK_WINDOW_WORDS; i-- > 0;) {
+                    uint64_t value = 0;
+                    if (i >= wordShift) {
+                        const uint32_t source = i - wordShift;
+                        value = m_words[source] << bitShift;
+                        if (bitShift != 0 && source > 0) {
+                            value |= m_words[source - 1] >> (64 - bitShift);
+                        }
+                    }
+                    m_words[i] = value;
+                }
+            }
+
+            std::array<uint64_t, SELECTIVE_ACK_WINDOW_WORDS> m_words{};
+        };
+
+        // Calls 'fn' for every sequence a selective ack block reports as received, newest first.
+        template <typename Fn>
+        void ForEachSelectivelyAcked(const SelectiveAckBlock& block, Fn&& fn) {
+            fn(block.highestReceived);
+            for (uint32_t word = 0; word < SELECTIVE_ACK_WINDOW_WORDS; ++word) {
+                uint64_t bits = block.receivedBits[word];
+                while (bits != 0) {
+                    const uint32_t bit = static_cast<uint32_t>(std::countr_zero(bits));
+                    bits &= bits - 1;
+                    fn(static_cast<SequenceNumber>(block.highestReceived - (word * 64 + bit + 1)));
+                }
+            }
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,225 @@
+﻿// File: SessionTable.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Dense array of client sessions indexed by the connection ID carried in
+// GamePacketHeader, with address indexes for packets that do not carry an ID yet and for game
+// code that knows a client by the address it joined from.
+
+#pragma once
+
+#include "GamePacketHeader.h"        // For INVALID_CONNECTION_ID
+#include "NetworkEndpoint.h"         // For NetworkEndpoint
+#include "HandshakeCookie.h"         // For SessionSecret
+#include "ConnectionTable.h"         // Endpoint -> connection ID index
+#include "ReliableConnectionState.h" // Per-session reliability state
+
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdint>  // For uint16_t, uint32_t, uint64_t
+#include <memory>   // For std::shared_ptr
+#include <random>   // For std::random_device (starting generations)
+#include <utility>  // For std::move
+#include <vector>   // For std::vector
+
+// Slot 0 is reserved so that no valid connection ID equals INVALID_CONNECTION_ID.
+const uint32_t MAX_CONNECTION_SESSIONS = 0xFFFF;
+// Most session tables one server can be split into (one per IO shard); a power of two.
+const uint32_t MAX_SESSION_TABLE_SHARDS = 64;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Everything the packet path needs about one client, found by connection ID with one
+        // array index.
+        struct ConnectionSession {
+            uint32_t connectionId = INVALID_CONNECTION_ID;
+            NetworkEndpoint endpoint;     // Current address; follows NAT rebinding.
+            NetworkEndpoint joinEndpoint; // Address the session started from; game code knows the client by it.
+            std::shared_ptr<ReliableConnectionState> state;
+            uint64_t playerId = 0;        // 0 until the game binds a player to the session.
+            uint32_t shardIndex = 0;
+            SessionSecret secret{};       // Proves ownership when the client rebinds; see HandshakeCookie.h.
+            uint8_t capabilities = 0;     // CONNECTION_CAPABILITY_ flags granted by the first handshake...
+            bool capabilitiesNegotiated = false; // ...after which repeats and rebinds reuse them.
+            std::chrono::steady_clock::time_point lastSeen;
+        };
+
+        // Bits of the 16-bit slot field that name the shard when sessions are split across
+        // 'shardCount' tables.
+        inline uint32_t GetSessionShardBits(uint32_t shardCount) {
+            uint32_t bits = 0;
+            while ((1u << bits) < shardCount && (1u << bits) < MAX_SESSION_TABLE_SHARDS) ++bits;
+            return bits;
+        }
+
+        // The shard whose SessionTable issued 'connectionId'.
+        inline uint32_t GetConnectionIdShard(uint32_t connectionId, uint32_t shardBits) {
+            return shardBits == 0 ? 0 : (connectionId & 0xFFFF) >> (16 - shardBits);
+        }
+
+        // SessionTable owns the sessions and the indexes that find them by address.
+        // A connection ID is (generation << 16) | slot: the slot indexes the array directly and
+        // the generation, drawn from std::random_device when the slot is first used and bumped on
+        // every reuse, rejects IDs of sessions that have since been removed.
+        //
+        // A connection ID is a routing handle, not an authenticator: it travels in clear in every
+        // header, so a packet carrying it proves nothing about its sender. The packet path only
+        // accepts an ID from the session's current address, and moving a session to a new address
+        // needs a proof keyed by the session's secret, drawn fresh by Create().
+        //
+        // A server may split its sessions into several tables, one per IO shard. The top
+        // 'shardBits' bits of every slot a table issues then hold its shard index, so the owning
+        // table of any connection ID is known without a lookup (GetConnectionIdShard).
+        //
+        // Two address indexes, for two kinds of caller:
+        //  - FindByEndpoint resolves only the current address. It serves the packet path, so after
+        //    a rebind, packets from the address the client left no longer reach the session.
+        //  - FindByAddress also resolves the join address. Game code knows the client by that
+        //    address, so sends and stats lookups by it still reach a client whose NAT mapping has
+        //    changed.
+        // An address that is any live session's current or join address cannot start another
+        // session or be rebound to one until that session is removed.
+        //
+        // Pointers returned by Find()/FindByEndpoint()/FindByAddress()/Create() stay valid until the next Create()
+        // or Remove(). Not thread-safe; the owner serializes access.
+        class SessionTable {
+        public:
+            explicit SessionTable(uint32_t maxSessions = MAX_CONNECTION_SESSIONS, uint32_t shardIndex = 0, uint32_t shardBits = 0)
+                : m_localSlotMask(SLOT_MASK >> shardBits),
+                m_shardSlotBits(shardBits == 0 ? 0 : (shardIndex << (16 - shardBits)) & SLOT_MASK),
+                m_maxSessions(maxSessions < m_localSlotMask ? maxSessions : m_localSlotMask) {
+                m_sessions.resize(1); // Slot 0: never used.
+                m_generations.resize(1);
+            }
+
+            ConnectionSession* Find(uint32_t connectionId) {
+                if ((connectionId & SLOT_MASK & ~m_localSlotMask) != m_shardSlotBits) return nullptr; // Another shard's ID
+                const uint32_t slot = connectionId & m_localSlotMask;
+                if (slot == 0 || slot >= m_sessions.size()) return nullptr;
+                ConnectionSession& session = m_sessions[slot];
+                return session.connectionId == connectionId ? &session : nullptr;
+            }
+
+            // The session whose current address is 'endpoint'.
+            ConnectionSession* FindByEndpoint(const NetworkEndpoint& endpoint) {
+                const uint32_t* connectionId = m_endpointIndex.Find(endpoint);
+                return connectionId ? Find(*connectionId) : nullptr;
+            }
+
+            // The session whose join or current address is 'endpoint'.
+            ConnectionSession* FindByAddress(const NetworkEndpoint& endpoint) {
+                const uint32_t* connectionId = m_joinEndpointIndex.Find(endpoint);
+                if (!connectionId) connectionId = m_endpointIndex.Find(endpoint);
+                return connectionId ? Find(*connectionId) : nullptr;
+            }
+
+            /**
+             * @brief Creates a session for 'endpoint' with a fresh connection ID.
+             * @return The new session, or nullptr if the table is full or 'endpoint' is already a
+             * session's current or join address.
+             */
+            ConnectionSession* Create(const NetworkEndpoint& endpoint, std::shared_ptr<ReliableConnectionState> state) {
+                if (m_endpointIndex.Find(endpoint) || m_joinEndpointIndex.Find(endpoint)) return nullptr;
+
+                uint32_t slot = 0;
+                if (!m_freeSlots.empty()) {
+                    slot = m_freeSlots.back();
+                    m_freeSlots.pop_back();
+                }
+                else if (m_sessions.size() <= m_maxSessions) {
+                    slot = static_cast<uint32_t>(m_sessions.size());
+                    m_sessions.emplace_back();
+                    m_generations.push_back(static_cast<uint16_t>(m_entropy()));
+                }
+                else {
+                    return nullptr;
+                }
+
+                const uint16_t generation = ++m_generations[slot];
+                ConnectionSession& session = m_sessions[slot];
+                session.connectionId = (static_cast<uint32_t>(generation) << 16) | m_shardSlotBits | slot;
+                session.endpoint = endpoint;
+                session.joinEndpoint = endpoint;
+                session.state = std::move(state);
+                session.playerId = 0;
+                session.shardIndex = 0;
+                session.secret = GenerateSessionSecret();
+                session.lastSeen = std::chrono::steady_clock::now();
+                *m_endpointIndex.FindOrInsert(endpoint).first = session.connectionId;
+                *m_joinEndpointIndex.FindOrInsert(endpoint).first = session.connectionId;
+                ++m_size;
+                return &session;
+            }
+
+            /**
+             * @brief Moves a session to a new current address (NAT rebinding). The caller must
+             * first check the client's proof of the session secret (ValidateSessionRebindProof).
+             * The previous address stops resolving through FindByEndpoint.
+             * @return False if the session is gone or 'newEndpoint' belongs to another session.
+             */
+            bool Rebind(uint32_t connectionId, const NetworkEndpoint& newEndpoint) {
+                ConnectionSession* session = Find(connectionId);
+                if (!session) return false;
+                if (session->endpoint == newEndpoint) return true;
+                const uint32_t* owner = m_endpointIndex.Find(newEndpoint);
+                if (owner && *owner != connectionId) return false;
+                const uint32_t* joinOwner = m_joinEndpointIndex.Find(newEndpoint);
+                if (joinOwner && *joinOwner != connectionId) return false;
+
+                m_endpointIndex.Erase(session->endpoint);
+                session->endpoint = newEndpoint;
+                *m_endpointIndex.FindOrInsert(newEndpoint).first = connectionId;
+                return true;
+            }
+
+            bool Remove(uint32_t connectionId) {
+                ConnectionSession* session = Find(connectionId);
+                if (!session) return false;
+                m_endpointIndex.Erase(session->endpoint);
+                m_joinEndpointIndex.Erase(session->joinEndpoint);
+                const uint32_t slot = connectionId & m_localSlotMask;
+                *session = ConnectionSession(); // Releases the reliability state.
+                m_freeSlots.push_back(static_cast<uint16_t>(slot));
+                --m_size;
+                return true;
+            }
+
+            // Calls fn(ConnectionSession&) for every live session. fn must not create or remove.
+            template <typename Fn>
+            void ForEach(Fn&& fn) {
+                for (size_t slot = 1; slot < m_sessions.size(); ++slot) {
+                    if (m_sessions[slot].connectionId != INVALID_CONNECTION_ID) fn(m_sessions[slot]);
+                }
+            }
+
+            // Drops every session. Generations are kept, so old IDs stay invalid.
+            void Clear() {
+                m_endpointIndex.Clear();
+                m_joinEndpointIndex.Clear();
+                m_freeSlots.clear();
+                for (size_t slot = m_sessions.size() - 1; slot >= 1; --slot) {
+                    m_sessions[slot] = ConnectionSession();
+                    m_freeSlots.push_back(static_cast<uint16_t>(slot));
+                }
+                m_size = 0;
+            }
+
+            size_t Size() const { return m_size; }
+            bool Empty() const { return m_size == 0; }
+
+        private:
+            static constexpr uint32_t SLOT_MASK = 0xFFFF;
+
+            std::vector<ConnectionSession> m_sessions;  // Indexed by slot; slot 0 unused.
+            std::vector<uint16_t> m_generations;        // Last generation issued per slot.
+            std::vector<uint16_t> m_freeSlots;
+            ConnectionTable<uint32_t> m_endpointIndex;      // Current endpoint -> connection ID
+            ConnectionTable<uint32_t> m_joinEndpointIndex;  // Join endpoint -> connection ID
+            uint32_t m_localSlotMask;                   // Slot bits indexing m_sessions
+            uint32_t m_shardSlotBits;                   // Shard index, already shifted into the slot field
+            uint32_t m_maxSessions;
+            std::random_device m_entropy;               // OS CSPRNG; starting generation of each new slot
+            size_t m_size = 0;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
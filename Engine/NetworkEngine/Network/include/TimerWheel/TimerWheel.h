@@ -0,0 +1,178 @@
+﻿// File: TimerWheel.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Hierarchical timer wheel with millisecond resolution. Scheduling is O(1) and
+// advancing the clock costs time proportional to the timers that expire (plus one cheap slot
+// check per elapsed millisecond), independent of how many timers are pending.
+
+#pragma once
+
+#include <algorithm>        // For std::max
+#include <array>            // For std::array
+#include <chrono>           // For std::chrono::steady_clock
+#include <cstdint>          // For uint64_t, uint32_t
+#include <utility>          // For std::move
+#include <vector>           // For std::vector
+
+namespace RiftForged {
+    namespace Networking {
+
+        // TimerWheel stores opaque payloads (T) against deadlines. It does not support cancellation:
+        // owners record the deadline they armed and ignore expirations whose deadline no longer
+        // matches (lazy cancellation), which keeps entries free of back-pointers and handles.
+        //
+        // Layout: LEVELS wheels of SLOTS slots each. Level 0 slots are one tick (1 ms) wide, level N
+        // slots are SLOTS^N ticks wide. A timer is filed in the lowest level whose span covers its
+        // distance from now and moves down a level each time the level below wraps ("cascading"),
+        // so it is touched at most LEVELS times in its life. Deadlines beyond the top level's span
+        // are clamped to it and re-filed when they come around.
+        //
+        // Not thread-safe; the owner serializes access.
+        template <typename T>
+        class TimerWheel {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            static constexpr uint32_t SLOT_BITS = 6;
+            static constexpr uint32_t SLOTS = 1u << SLOT_BITS;   // 64 slots per level
+            static constexpr uint32_t LEVELS = 4;                // 64^4 ms ~= 4.6 hours of direct range
+            static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+
+            explicit TimerWheel(Clock::time_point start = Clock::now())
+                : m_epoch(start) {
+            }
+
+            /**
+             * @brief Files 'payload' to expire at 'deadline' (rounded up to the next millisecond).
+             * Deadlines in the past expire on the next Advance().
+             */
+            void Schedule(Clock::time_point deadline, T payload) {
+                Insert(Entry{ ToTick(deadline), std::move(payload) });
+                ++m_size;
+            }
+
+            /**
+             * @brief Moves the wheel forward to 'now' and appends every expired payload to 'expired'.
+             * @return Number of payloads appended.
+             */
+            size_t Advance(Clock::time_point now, std::vector<T>& expired) {
+                const uint64_t targetTick = ToTickFloor(now);
+                const size_t before = expired.size();
+                if (m_size == 0) {
+                    m_currentTick = std::max(m_currentTick, targetTick);
+                    return 0;
+                }
+
+                // Slot for the current tick may hold timers filed "in the past".
+                CollectSlot(m_currentTick, expired);
+                while (m_currentTick < targetTick && m_size > 0) {
+                    ++m_currentTick;
+                    // Cascade higher levels whose slot boundary we just crossed.
+                    for (uint32_t level = 1; level < LEVELS; ++level) {
+                        if ((m_currentTick & ((uint64_t{ 1 } << (SLOT_BITS * level)) - 1)) != 0) {
+                            break;
+                        }
+                        Cascade(level);
+                    }
+                    CollectSlot(m_currentTick, expired);
+                }
+                if (m_currentTick < targetTick) {
+                    m_currentTick = targetTick; // Wheel drained; jump the rest of the way.
+                }
+                return expired.size() - before;
+            }
+
+            /**
+             * @brief Earliest time at which Advance() may expire or cascade a timer.
+             * Exact for timers within the next SLOTS ticks, conservative (never late) beyond that.
+             * Returns Clock::time_point::max() when the wheel is empty.
+             */
+            Clock::time_point NextWakeTime() const {
+                if (m_size == 0) {
+                    return Clock::time_point::max();
+                }
+                for (uint64_t tick = m_currentTick; tick < m_currentTick + SLOTS; ++tick) {
+                    if (!m_levels[0][tick & SLOT_MASK].empty()) {
+                        return FromTick(tick);
+                    }
+                }
+                // Nothing in level 0: wake when level 0 next wraps and level 1 cascades.
+                return FromTick((m_currentTick | SLOT_MASK) + 1);
+            }
+
+            size_t Size() const { return m_size; }
+            bool Empty() const { return m_size == 0; }
+
+            void Clear() {
+                for (auto& level : m_levels) {
+                    for (auto& slot : level) {
+                        slot.clear();
+                    }
+                }
+                m_size = 0;
+            }
+
+        private:
+            struct Entry {
+                uint64_t deadlineTick;
+                T payload;
+            };
+
+            uint64_t ToTick(Clock::time_point tp) const {
+                if (tp <= m_epoch) return 0;
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(tp - m_epoch).count();
+                return static_cast<uint64_t>((elapsed + 999) / 1000); // Round up: never fire early.
+            }
+
+            uint64_t ToTickFloor(Clock::time_point tp) const {
+                if (tp <= m_epoch) return 0;
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(tp - m_epoch).count());
+            }
+
+            Clock::time_point FromTick(uint64_t tick) const {
+                return m_epoch + std::chrono::milliseconds(tick);
+            }
+
+            void Insert(Entry&& entry) {
+                uint64_t deadline = std::max(entry.deadlineTick, m_currentTick);
+                uint64_t delta = deadline - m_currentTick;
+                uint32_t level = 0;
+                while (level < LEVELS - 1 && delta >= (uint64_t{ 1 } << (SLOT_BITS * (level + 1)))) {
+                    ++level;
+                }
+                if (level == LEVELS - 1) {
+                    // Clamp to the furthest slot the top level can represent; re-filed on cascade.
+                    const uint64_t maxDelta = (uint64_t{ 1 } << (SLOT_BITS * LEVELS)) - 1;
+                    if (delta > maxDelta) deadline = m_currentTick + maxDelta;
+                }
+                const uint64_t slot = (deadline >> (SLOT_BITS * level)) & SLOT_MASK;
+                m_levels[level][slot].push_back(std::move(entry));
+            }
+
+            void Cascade(uint32_t level) {
+                const uint64_t slot = (m_currentTick >> (SLOT_BITS * level)) & SLOT_MASK;
+                std::vector<Entry> moving;
+                moving.swap(m_levels[level][slot]);
+                for (Entry& entry : moving) {
+                    Insert(std::move(entry));
+                }
+            }
+
+            void CollectSlot(uint64_t tick, std::vector<T>& expired) {
+                std::vector<Entry>& slot = m_levels[0][tick & SLOT_MASK];
+                if (slot.empty()) return;
+                for (Entry& entry : slot) {
+                    expired.push_back(std::move(entry.payload));
+                }
+                m_size -= slot.size();
+                slot.clear(); // Keeps capacity for the next lap.
+            }
+
+            Clock::time_point m_epoch;
+            uint64_t m_currentTick = 0;
+            size_t m_size = 0;
+            std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> m_levels;
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -12,6 +12,9 @@
 
 #include "ReliableConnectionState.h" // <<< INCLUDE THE NEW HEADER
 #include "GamePacketHeader.h"        // Still needed for GamePacketHeader struct used in function signatures
+#include "PacketBufferPool.h"        // For PacketBufferRef, PacketBufferPool
+#include "MessageCoalescing.h"       // For coalesced payload framing
+#include "DeliveryChannel.h"         // For DeliveryChannel
 
 namespace RiftForged {
     namespace Networking {
@@ -41,31 +44,140 @@ namespace RiftForged {
             return IsSequenceGreaterThan(s1, s2) || (s1 == s2);
         }
 
-        std::vector<uint8_t> PrepareOutgoingPacket(
+        // A datagram ready to send: the per-connection header and the (possibly shared) payload.
+        // Hand it to INetworkIO::QueueSendGather; the payload is never copied per recipient.
+        struct OutgoingPacket {
+            GamePacketHeader header;
+            PacketBufferRef payload; // Empty for ACK-only packets.
+            bool valid = false;      // False if the packet could not be prepared.
+
+            const uint8_t* HeaderBytes() const { return reinterpret_cast<const uint8_t*>(&header); }
+            uint32_t HeaderSize() const { return static_cast<uint32_t>(GetGamePacketHeaderSize()); }
+            uint32_t TotalSize() const { return HeaderSize() + payload.Size(); }
+        };
+
+        /**
+         * @brief Builds the header for 'payload' and, for reliable packets, records it for retransmission.
+         * The payload is referenced, not copied, so the same buffer may be prepared for many connections.
+         * Data packets go on GetDefaultChannel(packetFlags).
+         */
+        OutgoingPacket PrepareOutgoingPacket(
             ReliableConnectionState& connectionState,
-            const uint8_t* payloadData,
-            uint16_t payloadSize,
+            const PacketBufferRef& payload,
             uint8_t packetFlags
         );
 
+        /**
+         * @brief Stages a message for the next BuildCoalescedPackets call instead of sending it alone.
+         * @param out_needsAssembly Set to true if the connection had nothing staged before, i.e. the
+         * caller must put it on its assembly list.
+         * @return False if MAX_PENDING_OUTBOUND_MESSAGES are already staged.
+         */
+        bool StageOutgoingMessage(
+            ReliableConnectionState& connectionState,
+            const PacketBufferRef& payload,
+            uint8_t payloadType,
+            DeliveryChannel channel,
+            bool* out_needsAssembly
+        );
+
+        /**
+         * @brief Packs the connection's staged messages into as few datagrams as fit
+         * COALESCED_DATAGRAM_MAX_SIZE, each with one header (and one set of ACK fields). Each channel's
+         * messages go in their own datagrams, channels in DeliveryChannel order; reliable messages too
+         * large for one datagram are sent as fragments (see FragmentReassembly.h), FRAGMENT_SEND_WINDOW_SIZE at a time.
+         * Every datagram must first be admitted by the connection's CongestionController (window for
+         * reliable data, pacer for all); whatever it defers stays staged. On connections with
+         * CONNECTION_CAPABILITY_COMPRESSION each non-fragment datagram is compressed by the
+         * connection's PayloadCompressor when that makes it smaller.
+         * @param out_nextSendTime If set, receives when the pacer will next admit deferred data, or
+         * time_point::max() if nothing waits on the pacer (a full window waits for acknowledgements). A message alone in its datagram is sent
+         * unframed, reusing its own (possibly shared) buffer; packed payloads come from 'payloadPool'.
+         * @return True if messages are still staged (deferred, or a send window is full); the caller
+         * must keep the connection on its assembly list.
+         */
+        bool BuildCoalescedPackets(
+            ReliableConnectionState& connectionState,
+            PacketBufferPool& payloadPool,
+            std::chrono::steady_clock::time_point currentTime,
+            std::vector<OutgoingPacket>& out_packets,
+            std::chrono::steady_clock::time_point* out_nextSendTime = nullptr
+        );
+
+        /**
+         * @brief Applies the header's ACK fields and sequence to the connection state.
+         * Compressed payloads are decompressed first into a buffer owned by the calling thread, so
+         * the returned payload is only valid until that thread processes its next packet.
+         * Coalesced payloads (IS_COALESCED) are checked for well-formed framing before any state is
+         * touched and are returned whole; walk them with CoalescedFrameReader. Fragments
+         * (IS_FRAGMENT) are reassembled; only the last one returns a payload, the whole message,
+         * which must be handed back with ReleaseReassembledMessage() once it has been processed.
+         * The header's channel decides delivery: an UnreliableSequenced packet older than the newest
+         * seen on its channel is dropped; a ReliableOrdered packet that arrives ahead of its turn is
+         * acknowledged but held back (copied) until PopOrderedMessage() can return it.
+         * @return True if '*out_payloadToProcess' holds a payload for the application.
+         */
         bool ProcessIncomingPacketHeader(
             ReliableConnectionState& connectionState,
             const GamePacketHeader& receivedHeader,
             const uint8_t* packetPayloadData,
             uint16_t packetPayloadLength,
             const uint8_t** out_payloadToProcess,
-            uint16_t* out_payloadSize
+            uint32_t* out_payloadSize
         );
 
-        std::vector<std::vector<uint8_t>> GetPacketsForRetransmission(
+        // Frees the reassembly space of a message returned by ProcessIncomingPacketHeader for an IS_FRAGMENT packet.
+        void ReleaseReassembledMessage(ReliableConnectionState& connectionState, const uint8_t* message);
+
+        /**
+         * @brief Returns the next held-back payload of a ReliableOrdered channel whose turn has come.
+         * Call until it returns false after every reliable packet received on such a channel, and after
+         * processing whatever ProcessIncomingPacketHeader returned for it.
+         * @param out_payload Receives the payload; its previous storage is recycled.
+         * @param out_coalesced True if the payload is a sequence of framed messages (IS_COALESCED).
+         */
+        bool PopOrderedMessage(
+            ReliableConnectionState& connectionState,
+            DeliveryChannel channel,
+            std::vector<uint8_t>& out_payload,
+            bool& out_coalesced
+        );
+
+        /**
+         * @brief Returns every packet whose RTO expired at currentTime and updates its retry state.
+         * @param out_nextDeadline If set, receives the earliest RTO deadline among the packets still
+         * in flight afterwards, or time_point::max() if none remain.
+         */
+        std::vector<OutgoingPacket> GetPacketsForRetransmission(
+            ReliableConnectionState& connectionState,
+            std::chrono::steady_clock::time_point currentTime,
+            std::chrono::steady_clock::time_point* out_nextDeadline = nullptr
+        );
+
+        /**
+         * @brief Returns the packets that later acknowledgements show were lost: those at least
+         * FAST_RETRANSMIT_PACKET_THRESHOLD sequence numbers older than the newest acknowledged one.
+         * Each packet is fast-retransmitted at most once. Call after ProcessIncomingPacketHeader; it
+         * returns immediately unless that call advanced the newest acknowledgement.
+         */
+        std::vector<OutgoingPacket> GetPacketsForFastRetransmission(
             ReliableConnectionState& connectionState,
             std::chrono::steady_clock::time_point currentTime
         );
 
+        // When TrySendAckOnlyPacket would next send a pending ACK; time_point::max() if none is pending.
+        std::chrono::steady_clock::time_point GetAckFlushDeadline(ReliableConnectionState& connectionState);
+
+        /**
+         * @brief Sends an ACK-only packet if an ACK has waited longer than the ACK delay. On connections
+         * with CONNECTION_CAPABILITY_SELECTIVE_ACKS whose receive window has a gap, the packet carries
+         * a SelectiveAckBlock acquired from 'payloadPool'.
+         */
         bool TrySendAckOnlyPacket(
             ReliableConnectionState& connectionState,
+            PacketBufferPool& payloadPool,
             std::chrono::steady_clock::time_point currentTime,
-            std::function<void(const std::vector<uint8_t>&)> sendPacketFunc
+            std::function<void(const OutgoingPacket&)> sendPacketFunc
         );
 
         // These helpers might be better as static functions within UDPReliabilityProtocol.cpp
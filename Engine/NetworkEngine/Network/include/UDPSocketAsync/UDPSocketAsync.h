@@ -10,8 +10,6 @@
 #include <vector>           // For std::vector
 #include <thread>           // For std::thread
 #include <atomic>           // For std::atomic
-#include <mutex>            // For std::mutex
-#include <deque>            // For std::deque
 #include <memory>           // For std::unique_ptr
 
 // Winsock specific includes
@@ -25,13 +23,18 @@
 
 // Project-specific includes
 #include "INetworkIO.h"           // Definition of the interface we are implementing
+#include "INetworkIOEvents.h"     // For ReceivedDatagram
 #include "NetworkEndpoint.h"      // Defines NetworkEndpoint struct
 #include "OverlappedIOContext.h"  // Defines OverlappedIOContext struct
+#include "IOContextPool.h"        // Lock-free context pools for receives and sends
+#include "PacketBufferPool.h"     // PacketBufferRef for gathered sends
 
 // Constants for the UDP buffer and pending receives.
 // These could be made configurable in a production system.
 const int DEFAULT_UDP_BUFFER_SIZE_IOCP = 4096; // Default buffer size for UDP datagrams
 const int MAX_PENDING_RECEIVES_IOCP = 200;     // Maximum number of concurrent WSARecvFrom operations
+const int MAX_PENDING_SENDS_IOCP = 1024;       // Send contexts available for in-flight WSASendTo operations
+const int IOCP_COMPLETION_BATCH_SIZE = 64;     // Maximum completions dequeued per GetQueuedCompletionStatusEx call
 
 namespace RiftForged {
     namespace Networking {
@@ -86,15 +89,36 @@ namespace RiftForged {
              */
             bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
 
+            /**
+             * @brief Sends header + shared payload as one datagram. Both are copied directly into a
+             * pooled send context (WSASendTo needs the bytes to outlive the call anyway).
+             */
+            bool QueueSendGather(const NetworkEndpoint& recipient, const uint8_t* header, uint32_t headerSize, const PacketBufferRef& payload) override;
+
             /**
              * @brief Checks if the network I/O is currently running.
              * @return True if running, false otherwise.
              */
             bool IsRunning() const override;
 
+            /**
+             * @brief Returns the batching counters. receiveSyscalls counts GetQueuedCompletionStatusEx
+             * wakeups that yielded at least one datagram.
+             */
+            NetworkIOStats GetIOStats() const override;
+
+            // Pool counters, including exhaustion, for diagnostics.
+            IOContextPoolStats GetReceivePoolStats() const { return m_receiveContextPool.GetStats(); }
+            IOContextPoolStats GetSendPoolStats() const { return m_sendContextPool.GetStats(); }
+
         private:
-            // The main loop for IOCP worker threads, processing completed I/O operations.
-            void WorkerThread();
+            // The main loop for IOCP worker threads. Dequeues completions in batches with
+            // GetQueuedCompletionStatusEx and delivers all received datagrams of a wakeup at once.
+            // Worker 'workerIndex' is pinned to the matching CPU of the NetworkIO thread group.
+            void WorkerThread(unsigned int workerIndex);
+
+            // Posts one WSASendTo of 'data' followed by 'tail'. SendData passes no tail.
+            bool SendGatherInternal(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t dataSize, const uint8_t* tail, uint32_t tailSize);
 
             /**
              * @brief Posts an asynchronous receive operation (WSARecvFrom) to the IOCP.
@@ -105,7 +129,7 @@ namespace RiftForged {
             bool PostReceiveInternal(OverlappedIOContext* pRecvContext);
 
             /**
-             * @brief Retrieves a free OverlappedIOContext from the internal pool for a new receive operation.
+             * @brief Retrieves a free OverlappedIOContext from the lock-free pool for a new receive operation.
              * @return A pointer to a free context, or nullptr if the pool is exhausted.
              */
             OverlappedIOContext* GetFreeReceiveContextInternal();
@@ -127,10 +151,16 @@ namespace RiftForged {
             std::vector<std::thread> m_workerThreads; // Collection of threads processing IOCP completions.
             std::atomic<bool> m_isRunning;            // Atomic flag to control the lifetime of worker threads.
 
-            // Receive context pooling for efficient reuse of OVERLAPPED structures and buffers.
-            std::vector<std::unique_ptr<OverlappedIOContext>> m_receiveContextPool; // Owns the memory for all contexts.
-            std::deque<OverlappedIOContext*> m_freeReceiveContexts;                 // Queue of currently available contexts.
-            std::mutex m_receiveContextMutex;                                       // Protects access to m_freeReceiveContexts.
+            // Preallocated, lock-free context pools. Buffers live in one cache-aligned slab per pool,
+            // so neither the receive nor the send path takes a lock or touches the heap per datagram.
+            IOContextPool m_receiveContextPool;
+            IOContextPool m_sendContextPool;
+
+            // Batching counters reported through GetIOStats().
+            std::atomic<uint64_t> m_receiveWakeups{ 0 };
+            std::atomic<uint64_t> m_datagramsReceived{ 0 };
+            std::atomic<uint64_t> m_sendSyscalls{ 0 };
+            std::atomic<uint64_t> m_datagramsSent{ 0 };
         };
 
     } // namespace Networking
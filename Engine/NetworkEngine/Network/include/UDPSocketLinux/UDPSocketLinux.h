@@ -0,0 +1,254 @@
+﻿// File: UDPSocketLinux.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Header file for the UDPSocketLinux class, the Linux counterpart of UDPSocketAsync.
+// It implements INetworkIO on top of io_uring, falling back to epoll when io_uring is unavailable.
+
+#pragma once
+
+#include <string>           // For std::string
+#include <vector>           // For std::vector
+#include <thread>           // For std::thread
+#include <atomic>           // For std::atomic
+#include <memory>           // For std::unique_ptr
+#include <mutex>            // For std::mutex (send queue)
+#include <cstdint>          // For uint64_t
+#include <sys/socket.h>     // For mmsghdr
+#include <netinet/in.h>     // For sockaddr_in
+
+// io_uring support is compiled in only when liburing is available. The epoll path is always built
+// and is used at runtime if the kernel (or a seccomp profile) refuses to create a ring.
+#if defined(__has_include)
+#if __has_include(<liburing.h>)
+#include <liburing.h>
+#define RF_NETWORK_HAS_LIBURING 1
+#endif
+#endif
+
+// Project-specific includes
+#include "INetworkIO.h"           // Definition of the interface we are implementing
+#include "INetworkIOEvents.h"     // For ReceivedDatagram
+#include "NetworkEndpoint.h"      // Defines NetworkEndpoint struct
+#include "OverlappedIOContext.h"  // Defines OverlappedIOContext struct (msghdr flavour on Linux)
+#include "IOContextPool.h"        // Preallocated receive contexts and buffer slab
+#include "PacketBufferPool.h"     // PacketBufferRef for scatter-gather sends
+
+// Constants for the UDP buffer and pending receives, mirroring the IOCP values.
+const int DEFAULT_UDP_BUFFER_SIZE_LINUX = 4096; // Default buffer size for UDP datagrams
+const int MAX_PENDING_RECEIVES_LINUX = 200;     // Receive contexts kept in flight across all worker threads
+const int LINUX_RECV_BATCH_SIZE = 32;           // Max datagrams pulled by one recvmmsg call
+const int LINUX_SEND_BATCH_SIZE = 64;           // Max datagrams pushed by one sendmmsg call
+const int LINUX_SEND_QUEUE_AUTO_FLUSH = 256;    // Queued datagrams that force a flush from QueueSendData
+const int LINUX_SEND_QUEUE_MAX_BACKLOG = 16384; // Queued datagrams beyond which QueueSendData refuses more
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Which kernel interface the worker threads are driving.
+        enum class LinuxIOBackend {
+            IoUring,
+            Epoll
+        };
+
+        // UDPSocketLinux implements INetworkIO for Linux hosts.
+        //
+        // io_uring mode: every worker thread owns a private ring and keeps its share of the
+        // MAX_PENDING_RECEIVES_LINUX recvmsg operations queued on it, re-arming each context
+        // as soon as its completion has been handed to the event handler (same model as the
+        // WSARecvFrom pool in UDPSocketAsync).
+        // epoll mode: every worker thread owns an epoll instance registered with EPOLLEXCLUSIVE,
+        // so one readiness event wakes one thread, which then drains the socket until EAGAIN.
+        //
+        // Both modes hand everything one wakeup produced to OnRawDataBatchReceived as a single
+        // span (recvmmsg in epoll mode, all ready CQEs in io_uring mode).
+        //
+        // Sends are issued directly from the calling thread with a non-blocking sendmsg. A UDP
+        // send never waits on the peer, so queuing it to a completion thread would only add a
+        // hop; OnSendCompleted is therefore invoked synchronously before SendData returns.
+        // QueueSendData copies into a shared queue that FlushSendQueue pushes out with sendmmsg.
+        // QueueSendGather copies only the header and keeps a reference to the shared payload, which
+        // goes out as a second iovec of the same message.
+        //
+        // SO_REUSEPORT sharding (reusePortShards > 0): instead of one socket shared by all workers,
+        // N sockets are bound to the same port and each gets exactly one worker thread pinned to its
+        // own core of the NetworkIO thread group (see ThreadPlacement). The kernel hashes every flow
+        // onto one socket, so a client endpoint is always received by the same thread
+        // (ReceivedDatagram::ioShard) and each socket has its own queue.
+        class UDPSocketLinux : public INetworkIO {
+        public:
+            // Default constructor. Initialization of specific IP/port and event handler
+            // happens via the Init method of the INetworkIO interface.
+            // @param preferredBackend IoUring tries a ring first and falls back to Epoll on failure.
+            // @param reusePortShards 0 = one shared socket; N = N SO_REUSEPORT sockets with one pinned thread each.
+            explicit UDPSocketLinux(LinuxIOBackend preferredBackend = LinuxIOBackend::IoUring, unsigned int reusePortShards = 0);
+
+            // Destructor. Ensures proper cleanup of socket resources and worker threads.
+            ~UDPSocketLinux() override;
+
+            UDPSocketLinux(const UDPSocketLinux&) = delete;
+            UDPSocketLinux& operator=(const UDPSocketLinux&) = delete;
+
+            // --- INetworkIO Interface Implementation ---
+
+            /**
+             * @brief Creates and binds the non-blocking UDP socket.
+             * @param listenIp The IP address to bind the socket to (e.g., "0.0.0.0" for all interfaces).
+             * @param listenPort The port number to listen on.
+             * @param eventHandler A pointer to the object that will receive network I/O events (e.g., UDPPacketHandler).
+             * @return True if initialization is successful, false otherwise.
+             */
+            bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+
+            /**
+             * @brief Sets up the per-thread rings (or epoll instances), posts the initial receives
+             * and launches the worker threads.
+             * @return True if operations are successfully started, false otherwise.
+             */
+            bool Start() override;
+
+            /**
+             * @brief Signals worker threads to exit, joins them, and closes the socket.
+             */
+            void Stop() override;
+
+            /**
+             * @brief Sends raw data to a specified recipient with a non-blocking sendmsg.
+             * @return True if the kernel accepted the datagram, false otherwise.
+             * OnSendCompleted is reported before this call returns.
+             */
+            bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+
+            bool IsRunning() const override;
+
+            /**
+             * @brief Copies the datagram into the send queue. Flushes inline once
+             * LINUX_SEND_QUEUE_AUTO_FLUSH datagrams are pending.
+             */
+            bool QueueSendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+
+            /**
+             * @brief Copies the header into the send queue and holds a reference to the payload until
+             * the datagram has been flushed. Same auto-flush rule as QueueSendData.
+             */
+            bool QueueSendGather(const NetworkEndpoint& recipient, const uint8_t* header, uint32_t headerSize, const PacketBufferRef& payload) override;
+
+            /**
+             * @brief Sends every queued datagram with sendmmsg, LINUX_SEND_BATCH_SIZE per call.
+             * OnSendCompleted is reported for each datagram sent before this returns. If the socket
+             * send buffer fills up, the rest stay queued, in order, for the next flush.
+             */
+            void FlushSendQueue() override;
+
+            NetworkIOStats GetIOStats() const override;
+
+            uint32_t GetIOShardCount() const override;
+
+            // The backend actually in use after Start(); may differ from the preferred one.
+            LinuxIOBackend GetActiveBackend() const { return m_activeBackend; }
+
+        private:
+            // Per-thread state. Nothing in here is shared between worker threads.
+            struct WorkerState {
+                std::thread thread;
+                int socketFd = -1;                                 // Socket this worker receives on.
+                uint32_t shardIndex = 0;                           // Index into m_sockets; reported as ReceivedDatagram::ioShard.
+                uint32_t workerIndex = 0;                          // Selects this worker's CPU in the NetworkIO thread group.
+                std::vector<OverlappedIOContext*> receiveContexts; // This worker's slice of m_receiveContextPool.
+                std::vector<mmsghdr> recvBatchHeaders;             // recvmmsg vector, one entry per batched context.
+                std::vector<ReceivedDatagram> deliveryBatch;       // Datagrams gathered for one OnRawDataBatchReceived call.
+                std::vector<OverlappedIOContext*> rearmList;       // io_uring contexts to re-post once the batch is delivered.
+                int epollFd = -1;
+#ifdef RF_NETWORK_HAS_LIBURING
+                io_uring ring{};
+                bool ringInitialized = false;
+#endif
+            };
+
+            void IoUringWorkerThread(WorkerState* worker);
+            void EpollWorkerThread(WorkerState* worker);
+
+            // Creates a non-blocking UDP socket bound to 'address'; SO_REUSEPORT is set first when requested.
+            // Returns -1 on failure (already logged and reported).
+            int CreateBoundSocket(const sockaddr_in& address, bool reusePort);
+            void CloseSockets();
+
+            bool SetupWorkerIoUring(WorkerState& worker);
+            bool SetupWorkerEpoll(WorkerState& worker);
+            void TeardownWorker(WorkerState& worker);
+
+#ifdef RF_NETWORK_HAS_LIBURING
+            // Queues a recvmsg SQE for the context on the worker's ring. Does not submit.
+            bool PostReceiveInternal(WorkerState& worker, OverlappedIOContext* pRecvContext);
+#endif
+
+            // Converts the native sender address and appends the datagram to the worker's delivery batch.
+            // Returns false (and appends nothing) for truncated or unparseable datagrams.
+            bool AppendReceivedDatagram(WorkerState& worker, OverlappedIOContext* pContext, uint32_t bytesReceived);
+
+            // Hands the worker's delivery batch to m_eventHandler and clears it.
+            void DeliverBatch(WorkerState& worker);
+
+            // A datagram waiting in the send queue; 'offset' indexes into the matching byte buffer.
+            // A gathered send appends 'payload' after those bytes.
+            struct PendingSend {
+                sockaddr_in address;
+                uint32_t offset;
+                uint32_t size;
+                PacketBufferRef payload;
+            };
+
+            // Shared by QueueSendData (no payload) and QueueSendGather.
+            bool QueueSendInternal(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size, const PacketBufferRef& payload);
+
+            // Sends m_flushingSends from m_flushResumeIndex on. Returns false if the socket buffer
+            // filled up first; the unsent part is kept and m_flushResumeIndex points at it.
+            bool SendFlushingSends();
+
+            // Counts a failed send and logs it at most once per LINUX_SEND_ERROR_LOG_INTERVAL_MS.
+            void ReportSendError(int errorCode, const sockaddr_in& address);
+
+            // --- Member Variables ---
+            std::string m_listenIp;           // The IP address the socket is bound to.
+            uint16_t m_listenPort;            // The port number the socket is listening on.
+            INetworkIOEvents* m_eventHandler; // Pointer to the handler that receives events.
+
+            int m_socket;                     // The UDP socket used for sends (== m_sockets[0]).
+            int m_wakeEventFd;                // eventfd used to wake epoll workers on Stop().
+            std::vector<int> m_sockets;       // All bound sockets; one per shard in SO_REUSEPORT mode.
+            unsigned int m_reusePortShards;   // 0 = single shared socket.
+
+            LinuxIOBackend m_preferredBackend;
+            LinuxIOBackend m_activeBackend;
+
+            std::vector<std::unique_ptr<WorkerState>> m_workers;
+            std::atomic<bool> m_isRunning;    // Controls the lifetime of worker threads.
+
+            // Owns the memory for all receive contexts. Start() drains it and assigns each context
+            // permanently to one worker, so the receive path never goes back to the free list.
+            IOContextPool m_receiveContextPool;
+
+            // Send queue filled by QueueSendData. FlushSendQueue swaps it into the flushing
+            // buffers so producers are never blocked behind the syscalls.
+            std::mutex m_sendQueueMutex;
+            std::vector<PendingSend> m_pendingSends;
+            std::vector<uint8_t> m_pendingSendBytes;
+            std::mutex m_flushMutex;                  // Serializes flushers; protects everything below.
+            std::vector<PendingSend> m_flushingSends;
+            std::vector<uint8_t> m_flushingSendBytes;
+            size_t m_flushResumeIndex = 0;            // First unsent entry of m_flushingSends after a stall.
+            std::vector<mmsghdr> m_sendBatchHeaders;
+            std::vector<iovec> m_sendBatchIovecs;     // Two per message: queued bytes, shared payload.
+
+            // Batching counters reported through GetIOStats().
+            std::atomic<uint64_t> m_receiveSyscalls{ 0 };
+            std::atomic<uint64_t> m_datagramsReceived{ 0 };
+            std::atomic<uint64_t> m_sendSyscalls{ 0 };
+            std::atomic<uint64_t> m_datagramsSent{ 0 };
+            std::atomic<uint64_t> m_sendBackpressureStalls{ 0 };
+            std::atomic<uint64_t> m_sendQueueOverflows{ 0 };
+            std::atomic<uint64_t> m_sendErrors{ 0 };
+            std::atomic<int64_t> m_nextSendErrorLogNanos{ 0 }; // steady_clock time before which send errors are only counted
+        };
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,47 @@
+﻿// File: VerifiedC2SMessage.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: A client message whose FlatBuffer has been verified, handed from UDPPacketHandler
+// through the message handler and dispatcher so the buffer is verified exactly once.
+
+#pragma once
+
+#include "NetworkEndpoint.h" // For NetworkEndpoint
+
+// Include FlatBuffers generated header for Root_C2S_UDP_Message and C2S_UDP_Payload
+#include "../FlatBuffers/Versioning/V0.0.5/riftforged_c2s_udp_messages_generated.h"
+
+#include <cstdint>  // For uint8_t, uint32_t, uint64_t
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Only VerifyC2SMessage() produces one, so holding a VerifiedC2SMessage means 'root' and
+        // everything reachable from it may be read without further checks. It points into the
+        // received datagram and is valid only for the duration of the dispatch call it is passed to.
+        struct VerifiedC2SMessage {
+            const UDP::C2S::Root_C2S_UDP_Message* root = nullptr;
+            UDP::C2S::C2S_UDP_Payload payloadType = UDP::C2S::C2S_UDP_Payload_NONE; // Never NONE once verified
+            const uint8_t* data = nullptr; // The verified buffer
+            uint32_t size = 0;
+
+            // The session it arrived on.
+            NetworkEndpoint sender;       // Join endpoint: the address game code knows the client by
+            uint32_t connectionId = 0;
+            uint64_t playerId = 0;        // 0 until a player is bound to the session
+            uint32_t shardIndex = 0;
+
+            // Typed access to the payload; null if the message is of another type.
+            template<typename T>
+            const T* PayloadAs() const { return root->payload_as<T>(); }
+        };
+
+        /**
+         * @brief Runs the FlatBuffer verifier over 'data' and fills the message part of 'out_message';
+         * the caller fills in the session part.
+         * @return False if the buffer is not a valid Root_C2S_UDP_Message or carries no payload.
+         */
+        bool VerifyC2SMessage(const uint8_t* data, uint32_t size, VerifiedC2SMessage& out_message);
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,116 @@
+﻿// File: CongestionController.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the per-connection AIMD congestion window and token-bucket pacer.
+
+#include "CongestionController.h"
+
+#include <algorithm> // For std::min, std::max
+
+namespace RiftForged {
+    namespace Networking {
+
+        void CongestionController::Reset() {
+            m_congestionWindow = CONGESTION_INITIAL_WINDOW_BYTES;
+            m_slowStartThreshold = CONGESTION_MAX_WINDOW_BYTES;
+            m_bytesInFlight = 0;
+            m_bytesAckedInAvoidance = 0;
+            m_recoveryEndSequence = 0;
+            m_inRecovery = false;
+            m_pacingTokens = static_cast<float>(CONGESTION_PACING_BURST_BYTES);
+            m_lastRefill = Clock::time_point::min();
+            m_lossEvents = 0;
+            m_timeoutEvents = 0;
+            m_sendsDeferred = 0;
+        }
+
+        float CongestionController::PacingRate(float smoothedRTT_ms) const {
+            const float rttSeconds = std::max(smoothedRTT_ms, 1.0f) / 1000.0f;
+            return CONGESTION_PACING_GAIN * static_cast<float>(m_congestionWindow) / rttSeconds;
+        }
+
+        void CongestionController::RefillTokens(Clock::time_point now, float smoothedRTT_ms) {
+            if (m_lastRefill == Clock::time_point::min() || now <= m_lastRefill) {
+                if (m_lastRefill == Clock::time_point::min()) m_lastRefill = now;
+                return;
+            }
+            const float elapsedSeconds = std::chrono::duration<float>(now - m_lastRefill).count();
+            m_pacingTokens = std::min(static_cast<float>(CONGESTION_PACING_BURST_BYTES),
+                m_pacingTokens + PacingRate(smoothedRTT_ms) * elapsedSeconds);
+            m_lastRefill = now;
+        }
+
+        bool CongestionController::CanSend(uint32_t bytes, bool countsAgainstWindow, Clock::time_point now, float smoothedRTT_ms,
+            Clock::time_point* out_retryTime) {
+            if (countsAgainstWindow && m_bytesInFlight > 0 && m_bytesInFlight + bytes > m_congestionWindow) {
+                if (out_retryTime) *out_retryTime = Clock::time_point::max();
+                return false;
+            }
+            RefillTokens(now, smoothedRTT_ms);
+            // Any positive balance admits one datagram; the debt it leaves delays the next one.
+            if (m_pacingTokens > 0.0f) {
+                return true;
+            }
+            if (out_retryTime) {
+                const float secondsUntilPositive = (1.0f - m_pacingTokens) / PacingRate(smoothedRTT_ms);
+                *out_retryTime = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(secondsUntilPositive));
+            }
+            return false;
+        }
+
+        void CongestionController::OnPacketSent(uint32_t bytes, bool inFlight, Clock::time_point now, float smoothedRTT_ms) {
+            RefillTokens(now, smoothedRTT_ms);
+            m_pacingTokens -= static_cast<float>(bytes);
+            if (inFlight) {
+                m_bytesInFlight += bytes;
+            }
+        }
+
+        void CongestionController::OnPacketAcked(uint32_t bytes) {
+            m_bytesInFlight -= std::min(bytes, m_bytesInFlight);
+            if (m_congestionWindow < m_slowStartThreshold) {
+                m_congestionWindow = std::min(m_congestionWindow + bytes, CONGESTION_MAX_WINDOW_BYTES);
+                return;
+            }
+            // Congestion avoidance: one datagram of growth per window's worth of acknowledged bytes.
+            m_bytesAckedInAvoidance += bytes;
+            if (m_bytesAckedInAvoidance >= m_congestionWindow) {
+                m_bytesAckedInAvoidance -= m_congestionWindow;
+                m_congestionWindow = std::min(m_congestionWindow + CONGESTION_MAX_DATAGRAM_SIZE, CONGESTION_MAX_WINDOW_BYTES);
+            }
+        }
+
+        void CongestionController::OnPacketLost(uint32_t lostSequence, uint32_t nextSequence, bool timeout) {
+            // Packets sent before the last reduction were part of the same congestion event.
+            if (m_inRecovery && static_cast<int32_t>(lostSequence - m_recoveryEndSequence) < 0) {
+                return;
+            }
+            m_slowStartThreshold = std::max(m_congestionWindow / 2, CONGESTION_MIN_WINDOW_BYTES);
+            m_congestionWindow = timeout ? CONGESTION_MIN_WINDOW_BYTES : m_slowStartThreshold;
+            m_bytesAckedInAvoidance = 0;
+            m_recoveryEndSequence = nextSequence;
+            m_inRecovery = true;
+            ++m_lossEvents;
+            if (timeout) {
+                ++m_timeoutEvents;
+            }
+        }
+
+        void CongestionController::OnPacketAbandoned(uint32_t bytes) {
+            m_bytesInFlight -= std::min(bytes, m_bytesInFlight);
+        }
+
+        CongestionStats CongestionController::GetStats(float smoothedRTT_ms) const {
+            CongestionStats stats;
+            stats.congestionWindowBytes = m_congestionWindow;
+            stats.slowStartThresholdBytes = m_slowStartThreshold;
+            stats.bytesInFlight = m_bytesInFlight;
+            stats.pacingRateBytesPerSecond = PacingRate(smoothedRTT_ms);
+            stats.lossEvents = m_lossEvents;
+            stats.timeoutEvents = m_timeoutEvents;
+            stats.sendsDeferred = m_sendsDeferred;
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,1193 @@
+﻿// File: ConnectionManager.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements ConnectionManager: the cookie handshake, sessions, reliability,
+// outbound assembly and the reliability timer thread of the UDP transport.
+
+#include "ConnectionManager.h"
+#include "INetworkIO.h"           // For calling m_networkIO->SendData()
+#include "OverlappedIOContext.h"  // For the type passed in OnRawDataReceived, OnSendCompleted
+#include "UDPReliabilityProtocol.h" // For the free functions and ReliableConnectionState, GamePacketFlag, GamePacketHeader
+#include "PacketCapture.h"        // For recording inbound traffic
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+
+#include <utility>     // For std::move
+#include <algorithm>   // For std::clamp, std::max, std::min
+#include <cstring>     // For memcpy
+#include <stdexcept>   // For std::invalid_argument
+#include <fmt/core.h>  // For FMT_STRING
+
+
+namespace RiftForged {
+    namespace Networking {
+
+        // --- Constructor & Destructor ---
+
+        ConnectionManager::ConnectionManager(INetworkIO* networkIO)
+            : m_networkIO(networkIO),
+            m_isRunning(false) {
+            if (!m_networkIO) {
+                // Note: Logger might not be initialized if this throws super early,
+                // but critical errors should attempt to log.
+                RF_NETWORK_CRITICAL(FMT_STRING("ConnectionManager: INetworkIO dependency is null!"));
+                throw std::invalid_argument("INetworkIO cannot be null in ConnectionManager constructor");
+            }
+            for (uint32_t i = 0; i < INBOUND_RATE_CLASS_COUNT; ++i) {
+                m_inboundRateLimits[i] = GetDefaultInboundRateLimit(static_cast<InboundRateClass>(i));
+            }
+            m_sessionShards.push_back(std::make_unique<SessionShard>(0, 0)); // Until Start() learns the IO shard count.
+        }
+
+        ConnectionManager::~ConnectionManager() {
+            Stop();
+        }
+
+        // --- Public Control Methods ---
+
+        bool ConnectionManager::Start() {
+            if (m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: Already running."));
+                return true;
+            }
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Starting..."));
+            ResizeSessionShards();
+            m_isRunning.store(true, std::memory_order_release);
+
+            try {
+                m_reliabilityThread = std::thread(&ConnectionManager::ReliabilityManagementThread, this);
+                RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Reliability management thread created and started."));
+            }
+            catch (const std::system_error& e) {
+                RF_NETWORK_CRITICAL(FMT_STRING("ConnectionManager: Failed to create reliability management thread: {}"), e.what());
+                m_isRunning.store(false, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        void ConnectionManager::Stop() {
+            bool alreadyStoppingOrStopped = !m_isRunning.exchange(false, std::memory_order_acq_rel);
+            if (alreadyStoppingOrStopped) {
+                RF_NETWORK_DEBUG(FMT_STRING("ConnectionManager: Stop called but already not running or stop initiated."));
+                // If thread was created but start failed, or if stop was called multiple times,
+                // we still might want to try joining if joinable.
+                if (m_reliabilityThread.joinable() && m_reliabilityThread.get_id() != std::this_thread::get_id()) {
+                    RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Attempting to join reliability thread on redundant stop call..."));
+                    m_reliabilityThread.join();
+                    RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Reliability thread joined on redundant stop call."));
+                }
+                return;
+            }
+
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Stopping reliability management thread..."));
+            {
+                // Taking the lock orders this notify after the thread's predicate check.
+                std::lock_guard<std::mutex> timerLock(m_timerMutex);
+                m_timerCondition.notify_all();
+            }
+            if (m_reliabilityThread.joinable()) {
+                // Ensure the thread is not trying to join itself if Stop() is called from the thread
+                if (m_reliabilityThread.get_id() == std::this_thread::get_id()) {
+                    RF_NETWORK_CRITICAL(FMT_STRING("ConnectionManager::Stop() called from reliability thread itself! Cannot join."));
+                }
+                else {
+                    m_reliabilityThread.join();
+                    RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Reliability management thread joined."));
+                }
+            }
+            else {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: Reliability thread was not joinable upon stop."));
+            }
+
+
+            StopTelemetryDump();
+
+            // Clean up reliability states upon stop
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                shard->sessions.Clear();
+            }
+            {
+                std::lock_guard<std::mutex> timerLock(m_timerMutex);
+                m_timerWheel.Clear();
+            }
+            {
+                std::lock_guard<std::mutex> assemblyLock(m_outboundAssemblyMutex);
+                m_outboundAssemblyList.clear();
+            }
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Reliability states and last seen times cleared."));
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Stopped."));
+        }
+
+        // --- INetworkIOEvents Implementation ---
+
+        void ConnectionManager::OnRawDataReceived(const NetworkEndpoint& sender,
+            const uint8_t* data,
+            uint32_t size,
+            OverlappedIOContext* context) {
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: OnRawDataReceived from {} ({} bytes)"), sender.ToString(), size);
+            if (PacketCaptureWriter* capture = m_captureWriter.load(std::memory_order_acquire)) {
+                capture->Record(sender, data, size);
+            }
+            ProcessIncomingDatagram(sender, data, size, context, 0);
+            AssembleOutgoing();
+            m_networkIO->FlushSendQueue();
+        }
+
+        void ConnectionManager::OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) {
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: OnRawDataBatchReceived with {} datagrams"), datagrams.size());
+            if (PacketCaptureWriter* capture = m_captureWriter.load(std::memory_order_acquire)) {
+                capture->RecordBatch(datagrams);
+            }
+            for (const ReceivedDatagram& datagram : datagrams) {
+                ProcessIncomingDatagram(datagram.sender, datagram.data, datagram.size, datagram.context, datagram.ioShard);
+            }
+            // Every ACK/response produced by the batch goes out in one flush.
+            AssembleOutgoing();
+            m_networkIO->FlushSendQueue();
+        }
+
+        void ConnectionManager::ProcessIncomingDatagram(const NetworkEndpoint& sender,
+            const uint8_t* data,
+            uint32_t size,
+            OverlappedIOContext* context,
+            uint32_t ioShard) {
+            if (!m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: Received data but handler is not running. Ignoring from {}."), sender.ToString());
+                return;
+            }
+
+            // Pre-filter: until a datagram is matched to a session it costs a header copy and one
+            // lookup, allocates nothing and is counted rather than logged, so junk floods stay cheap.
+            if (size < GetGamePacketHeaderSize()) {
+                m_malformedDrops.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            GamePacketHeader receivedHeader;
+            memcpy(&receivedHeader, data, GetGamePacketHeaderSize());
+
+            if (receivedHeader.protocolId != CURRENT_PROTOCOL_ID_VERSION) {
+                m_malformedDrops.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (IsHandshakePacket(receivedHeader.flags)) {
+                HandleHandshakePacket(sender, ioShard, receivedHeader, data + GetGamePacketHeaderSize(), size - static_cast<uint32_t>(GetGamePacketHeaderSize()));
+                return;
+            }
+
+            ConnectionSession session;
+            if (!ResolveIncomingSession(sender, receivedHeader.connectionId, ioShard, session)) {
+                m_unknownSourceDrops.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            const std::shared_ptr<ReliableConnectionState>& connState = session.state;
+
+            // A client over its datagram rate costs nothing beyond this point: no ACK processing, no
+            // decompression, no verification. Reliable data dropped here is unacknowledged and resent.
+            if (!connState->inboundRateLimiter.Admit(InboundRateClass::Datagram, std::chrono::steady_clock::now())) {
+                m_rateLimitedDrops[static_cast<size_t>(InboundRateClass::Datagram)].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Raw Header from {} - Proto: 0x{:X}, Conn: 0x{:08X}, Seq: {}, Ack: {}, AckBits: 0x{:08X}, Flags: 0x{:X}"),
+                sender.ToString(), receivedHeader.protocolId, receivedHeader.connectionId,
+                receivedHeader.sequenceNumber,
+                receivedHeader.ackNumber, receivedHeader.ackBitfield, receivedHeader.flags);
+
+            const uint8_t* payloadAfterGameHeader = data + GetGamePacketHeaderSize();
+            uint16_t payloadAfterGameHeaderSize = static_cast<uint16_t>(size - GetGamePacketHeaderSize());
+
+            const uint8_t* appPayloadToProcess = nullptr;
+            uint32_t appPayloadSize = 0;
+
+            bool shouldRelayToGameLogic = RiftForged::Networking::ProcessIncomingPacketHeader(
+                *connState,
+                receivedHeader,
+                payloadAfterGameHeader,
+                payloadAfterGameHeaderSize,
+                &appPayloadToProcess,
+                &appPayloadSize
+            );
+
+            // New reliable data leaves an ACK pending; make sure it goes out if nothing piggybacks it.
+            auto ackDeadline = RiftForged::Networking::GetAckFlushDeadline(*connState);
+            if (ackDeadline != std::chrono::steady_clock::time_point::max()) {
+                ArmReliabilityTimer(connState, ReliabilityTimerKind::AckFlush, ackDeadline);
+            }
+
+            // ACKs for later packets reveal losses an RTO would only catch much later; resend now.
+            for (const OutgoingPacket& packet : RiftForged::Networking::GetPacketsForFastRetransmission(*connState, std::chrono::steady_clock::now())) {
+                m_networkIO->QueueSendGather(sender, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+            }
+
+            if (shouldRelayToGameLogic) {
+                if (appPayloadToProcess && appPayloadSize > 0) {
+                    RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Relaying app payload from {}. Size: {} bytes."),
+                        sender.ToString(), appPayloadSize);
+
+                    DispatchRelayedPayload(sender, session, appPayloadToProcess, appPayloadSize,
+                        HasFlag(receivedHeader.flags, GamePacketFlag::IS_COALESCED),
+                        HasFlag(receivedHeader.flags, GamePacketFlag::IS_RELIABLE));
+                    if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_FRAGMENT)) {
+                        // The reassembled message lived in the connection's arena until now.
+                        RiftForged::Networking::ReleaseReassembledMessage(*connState, appPayloadToProcess);
+                    }
+                }
+                else {
+                    RF_NETWORK_WARN(FMT_STRING("ConnectionManager: ProcessIncomingPacketHeader indicated relay, but no app payload provided from {}. Header Flags: 0x{:X}"),
+                        sender.ToString(), receivedHeader.flags);
+                }
+            }
+            else {
+                RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Packet from {} not relayed by reliability protocol (e.g., duplicate, pure ACK). Header Flags: 0x{:X}"),
+                    sender.ToString(), receivedHeader.flags);
+            }
+
+            // On an ordered channel this packet may have filled a gap; deliver what was waiting on it.
+            if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_RELIABLE) && IsChannelDataPacket(receivedHeader.flags) &&
+                receivedHeader.channelId < DELIVERY_CHANNEL_COUNT &&
+                GetChannelMode(static_cast<DeliveryChannel>(receivedHeader.channelId)) == ChannelMode::ReliableOrdered) {
+                std::vector<uint8_t> heldBackPayload;
+                bool heldBackCoalesced = false;
+                while (RiftForged::Networking::PopOrderedMessage(*connState, static_cast<DeliveryChannel>(receivedHeader.channelId),
+                    heldBackPayload, heldBackCoalesced)) {
+                    RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Relaying held-back payload ({} bytes) from {} on ordered channel {}."),
+                        heldBackPayload.size(), sender.ToString(), receivedHeader.channelId);
+                    DispatchRelayedPayload(sender, session, heldBackPayload.data(), static_cast<uint32_t>(heldBackPayload.size()), heldBackCoalesced, true);
+                }
+            }
+        }
+
+        void ConnectionManager::DispatchRelayedPayload(const NetworkEndpoint& sender,
+            ConnectionSession& session,
+            const uint8_t* payload,
+            uint32_t payloadSize,
+            bool coalesced,
+            bool reliable) {
+            if (!coalesced) {
+                DispatchApplicationPayload(sender, session, payload, payloadSize, reliable);
+                return;
+            }
+            // Framing was validated by ProcessIncomingPacketHeader; each frame is one message.
+            CoalescedFrameReader reader(payload, payloadSize);
+            uint8_t framePayloadType = 0;
+            const uint8_t* frameData = nullptr;
+            uint32_t frameSize = 0;
+            while (reader.Next(framePayloadType, frameData, frameSize)) {
+                DispatchApplicationPayload(sender, session, frameData, frameSize, reliable);
+            }
+        }
+
+        bool ConnectionManager::AdmitInboundMessage(ConnectionSession& session, InboundRateClass rateClass, bool reliable) {
+            // A reliable message was acknowledged before it got here; dropping it now would lose it for
+            // good. The datagram bucket, checked before the ACK, is what bounds reliable traffic.
+            if (reliable || session.state->inboundRateLimiter.Admit(rateClass, std::chrono::steady_clock::now())) {
+                return true;
+            }
+            m_rateLimitedDrops[static_cast<size_t>(rateClass)].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        void ConnectionManager::SetSessionPlayerId(ConnectionSession& session, uint64_t playerId) {
+            session.playerId = playerId;
+            if (SessionShard* shard = GetSessionShardForConnection(session.connectionId)) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                if (ConnectionSession* liveSession = shard->sessions.Find(session.connectionId)) {
+                    liveSession->playerId = playerId;
+                }
+            }
+        }
+
+        void ConnectionManager::OnSendCompleted(OverlappedIOContext* context,
+            bool success,
+            uint32_t bytesSent) {
+            if (success) {
+                RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: NetworkIO reported send of {} bytes completed successfully. Context: {}"), bytesSent, static_cast<void*>(context));
+            }
+            else {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: NetworkIO reported send operation failed. Context: {}"), static_cast<void*>(context));
+            }
+        }
+
+        void ConnectionManager::OnNetworkError(const std::string& errorMessage, int errorCode) {
+            RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: Received OnNetworkError from NetworkIO: \"{}\" (Code: {})"), errorMessage, errorCode);
+        }
+
+        // --- Public Sending Interface ---
+
+        void ConnectionManager::FlushOutgoing() {
+            AssembleOutgoing();
+            m_networkIO->FlushSendQueue();
+        }
+
+        PacketBufferRef ConnectionManager::AcquirePayloadBuffer(const uint8_t* data, uint32_t size) {
+            return m_payloadPool.CopyFrom(data, size);
+        }
+
+        bool ConnectionManager::SendReliablePacket(const NetworkEndpoint& recipient,
+            uint8_t payloadType,
+            const PacketBufferRef& payload,
+            uint8_t additionalFlags) {
+            if (!m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: SendReliablePacket called but handler is not running. Dropping packet to {}."), recipient.ToString());
+                return false;
+            }
+
+            NetworkEndpoint destination;
+            std::shared_ptr<ReliableConnectionState> connState = GetOrCreateReliabilityState(recipient, destination);
+            if (!connState) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendReliablePacket - Failed to get/create reliability state for {}. Dropping packet."), recipient.ToString());
+                return false;
+            }
+
+            if (additionalFlags == 0 && payload.Size() > 0) {
+                return StageOutgoingMessage(connState, payloadType, payload, DeliveryChannel::Reliable);
+            }
+
+            uint8_t flags = static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE) | additionalFlags;
+            OutgoingPacket packet = RiftForged::Networking::PrepareOutgoingPacket(*connState, payload, flags);
+
+            if (!packet.valid) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendReliablePacket - PrepareOutgoingPacket failed for payload type {} to {}."),
+                    payloadType, recipient.ToString());
+                return false;
+            }
+
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Sending RELIABLE payload type {} ({} bytes total) to {}."),
+                payloadType, packet.TotalSize(), destination.ToString());
+            ArmRetransmitTimer(connState);
+
+            return m_networkIO->QueueSendGather(destination, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+        }
+
+        bool ConnectionManager::SendUnreliablePacket(const NetworkEndpoint& recipient,
+            uint8_t payloadType,
+            const PacketBufferRef& payload,
+            uint8_t additionalFlags) {
+            if (!m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: SendUnreliablePacket called but handler is not running. Dropping packet to {}."), recipient.ToString());
+                return false;
+            }
+
+            NetworkEndpoint destination;
+            std::shared_ptr<ReliableConnectionState> connState = GetOrCreateReliabilityState(recipient, destination);
+            if (!connState) {
+                // Unreliable packets still need connState for current ACK info to send.
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendUnreliablePacket - Failed to get/create reliability state for {}. Dropping packet."), recipient.ToString());
+                return false;
+            }
+
+            if (additionalFlags == 0 && payload.Size() > 0) {
+                return StageOutgoingMessage(connState, payloadType, payload, DeliveryChannel::Unreliable);
+            }
+
+            uint8_t flags = additionalFlags & (~static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE));
+            OutgoingPacket packet = RiftForged::Networking::PrepareOutgoingPacket(*connState, payload, flags);
+
+            if (!packet.valid) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendUnreliablePacket - PrepareOutgoingPacket failed for payload type {} to {}."),
+                    payloadType, recipient.ToString());
+                return false;
+            }
+
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Sending UNRELIABLE payload type {} ({} bytes total) to {}."),
+                payloadType, packet.TotalSize(), destination.ToString());
+
+            return m_networkIO->QueueSendGather(destination, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+        }
+
+        bool ConnectionManager::SendOnChannel(const NetworkEndpoint& recipient,
+            DeliveryChannel channel,
+            uint8_t payloadType,
+            const PacketBufferRef& payload) {
+            if (!m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: SendOnChannel called but handler is not running. Dropping packet to {}."), recipient.ToString());
+                return false;
+            }
+
+            NetworkEndpoint destination;
+            std::shared_ptr<ReliableConnectionState> connState = GetOrCreateReliabilityState(recipient, destination);
+            if (!connState) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendOnChannel - Failed to get/create reliability state for {}. Dropping packet."), recipient.ToString());
+                return false;
+            }
+            return StageOutgoingMessage(connState, payloadType, payload, channel);
+        }
+
+        bool ConnectionManager::StageOutgoingMessage(const std::shared_ptr<ReliableConnectionState>& state,
+            uint8_t payloadType,
+            const PacketBufferRef& payload,
+            DeliveryChannel channel) {
+            bool needsAssembly = false;
+            if (!RiftForged::Networking::StageOutgoingMessage(*state, payload, payloadType, channel, &needsAssembly)) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: Outbound backlog full for connection 0x{:08X}. Dropping payload type {}."),
+                    state->connectionId, payloadType);
+                return false;
+            }
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Staged payload type {} ({} bytes) on channel {} for connection 0x{:08X}."),
+                payloadType, payload.Size(), static_cast<uint32_t>(channel), state->connectionId);
+            if (needsAssembly) {
+                std::lock_guard<std::mutex> lock(m_outboundAssemblyMutex);
+                m_outboundAssemblyList.push_back(state);
+            }
+            return true;
+        }
+
+        void ConnectionManager::AssembleOutgoing() {
+            std::lock_guard<std::mutex> runLock(m_outboundAssemblyRunMutex);
+            {
+                std::lock_guard<std::mutex> lock(m_outboundAssemblyMutex);
+                if (m_outboundAssemblyList.empty()) {
+                    return;
+                }
+                m_outboundAssemblyScratch.swap(m_outboundAssemblyList);
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+            size_t stillPending = 0;
+            for (std::shared_ptr<ReliableConnectionState>& state : m_outboundAssemblyScratch) {
+                NetworkEndpoint destination;
+                if (!GetSessionEndpoint(state, destination)) {
+                    continue; // Session removed; its staged messages go with the state.
+                }
+                m_outboundPacketScratch.clear();
+                auto nextSendTime = std::chrono::steady_clock::time_point::max();
+                const bool messagesRemain = RiftForged::Networking::BuildCoalescedPackets(*state, m_payloadPool, now,
+                    m_outboundPacketScratch, &nextSendTime);
+                bool sentReliable = false;
+                for (const OutgoingPacket& packet : m_outboundPacketScratch) {
+                    m_networkIO->QueueSendGather(destination, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+                    sentReliable = sentReliable || HasFlag(packet.header.flags, GamePacketFlag::IS_RELIABLE);
+                }
+                if (sentReliable) {
+                    ArmRetransmitTimer(state);
+                }
+                if (nextSendTime != std::chrono::steady_clock::time_point::max()) {
+                    // Held back by the pacer: make sure a reliability pass runs when it allows more.
+                    ArmReliabilityTimer(state, ReliabilityTimerKind::PacedSend, nextSendTime);
+                }
+                if (messagesRemain) {
+                    // Window full or paced: keep the connection listed and retry on the next flush.
+                    m_outboundAssemblyScratch[stillPending++] = std::move(state);
+                }
+            }
+            m_outboundPacketScratch.clear(); // Release payload references now rather than on the next pass.
+            m_outboundAssemblyScratch.resize(stillPending);
+
+            std::lock_guard<std::mutex> lock(m_outboundAssemblyMutex);
+            m_outboundAssemblyList.insert(m_outboundAssemblyList.end(), m_outboundAssemblyScratch.begin(), m_outboundAssemblyScratch.end());
+            m_outboundAssemblyScratch.clear();
+        }
+
+        bool ConnectionManager::SendAckPacket(const NetworkEndpoint& recipient, ReliableConnectionState& connectionState) {
+            if (!m_isRunning.load(std::memory_order_acquire)) return false;
+
+            RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Sending explicit ACK-only packet to {}. Current RemoteHighestSeq: {}, Current RemoteAckBits: 0x{:08X}"),
+                recipient.ToString(), connectionState.highestReceivedSequenceNumberFromRemote, connectionState.receivedSequenceBitfield);
+
+            uint8_t flags = static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE) | static_cast<uint8_t>(GamePacketFlag::IS_ACK_ONLY);
+            OutgoingPacket packet = RiftForged::Networking::PrepareOutgoingPacket(connectionState, PacketBufferRef(), flags);
+
+            if (!packet.valid) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: SendAckPacket - PrepareOutgoingPacket failed for ACK to {}."), recipient.ToString());
+                return false;
+            }
+            // Explicit ACKs are sent reliably, so they are tracked for retransmission as well.
+            NetworkEndpoint destination = recipient;
+            {
+                std::shared_ptr<ReliableConnectionState> connState;
+                if (SessionShard* shard = GetSessionShardForConnection(connectionState.connectionId)) {
+                    std::lock_guard<std::mutex> lock(shard->mutex);
+                    const ConnectionSession* session = shard->sessions.Find(connectionState.connectionId);
+                    if (session && session->state.get() == &connectionState) {
+                        connState = session->state;
+                        destination = session->endpoint;
+                    }
+                }
+                if (connState) ArmRetransmitTimer(connState);
+            }
+            return m_networkIO->QueueSendGather(destination, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+        }
+
+        bool ConnectionManager::BindPlayerToConnection(const NetworkEndpoint& endpoint, uint64_t playerId, uint32_t shardIndex) {
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                ConnectionSession* session = shard->sessions.FindByAddress(endpoint);
+                if (!session) {
+                    continue;
+                }
+                session->playerId = playerId;
+                session->shardIndex = shardIndex;
+                RF_NETWORK_DEBUG(FMT_STRING("ConnectionManager: Connection 0x{:08X} ({}) bound to PlayerID {} on shard {}."),
+                    session->connectionId, endpoint.ToString(), playerId, shardIndex);
+                return true;
+            }
+            RF_NETWORK_WARN(FMT_STRING("ConnectionManager: BindPlayerToConnection - No session for {}."), endpoint.ToString());
+            return false;
+        }
+
+        // --- Private Reliability Protocol Methods ---
+
+        std::shared_ptr<ReliableConnectionState> ConnectionManager::GetOrCreateReliabilityState(const NetworkEndpoint& endpoint, NetworkEndpoint& out_destination) {
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                if (const ConnectionSession* session = shard->sessions.FindByAddress(endpoint)) {
+                    out_destination = session->endpoint;
+                    return session->state;
+                }
+            }
+            // No receive shard has heard from this address; the first one takes the session.
+            SessionShard& shard = *m_sessionShards.front();
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ConnectionSession* session = shard.sessions.FindByAddress(endpoint);
+            if (!session) {
+                session = CreateSessionLocked(shard, endpoint);
+                if (!session) {
+                    return nullptr;
+                }
+            }
+            out_destination = session->endpoint;
+            return session->state;
+        }
+
+        bool ConnectionManager::ResolveIncomingSession(const NetworkEndpoint& sender, uint32_t connectionId, uint32_t ioShard,
+            ConnectionSession& out_session) {
+            // The kernel steers each address to one receive shard, so this lock is only contended by
+            // game-thread lookups, never by another receive thread.
+            if (connectionId != INVALID_CONNECTION_ID) {
+                if (SessionShard* shard = GetSessionShardForConnection(connectionId)) {
+                    std::lock_guard<std::mutex> lock(shard->mutex);
+                    if (ConnectionSession* session = shard->sessions.Find(connectionId)) {
+                        if (session->endpoint != sender) {
+                            // A client whose address changed re-handshakes from the new one; the ID
+                            // alone is not proof that the sender owns the session.
+                            return false;
+                        }
+                        session->lastSeen = std::chrono::steady_clock::now();
+                        out_session = *session;
+                        return true;
+                    }
+                }
+            }
+            // Packets without a live ID are looked up by address in the receiving shard only. A
+            // session that moved to an address another shard receives is found by its ID.
+            SessionShard& shard = GetSessionShardForIO(ioShard);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            ConnectionSession* session = shard.sessions.FindByEndpoint(sender);
+            if (!session) {
+                return false;
+            }
+            session->lastSeen = std::chrono::steady_clock::now();
+            out_session = *session;
+            return true;
+        }
+
+        void ConnectionManager::HandleHandshakePacket(const NetworkEndpoint& sender,
+            uint32_t ioShard,
+            const GamePacketHeader& header,
+            const uint8_t* payload,
+            uint32_t payloadSize) {
+            const auto now = std::chrono::steady_clock::now();
+
+            if (HasFlag(header.flags, GamePacketFlag::IS_CONNECT_REQUEST)) {
+                // The request must be at least as large as the challenge, so a spoofed request can
+                // never make us send more bytes to its victim than the attacker sent to us.
+                if (payloadSize < HANDSHAKE_CHALLENGE_SIZE) {
+                    m_malformedDrops.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                // The cookie, then the sender's address as we see it: a client behind NAT needs it
+                // to prove a rebind from that address.
+                const HandshakeCookieGenerator::Cookie cookie = m_cookieGenerator.Generate(sender, now);
+                GamePacketHeader challengeHeader;
+                challengeHeader.flags = static_cast<uint8_t>(GamePacketFlag::IS_CONNECT_CHALLENGE);
+                uint8_t challenge[sizeof(GamePacketHeader) + HANDSHAKE_CHALLENGE_SIZE];
+                memcpy(challenge, &challengeHeader, sizeof(GamePacketHeader));
+                memcpy(challenge + sizeof(GamePacketHeader), cookie.data(), cookie.size());
+                WriteObservedEndpoint(sender, challenge + sizeof(GamePacketHeader) + HANDSHAKE_COOKIE_SIZE);
+                m_networkIO->QueueSendData(sender, challenge, sizeof(challenge));
+                m_challengesSent.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (!HasFlag(header.flags, GamePacketFlag::IS_CONNECT_RESPONSE)) {
+                m_malformedDrops.fetch_add(1, std::memory_order_relaxed); // Challenges only travel server->client.
+                return;
+            }
+
+            if (!m_cookieGenerator.Validate(sender, payload, payloadSize, now)) {
+                m_cookiesRejected.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // The sender has proven it receives at its address: create its session, or move an
+            // existing one here when it names its connection ID and proves it holds that session's
+            // secret. Handshakes are rare, so looking the address up in every shard (one lock at a
+            // time) is affordable here.
+            std::shared_ptr<ReliableConnectionState> state;
+            SessionSecret secret{};
+            uint8_t grantedCapabilities = 0;
+            SessionShard* ownerShard = nullptr; // Shard that already has a session at 'sender'
+
+            // Optional features the client asked for after its cookie; we grant those we support.
+            // They are settled by the session's first handshake: the client repeats step 3 until
+            // step 4 arrives, and neither a repeat nor a rebind renegotiates them.
+            auto negotiateCapabilitiesLocked = [&](ConnectionSession& session) {
+                if (!session.capabilitiesNegotiated) {
+                    const uint8_t requestedCapabilities = payloadSize > HANDSHAKE_COOKIE_SIZE ? payload[HANDSHAKE_COOKIE_SIZE] : 0;
+                    session.capabilities = requestedCapabilities & SUPPORTED_CONNECTION_CAPABILITIES;
+                    if (!m_payloadCompressor.IsAvailable()) {
+                        session.capabilities &= static_cast<uint8_t>(~CONNECTION_CAPABILITY_COMPRESSION);
+                    }
+                    session.capabilitiesNegotiated = true;
+                    session.state->SetCapabilities(session.capabilities);
+                }
+                grantedCapabilities = session.capabilities;
+            };
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                if (shard->sessions.FindByEndpoint(sender)) {
+                    ownerShard = shard.get();
+                    break;
+                }
+            }
+            if (header.connectionId != INVALID_CONNECTION_ID) {
+                if (SessionShard* shard = GetSessionShardForConnection(header.connectionId)) {
+                    std::lock_guard<std::mutex> lock(shard->mutex);
+                    ConnectionSession* session = shard->sessions.Find(header.connectionId);
+                    if (session && session->endpoint != sender) {
+                        // Step 3 rebind: cookie | u8 capabilities | proof keyed by the session secret.
+                        const uint32_t proofOffset = HANDSHAKE_COOKIE_SIZE + 1;
+                        const bool proven = payloadSize >= proofOffset + SESSION_REBIND_PROOF_SIZE &&
+                            ValidateSessionRebindProof(session->secret, header.connectionId, sender, payload,
+                                payload + proofOffset, payloadSize - proofOffset);
+                        const NetworkEndpoint previousEndpoint = session->endpoint;
+                        if (!proven) {
+                            m_rebindsRejected.fetch_add(1, std::memory_order_relaxed);
+                            RF_NETWORK_DEBUG(FMT_STRING("ConnectionManager: Connection 0x{:08X} claimed by {} without proof of its secret. Treating it as a new client."),
+                                header.connectionId, sender.ToString());
+                            session = nullptr;
+                        }
+                        else if ((ownerShard == nullptr || ownerShard == shard) && shard->sessions.Rebind(header.connectionId, sender)) {
+                            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Connection 0x{:08X} moved from {} to {}."),
+                                header.connectionId, previousEndpoint.ToString(), sender.ToString());
+                        }
+                        else {
+                            m_rebindConflicts.fetch_add(1, std::memory_order_relaxed);
+                            RF_NETWORK_DEBUG(FMT_STRING("ConnectionManager: Connection 0x{:08X} claimed by {}, which belongs to another session. Using that session."),
+                                header.connectionId, sender.ToString());
+                            session = nullptr;
+                        }
+                    }
+                    if (session) {
+                        session->lastSeen = now;
+                        state = session->state;
+                        secret = session->secret;
+                        negotiateCapabilitiesLocked(*session);
+                    }
+                }
+            }
+            if (!state) {
+                SessionShard& shard = ownerShard ? *ownerShard : GetSessionShardForIO(ioShard);
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                ConnectionSession* session = shard.sessions.FindByEndpoint(sender);
+                if (!session) {
+                    session = CreateSessionLocked(shard, sender);
+                    if (!session) {
+                        return;
+                    }
+                }
+                session->lastSeen = now;
+                state = session->state;
+                secret = session->secret;
+                negotiateCapabilitiesLocked(*session);
+            }
+            m_handshakesAccepted.fetch_add(1, std::memory_order_relaxed);
+
+            // Step 4 tells the client its connection ID, granted capabilities and session secret. It is
+            // unreliable: the client repeats step 3 until it arrives, and repeats are idempotent.
+            uint8_t acceptBytes[1 + SESSION_SECRET_SIZE];
+            acceptBytes[0] = grantedCapabilities;
+            memcpy(acceptBytes + 1, secret.data(), SESSION_SECRET_SIZE);
+            PacketBufferRef acceptPayload = m_payloadPool.CopyFrom(acceptBytes, sizeof(acceptBytes));
+            OutgoingPacket accept = RiftForged::Networking::PrepareOutgoingPacket(*state, acceptPayload,
+                static_cast<uint8_t>(GamePacketFlag::IS_CONNECT_RESPONSE));
+            if (accept.valid) {
+                m_networkIO->QueueSendGather(sender, accept.HeaderBytes(), accept.HeaderSize(), accept.payload);
+            }
+        }
+
+        HandshakeStats ConnectionManager::GetHandshakeStats() const {
+            HandshakeStats stats;
+            stats.challengesSent = m_challengesSent.load(std::memory_order_relaxed);
+            stats.handshakesAccepted = m_handshakesAccepted.load(std::memory_order_relaxed);
+            stats.cookiesRejected = m_cookiesRejected.load(std::memory_order_relaxed);
+            stats.rebindsRejected = m_rebindsRejected.load(std::memory_order_relaxed);
+            stats.rebindConflicts = m_rebindConflicts.load(std::memory_order_relaxed);
+            stats.unknownSourceDrops = m_unknownSourceDrops.load(std::memory_order_relaxed);
+            stats.malformedDrops = m_malformedDrops.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        size_t ConnectionManager::GetSessionCount() {
+            size_t count = 0;
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                count += shard->sessions.Size();
+            }
+            return count;
+        }
+
+        bool ConnectionManager::GetConnectionEndpoint(uint32_t connectionId, NetworkEndpoint& out_endpoint) {
+            SessionShard* shard = GetSessionShardForConnection(connectionId);
+            if (!shard) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            const ConnectionSession* session = shard->sessions.Find(connectionId);
+            if (!session) {
+                return false;
+            }
+            out_endpoint = session->endpoint;
+            return true;
+        }
+
+        bool ConnectionManager::GetConnectionRetransmitStats(const NetworkEndpoint& endpoint, RetransmitStats& out_stats) {
+            std::shared_ptr<ReliableConnectionState> state = FindSessionStateByEndpoint(endpoint);
+            if (!state) {
+                return false;
+            }
+            out_stats = state->GetRetransmitStats();
+            return true;
+        }
+
+        bool ConnectionManager::LoadCompressionDictionary(const std::string& path) {
+            return m_payloadCompressor.LoadDictionary(path);
+        }
+
+        void ConnectionManager::SetCompressionCpuBudget(uint32_t microsecondsPerSecond) {
+            m_payloadCompressor.SetCpuBudget(microsecondsPerSecond);
+        }
+
+        CompressionStats ConnectionManager::GetCompressionStats() const {
+            return m_payloadCompressor.GetStats();
+        }
+
+        bool ConnectionManager::GetConnectionCompressionStats(const NetworkEndpoint& endpoint, CompressionStats& out_stats) {
+            std::shared_ptr<ReliableConnectionState> state = FindSessionStateByEndpoint(endpoint);
+            if (!state) {
+                return false;
+            }
+            out_stats = state->GetCompressionStats();
+            return true;
+        }
+
+        void ConnectionManager::SetInboundRateLimit(InboundRateClass rateClass, const InboundRateLimit& limit) {
+            if (static_cast<uint32_t>(rateClass) >= INBOUND_RATE_CLASS_COUNT) {
+                return;
+            }
+            if (m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: SetInboundRateLimit ignored while running; call it before Start()."));
+                return;
+            }
+            m_inboundRateLimits[static_cast<size_t>(rateClass)] = limit;
+        }
+
+        InboundRateLimitStats ConnectionManager::GetInboundRateLimitStats() const {
+            InboundRateLimitStats stats;
+            for (uint32_t i = 0; i < INBOUND_RATE_CLASS_COUNT; ++i) {
+                stats.dropped[i] = m_rateLimitedDrops[i].load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        bool ConnectionManager::GetConnectionRateLimitStats(const NetworkEndpoint& endpoint, InboundRateLimitStats& out_stats) {
+            std::shared_ptr<ReliableConnectionState> state = FindSessionStateByEndpoint(endpoint);
+            if (!state) {
+                return false;
+            }
+            out_stats = state->inboundRateLimiter.GetStats();
+            return true;
+        }
+
+        TelemetrySnapshot ConnectionManager::GetTelemetrySnapshot() {
+            std::vector<std::pair<uint32_t, std::shared_ptr<ReliableConnectionState>>> liveConnections;
+            std::map<uint32_t, ShardTelemetry> shards;
+            {
+                // Only references are taken under the locks; the counters are read after they are released.
+                std::lock_guard<std::mutex> lock(m_closedTelemetryMutex);
+                for (const auto& [shardIndex, closedTotals] : m_closedConnectionTelemetry) {
+                    shards[shardIndex].totals = closedTotals;
+                }
+            }
+            for (const auto& sessionShard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(sessionShard->mutex);
+                liveConnections.reserve(liveConnections.size() + sessionShard->sessions.Size());
+                sessionShard->sessions.ForEach([&](ConnectionSession& session) {
+                    liveConnections.emplace_back(session.shardIndex, session.state);
+                });
+            }
+            for (const auto& [shardIndex, state] : liveConnections) {
+                ShardTelemetry& shard = shards[shardIndex];
+                shard.activeConnections++;
+                shard.totals.Accumulate(state->telemetry.Snapshot());
+            }
+
+            TelemetrySnapshot snapshot;
+            snapshot.captureTime = std::chrono::system_clock::now();
+            snapshot.shards.reserve(shards.size());
+            for (auto& [shardIndex, shard] : shards) {
+                shard.shardIndex = shardIndex;
+                snapshot.shards.push_back(shard);
+            }
+            return snapshot;
+        }
+
+        bool ConnectionManager::GetConnectionTelemetry(const NetworkEndpoint& endpoint, ConnectionTelemetrySnapshot& out_telemetry) {
+            std::shared_ptr<ReliableConnectionState> state = FindSessionStateByEndpoint(endpoint);
+            if (!state) {
+                return false;
+            }
+            out_telemetry = state->telemetry.Snapshot();
+            return true;
+        }
+
+        bool ConnectionManager::StartTelemetryDump(const std::string& path, std::chrono::seconds interval) {
+            std::lock_guard<std::mutex> lock(m_telemetryDumpMutex);
+            if (m_telemetryDumpFile.is_open()) {
+                m_telemetryDumpFile.close();
+            }
+            m_nextTelemetryDump = std::chrono::steady_clock::time_point::max();
+            m_telemetryDumpFile.open(path, std::ios::out | std::ios::app);
+            if (!m_telemetryDumpFile) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: Cannot open telemetry dump file '{}'."), path);
+                return false;
+            }
+            m_telemetryDumpInterval = std::max<std::chrono::steady_clock::duration>(interval, std::chrono::seconds(1));
+            m_nextTelemetryDump = std::chrono::steady_clock::now() + m_telemetryDumpInterval;
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Dumping connection telemetry to '{}' every {}s."), path,
+                std::chrono::duration_cast<std::chrono::seconds>(m_telemetryDumpInterval).count());
+            return true;
+        }
+
+        void ConnectionManager::StopTelemetryDump() {
+            std::lock_guard<std::mutex> lock(m_telemetryDumpMutex);
+            if (!m_telemetryDumpFile.is_open()) {
+                return;
+            }
+            WriteTelemetryDumpLocked();
+            m_telemetryDumpFile.close();
+            m_nextTelemetryDump = std::chrono::steady_clock::time_point::max();
+        }
+
+        void ConnectionManager::DumpTelemetryIfDue(std::chrono::steady_clock::time_point now) {
+            std::lock_guard<std::mutex> lock(m_telemetryDumpMutex);
+            if (now < m_nextTelemetryDump) {
+                return;
+            }
+            WriteTelemetryDumpLocked();
+            if (m_telemetryDumpFile.is_open()) {
+                m_nextTelemetryDump = now + m_telemetryDumpInterval;
+            }
+        }
+
+        void ConnectionManager::WriteTelemetryDumpLocked() {
+            std::string lines;
+            AppendTelemetryJsonLines(GetTelemetrySnapshot(), lines);
+            m_telemetryDumpFile << lines;
+            m_telemetryDumpFile.flush();
+            if (!m_telemetryDumpFile) {
+                RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: Writing the telemetry dump failed; stopping it."));
+                m_telemetryDumpFile.close();
+                m_nextTelemetryDump = std::chrono::steady_clock::time_point::max();
+            }
+        }
+
+        bool ConnectionManager::GetConnectionCongestionStats(const NetworkEndpoint& endpoint, CongestionStats& out_stats) {
+            std::shared_ptr<ReliableConnectionState> state = FindSessionStateByEndpoint(endpoint);
+            if (!state) {
+                return false;
+            }
+            out_stats = state->GetCongestionStats();
+            return true;
+        }
+
+        ConnectionSession* ConnectionManager::CreateSessionLocked(SessionShard& shard, const NetworkEndpoint& endpoint) {
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Creating new session for endpoint: {}."), endpoint.ToString());
+            try {
+                auto newState = std::make_shared<ReliableConnectionState>();
+                ConnectionSession* session = shard.sessions.Create(endpoint, newState);
+                if (!session) {
+                    RF_NETWORK_ERROR(FMT_STRING("ConnectionManager: Session table full ({} sessions). Refusing {}."), shard.sessions.Size(), endpoint.ToString());
+                    return nullptr;
+                }
+                newState->connectionId = session->connectionId; // Not yet shared; no lock needed.
+                newState->payloadCompressor = &m_payloadCompressor;
+                newState->inboundRateLimiter.Configure(m_inboundRateLimits);
+                ArmReliabilityTimer(newState, ReliabilityTimerKind::StaleConnection,
+                    session->lastSeen + std::chrono::seconds(STALE_CONNECTION_TIMEOUT_SECONDS_PKT));
+                return session;
+            }
+            catch (const std::bad_alloc& e) {
+                RF_NETWORK_CRITICAL(FMT_STRING("ConnectionManager: Failed to allocate session for {}: {}"), endpoint.ToString(), e.what());
+                return nullptr;
+            }
+        }
+
+        void ConnectionManager::ResizeSessionShards() {
+            const uint32_t ioShards = std::clamp<uint32_t>(m_networkIO->GetIOShardCount(), 1u, MAX_SESSION_TABLE_SHARDS);
+            if (ioShards == m_sessionShards.size()) {
+                return;
+            }
+            m_sessionShardBits = GetSessionShardBits(ioShards);
+            m_sessionShards.clear();
+            for (uint32_t i = 0; i < ioShards; ++i) {
+                m_sessionShards.push_back(std::make_unique<SessionShard>(i, m_sessionShardBits));
+            }
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Sessions split across {} receive shards."), ioShards);
+        }
+
+        ConnectionManager::SessionShard* ConnectionManager::GetSessionShardForConnection(uint32_t connectionId) {
+            const uint32_t shardIndex = GetConnectionIdShard(connectionId, m_sessionShardBits);
+            return shardIndex < m_sessionShards.size() ? m_sessionShards[shardIndex].get() : nullptr;
+        }
+
+        std::shared_ptr<ReliableConnectionState> ConnectionManager::FindSessionStateByEndpoint(const NetworkEndpoint& endpoint) {
+            for (const auto& shard : m_sessionShards) {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                if (const ConnectionSession* session = shard->sessions.FindByAddress(endpoint)) {
+                    return session->state;
+                }
+            }
+            return nullptr;
+        }
+
+        void ConnectionManager::ArmReliabilityTimer(const std::shared_ptr<ReliableConnectionState>& state,
+            ReliabilityTimerKind kind,
+            std::chrono::steady_clock::time_point deadline) {
+            {
+                std::lock_guard<std::mutex> stateLock(state->internalStateMutex);
+                auto& armed = state->armedTimerDeadlines[static_cast<size_t>(kind)];
+                if (armed <= deadline) {
+                    return; // An earlier expiry is pending; it re-arms for later work when it fires.
+                }
+                armed = deadline;
+            }
+
+            std::lock_guard<std::mutex> timerLock(m_timerMutex);
+            m_timerWheel.Schedule(deadline, ReliabilityTimer{ state, state->connectionId, kind, deadline });
+            if (deadline < m_timerThreadWakeTime) {
+                m_timerThreadWakeTime = deadline;
+                m_timerCondition.notify_one();
+            }
+        }
+
+        void ConnectionManager::ArmRetransmitTimer(const std::shared_ptr<ReliableConnectionState>& state) {
+            auto rto = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<float, std::milli>(state->GetRetransmissionTimeoutMs()));
+            ArmReliabilityTimer(state, ReliabilityTimerKind::Retransmit, std::chrono::steady_clock::now() + rto);
+        }
+
+        bool ConnectionManager::RemoveSession(uint32_t connectionId, const std::shared_ptr<ReliableConnectionState>& state,
+            NetworkEndpoint& out_joinEndpoint) {
+            SessionShard* shard = GetSessionShardForConnection(connectionId);
+            if (!shard) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(shard->mutex);
+                const ConnectionSession* session = shard->sessions.Find(connectionId);
+                if (!session || session->state != state) {
+                    return false; // Already removed.
+                }
+                out_joinEndpoint = session->joinEndpoint;
+                {
+                    std::lock_guard<std::mutex> telemetryLock(m_closedTelemetryMutex);
+                    m_closedConnectionTelemetry[session->shardIndex].Accumulate(state->telemetry.Snapshot());
+                }
+                shard->sessions.Remove(connectionId);
+            }
+            const CompressionStats compression = state->GetCompressionStats();
+            if (compression.packetsCompressed > 0) {
+                RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Connection 0x{:08X} compression saved {} of {} payload bytes over {} packets ({} skipped for the CPU budget)."),
+                    connectionId, compression.bytesBeforeCompression - compression.bytesAfterCompression,
+                    compression.bytesBeforeCompression, compression.packetsCompressed, compression.packetsSkippedForBudget);
+            }
+            const InboundRateLimitStats rateLimited = state->inboundRateLimiter.GetStats();
+            uint64_t totalRateLimited = 0;
+            for (uint64_t dropped : rateLimited.dropped) {
+                totalRateLimited += dropped;
+            }
+            if (totalRateLimited > 0) {
+                RF_NETWORK_WARN(FMT_STRING("ConnectionManager: Connection 0x{:08X} was rate limited: {} datagrams, {} movement, {} action and {} control messages dropped."),
+                    connectionId,
+                    rateLimited.dropped[static_cast<size_t>(InboundRateClass::Datagram)],
+                    rateLimited.dropped[static_cast<size_t>(InboundRateClass::Movement)],
+                    rateLimited.dropped[static_cast<size_t>(InboundRateClass::Action)],
+                    rateLimited.dropped[static_cast<size_t>(InboundRateClass::Control)]);
+            }
+            return true;
+        }
+
+        bool ConnectionManager::GetSessionEndpoint(const std::shared_ptr<ReliableConnectionState>& state, NetworkEndpoint& out_endpoint) {
+            SessionShard* shard = GetSessionShardForConnection(state->connectionId);
+            if (!shard) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            const ConnectionSession* session = shard->sessions.Find(state->connectionId);
+            if (!session || session->state != state) {
+                return false;
+            }
+            out_endpoint = session->endpoint;
+            return true;
+        }
+
+        void ConnectionManager::HandleReliabilityTimer(const ReliabilityTimer& timer,
+            std::chrono::steady_clock::time_point currentTime,
+            std::vector<NetworkEndpoint>& droppedEndpoints) {
+            std::shared_ptr<ReliableConnectionState> state = timer.state.lock();
+            if (!state) {
+                return; // Connection already gone.
+            }
+            {
+                std::lock_guard<std::mutex> stateLock(state->internalStateMutex);
+                auto& armed = state->armedTimerDeadlines[static_cast<size_t>(timer.kind)];
+                if (armed != timer.deadline) {
+                    return; // Superseded by an earlier deadline that already ran.
+                }
+                armed = std::chrono::steady_clock::time_point::max();
+            }
+            NetworkEndpoint endpoint;
+            if (!GetSessionEndpoint(state, endpoint)) {
+                return; // Session removed; only this timer still referenced the state.
+            }
+
+            switch (timer.kind) {
+            case ReliabilityTimerKind::Retransmit: {
+                auto nextDeadline = std::chrono::steady_clock::time_point::max();
+                std::vector<OutgoingPacket> retransmits =
+                    RiftForged::Networking::GetPacketsForRetransmission(*state, currentTime, &nextDeadline);
+                for (const OutgoingPacket& packet : retransmits) {
+                    RF_NETWORK_TRACE(FMT_STRING("ConnectionManager: Retransmitting packet ({} bytes) to {}."), packet.TotalSize(), endpoint.ToString());
+                    m_networkIO->QueueSendGather(endpoint, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+                }
+                if (state->connectionDroppedByMaxRetries) {
+                    RF_NETWORK_WARN(FMT_STRING("ConnectionManager: Endpoint {} flagged for drop by MAX RETRIES."), endpoint.ToString());
+                    NetworkEndpoint joinEndpoint;
+                    if (RemoveSession(timer.connectionId, state, joinEndpoint)) {
+                        droppedEndpoints.push_back(joinEndpoint);
+                    }
+                }
+                else if (nextDeadline != std::chrono::steady_clock::time_point::max()) {
+                    ArmReliabilityTimer(state, ReliabilityTimerKind::Retransmit, nextDeadline);
+                }
+                break;
+            }
+            case ReliabilityTimerKind::AckFlush: {
+                bool sent = RiftForged::Networking::TrySendAckOnlyPacket(
+                    *state,
+                    m_payloadPool,
+                    currentTime,
+                    [this, &endpoint](const OutgoingPacket& packet) {
+                        // This lambda is called by TrySendAckOnlyPacket, which itself already holds the
+                        // ReliableConnectionState's internal mutex when calling PrepareOutgoingPacketUnlocked.
+                        // The actual QueueSendGather call is thread-safe.
+                        m_networkIO->QueueSendGather(endpoint, packet.HeaderBytes(), packet.HeaderSize(), packet.payload);
+                    }
+                );
+                if (sent) {
+                    ArmRetransmitTimer(state); // ACK-only packets are sent reliably.
+                }
+                // Still pending if a recent send pushed the deadline back.
+                auto ackDeadline = RiftForged::Networking::GetAckFlushDeadline(*state);
+                if (ackDeadline != std::chrono::steady_clock::time_point::max()) {
+                    ArmReliabilityTimer(state, ReliabilityTimerKind::AckFlush, ackDeadline);
+                }
+                break;
+            }
+            case ReliabilityTimerKind::StaleConnection: {
+                std::chrono::steady_clock::time_point lastReceived;
+                bool awaitingAcks = false;
+                {
+                    std::lock_guard<std::mutex> stateLock(state->internalStateMutex);
+                    lastReceived = state->lastPacketReceivedTimeFromRemote;
+                    awaitingAcks = !state->unacknowledgedSentPackets.Empty();
+                }
+                const auto timeout = std::chrono::seconds(STALE_CONNECTION_TIMEOUT_SECONDS_PKT);
+                const bool idle = lastReceived == std::chrono::steady_clock::time_point::min() || currentTime - lastReceived > timeout;
+                if (idle && !awaitingAcks) { // Only if we are not waiting for their ACKs
+                    RF_NETWORK_INFO(FMT_STRING("ConnectionManager: Endpoint {} flagged for drop due to STALENESS."), endpoint.ToString());
+                    NetworkEndpoint joinEndpoint;
+                    if (RemoveSession(timer.connectionId, state, joinEndpoint)) {
+                        droppedEndpoints.push_back(joinEndpoint);
+                    }
+                }
+                else {
+                    // Traffic since arming moved the expiry; while ACKs are outstanding, the retransmit
+                    // timer decides the connection's fate and this one checks back a second later.
+                    auto nextCheck = idle ? currentTime + std::chrono::seconds(1) : lastReceived + timeout;
+                    ArmReliabilityTimer(state, ReliabilityTimerKind::StaleConnection, nextCheck);
+                }
+                break;
+            }
+            case ReliabilityTimerKind::PacedSend:
+                // Nothing to do here: the connection is still on the assembly list and the
+                // AssembleOutgoing() that follows every pass sends what the pacer now allows.
+                break;
+            default:
+                break;
+            }
+        }
+
+        void ConnectionManager::ReliabilityManagementThread() {
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: ReliabilityManagementThread started."));
+            std::vector<NetworkEndpoint> clientsToNotifyDropped;
+            std::vector<ReliabilityTimer> expiredTimers;
+
+            while (m_isRunning.load(std::memory_order_acquire)) {
+                clientsToNotifyDropped.clear();
+                expiredTimers.clear();
+
+                {
+                    std::unique_lock<std::mutex> timerLock(m_timerMutex);
+                    const auto idleLimit = std::chrono::steady_clock::now() + std::chrono::milliseconds(RELIABILITY_THREAD_SLEEP_MS_PKT);
+                    const auto wakeTime = std::min(m_timerWheel.NextWakeTime(), idleLimit);
+                    m_timerThreadWakeTime = wakeTime;
+                    // ArmReliabilityTimer lowers m_timerThreadWakeTime (and notifies) for earlier deadlines.
+                    m_timerCondition.wait_until(timerLock, m_timerThreadWakeTime, [this, wakeTime] {
+                        return !m_isRunning.load(std::memory_order_acquire) || m_timerThreadWakeTime < wakeTime;
+                    });
+                    if (m_timerThreadWakeTime < wakeTime && std::chrono::steady_clock::now() < m_timerThreadWakeTime) {
+                        continue; // Woken for an earlier deadline that is not due yet; sleep until it.
+                    }
+                    m_timerWheel.Advance(std::chrono::steady_clock::now(), expiredTimers);
+                    m_timerThreadWakeTime = std::chrono::steady_clock::time_point::max(); // Awake; no notifies needed.
+                }
+                if (!m_isRunning.load(std::memory_order_acquire)) {
+                    break;
+                }
+
+                // Timers run outside the wheel lock so they can re-arm themselves.
+                auto currentTime = std::chrono::steady_clock::now();
+                for (const ReliabilityTimer& timer : expiredTimers) {
+                    HandleReliabilityTimer(timer, currentTime, clientsToNotifyDropped);
+                }
+
+                if (!clientsToNotifyDropped.empty()) {
+                    RF_NETWORK_INFO(FMT_STRING("ConnectionManager: {} client(s) dropped."), clientsToNotifyDropped.size());
+                    OnConnectionsDropped(clientsToNotifyDropped);
+                }
+                // Retransmits, delayed ACKs and anything game systems queued since the last pass.
+                AssembleOutgoing();
+                m_networkIO->FlushSendQueue();
+
+                DumpTelemetryIfDue(std::chrono::steady_clock::now());
+            }
+            RF_NETWORK_INFO(FMT_STRING("ConnectionManager: ReliabilityManagementThread gracefully exited."));
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
\ No newline at end of file
@@ -0,0 +1,108 @@
+﻿// File: ConnectionTelemetry.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the connection telemetry counters, their aggregation and the JSON-lines
+// format of telemetry dumps.
+
+#include "ConnectionTelemetry.h"
+
+#include <fmt/format.h> // For fmt::format_to
+#include <iterator>     // For std::back_inserter
+
+namespace RiftForged {
+    namespace Networking {
+
+        void ConnectionTelemetrySnapshot::Accumulate(const ConnectionTelemetrySnapshot& other) {
+            packetsSent += other.packetsSent;
+            bytesSent += other.bytesSent;
+            packetsReceived += other.packetsReceived;
+            bytesReceived += other.bytesReceived;
+            retransmits += other.retransmits;
+            packetsAbandoned += other.packetsAbandoned;
+            duplicatesReceived += other.duplicatesReceived;
+            outOfOrderReceived += other.outOfOrderReceived;
+            for (uint32_t i = 0; i < RTT_HISTOGRAM_BUCKET_COUNT; ++i) {
+                rttHistogram[i] += other.rttHistogram[i];
+            }
+        }
+
+        uint64_t ConnectionTelemetrySnapshot::RttSamples() const {
+            uint64_t samples = 0;
+            for (uint64_t bucket : rttHistogram) {
+                samples += bucket;
+            }
+            return samples;
+        }
+
+        double ConnectionTelemetrySnapshot::RetransmitRatio() const {
+            return packetsSent == 0 ? 0.0 : static_cast<double>(retransmits) / static_cast<double>(packetsSent);
+        }
+
+        uint32_t ConnectionTelemetrySnapshot::EstimateRttPercentileMs(double percentile) const {
+            const uint64_t samples = RttSamples();
+            if (samples == 0) {
+                return 0;
+            }
+            // Rank of the sample sought, 1-based, so the 100th percentile is the last sample.
+            uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(samples) + 0.5);
+            rank = rank < 1 ? 1 : (rank > samples ? samples : rank);
+            uint64_t seen = 0;
+            for (uint32_t i = 0; i < RTT_HISTOGRAM_BUCKET_BOUNDS_MS.size(); ++i) {
+                seen += rttHistogram[i];
+                if (seen >= rank) {
+                    return RTT_HISTOGRAM_BUCKET_BOUNDS_MS[i];
+                }
+            }
+            return RTT_HISTOGRAM_BUCKET_BOUNDS_MS.back();
+        }
+
+        void ConnectionTelemetry::OnRttSample(float sampleMs) {
+            uint32_t bucket = 0;
+            while (bucket < RTT_HISTOGRAM_BUCKET_BOUNDS_MS.size() && sampleMs >= static_cast<float>(RTT_HISTOGRAM_BUCKET_BOUNDS_MS[bucket])) {
+                ++bucket;
+            }
+            m_rttHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ConnectionTelemetrySnapshot ConnectionTelemetry::Snapshot() const {
+            ConnectionTelemetrySnapshot snapshot;
+            snapshot.packetsSent = m_packetsSent.load(std::memory_order_relaxed);
+            snapshot.bytesSent = m_bytesSent.load(std::memory_order_relaxed);
+            snapshot.packetsReceived = m_packetsReceived.load(std::memory_order_relaxed);
+            snapshot.bytesReceived = m_bytesReceived.load(std::memory_order_relaxed);
+            snapshot.retransmits = m_retransmits.load(std::memory_order_relaxed);
+            snapshot.packetsAbandoned = m_packetsAbandoned.load(std::memory_order_relaxed);
+            snapshot.duplicatesReceived = m_duplicatesReceived.load(std::memory_order_relaxed);
+            snapshot.outOfOrderReceived = m_outOfOrderReceived.load(std::memory_order_relaxed);
+            for (uint32_t i = 0; i < RTT_HISTOGRAM_BUCKET_COUNT; ++i) {
+                snapshot.rttHistogram[i] = m_rttHistogram[i].load(std::memory_order_relaxed);
+            }
+            return snapshot;
+        }
+
+        void AppendTelemetryJsonLines(const TelemetrySnapshot& snapshot, std::string& out) {
+            const long long captureTimeMs = static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                snapshot.captureTime.time_since_epoch()).count());
+            auto writer = std::back_inserter(out);
+            for (const ShardTelemetry& shard : snapshot.shards) {
+                const ConnectionTelemetrySnapshot& totals = shard.totals;
+                fmt::format_to(writer,
+                    "{{\"time_ms\":{},\"shard\":{},\"connections\":{},\"packets_sent\":{},\"bytes_sent\":{},"
+                    "\"packets_received\":{},\"bytes_received\":{},\"retransmits\":{},\"retransmit_ratio\":{:.4f},"
+                    "\"packets_abandoned\":{},\"duplicates\":{},\"out_of_order\":{},\"rtt_p50_ms\":{},\"rtt_p99_ms\":{},\"rtt_histogram\":[",
+                    captureTimeMs, shard.shardIndex, shard.activeConnections, totals.packetsSent, totals.bytesSent,
+                    totals.packetsReceived, totals.bytesReceived, totals.retransmits, totals.RetransmitRatio(),
+                    totals.packetsAbandoned, totals.duplicatesReceived, totals.outOfOrderReceived,
+                    totals.EstimateRttPercentileMs(50.0), totals.EstimateRttPercentileMs(99.0));
+                for (uint32_t i = 0; i < RTT_HISTOGRAM_BUCKET_COUNT; ++i) {
+                    if (i > 0) {
+                        out += ',';
+                    }
+                    fmt::format_to(writer, "{}", totals.rttHistogram[i]);
+                }
+                out += "]}\n";
+            }
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,83 @@
+﻿// File: DeliveryChannel.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the reorder buffer of reliable-ordered delivery channels.
+
+#include "DeliveryChannel.h"
+
+#include <new>      // For std::nothrow
+#include <utility>  // For std::swap
+
+namespace RiftForged {
+    namespace Networking {
+
+        OrderedArrival OrderedChannelReceiver::Classify(uint16_t channelSequence) const {
+            const int16_t distance = static_cast<int16_t>(static_cast<uint16_t>(channelSequence - m_nextExpected));
+            if (distance < 0) {
+                return OrderedArrival::Duplicate;
+            }
+            if (distance == 0) {
+                return OrderedArrival::InOrder;
+            }
+            if (static_cast<uint32_t>(distance) >= ORDERED_CHANNEL_REORDER_WINDOW) {
+                return OrderedArrival::TooFarAhead;
+            }
+            if (m_slots && m_slots[channelSequence % ORDERED_CHANNEL_REORDER_WINDOW].arrived) {
+                return OrderedArrival::Duplicate;
+            }
+            return OrderedArrival::Early;
+        }
+
+        bool OrderedChannelReceiver::Reserve() {
+            if (!m_slots) {
+                m_slots.reset(new (std::nothrow) Slot[ORDERED_CHANNEL_REORDER_WINDOW]);
+            }
+            return m_slots != nullptr;
+        }
+
+        void OrderedChannelReceiver::Store(uint16_t channelSequence, const uint8_t* data, uint32_t size, bool coalesced) {
+            if (!m_slots) {
+                return; // Reserve() failed or was not called; the caller did not acknowledge it.
+            }
+            Slot& slot = SlotFor(channelSequence);
+            slot.arrived = true;
+            slot.coalesced = coalesced;
+            if (data && size > 0) {
+                slot.payload.assign(data, data + size);
+            }
+            else {
+                slot.payload.clear();
+            }
+        }
+
+        bool OrderedChannelReceiver::PopReady(std::vector<uint8_t>& out_payload, bool& out_coalesced) {
+            if (!m_slots) {
+                return false;
+            }
+            // Turns with nothing to deliver (incomplete fragments) are skipped.
+            while (SlotFor(m_nextExpected).arrived) {
+                Slot& slot = SlotFor(m_nextExpected);
+                slot.arrived = false;
+                ++m_nextExpected;
+                if (!slot.payload.empty()) {
+                    std::swap(out_payload, slot.payload);
+                    slot.payload.clear();
+                    out_coalesced = slot.coalesced;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void OrderedChannelReceiver::Clear() {
+            m_nextExpected = 0;
+            if (m_slots) {
+                for (uint32_t i = 0; i < ORDERED_CHANNEL_REORDER_WINDOW; ++i) {
+                    m_slots[i].arrived = false;
+                    m_slots[i].payload.clear();
+                }
+            }
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,213 @@
+﻿// File: FragmentReassembly.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements in-place reassembly of fragmented reliable messages.
+
+#include "FragmentReassembly.h"
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+
+#include <algorithm> // For std::sort
+#include <cstring>   // For std::memcpy
+#include <new>       // For std::nothrow
+
+namespace RiftForged {
+    namespace Networking {
+
+        std::atomic<uint64_t> FragmentReassembler::s_totalArenaBytes{ 0 };
+        std::atomic<uint64_t> FragmentReassembler::s_capRefusals{ 0 };
+
+        FragmentReassembler::~FragmentReassembler() {
+            if (m_arena) {
+                s_totalArenaBytes.fetch_sub(REASSEMBLY_ARENA_SIZE, std::memory_order_relaxed);
+            }
+        }
+
+        uint64_t FragmentReassembler::GetTotalArenaBytes() {
+            return s_totalArenaBytes.load(std::memory_order_relaxed);
+        }
+
+        uint64_t FragmentReassembler::GetCapRefusalCount() {
+            return s_capRefusals.load(std::memory_order_relaxed);
+        }
+
+        bool FragmentReassembler::EnsureArena() {
+            if (m_arena) {
+                return true;
+            }
+            const uint64_t previous = s_totalArenaBytes.fetch_add(REASSEMBLY_ARENA_SIZE, std::memory_order_relaxed);
+            if (previous + REASSEMBLY_ARENA_SIZE > REASSEMBLY_TOTAL_MEMORY_CAP) {
+                s_totalArenaBytes.fetch_sub(REASSEMBLY_ARENA_SIZE, std::memory_order_relaxed);
+                // Every fragment is refused while the cap holds; count them instead of logging each.
+                s_capRefusals.fetch_add(1, std::memory_order_relaxed);
+                RF_NETWORK_DEBUG("FragmentReassembler: Reassembly memory cap ({} bytes) reached. Refusing fragment.", REASSEMBLY_TOTAL_MEMORY_CAP);
+                return false;
+            }
+            m_arena.reset(new (std::nothrow) uint8_t[REASSEMBLY_ARENA_SIZE]);
+            if (!m_arena) {
+                s_totalArenaBytes.fetch_sub(REASSEMBLY_ARENA_SIZE, std::memory_order_relaxed);
+                RF_NETWORK_ERROR("FragmentReassembler: Failed to allocate a {} byte reassembly arena.", REASSEMBLY_ARENA_SIZE);
+                return false;
+            }
+            return true;
+        }
+
+        void FragmentReassembler::ReleaseArenaIfIdle() {
+            if (!m_arena) {
+                return;
+            }
+            for (const Slot& slot : m_slots) {
+                if (slot.inUse) {
+                    return;
+                }
+            }
+            m_arena.reset();
+            s_totalArenaBytes.fetch_sub(REASSEMBLY_ARENA_SIZE, std::memory_order_relaxed);
+        }
+
+        FragmentReassembler::Slot* FragmentReassembler::FindSlot(uint16_t messageId) {
+            for (Slot& slot : m_slots) {
+                if (slot.inUse && slot.messageId == messageId) {
+                    return &slot;
+                }
+            }
+            return nullptr;
+        }
+
+        FragmentReassembler::Slot* FragmentReassembler::AllocateSlot(uint32_t size) {
+            Slot* freeSlot = nullptr;
+            std::array<const Slot*, REASSEMBLY_MAX_CONCURRENT_MESSAGES> used{};
+            size_t usedCount = 0;
+            for (Slot& slot : m_slots) {
+                if (slot.inUse) {
+                    used[usedCount++] = &slot;
+                }
+                else if (!freeSlot) {
+                    freeSlot = &slot;
+                }
+            }
+            if (!freeSlot) {
+                return nullptr;
+            }
+
+            // First fit over the regions in arena order.
+            std::sort(used.begin(), used.begin() + usedCount,
+                [](const Slot* a, const Slot* b) { return a->offset < b->offset; });
+            uint32_t gapStart = 0;
+            for (size_t i = 0; i < usedCount; ++i) {
+                if (used[i]->offset - gapStart >= size) {
+                    break;
+                }
+                gapStart = used[i]->offset + used[i]->size;
+            }
+            if (REASSEMBLY_ARENA_SIZE - gapStart < size) {
+                return nullptr;
+            }
+
+            *freeSlot = Slot();
+            freeSlot->inUse = true;
+            freeSlot->offset = gapStart;
+            freeSlot->size = size;
+            return freeSlot;
+        }
+
+        void FragmentReassembler::ExpireStale(std::chrono::steady_clock::time_point now) {
+            const auto timeout = std::chrono::seconds(REASSEMBLY_TIMEOUT_SECONDS);
+            for (Slot& slot : m_slots) {
+                if (slot.inUse && !slot.complete && now - slot.lastArrival > timeout) {
+                    RF_NETWORK_WARN("FragmentReassembler: Message {} timed out with {}/{} fragments. Discarding.",
+                        slot.messageId, slot.receivedCount, slot.fragmentCount);
+                    slot.inUse = false;
+                }
+            }
+            ReleaseArenaIfIdle();
+        }
+
+        FragmentAcceptResult FragmentReassembler::Accept(const FragmentHeader& header,
+            const uint8_t* data,
+            uint32_t dataSize,
+            std::chrono::steady_clock::time_point now,
+            const uint8_t** out_message,
+            uint32_t* out_messageSize) {
+            if (out_message) *out_message = nullptr;
+            if (out_messageSize) *out_messageSize = 0;
+
+            const uint32_t messageSize = header.messageSize;
+            const uint32_t fragmentCount = header.fragmentCount;
+            if (fragmentCount < 2 || fragmentCount > MAX_FRAGMENTS_PER_MESSAGE ||
+                messageSize > REASSEMBLY_ARENA_SIZE || GetFragmentCount(messageSize) != fragmentCount ||
+                header.fragmentIndex >= fragmentCount) {
+                RF_NETWORK_WARN("FragmentReassembler: Malformed fragment header (message {}, fragment {}/{}, {} bytes).",
+                    header.messageId, header.fragmentIndex, fragmentCount, messageSize);
+                return FragmentAcceptResult::Rejected;
+            }
+            const uint32_t offsetInMessage = header.fragmentIndex * GetFragmentDataMaxSize();
+            const uint32_t expectedSize = std::min(GetFragmentDataMaxSize(), messageSize - offsetInMessage);
+            if (!data || dataSize != expectedSize) {
+                RF_NETWORK_WARN("FragmentReassembler: Fragment {}/{} of message {} carries {} bytes, expected {}.",
+                    header.fragmentIndex, fragmentCount, header.messageId, dataSize, expectedSize);
+                return FragmentAcceptResult::Rejected;
+            }
+
+            ExpireStale(now);
+
+            Slot* slot = FindSlot(header.messageId);
+            if (slot) {
+                if (slot->complete || slot->size != messageSize || slot->fragmentCount != fragmentCount) {
+                    RF_NETWORK_WARN("FragmentReassembler: Fragment for message {} does not match the message being rebuilt.", header.messageId);
+                    return FragmentAcceptResult::Rejected;
+                }
+            }
+            else {
+                if (!EnsureArena()) {
+                    return FragmentAcceptResult::Rejected;
+                }
+                slot = AllocateSlot(messageSize);
+                if (!slot) {
+                    RF_NETWORK_DEBUG("FragmentReassembler: No room for message {} ({} bytes) yet. Fragment will be retransmitted.",
+                        header.messageId, messageSize);
+                    return FragmentAcceptResult::Rejected;
+                }
+                slot->messageId = header.messageId;
+                slot->fragmentCount = static_cast<uint16_t>(fragmentCount);
+            }
+            slot->lastArrival = now;
+
+            uint64_t& word = slot->receivedBitmap[header.fragmentIndex / 64];
+            const uint64_t bit = 1ull << (header.fragmentIndex % 64);
+            if ((word & bit) == 0) {
+                std::memcpy(m_arena.get() + slot->offset + offsetInMessage, data, dataSize);
+                word |= bit;
+                ++slot->receivedCount;
+            }
+            if (slot->receivedCount < slot->fragmentCount) {
+                return FragmentAcceptResult::Stored;
+            }
+
+            slot->complete = true;
+            if (out_message) *out_message = m_arena.get() + slot->offset;
+            if (out_messageSize) *out_messageSize = slot->size;
+            return FragmentAcceptResult::Completed;
+        }
+
+        void FragmentReassembler::Release(const uint8_t* message) {
+            if (!m_arena || !message) {
+                return;
+            }
+            for (Slot& slot : m_slots) {
+                if (slot.inUse && slot.complete && m_arena.get() + slot.offset == message) {
+                    slot.inUse = false;
+                    ReleaseArenaIfIdle();
+                    return;
+                }
+            }
+        }
+
+        void FragmentReassembler::Clear() {
+            for (Slot& slot : m_slots) {
+                slot.inUse = false;
+            }
+            ReleaseArenaIfIdle();
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
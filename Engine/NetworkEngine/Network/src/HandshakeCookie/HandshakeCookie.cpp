@@ -0,0 +1,214 @@
+﻿// File: HandshakeCookie.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements stateless join cookies (SipHash-2-4 over endpoint and issue time) and
+// the session secret / rebind proof.
+
+#include "HandshakeCookie.h"
+#include <cstring>  // For std::memcpy
+#include <random>   // For std::random_device
+
+namespace RiftForged {
+    namespace Networking {
+
+        namespace {
+
+            inline uint64_t RotateLeft(uint64_t value, int bits) {
+                return (value << bits) | (value >> (64 - bits));
+            }
+
+            inline void SipRound(uint64_t& v0, uint64_t& v1, uint64_t& v2, uint64_t& v3) {
+                v0 += v1; v1 = RotateLeft(v1, 13); v1 ^= v0; v0 = RotateLeft(v0, 32);
+                v2 += v3; v3 = RotateLeft(v3, 16); v3 ^= v2;
+                v0 += v3; v3 = RotateLeft(v3, 21); v3 ^= v0;
+                v2 += v1; v1 = RotateLeft(v1, 17); v1 ^= v2; v2 = RotateLeft(v2, 32);
+            }
+
+            inline uint64_t LoadLE64(const uint8_t* bytes) {
+                uint64_t value = 0;
+                for (int i = 7; i >= 0; --i) {
+                    value = (value << 8) | bytes[i];
+                }
+                return value;
+            }
+
+            // SipHash-2-4 (Aumasson & Bernstein), 64-bit output.
+            uint64_t SipHash24(uint64_t k0, uint64_t k1, const uint8_t* data, size_t size) {
+                uint64_t v0 = 0x736F6D6570736575ull ^ k0;
+                uint64_t v1 = 0x646F72616E646F6Dull ^ k1;
+                uint64_t v2 = 0x6C7967656E657261ull ^ k0;
+                uint64_t v3 = 0x7465646279746573ull ^ k1;
+
+                const size_t fullBlocks = size / 8;
+                for (size_t block = 0; block < fullBlocks; ++block) {
+                    const uint64_t m = LoadLE64(data + block * 8);
+                    v3 ^= m;
+                    SipRound(v0, v1, v2, v3);
+                    SipRound(v0, v1, v2, v3);
+                    v0 ^= m;
+                }
+
+                uint64_t last = static_cast<uint64_t>(size & 0xFF) << 56;
+                const uint8_t* tail = data + fullBlocks * 8;
+                for (size_t i = 0; i < (size & 7); ++i) {
+                    last |= static_cast<uint64_t>(tail[i]) << (8 * i);
+                }
+                v3 ^= last;
+                SipRound(v0, v1, v2, v3);
+                SipRound(v0, v1, v2, v3);
+                v0 ^= last;
+
+                v2 ^= 0xFF;
+                for (int round = 0; round < 4; ++round) {
+                    SipRound(v0, v1, v2, v3);
+                }
+                return v0 ^ v1 ^ v2 ^ v3;
+            }
+
+            // address[16] | port (LE) | family: the endpoint bytes every MAC here covers.
+            const size_t ENDPOINT_MAC_BYTES = 16 + 2 + 1;
+
+            void WriteEndpointMacBytes(const NetworkEndpoint& endpoint, uint8_t* out) {
+                std::memcpy(out, endpoint.GetAddressBytes().data(), 16);
+                out[16] = static_cast<uint8_t>(endpoint.GetPort());
+                out[17] = static_cast<uint8_t>(endpoint.GetPort() >> 8);
+                out[18] = static_cast<uint8_t>(endpoint.GetFamily());
+            }
+
+            uint64_t ComputeRebindMac(const SessionSecret& secret, uint32_t connectionId,
+                const NetworkEndpoint& newEndpoint, const uint8_t* cookie) {
+                static_assert(SESSION_SECRET_SIZE == 16, "The session secret is the 128-bit SipHash key");
+                // connectionId (LE) | endpoint | cookie
+                uint8_t message[4 + ENDPOINT_MAC_BYTES + HANDSHAKE_COOKIE_SIZE];
+                for (int i = 0; i < 4; ++i) {
+                    message[i] = static_cast<uint8_t>(connectionId >> (8 * i));
+                }
+                WriteEndpointMacBytes(newEndpoint, message + 4);
+                std::memcpy(message + 4 + ENDPOINT_MAC_BYTES, cookie, HANDSHAKE_COOKIE_SIZE);
+                return SipHash24(LoadLE64(secret.data()), LoadLE64(secret.data() + 8), message, sizeof(message));
+            }
+
+        } // anonymous namespace
+
+        HandshakeCookieGenerator::HandshakeCookieGenerator()
+            : m_epoch(std::chrono::steady_clock::now()) {
+            std::random_device entropy;
+            m_key0 = (static_cast<uint64_t>(entropy()) << 32) | entropy();
+            m_key1 = (static_cast<uint64_t>(entropy()) << 32) | entropy();
+        }
+
+        uint32_t HandshakeCookieGenerator::ToSeconds(std::chrono::steady_clock::time_point now) const {
+            if (now <= m_epoch) return 0;
+            return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now - m_epoch).count());
+        }
+
+        uint64_t HandshakeCookieGenerator::ComputeMac(const NetworkEndpoint& endpoint, uint32_t issuedAt) const {
+            // endpoint | issuedAt (LE)
+            uint8_t message[ENDPOINT_MAC_BYTES + 4];
+            WriteEndpointMacBytes(endpoint, message);
+            for (int i = 0; i < 4; ++i) {
+                message[ENDPOINT_MAC_BYTES + i] = static_cast<uint8_t>(issuedAt >> (8 * i));
+            }
+            return SipHash24(m_key0, m_key1, message, sizeof(message));
+        }
+
+        HandshakeCookieGenerator::Cookie HandshakeCookieGenerator::Generate(const NetworkEndpoint& endpoint,
+            std::chrono::steady_clock::time_point now) const {
+            const uint32_t issuedAt = ToSeconds(now);
+            const uint64_t mac = ComputeMac(endpoint, issuedAt);
+            Cookie cookie{};
+            for (int i = 0; i < 4; ++i) {
+                cookie[i] = static_cast<uint8_t>(issuedAt >> (8 * i));
+            }
+            for (int i = 0; i < 8; ++i) {
+                cookie[4 + i] = static_cast<uint8_t>(mac >> (8 * i));
+            }
+            return cookie;
+        }
+
+        bool HandshakeCookieGenerator::Validate(const NetworkEndpoint& endpoint, const uint8_t* cookie, uint32_t cookieSize,
+            std::chrono::steady_clock::time_point now) const {
+            if (!cookie || cookieSize < HANDSHAKE_COOKIE_SIZE) {
+                return false;
+            }
+            uint32_t issuedAt = 0;
+            for (int i = 3; i >= 0; --i) {
+                issuedAt = (issuedAt << 8) | cookie[i];
+            }
+            const uint32_t nowSeconds = ToSeconds(now);
+            if (issuedAt > nowSeconds || nowSeconds - issuedAt > HANDSHAKE_COOKIE_LIFETIME_SECONDS) {
+                return false;
+            }
+            const uint64_t expected = ComputeMac(endpoint, issuedAt);
+            // Constant-time compare so the MAC cannot be recovered byte by byte from timing.
+            uint8_t difference = 0;
+            for (int i = 0; i < 8; ++i) {
+                difference |= static_cast<uint8_t>(cookie[4 + i] ^ static_cast<uint8_t>(expected >> (8 * i)));
+            }
+            return difference == 0;
+        }
+
+        void WriteObservedEndpoint(const NetworkEndpoint& endpoint, uint8_t* out) {
+            out[0] = static_cast<uint8_t>(endpoint.GetFamily());
+            out[1] = static_cast<uint8_t>(endpoint.GetPort());
+            out[2] = static_cast<uint8_t>(endpoint.GetPort() >> 8);
+            std::memcpy(out + 3, endpoint.GetAddressBytes().data(), 16);
+        }
+
+        bool ReadObservedEndpoint(const uint8_t* data, uint32_t size, NetworkEndpoint& out_endpoint) {
+            if (!data || size < HANDSHAKE_OBSERVED_ENDPOINT_SIZE) {
+                return false;
+            }
+            const uint16_t port = static_cast<uint16_t>(data[1] | (data[2] << 8));
+            if (data[0] == static_cast<uint8_t>(NetworkEndpoint::Family::IPv4)) {
+                uint32_t ipv4 = 0;
+                std::memcpy(&ipv4, data + 3, sizeof(ipv4));
+                out_endpoint = NetworkEndpoint::FromIPv4(ipv4, port);
+                return true;
+            }
+            if (data[0] == static_cast<uint8_t>(NetworkEndpoint::Family::IPv6)) {
+                uint8_t ipv6[16];
+                std::memcpy(ipv6, data + 3, sizeof(ipv6));
+                out_endpoint = NetworkEndpoint::FromIPv6(ipv6, port);
+                return true;
+            }
+            return false;
+        }
+
+        SessionSecret GenerateSessionSecret() {
+            std::random_device entropy;
+            SessionSecret secret;
+            for (size_t i = 0; i < secret.size(); i += 4) {
+                const uint32_t word = entropy();
+                for (size_t b = 0; b < 4; ++b) {
+                    secret[i + b] = static_cast<uint8_t>(word >> (8 * b));
+                }
+            }
+            return secret;
+        }
+
+        SessionRebindProof ComputeSessionRebindProof(const SessionSecret& secret, uint32_t connectionId,
+            const NetworkEndpoint& newEndpoint, const uint8_t* cookie) {
+            const uint64_t mac = ComputeRebindMac(secret, connectionId, newEndpoint, cookie);
+            SessionRebindProof proof{};
+            for (int i = 0; i < 8; ++i) {
+                proof[i] = static_cast<uint8_t>(mac >> (8 * i));
+            }
+            return proof;
+        }
+
+        bool ValidateSessionRebindProof(const SessionSecret& secret, uint32_t connectionId,
+            const NetworkEndpoint& newEndpoint, const uint8_t* cookie, const uint8_t* proof, uint32_t proofSize) {
+            if (!cookie || !proof || proofSize < SESSION_REBIND_PROOF_SIZE) {
+                return false;
+            }
+            const uint64_t expected = ComputeRebindMac(secret, connectionId, newEndpoint, cookie);
+            uint8_t difference = 0;
+            for (int i = 0; i < 8; ++i) {
+                difference |= static_cast<uint8_t>(proof[i] ^ static_cast<uint8_t>(expected >> (8 * i)));
+            }
+            return difference == 0;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
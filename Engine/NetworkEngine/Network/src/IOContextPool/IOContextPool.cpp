@@ -0,0 +1,123 @@
+﻿// File: IOContextPool.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the lock-free OverlappedIOContext pool.
+
+#include "IOContextPool.h"
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <new>                   // For std::align_val_t, std::bad_alloc
+#include <span>                  // For std::span
+
+namespace RiftForged {
+    namespace Networking {
+
+        IOContextPool::~IOContextPool() {
+            Clear();
+        }
+
+        bool IOContextPool::Initialize(IOOperationType opType, uint32_t contextCount, uint32_t bufferSize) {
+            Clear();
+            if (contextCount == 0 || contextCount == INVALID_INDEX) {
+                RF_NETWORK_ERROR("IOContextPool: Invalid context count {}.", contextCount);
+                return false;
+            }
+
+            m_bufferStride = ((static_cast<size_t>(bufferSize) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+            try {
+                if (m_bufferStride > 0) {
+                    m_slab = static_cast<char*>(::operator new[](m_bufferStride * contextCount, std::align_val_t{ CACHE_LINE_SIZE }));
+                }
+                m_next = std::make_unique<std::atomic<uint32_t>[]>(contextCount);
+                m_contexts.reserve(contextCount);
+                for (uint32_t i = 0; i < contextCount; ++i) {
+                    std::span<char> storage(m_slab ? m_slab + (m_bufferStride * i) : nullptr, bufferSize);
+                    m_contexts.emplace_back(opType, storage);
+                    m_contexts.back().poolIndex = i;
+                }
+            }
+            catch (const std::bad_alloc& e) {
+                RF_NETWORK_CRITICAL("IOContextPool: Failed to allocate {} contexts of {} bytes: {}", contextCount, bufferSize, e.what());
+                Clear();
+                return false;
+            }
+
+            // Chain every index into the free list: 0 -> 1 -> ... -> n-1 -> INVALID.
+            for (uint32_t i = 0; i < contextCount; ++i) {
+                m_next[i].store(i + 1 < contextCount ? i + 1 : INVALID_INDEX, std::memory_order_relaxed);
+            }
+            m_capacity = contextCount;
+            m_bufferSize = bufferSize;
+            m_inUse.store(0, std::memory_order_relaxed);
+            m_head.store(PackHead(0, 0), std::memory_order_release);
+
+            RF_NETWORK_DEBUG("IOContextPool: Initialized {} contexts, {} byte buffers ({} byte stride).", contextCount, bufferSize, m_bufferStride);
+            return true;
+        }
+
+        void IOContextPool::Clear() {
+            m_head.store(PackHead(0, INVALID_INDEX), std::memory_order_release);
+            m_contexts.clear();
+            m_next.reset();
+            if (m_slab) {
+                ::operator delete[](m_slab, std::align_val_t{ CACHE_LINE_SIZE });
+                m_slab = nullptr;
+            }
+            m_capacity = 0;
+            m_bufferSize = 0;
+            m_bufferStride = 0;
+        }
+
+        OverlappedIOContext* IOContextPool::Acquire() {
+            uint64_t head = m_head.load(std::memory_order_acquire);
+            for (;;) {
+                const uint32_t index = HeadIndex(head);
+                if (index == INVALID_INDEX) {
+                    m_exhaustions.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+                // m_next[index] may be stale if another thread popped 'index' meanwhile; the tag
+                // bump on every push/pop makes the CAS below fail in that case.
+                const uint32_t next = m_next[index].load(std::memory_order_relaxed);
+                if (m_head.compare_exchange_weak(head, PackHead(HeadTag(head) + 1, next),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    m_acquires.fetch_add(1, std::memory_order_relaxed);
+                    m_inUse.fetch_add(1, std::memory_order_relaxed);
+                    return &m_contexts[index];
+                }
+            }
+        }
+
+        void IOContextPool::Return(OverlappedIOContext* pContext) {
+            if (!Owns(pContext)) {
+                RF_NETWORK_ERROR("IOContextPool: Return called with a context {} not owned by this pool.", static_cast<void*>(pContext));
+                return;
+            }
+            const uint32_t index = pContext->poolIndex;
+            uint64_t head = m_head.load(std::memory_order_relaxed);
+            for (;;) {
+                m_next[index].store(HeadIndex(head), std::memory_order_relaxed);
+                if (m_head.compare_exchange_weak(head, PackHead(HeadTag(head) + 1, index),
+                    std::memory_order_release, std::memory_order_relaxed)) {
+                    m_inUse.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        bool IOContextPool::Owns(const OverlappedIOContext* pContext) const {
+            return pContext != nullptr &&
+                pContext->poolIndex < m_capacity &&
+                &m_contexts[pContext->poolIndex] == pContext;
+        }
+
+        IOContextPoolStats IOContextPool::GetStats() const {
+            IOContextPoolStats stats;
+            stats.capacity = m_capacity;
+            stats.inUse = m_inUse.load(std::memory_order_relaxed);
+            stats.acquires = m_acquires.load(std::memory_order_relaxed);
+            stats.exhaustions = m_exhaustions.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,302 @@
+﻿// File: ImpairedNetworkIO.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the latency/loss/reorder/duplication decorator for INetworkIO.
+
+#include "ImpairedNetworkIO.h"
+#include "OverlappedIOContext.h" // Forwarded through OnSendCompleted
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <algorithm>             // For std::max
+#include <stdexcept>             // For std::invalid_argument
+#include <system_error>          // For std::system_error
+
+// Outbound RNG stream is derived from the configured seed so both directions are independent
+// but still fully determined by one number.
+static const uint64_t IMPAIRMENT_OUTBOUND_SEED_SALT = 0x9E3779B97F4A7C15ull;
+
+namespace RiftForged {
+    namespace Networking {
+
+        ImpairedNetworkIO::ImpairedNetworkIO(INetworkIO* innerIO, const NetworkImpairmentConfig& config)
+            : m_innerIO(innerIO),
+            m_eventHandler(nullptr),
+            m_isRunning(false) {
+            if (!m_innerIO) {
+                throw std::invalid_argument("ImpairedNetworkIO: inner INetworkIO cannot be null.");
+            }
+            m_inbound.profile = config.inbound;
+            m_inbound.rng.seed(config.seed);
+            m_outbound.profile = config.outbound;
+            m_outbound.rng.seed(config.seed ^ IMPAIRMENT_OUTBOUND_SEED_SALT);
+            RF_NETWORK_INFO("ImpairedNetworkIO: Constructed (seed {:#x}, inbound delay {}ms +/- {}ms, outbound delay {}ms +/- {}ms).",
+                config.seed, config.inbound.baseDelayMs, config.inbound.jitterMs,
+                config.outbound.baseDelayMs, config.outbound.jitterMs);
+        }
+
+        ImpairedNetworkIO::~ImpairedNetworkIO() {
+            Stop();
+        }
+
+        bool ImpairedNetworkIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+            if (!eventHandler) {
+                RF_NETWORK_CRITICAL("ImpairedNetworkIO: Initialization failed - INetworkIOEvents handler is null.");
+                return false;
+            }
+            m_eventHandler = eventHandler;
+            // The inner transport reports to us; survivors are forwarded to the real handler.
+            return m_innerIO->Init(listenIp, listenPort, this);
+        }
+
+        bool ImpairedNetworkIO::Start() {
+            if (m_isRunning.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN("ImpairedNetworkIO: Already running.");
+                return true;
+            }
+            m_isRunning.store(true, std::memory_order_release);
+            try {
+                m_schedulerThread = std::thread(&ImpairedNetworkIO::SchedulerThread, this);
+            }
+            catch (const std::system_error& e) {
+                RF_NETWORK_CRITICAL("ImpairedNetworkIO: Failed to create scheduler thread: {}", e.what());
+                m_isRunning.store(false, std::memory_order_release);
+                return false;
+            }
+            if (!m_innerIO->Start()) {
+                RF_NETWORK_ERROR("ImpairedNetworkIO: Inner transport failed to start.");
+                Stop();
+                return false;
+            }
+            return true;
+        }
+
+        void ImpairedNetworkIO::Stop() {
+            // Stop the inner transport first so nothing new is scheduled while we wind down.
+            m_innerIO->Stop();
+            if (!m_isRunning.exchange(false, std::memory_order_acq_rel)) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_scheduleMutex);
+            }
+            m_scheduleCondition.notify_all();
+            if (m_schedulerThread.joinable()) {
+                m_schedulerThread.join();
+            }
+
+            size_t discarded = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_scheduleMutex);
+                discarded = m_schedule.size();
+                m_schedule = {};
+            }
+            RF_NETWORK_INFO("ImpairedNetworkIO: Stopped. {} delayed datagrams discarded.", discarded);
+        }
+
+        bool ImpairedNetworkIO::IsRunning() const {
+            return m_isRunning.load(std::memory_order_acquire) && m_innerIO->IsRunning();
+        }
+
+        bool ImpairedNetworkIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            if (m_outbound.profile.IsPassThrough()) {
+                return m_innerIO->SendData(recipient, data, size);
+            }
+            if (data == nullptr && size > 0) {
+                RF_NETWORK_ERROR("ImpairedNetworkIO::SendData: Null data for {} bytes to {}.", size, recipient.ToString());
+                return false;
+            }
+            // Like a real network, a datagram the impairment swallows still counts as sent.
+            std::lock_guard<std::mutex> lock(m_directionMutex);
+            ImpairAndSchedule(m_outbound, false, recipient, 0, data, size);
+            return true;
+        }
+
+        bool ImpairedNetworkIO::QueueSendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            if (m_outbound.profile.IsPassThrough()) {
+                return m_innerIO->QueueSendData(recipient, data, size);
+            }
+            // Scheduled datagrams are pushed through the inner queue by the scheduler thread.
+            return SendData(recipient, data, size);
+        }
+
+        void ImpairedNetworkIO::FlushSendQueue() {
+            if (m_outbound.profile.IsPassThrough()) {
+                m_innerIO->FlushSendQueue();
+            }
+            // Otherwise the scheduler flushes after releasing each group of due datagrams.
+        }
+
+        void ImpairedNetworkIO::OnRawDataReceived(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size, OverlappedIOContext* context) {
+            if (m_inbound.profile.IsPassThrough()) {
+                m_eventHandler->OnRawDataReceived(sender, data, size, context);
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_directionMutex);
+            ImpairAndSchedule(m_inbound, true, sender, 0, data, size);
+        }
+
+        void ImpairedNetworkIO::OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) {
+            if (m_inbound.profile.IsPassThrough()) {
+                m_eventHandler->OnRawDataBatchReceived(datagrams);
+                return;
+            }
+            // The receive buffers belong to the inner transport and are recycled once we return,
+            // so every surviving datagram is copied into the schedule.
+            std::lock_guard<std::mutex> lock(m_directionMutex);
+            for (const ReceivedDatagram& datagram : datagrams) {
+                ImpairAndSchedule(m_inbound, true, datagram.sender, datagram.ioShard, datagram.data, datagram.size);
+            }
+        }
+
+        void ImpairedNetworkIO::OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) {
+            m_eventHandler->OnSendCompleted(context, success, bytesSent);
+        }
+
+        void ImpairedNetworkIO::OnNetworkError(const std::string& errorMessage, int errorCode) {
+            m_eventHandler->OnNetworkError(errorMessage, errorCode);
+        }
+
+        ImpairmentStats ImpairedNetworkIO::GetImpairmentStats() const {
+            std::lock_guard<std::mutex> lock(m_directionMutex);
+            ImpairmentStats stats;
+            stats.inbound = m_inbound.stats;
+            stats.outbound = m_outbound.stats;
+            return stats;
+        }
+
+        double ImpairedNetworkIO::SampleDelayMs(DirectionState& direction) {
+            const NetworkImpairmentProfile& profile = direction.profile;
+            double delayMs = profile.baseDelayMs;
+            if (profile.jitterMs > 0.0) {
+                switch (profile.delayDistribution) {
+                case DelayDistribution::Constant:
+                    break;
+                case DelayDistribution::Uniform: {
+                    std::uniform_real_distribution<double> jitter(-profile.jitterMs, profile.jitterMs);
+                    delayMs += jitter(direction.rng);
+                    break;
+                }
+                case DelayDistribution::Normal: {
+                    std::normal_distribution<double> jitter(0.0, profile.jitterMs);
+                    delayMs += jitter(direction.rng);
+                    break;
+                }
+                case DelayDistribution::Exponential: {
+                    std::exponential_distribution<double> tail(1.0 / profile.jitterMs);
+                    delayMs += tail(direction.rng);
+                    break;
+                }
+                }
+            }
+            return std::max(0.0, delayMs);
+        }
+
+        int ImpairedNetworkIO::ImpairAndSchedule(DirectionState& direction, bool inbound, const NetworkEndpoint& peer,
+            uint32_t ioShard, const uint8_t* data, uint32_t size) {
+            const NetworkImpairmentProfile& profile = direction.profile;
+            std::uniform_real_distribution<double> unit(0.0, 1.0);
+            direction.stats.packets++;
+
+            // Gilbert-Elliott: move between states first, then roll loss for the current state.
+            if (direction.inBadState) {
+                if (unit(direction.rng) < profile.badToGoodProbability) {
+                    direction.inBadState = false;
+                }
+            }
+            else if (unit(direction.rng) < profile.goodToBadProbability) {
+                direction.inBadState = true;
+                direction.stats.burstEntries++;
+            }
+            const double lossProbability = direction.inBadState ? profile.lossProbabilityBad : profile.lossProbabilityGood;
+            if (lossProbability > 0.0 && unit(direction.rng) < lossProbability) {
+                direction.stats.dropped++;
+                return 0;
+            }
+
+            int copies = 1;
+            if (profile.duplicateProbability > 0.0 && unit(direction.rng) < profile.duplicateProbability) {
+                copies = 2;
+                direction.stats.duplicated++;
+            }
+
+            const Clock::time_point now = Clock::now();
+            std::lock_guard<std::mutex> lock(m_scheduleMutex);
+            for (int copy = 0; copy < copies; ++copy) {
+                double delayMs = SampleDelayMs(direction);
+                if (profile.reorderProbability > 0.0 && unit(direction.rng) < profile.reorderProbability) {
+                    delayMs += profile.reorderExtraDelayMs;
+                    direction.stats.reordered++;
+                }
+                ScheduledDatagram scheduled;
+                scheduled.due = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(delayMs));
+                scheduled.order = m_nextOrder++;
+                scheduled.inbound = inbound;
+                scheduled.ioShard = ioShard;
+                scheduled.peer = peer;
+                if (size > 0) {
+                    scheduled.data.assign(data, data + size);
+                }
+                m_schedule.push(std::move(scheduled));
+            }
+            m_scheduleCondition.notify_one();
+            return copies;
+        }
+
+        void ImpairedNetworkIO::SchedulerThread() {
+            RF_NETWORK_INFO("ImpairedNetworkIO: Scheduler thread started.");
+            std::vector<ScheduledDatagram> due;
+            std::vector<ReceivedDatagram> inboundBatch;
+
+            while (m_isRunning.load(std::memory_order_acquire)) {
+                {
+                    std::unique_lock<std::mutex> lock(m_scheduleMutex);
+                    if (m_schedule.empty()) {
+                        m_scheduleCondition.wait(lock, [this] {
+                            return !m_schedule.empty() || !m_isRunning.load(std::memory_order_acquire);
+                        });
+                    }
+                    else {
+                        // Copy: the heap can change while the lock is released. Wakes early if
+                        // something with an earlier due time is scheduled meanwhile.
+                        const Clock::time_point nextDue = m_schedule.top().due;
+                        m_scheduleCondition.wait_until(lock, nextDue);
+                    }
+                    const Clock::time_point now = Clock::now();
+                    while (!m_schedule.empty() && m_schedule.top().due <= now) {
+                        // priority_queue::top is const; the element is popped right after, so moving is safe.
+                        due.push_back(std::move(const_cast<ScheduledDatagram&>(m_schedule.top())));
+                        m_schedule.pop();
+                    }
+                }
+                if (due.empty()) {
+                    continue;
+                }
+
+                bool sentAny = false;
+                inboundBatch.clear();
+                for (const ScheduledDatagram& scheduled : due) {
+                    if (scheduled.inbound) {
+                        ReceivedDatagram& datagram = inboundBatch.emplace_back();
+                        datagram.sender = scheduled.peer;
+                        datagram.data = scheduled.data.empty() ? nullptr : scheduled.data.data();
+                        datagram.size = static_cast<uint32_t>(scheduled.data.size());
+                        datagram.context = nullptr; // The original receive context was recycled long ago.
+                        datagram.ioShard = scheduled.ioShard;
+                    }
+                    else {
+                        m_innerIO->QueueSendData(scheduled.peer, scheduled.data.data(), static_cast<uint32_t>(scheduled.data.size()));
+                        sentAny = true;
+                    }
+                }
+                if (sentAny) {
+                    m_innerIO->FlushSendQueue();
+                }
+                if (!inboundBatch.empty()) {
+                    m_eventHandler->OnRawDataBatchReceived(std::span<const ReceivedDatagram>(inboundBatch));
+                }
+                due.clear();
+            }
+            RF_NETWORK_INFO("ImpairedNetworkIO: Scheduler thread exiting gracefully.");
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
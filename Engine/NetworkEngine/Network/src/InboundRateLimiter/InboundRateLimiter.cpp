@@ -0,0 +1,76 @@
+﻿// File: InboundRateLimiter.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the lock-free token buckets of InboundRateLimiter.
+
+#include "InboundRateLimiter.h"
+
+#include <algorithm> // For std::max
+
+namespace RiftForged {
+    namespace Networking {
+
+        void TokenBucket::Configure(const InboundRateLimit& limit) {
+            if (limit.ratePerSecond == 0) {
+                m_emissionIntervalNanos = 0;
+                m_burstToleranceNanos = 0;
+            }
+            else {
+                m_emissionIntervalNanos = std::max<int64_t>(1, 1000000000LL / limit.ratePerSecond);
+                m_burstToleranceNanos = m_emissionIntervalNanos * (std::max<uint32_t>(limit.burst, 1) - 1);
+            }
+            m_fullAtNanos.store(0, std::memory_order_relaxed);
+        }
+
+        bool TokenBucket::TryConsume(std::chrono::steady_clock::time_point now) {
+            if (m_emissionIntervalNanos == 0) {
+                return true;
+            }
+            const int64_t nowNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+            int64_t fullAt = m_fullAtNanos.load(std::memory_order_relaxed);
+            for (;;) {
+                // A bucket that has been full since before 'now' starts from now, not from the past.
+                const int64_t base = std::max(fullAt, nowNanos);
+                if (base - nowNanos > m_burstToleranceNanos) {
+                    return false;
+                }
+                if (m_fullAtNanos.compare_exchange_weak(fullAt, base + m_emissionIntervalNanos, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        InboundRateLimiter::InboundRateLimiter() {
+            for (uint32_t i = 0; i < INBOUND_RATE_CLASS_COUNT; ++i) {
+                m_buckets[i].Configure(GetDefaultInboundRateLimit(static_cast<InboundRateClass>(i)));
+            }
+        }
+
+        void InboundRateLimiter::Configure(const std::array<InboundRateLimit, INBOUND_RATE_CLASS_COUNT>& limits) {
+            for (uint32_t i = 0; i < INBOUND_RATE_CLASS_COUNT; ++i) {
+                m_buckets[i].Configure(limits[i]);
+            }
+        }
+
+        bool InboundRateLimiter::Admit(InboundRateClass rateClass, std::chrono::steady_clock::time_point now) {
+            const uint32_t index = static_cast<uint32_t>(rateClass);
+            if (index >= INBOUND_RATE_CLASS_COUNT) {
+                return false;
+            }
+            if (m_buckets[index].TryConsume(now)) {
+                return true;
+            }
+            m_dropped[index].fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        InboundRateLimitStats InboundRateLimiter::GetStats() const {
+            InboundRateLimitStats stats;
+            for (uint32_t i = 0; i < INBOUND_RATE_CLASS_COUNT; ++i) {
+                stats.dropped[i] = m_dropped[i].load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,289 @@
+﻿// File: LoopbackNetworkIO.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the memory-backed loopback INetworkIO and its routing hub.
+
+#include "LoopbackNetworkIO.h"
+#include "OverlappedIOContext.h" // For the context reported through OnSendCompleted
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <cstring>               // For memcpy
+#include <algorithm>             // For std::min
+#include <stdexcept>             // For std::invalid_argument
+#include <chrono>                // For idle wait timeout
+#include <span>                  // For std::span
+#include <system_error>          // For std::system_error
+
+// Idle delivery threads re-check the queue at least this often, bounding a missed wake-up.
+static const auto LOOPBACK_IDLE_WAIT = std::chrono::milliseconds(1);
+// Empty polls a delivery thread spins through (yielding) before it parks on the condition variable.
+static const int LOOPBACK_IDLE_SPINS = 64;
+
+namespace RiftForged {
+    namespace Networking {
+
+        // --- LoopbackNetworkHub ---
+
+        bool LoopbackNetworkHub::Attach(const NetworkEndpoint& endpoint, LoopbackNetworkIO* io) {
+            std::unique_lock<std::shared_mutex> lock(m_bindingsMutex);
+            auto result = m_bindings.emplace(endpoint, io);
+            return result.second;
+        }
+
+        void LoopbackNetworkHub::Detach(const NetworkEndpoint& endpoint, LoopbackNetworkIO* io) {
+            std::unique_lock<std::shared_mutex> lock(m_bindingsMutex);
+            auto it = m_bindings.find(endpoint);
+            if (it != m_bindings.end() && it->second == io) {
+                m_bindings.erase(it);
+            }
+        }
+
+        bool LoopbackNetworkHub::Route(const NetworkEndpoint& sender, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            std::shared_lock<std::shared_mutex> lock(m_bindingsMutex);
+            auto it = m_bindings.find(recipient);
+            if (it == m_bindings.end()) {
+                it = m_bindings.find(NetworkEndpoint::FromIPv4(0, recipient.GetPort()));
+            }
+            if (it == m_bindings.end()) {
+                m_unroutable.fetch_add(1, std::memory_order_relaxed);
+                return true; // Nobody listening: UDP drops silently.
+            }
+            // The shared lock keeps the target attached (and alive) while we enqueue.
+            return it->second->Enqueue(sender, data, size);
+        }
+
+        // --- LoopbackNetworkIO ---
+
+        LoopbackNetworkIO::LoopbackNetworkIO(std::shared_ptr<LoopbackNetworkHub> hub,
+            LoopbackDeliveryMode deliveryMode,
+            uint32_t queueCapacity)
+            : m_hub(std::move(hub)),
+            m_deliveryMode(deliveryMode),
+            m_eventHandler(nullptr),
+            m_attached(false),
+            m_mask(0),
+            m_isRunning(false)
+        {
+            if (!m_hub) {
+                throw std::invalid_argument("LoopbackNetworkHub cannot be null in LoopbackNetworkIO constructor");
+            }
+            uint64_t capacity = 2;
+            while (capacity < queueCapacity) capacity <<= 1;
+            m_slots = std::make_unique<Slot[]>(capacity);
+            for (uint64_t i = 0; i < capacity; ++i) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            m_mask = capacity - 1;
+            m_deliveryBatch.reserve(LOOPBACK_DELIVERY_BATCH_SIZE);
+        }
+
+        LoopbackNetworkIO::~LoopbackNetworkIO() {
+            Stop();
+            if (m_attached) {
+                m_hub->Detach(m_localEndpoint, this);
+                m_attached = false;
+            }
+        }
+
+        bool LoopbackNetworkIO::IsRunning() const {
+            return m_isRunning.load(std::memory_order_acquire);
+        }
+
+        bool LoopbackNetworkIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+            if (!eventHandler) {
+                RF_NETWORK_CRITICAL("LoopbackNetworkIO: Initialization failed - INetworkIOEvents handler is null.");
+                return false;
+            }
+            if (m_attached) {
+                RF_NETWORK_WARN("LoopbackNetworkIO: Already bound to {}.", m_localEndpoint.ToString());
+                return false;
+            }
+            NetworkEndpoint endpoint(listenIp, listenPort);
+            if (!m_hub->Attach(endpoint, this)) {
+                RF_NETWORK_ERROR("LoopbackNetworkIO: {} is already bound on this hub.", endpoint.ToString());
+                eventHandler->OnNetworkError("loopback endpoint already in use", 0);
+                return false;
+            }
+            m_eventHandler = eventHandler;
+            m_localEndpoint = endpoint;
+            m_attached = true;
+            RF_NETWORK_INFO("LoopbackNetworkIO: Bound to {} (queue depth {}).", m_localEndpoint.ToString(), m_mask + 1);
+            return true;
+        }
+
+        bool LoopbackNetworkIO::Start() {
+            if (!m_attached) {
+                RF_NETWORK_ERROR("LoopbackNetworkIO: Cannot start. Init was not called or failed.");
+                return false;
+            }
+            if (m_isRunning.exchange(true, std::memory_order_acq_rel)) {
+                RF_NETWORK_WARN("LoopbackNetworkIO: Already running.");
+                return true;
+            }
+            if (m_deliveryMode == LoopbackDeliveryMode::Thread) {
+                try {
+                    m_deliveryThread = std::thread(&LoopbackNetworkIO::DeliveryThread, this);
+                }
+                catch (const std::system_error& e) {
+                    RF_NETWORK_CRITICAL("LoopbackNetworkIO: Failed to create delivery thread: {}", e.what());
+                    m_isRunning.store(false, std::memory_order_release);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void LoopbackNetworkIO::Stop() {
+            if (!m_isRunning.exchange(false, std::memory_order_acq_rel)) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+            }
+            m_wakeCondition.notify_all();
+            if (m_deliveryThread.joinable()) {
+                m_deliveryThread.join();
+            }
+            RF_NETWORK_INFO("LoopbackNetworkIO: {} stopped.", m_localEndpoint.ToString());
+        }
+
+        bool LoopbackNetworkIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            if (!m_attached) {
+                RF_NETWORK_ERROR("LoopbackNetworkIO::SendData: Not bound. Cannot send to {}.", recipient.ToString());
+                return false;
+            }
+            if ((data == nullptr && size > 0) || size > LOOPBACK_MAX_DATAGRAM_SIZE) {
+                RF_NETWORK_ERROR("LoopbackNetworkIO::SendData: Invalid datagram ({} bytes) to {}.", size, recipient.ToString());
+                return false;
+            }
+
+            const bool accepted = m_hub->Route(m_localEndpoint, recipient, data, size);
+            if (accepted) {
+                m_datagramsSent.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (m_eventHandler) {
+                OverlappedIOContext sendContext(IOOperationType::Send);
+                m_eventHandler->OnSendCompleted(&sendContext, accepted, accepted ? size : 0);
+            }
+            return accepted;
+        }
+
+        NetworkIOStats LoopbackNetworkIO::GetIOStats() const {
+            NetworkIOStats stats;
+            stats.receiveSyscalls = m_deliveries.load(std::memory_order_relaxed);
+            stats.datagramsReceived = m_datagramsReceived.load(std::memory_order_relaxed);
+            stats.sendSyscalls = m_datagramsSent.load(std::memory_order_relaxed); // One enqueue per datagram.
+            stats.datagramsSent = m_datagramsSent.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        size_t LoopbackNetworkIO::Poll(size_t maxDatagrams) {
+            if (m_deliveryMode != LoopbackDeliveryMode::Manual) {
+                RF_NETWORK_WARN("LoopbackNetworkIO::Poll: {} uses a delivery thread; Poll ignored.", m_localEndpoint.ToString());
+                return 0;
+            }
+            size_t total = 0;
+            while (total < maxDatagrams) {
+                size_t delivered = DeliverBatch(maxDatagrams - total);
+                if (delivered == 0) break;
+                total += delivered;
+            }
+            return total;
+        }
+
+        bool LoopbackNetworkIO::Enqueue(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size) {
+            // Bounded MPMC ring (Vyukov): a slot is free for position 'pos' when its sequence == pos.
+            uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+            Slot* slot = nullptr;
+            for (;;) {
+                slot = &m_slots[pos & m_mask];
+                const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+                if (diff == 0) {
+                    if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if (diff < 0) {
+                    m_queueFullDrops.fetch_add(1, std::memory_order_relaxed);
+                    return false; // Ring full; the consumer has not released this slot yet.
+                }
+                else {
+                    pos = m_enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->sender = sender;
+            slot->size = size;
+            if (size > 0) {
+                std::memcpy(slot->data, data, size);
+            }
+            slot->sequence.store(pos + 1, std::memory_order_release); // Publish to the consumer.
+
+            if (m_consumerSleeping.load(std::memory_order_acquire)) {
+                m_wakeCondition.notify_one();
+            }
+            return true;
+        }
+
+        size_t LoopbackNetworkIO::DeliverBatch(size_t maxDatagrams) {
+            const size_t limit = std::min(maxDatagrams, static_cast<size_t>(LOOPBACK_DELIVERY_BATCH_SIZE));
+            m_deliveryBatch.clear();
+
+            // Collect a run of published slots; they stay owned by us until released below.
+            uint64_t pos = m_dequeuePos;
+            while (m_deliveryBatch.size() < limit) {
+                Slot& slot = m_slots[pos & m_mask];
+                if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                    break; // Not yet published.
+                }
+                ReceivedDatagram& datagram = m_deliveryBatch.emplace_back();
+                datagram.sender = slot.sender;
+                datagram.data = slot.size > 0 ? slot.data : nullptr;
+                datagram.size = slot.size;
+                ++pos;
+            }
+            const size_t count = m_deliveryBatch.size();
+            if (count == 0) {
+                return 0;
+            }
+
+            m_deliveries.fetch_add(1, std::memory_order_relaxed);
+            m_datagramsReceived.fetch_add(count, std::memory_order_relaxed);
+            if (m_eventHandler) {
+                m_eventHandler->OnRawDataBatchReceived(std::span<const ReceivedDatagram>(m_deliveryBatch));
+            }
+
+            // Release the slots for the producers' next lap around the ring.
+            for (uint64_t p = m_dequeuePos; p < pos; ++p) {
+                m_slots[p & m_mask].sequence.store(p + m_mask + 1, std::memory_order_release);
+            }
+            m_dequeuePos = pos;
+            return count;
+        }
+
+        void LoopbackNetworkIO::DeliveryThread() {
+            RF_NETWORK_INFO("LoopbackNetworkIO: Delivery thread started for {}.", m_localEndpoint.ToString());
+            int idleSpins = 0;
+            while (m_isRunning.load(std::memory_order_acquire)) {
+                if (DeliverBatch(LOOPBACK_DELIVERY_BATCH_SIZE) > 0) {
+                    idleSpins = 0;
+                    continue;
+                }
+                if (++idleSpins < LOOPBACK_IDLE_SPINS) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // Park. A producer that misses the flag costs at most LOOPBACK_IDLE_WAIT of latency.
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_consumerSleeping.store(true, std::memory_order_release);
+                m_wakeCondition.wait_for(lock, LOOPBACK_IDLE_WAIT);
+                m_consumerSleeping.store(false, std::memory_order_release);
+                idleSpins = 0;
+            }
+            // Drain whatever is left so nothing queued before Stop() is silently lost.
+            while (DeliverBatch(LOOPBACK_DELIVERY_BATCH_SIZE) > 0) {}
+            RF_NETWORK_INFO("LoopbackNetworkIO: Delivery thread for {} exiting gracefully.", m_localEndpoint.ToString());
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
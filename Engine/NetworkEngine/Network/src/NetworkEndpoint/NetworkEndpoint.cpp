@@ -0,0 +1,71 @@
+﻿// File: NetworkEndpoint.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Text parsing and formatting for NetworkEndpoint. Not used on the packet path.
+
+#include "NetworkEndpoint.h"
+
+#ifdef _WIN32
+#include <winsock2.h>   // For AF_INET, AF_INET6
+#include <ws2tcpip.h>   // For inet_pton, inet_ntop, INET6_ADDRSTRLEN
+#else
+#include <arpa/inet.h>  // For inet_pton, inet_ntop, INET6_ADDRSTRLEN
+#endif
+
+namespace RiftForged {
+    namespace Networking {
+
+        NetworkEndpoint::NetworkEndpoint(const std::string& ip, uint16_t p) {
+            if (ip.empty()) {
+                m_port = p;
+                m_hash = ComputeHash();
+                return;
+            }
+
+            uint8_t ipv4[4] = {};
+            if (inet_pton(AF_INET, ip.c_str(), ipv4) == 1) {
+                uint32_t networkOrder = 0;
+                std::memcpy(&networkOrder, ipv4, sizeof(networkOrder));
+                *this = FromIPv4(networkOrder, p);
+                return;
+            }
+
+            uint8_t ipv6[16] = {};
+            if (inet_pton(AF_INET6, ip.c_str(), ipv6) == 1) {
+                *this = FromIPv6(ipv6, p);
+                return;
+            }
+
+            // Unparsable: keep the port so the failure is visible in logs, but the endpoint is not valid.
+            m_port = p;
+            m_hash = ComputeHash();
+        }
+
+        std::string NetworkEndpoint::IpToString() const {
+            char buffer[INET6_ADDRSTRLEN] = {};
+            switch (m_family) {
+            case Family::IPv4:
+                if (inet_ntop(AF_INET, m_address.data(), buffer, sizeof(buffer))) {
+                    return std::string(buffer);
+                }
+                break;
+            case Family::IPv6:
+                if (inet_ntop(AF_INET6, m_address.data(), buffer, sizeof(buffer))) {
+                    return std::string(buffer);
+                }
+                break;
+            default:
+                break;
+            }
+            return std::string();
+        }
+
+        std::string NetworkEndpoint::ToString() const {
+            if (m_family == Family::IPv6) {
+                return "[" + IpToString() + "]:" + std::to_string(m_port);
+            }
+            return IpToString() + ":" + std::to_string(m_port);
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
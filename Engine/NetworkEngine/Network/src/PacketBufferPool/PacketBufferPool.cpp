@@ -0,0 +1,233 @@
+﻿// File: PacketBufferPool.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements the pooled, reference-counted outgoing payload buffers.
+
+#include "PacketBufferPool.h"
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <algorithm>             // For std::min
+#include <cstring>               // For std::memcpy
+#include <new>                   // For placement new, std::bad_alloc
+
+namespace RiftForged {
+    namespace Networking {
+
+        // Buffer header; the payload bytes follow it in the same allocation.
+        struct PacketBuffer {
+            std::atomic<uint32_t> refCount{ 0 };
+            uint32_t size = 0;
+            uint32_t capacity = 0;
+            bool pooled = false;                        // False for one-off oversize buffers.
+            std::shared_ptr<PacketBufferPoolCore> core; // Where the buffer goes when the last handle drops.
+
+            uint8_t* Bytes() { return reinterpret_cast<uint8_t*>(this + 1); }
+
+            static PacketBuffer* Create(uint32_t capacity, bool pooled, std::shared_ptr<PacketBufferPoolCore> core) {
+                void* memory = ::operator new(sizeof(PacketBuffer) + capacity);
+                PacketBuffer* buffer = new (memory) PacketBuffer();
+                buffer->capacity = capacity;
+                buffer->pooled = pooled;
+                buffer->core = std::move(core);
+                return buffer;
+            }
+
+            static void Destroy(PacketBuffer* buffer) {
+                buffer->~PacketBuffer();
+                ::operator delete(static_cast<void*>(buffer));
+            }
+        };
+
+        // State shared between the pool and every buffer it created.
+        struct PacketBufferPoolCore : std::enable_shared_from_this<PacketBufferPoolCore> {
+            uint32_t bufferCapacity = PACKET_BUFFER_DEFAULT_CAPACITY;
+            uint32_t maxPooled = PACKET_BUFFER_DEFAULT_MAX_POOLED;
+
+            std::mutex freeListMutex;
+            std::vector<PacketBuffer*> freeList;
+            bool closed = false; // Set by ~PacketBufferPool; released buffers are freed from then on.
+
+            std::atomic<uint64_t> acquires{ 0 };
+            std::atomic<uint64_t> allocations{ 0 };
+            std::atomic<uint64_t> oversizeAllocations{ 0 };
+            std::atomic<uint32_t> outstanding{ 0 };
+
+            PacketBufferRef Acquire(uint32_t size) {
+                PacketBuffer* buffer = nullptr;
+                try {
+                    if (size > bufferCapacity) {
+                        buffer = PacketBuffer::Create(size, false, shared_from_this());
+                        oversizeAllocations.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else {
+                        {
+                            std::lock_guard<std::mutex> lock(freeListMutex);
+                            if (!freeList.empty()) {
+                                buffer = freeList.back();
+                                freeList.pop_back();
+                            }
+                        }
+                        if (!buffer) {
+                            buffer = PacketBuffer::Create(bufferCapacity, true, shared_from_this());
+                            allocations.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+                catch (const std::bad_alloc& e) {
+                    RF_NETWORK_CRITICAL("PacketBufferPool: Failed to allocate a {} byte buffer: {}", size, e.what());
+                    return PacketBufferRef();
+                }
+
+                buffer->size = size;
+                buffer->refCount.store(1, std::memory_order_relaxed);
+                acquires.fetch_add(1, std::memory_order_relaxed);
+                outstanding.fetch_add(1, std::memory_order_relaxed);
+                return PacketBufferRef(buffer);
+            }
+
+            // Called by the last handle. The buffer's reference to the core keeps 'this' alive until
+            // the buffer is destroyed, so this is safe even after the pool itself is gone.
+            void Release(PacketBuffer* buffer) {
+                outstanding.fetch_sub(1, std::memory_order_relaxed);
+                if (buffer->pooled) {
+                    std::lock_guard<std::mutex> lock(freeListMutex);
+                    if (!closed && freeList.size() < maxPooled) {
+                        freeList.push_back(buffer);
+                        return;
+                    }
+                }
+                PacketBuffer::Destroy(buffer); // May drop the last reference to this core.
+            }
+
+            void Close() {
+                std::vector<PacketBuffer*> toFree;
+                {
+                    std::lock_guard<std::mutex> lock(freeListMutex);
+                    closed = true;
+                    toFree.swap(freeList);
+                }
+                for (PacketBuffer* buffer : toFree) {
+                    PacketBuffer::Destroy(buffer);
+                }
+            }
+        };
+
+        // --- PacketBufferRef ---
+
+        PacketBufferRef::PacketBufferRef(const PacketBufferRef& other) : m_buffer(other.m_buffer) {
+            if (m_buffer) {
+                m_buffer->refCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        PacketBufferRef::PacketBufferRef(PacketBufferRef&& other) noexcept : m_buffer(other.m_buffer) {
+            other.m_buffer = nullptr;
+        }
+
+        PacketBufferRef& PacketBufferRef::operator=(const PacketBufferRef& other) {
+            if (this != &other) {
+                PacketBufferRef copy(other);
+                std::swap(m_buffer, copy.m_buffer);
+            }
+            return *this;
+        }
+
+        PacketBufferRef& PacketBufferRef::operator=(PacketBufferRef&& other) noexcept {
+            if (this != &other) {
+                Reset();
+                m_buffer = other.m_buffer;
+                other.m_buffer = nullptr;
+            }
+            return *this;
+        }
+
+        PacketBufferRef::~PacketBufferRef() {
+            Reset();
+        }
+
+        void PacketBufferRef::Reset() {
+            PacketBuffer* buffer = m_buffer;
+            m_buffer = nullptr;
+            if (buffer && buffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                // Hold the core across Release(); the buffer may be destroyed inside it.
+                std::shared_ptr<PacketBufferPoolCore> core = buffer->core;
+                core->Release(buffer);
+            }
+        }
+
+        const uint8_t* PacketBufferRef::Data() const {
+            return m_buffer ? m_buffer->Bytes() : nullptr;
+        }
+
+        uint32_t PacketBufferRef::Size() const {
+            return m_buffer ? m_buffer->size : 0;
+        }
+
+        uint32_t PacketBufferRef::Capacity() const {
+            return m_buffer ? m_buffer->capacity : 0;
+        }
+
+        uint8_t* PacketBufferRef::MutableData() {
+            return m_buffer ? m_buffer->Bytes() : nullptr;
+        }
+
+        void PacketBufferRef::SetSize(uint32_t size) {
+            if (m_buffer) {
+                m_buffer->size = std::min(size, m_buffer->capacity);
+            }
+        }
+
+        uint32_t PacketBufferRef::UseCount() const {
+            return m_buffer ? m_buffer->refCount.load(std::memory_order_relaxed) : 0;
+        }
+
+        // --- PacketBufferPool ---
+
+        PacketBufferPool::PacketBufferPool(uint32_t bufferCapacity, uint32_t maxPooled, uint32_t preallocate)
+            : m_core(std::make_shared<PacketBufferPoolCore>()) {
+            m_core->bufferCapacity = bufferCapacity;
+            m_core->maxPooled = maxPooled;
+
+            // Acquire and drop 'preallocate' buffers at once so they all land on the free list.
+            std::vector<PacketBufferRef> warmup;
+            warmup.reserve(std::min(preallocate, maxPooled));
+            for (uint32_t i = 0; i < preallocate && i < maxPooled; ++i) {
+                warmup.push_back(m_core->Acquire(0));
+            }
+            m_core->acquires.store(0, std::memory_order_relaxed);
+        }
+
+        PacketBufferPool::~PacketBufferPool() {
+            m_core->Close();
+        }
+
+        PacketBufferRef PacketBufferPool::Acquire(uint32_t size) {
+            return m_core->Acquire(size);
+        }
+
+        PacketBufferRef PacketBufferPool::CopyFrom(const uint8_t* data, uint32_t size) {
+            PacketBufferRef buffer = m_core->Acquire(size);
+            if (buffer && size > 0 && data != nullptr) {
+                std::memcpy(buffer.MutableData(), data, size);
+            }
+            return buffer;
+        }
+
+        uint32_t PacketBufferPool::GetBufferCapacity() const {
+            return m_core->bufferCapacity;
+        }
+
+        PacketBufferPoolStats PacketBufferPool::GetStats() const {
+            PacketBufferPoolStats stats;
+            stats.acquires = m_core->acquires.load(std::memory_order_relaxed);
+            stats.allocations = m_core->allocations.load(std::memory_order_relaxed);
+            stats.oversizeAllocations = m_core->oversizeAllocations.load(std::memory_order_relaxed);
+            stats.outstanding = m_core->outstanding.load(std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(m_core->freeListMutex);
+                stats.freeBuffers = static_cast<uint32_t>(m_core->freeList.size());
+            }
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
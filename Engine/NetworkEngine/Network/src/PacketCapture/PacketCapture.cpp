@@ -0,0 +1,318 @@
+﻿// File: PacketCapture.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements packet capture recording and replay.
+
+#include "PacketCapture.h"
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <cstring>               // For memcpy
+#include <thread>                // For std::this_thread::sleep_until
+#include <cstdio>                // For std::snprintf (FormatRecord)
+
+namespace RiftForged {
+    namespace Networking {
+
+        namespace {
+            const size_t PACKET_CAPTURE_HEADER_SIZE = 16;
+            const uint16_t PACKET_CAPTURE_TEXT_ADDRESS_VERSION = 1; // Senders stored as IP text
+
+            // Significant address bytes recorded for each NetworkEndpoint family.
+            size_t GetCapturedAddressLength(NetworkEndpoint::Family family) {
+                switch (family) {
+                case NetworkEndpoint::Family::IPv4: return 4;
+                case NetworkEndpoint::Family::IPv6: return 16;
+                default: return 0;
+                }
+            }
+
+            // Fixed little-endian encoding so captures move between hosts unchanged.
+            template <typename T>
+            void AppendLE(std::vector<uint8_t>& out, T value) {
+                for (size_t i = 0; i < sizeof(T); ++i) {
+                    out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+                }
+            }
+
+            template <typename T>
+            bool ReadLE(const std::vector<uint8_t>& in, size_t& cursor, T& value) {
+                if (in.size() - cursor < sizeof(T)) {
+                    return false;
+                }
+                uint64_t result = 0;
+                for (size_t i = 0; i < sizeof(T); ++i) {
+                    result |= static_cast<uint64_t>(in[cursor + i]) << (8 * i);
+                }
+                cursor += sizeof(T);
+                value = static_cast<T>(result);
+                return true;
+            }
+        }
+
+        // --- PacketCaptureWriter ---
+
+        PacketCaptureWriter::~PacketCaptureWriter() {
+            Close();
+        }
+
+        bool PacketCaptureWriter::Open(const std::string& filePath) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_isOpen.load(std::memory_order_acquire)) {
+                RF_NETWORK_WARN("PacketCaptureWriter: Already capturing to '{}'.", m_filePath);
+                return false;
+            }
+            m_file.open(filePath, std::ios::binary | std::ios::trunc);
+            if (!m_file.is_open()) {
+                RF_NETWORK_ERROR("PacketCaptureWriter: Failed to open capture file '{}'.", filePath);
+                return false;
+            }
+            m_filePath = filePath;
+            m_captureStart = std::chrono::steady_clock::now();
+            const uint64_t startUnixNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+
+            m_staging.clear();
+            m_staging.reserve(PACKET_CAPTURE_FLUSH_BYTES * 2);
+            AppendLE<uint32_t>(m_staging, PACKET_CAPTURE_MAGIC);
+            AppendLE<uint16_t>(m_staging, PACKET_CAPTURE_VERSION);
+            AppendLE<uint16_t>(m_staging, 0);
+            AppendLE<uint64_t>(m_staging, startUnixNs);
+            WriteStagedLocked();
+
+            m_recordCount.store(0, std::memory_order_relaxed);
+            m_isOpen.store(true, std::memory_order_release);
+            RF_NETWORK_INFO("PacketCaptureWriter: Capturing inbound traffic to '{}'.", filePath);
+            return true;
+        }
+
+        void PacketCaptureWriter::Close() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isOpen.exchange(false, std::memory_order_acq_rel)) {
+                return;
+            }
+            WriteStagedLocked();
+            m_file.close();
+            RF_NETWORK_INFO("PacketCaptureWriter: Closed '{}' after {} records.", m_filePath, m_recordCount.load(std::memory_order_relaxed));
+        }
+
+        void PacketCaptureWriter::Record(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size) {
+            if (!m_isOpen.load(std::memory_order_acquire)) {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isOpen.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const uint64_t offsetNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_captureStart).count());
+            AppendRecordLocked(offsetNs, sender, data, size);
+            if (m_staging.size() >= PACKET_CAPTURE_FLUSH_BYTES) {
+                WriteStagedLocked();
+            }
+        }
+
+        void PacketCaptureWriter::RecordBatch(std::span<const ReceivedDatagram> datagrams) {
+            if (datagrams.empty() || !m_isOpen.load(std::memory_order_acquire)) {
+                return;
+            }
+            // One wakeup produced the whole batch, so it shares one timestamp.
+            const auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_isOpen.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const uint64_t offsetNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_captureStart).count());
+            for (const ReceivedDatagram& datagram : datagrams) {
+                AppendRecordLocked(offsetNs, datagram.sender, datagram.data, datagram.size);
+            }
+            if (m_staging.size() >= PACKET_CAPTURE_FLUSH_BYTES) {
+                WriteStagedLocked();
+            }
+        }
+
+        void PacketCaptureWriter::Flush() {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_isOpen.load(std::memory_order_relaxed)) {
+                WriteStagedLocked();
+                m_file.flush();
+            }
+        }
+
+        void PacketCaptureWriter::AppendRecordLocked(uint64_t offsetNs, const NetworkEndpoint& sender, const uint8_t* data, uint32_t size) {
+            // The sender is copied as raw bytes; nothing is formatted or allocated per datagram.
+            const std::array<uint8_t, 16>& address = sender.GetAddressBytes();
+            AppendLE<uint64_t>(m_staging, offsetNs);
+            AppendLE<uint8_t>(m_staging, static_cast<uint8_t>(sender.GetFamily()));
+            AppendLE<uint16_t>(m_staging, sender.GetPort());
+            m_staging.insert(m_staging.end(), address.begin(), address.begin() + GetCapturedAddressLength(sender.GetFamily()));
+            AppendLE<uint32_t>(m_staging, size);
+            if (size > 0 && data) {
+                m_staging.insert(m_staging.end(), data, data + size);
+            }
+            m_recordCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void PacketCaptureWriter::WriteStagedLocked() {
+            if (m_staging.empty()) {
+                return;
+            }
+            m_file.write(reinterpret_cast<const char*>(m_staging.data()), static_cast<std::streamsize>(m_staging.size()));
+            if (!m_file) {
+                RF_NETWORK_ERROR("PacketCaptureWriter: Write to '{}' failed; {} staged bytes lost.", m_filePath, m_staging.size());
+                m_file.clear();
+            }
+            m_staging.clear();
+        }
+
+        // --- PacketCaptureReplayer ---
+
+        bool PacketCaptureReplayer::Load(const std::string& filePath) {
+            std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                RF_NETWORK_ERROR("PacketCaptureReplayer: Failed to open capture file '{}'.", filePath);
+                return false;
+            }
+            const std::streamsize fileSize = file.tellg();
+            file.seekg(0, std::ios::beg);
+            std::vector<uint8_t> bytes(static_cast<size_t>(fileSize));
+            if (fileSize > 0 && !file.read(reinterpret_cast<char*>(bytes.data()), fileSize)) {
+                RF_NETWORK_ERROR("PacketCaptureReplayer: Failed to read capture file '{}'.", filePath);
+                return false;
+            }
+
+            size_t cursor = 0;
+            uint32_t magic = 0;
+            uint16_t version = 0;
+            uint16_t reserved = 0;
+            if (bytes.size() < PACKET_CAPTURE_HEADER_SIZE ||
+                !ReadLE(bytes, cursor, magic) || !ReadLE(bytes, cursor, version) ||
+                !ReadLE(bytes, cursor, reserved) || !ReadLE(bytes, cursor, m_captureStartUnixNs) ||
+                magic != PACKET_CAPTURE_MAGIC) {
+                RF_NETWORK_ERROR("PacketCaptureReplayer: '{}' is not a packet capture.", filePath);
+                return false;
+            }
+            if (version != PACKET_CAPTURE_VERSION && version != PACKET_CAPTURE_TEXT_ADDRESS_VERSION) {
+                RF_NETWORK_ERROR("PacketCaptureReplayer: '{}' has unsupported version {}.", filePath, version);
+                return false;
+            }
+
+            m_records.clear();
+            m_payloads.clear();
+            m_payloads.reserve(bytes.size());
+            while (cursor < bytes.size()) {
+                CapturedDatagram record;
+                uint16_t port = 0;
+                if (!ReadLE(bytes, cursor, record.offsetNs)) {
+                    break;
+                }
+                if (version == PACKET_CAPTURE_TEXT_ADDRESS_VERSION) {
+                    uint8_t ipLength = 0;
+                    if (!ReadLE(bytes, cursor, port) || !ReadLE(bytes, cursor, ipLength) || bytes.size() - cursor < ipLength) {
+                        break;
+                    }
+                    record.sender = NetworkEndpoint(std::string(reinterpret_cast<const char*>(bytes.data() + cursor), ipLength), port);
+                    cursor += ipLength;
+                }
+                else {
+                    uint8_t family = 0;
+                    if (!ReadLE(bytes, cursor, family) || !ReadLE(bytes, cursor, port)) {
+                        break;
+                    }
+                    const size_t addressLength = GetCapturedAddressLength(static_cast<NetworkEndpoint::Family>(family));
+                    if (bytes.size() - cursor < addressLength) {
+                        break;
+                    }
+                    if (addressLength == 4) {
+                        uint32_t ipv4 = 0;
+                        std::memcpy(&ipv4, bytes.data() + cursor, sizeof(ipv4));
+                        record.sender = NetworkEndpoint::FromIPv4(ipv4, port);
+                    }
+                    else if (addressLength == 16) {
+                        uint8_t ipv6[16];
+                        std::memcpy(ipv6, bytes.data() + cursor, sizeof(ipv6));
+                        record.sender = NetworkEndpoint::FromIPv6(ipv6, port);
+                    }
+                    cursor += addressLength;
+                }
+                if (!ReadLE(bytes, cursor, record.size) || bytes.size() - cursor < record.size) {
+                    break;
+                }
+                record.dataOffset = m_payloads.size();
+                m_payloads.insert(m_payloads.end(), bytes.begin() + cursor, bytes.begin() + cursor + record.size);
+                cursor += record.size;
+                m_records.push_back(std::move(record));
+            }
+            if (cursor < bytes.size()) {
+                RF_NETWORK_WARN("PacketCaptureReplayer: '{}' ends with a truncated record; {} trailing bytes ignored.", filePath, bytes.size() - cursor);
+            }
+
+            RF_NETWORK_INFO("PacketCaptureReplayer: Loaded {} records ({} payload bytes) from '{}'.", m_records.size(), m_payloads.size(), filePath);
+            return true;
+        }
+
+        uint64_t PacketCaptureReplayer::GetDurationNs() const {
+            if (m_records.empty()) {
+                return 0;
+            }
+            return m_records.back().offsetNs - m_records.front().offsetNs;
+        }
+
+        std::string PacketCaptureReplayer::FormatRecord(size_t index) const {
+            if (index >= m_records.size()) {
+                return std::string();
+            }
+            const CapturedDatagram& record = m_records[index];
+            const double offsetMs = static_cast<double>(record.offsetNs - m_records.front().offsetNs) / 1e6;
+            char text[160];
+            std::snprintf(text, sizeof(text), "+%.3fms %s %u bytes", offsetMs, record.sender.ToString().c_str(), record.size);
+            return text;
+        }
+
+        size_t PacketCaptureReplayer::Replay(INetworkIOEvents* target, PacketReplayMode mode, uint32_t maxBatch) {
+            if (!target) {
+                RF_NETWORK_ERROR("PacketCaptureReplayer::Replay: Target handler is null.");
+                return 0;
+            }
+            if (maxBatch == 0) {
+                maxBatch = PACKET_REPLAY_BATCH_SIZE;
+            }
+            m_stopRequested.store(false, std::memory_order_release);
+
+            std::vector<ReceivedDatagram> batch;
+            batch.reserve(maxBatch);
+            const auto replayStart = std::chrono::steady_clock::now();
+            const uint64_t firstOffsetNs = m_records.empty() ? 0 : m_records.front().offsetNs;
+            size_t next = 0;
+
+            while (next < m_records.size() && !m_stopRequested.load(std::memory_order_acquire)) {
+                if (mode == PacketReplayMode::RecordedSpeed) {
+                    const auto releaseAt = replayStart + std::chrono::nanoseconds(m_records[next].offsetNs - firstOffsetNs);
+                    std::this_thread::sleep_until(releaseAt);
+                }
+
+                // Everything captured at or before 'now' (in replay time) goes out together,
+                // mirroring how the socket would have batched it.
+                const auto now = std::chrono::steady_clock::now();
+                batch.clear();
+                while (next < m_records.size() && batch.size() < maxBatch) {
+                    const CapturedDatagram& record = m_records[next];
+                    if (mode == PacketReplayMode::RecordedSpeed &&
+                        replayStart + std::chrono::nanoseconds(record.offsetNs - firstOffsetNs) > now) {
+                        break;
+                    }
+                    ReceivedDatagram& datagram = batch.emplace_back();
+                    datagram.sender = record.sender;
+                    datagram.data = record.size > 0 ? m_payloads.data() + record.dataOffset : nullptr;
+                    datagram.size = record.size;
+                    datagram.context = nullptr;
+                    ++next;
+                }
+                target->OnRawDataBatchReceived(std::span<const ReceivedDatagram>(batch));
+            }
+
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+            RF_NETWORK_INFO("PacketCaptureReplayer: Replayed {} of {} datagrams in {:.3f}s.", next, m_records.size(), seconds);
+            return next;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,215 @@
+﻿// File: PayloadCompression.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements zstd payload compression with an optional offline-trained dictionary
+// and a per-second CPU budget.
+
+#include "PayloadCompression.h"
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+
+#include <fstream>  // For std::ifstream
+#include <iterator> // For std::istreambuf_iterator
+#include <vector>   // For std::vector
+
+// zstd support is compiled in only when the library's header is available.
+#if defined(__has_include)
+#if __has_include(<zstd.h>)
+#include <zstd.h>
+#define RF_NETWORK_HAS_ZSTD 1
+#endif
+#endif
+
+namespace RiftForged {
+    namespace Networking {
+
+#ifdef RF_NETWORK_HAS_ZSTD
+        namespace {
+
+            // zstd contexts are not thread-safe; each thread that compresses or decompresses keeps its own.
+            struct ThreadCompressionContexts {
+                ZSTD_CCtx* compressionContext = nullptr;
+                ZSTD_DCtx* decompressionContext = nullptr;
+                std::vector<uint8_t> decompressedPayload;
+
+                ~ThreadCompressionContexts() {
+                    ZSTD_freeCCtx(compressionContext);
+                    ZSTD_freeDCtx(decompressionContext);
+                }
+            };
+
+            ThreadCompressionContexts& GetThreadCompressionContexts() {
+                thread_local ThreadCompressionContexts contexts;
+                return contexts;
+            }
+
+        } // namespace
+#endif
+
+        struct PayloadCompressor::Dictionary {
+#ifdef RF_NETWORK_HAS_ZSTD
+            ZSTD_CDict* compressionDictionary = nullptr;
+            ZSTD_DDict* decompressionDictionary = nullptr;
+
+            ~Dictionary() {
+                ZSTD_freeCDict(compressionDictionary);
+                ZSTD_freeDDict(decompressionDictionary);
+            }
+#endif
+        };
+
+        PayloadCompressor::PayloadCompressor() = default;
+        PayloadCompressor::~PayloadCompressor() = default;
+
+        bool PayloadCompressor::IsAvailable() const {
+#ifdef RF_NETWORK_HAS_ZSTD
+            return m_budgetMicrosPerSecond.load(std::memory_order_relaxed) > 0;
+#else
+            return false;
+#endif
+        }
+
+        bool PayloadCompressor::LoadDictionary(const std::string& path) {
+#ifdef RF_NETWORK_HAS_ZSTD
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                RF_NETWORK_ERROR("PayloadCompressor: Cannot open dictionary file '{}'.", path);
+                return false;
+            }
+            const std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (contents.empty()) {
+                RF_NETWORK_ERROR("PayloadCompressor: Dictionary file '{}' is empty.", path);
+                return false;
+            }
+
+            auto dictionary = std::make_unique<Dictionary>();
+            dictionary->compressionDictionary = ZSTD_createCDict(contents.data(), contents.size(), PAYLOAD_COMPRESSION_LEVEL);
+            dictionary->decompressionDictionary = ZSTD_createDDict(contents.data(), contents.size());
+            if (!dictionary->compressionDictionary || !dictionary->decompressionDictionary) {
+                RF_NETWORK_ERROR("PayloadCompressor: '{}' is not a usable zstd dictionary.", path);
+                return false;
+            }
+            m_dictionary = std::move(dictionary);
+            RF_NETWORK_INFO("PayloadCompressor: Loaded dictionary '{}' ({} bytes, ID {}).",
+                path, contents.size(), ZSTD_getDictID_fromDict(contents.data(), contents.size()));
+            return true;
+#else
+            RF_NETWORK_WARN("PayloadCompressor: Built without zstd; ignoring dictionary '{}'.", path);
+            return false;
+#endif
+        }
+
+        void PayloadCompressor::SetCpuBudget(uint32_t microsecondsPerSecond) {
+            m_budgetMicrosPerSecond.store(microsecondsPerSecond, std::memory_order_relaxed);
+        }
+
+        bool PayloadCompressor::HasBudgetLeft(std::chrono::steady_clock::time_point now, uint32_t budgetMicrosPerSecond) {
+            const int64_t nowTicks = now.time_since_epoch().count();
+            const int64_t windowTicks = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)).count();
+            int64_t windowStart = m_budgetWindowStart.load(std::memory_order_relaxed);
+            if (nowTicks - windowStart >= windowTicks &&
+                m_budgetWindowStart.compare_exchange_strong(windowStart, nowTicks, std::memory_order_relaxed)) {
+                m_budgetSpentNanos.store(0, std::memory_order_relaxed);
+            }
+            return m_budgetSpentNanos.load(std::memory_order_relaxed) < static_cast<uint64_t>(budgetMicrosPerSecond) * 1000;
+        }
+
+        CompressResult PayloadCompressor::Compress(const uint8_t* data, uint32_t size, PacketBufferPool& pool, PacketBufferRef& out_payload) {
+#ifdef RF_NETWORK_HAS_ZSTD
+            const uint32_t budgetMicrosPerSecond = m_budgetMicrosPerSecond.load(std::memory_order_relaxed);
+            if (budgetMicrosPerSecond == 0) {
+                return CompressResult::Unavailable;
+            }
+            if (!data || size < PAYLOAD_COMPRESSION_MIN_SIZE) {
+                return CompressResult::TooSmall;
+            }
+            const auto startTime = std::chrono::steady_clock::now();
+            if (!HasBudgetLeft(startTime, budgetMicrosPerSecond)) {
+                m_packetsSkippedForBudget.fetch_add(1, std::memory_order_relaxed);
+                return CompressResult::OverBudget;
+            }
+
+            ThreadCompressionContexts& contexts = GetThreadCompressionContexts();
+            if (!contexts.compressionContext) {
+                contexts.compressionContext = ZSTD_createCCtx();
+                if (!contexts.compressionContext) {
+                    RF_NETWORK_ERROR("PayloadCompressor: Failed to create a compression context.");
+                    return CompressResult::Unavailable;
+                }
+            }
+            // Only a frame smaller than the input is worth sending, so the output is capped one byte
+            // short of it and zstd gives up as soon as it cannot fit.
+            PacketBufferRef frame = pool.Acquire(size - 1);
+            if (!frame) {
+                RF_NETWORK_ERROR("PayloadCompressor: Failed to acquire a {} byte frame buffer.", size - 1);
+                return CompressResult::Unavailable;
+            }
+            const size_t frameSize = m_dictionary
+                ? ZSTD_compress_usingCDict(contexts.compressionContext, frame.MutableData(), size - 1, data, size, m_dictionary->compressionDictionary)
+                : ZSTD_compressCCtx(contexts.compressionContext, frame.MutableData(), size - 1, data, size, PAYLOAD_COMPRESSION_LEVEL);
+            m_budgetSpentNanos.fetch_add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count()),
+                std::memory_order_relaxed);
+            if (ZSTD_isError(frameSize)) {
+                m_packetsIncompressible.fetch_add(1, std::memory_order_relaxed);
+                return CompressResult::Incompressible;
+            }
+
+            frame.SetSize(static_cast<uint32_t>(frameSize));
+            out_payload = std::move(frame);
+            m_packetsCompressed.fetch_add(1, std::memory_order_relaxed);
+            m_bytesBeforeCompression.fetch_add(size, std::memory_order_relaxed);
+            m_bytesAfterCompression.fetch_add(frameSize, std::memory_order_relaxed);
+            return CompressResult::Compressed;
+#else
+            (void)data; (void)size; (void)pool; (void)out_payload;
+            return CompressResult::Unavailable;
+#endif
+        }
+
+        bool PayloadCompressor::Decompress(const uint8_t* data, uint32_t size, const uint8_t** out_data, uint32_t* out_size) {
+#ifdef RF_NETWORK_HAS_ZSTD
+            ThreadCompressionContexts& contexts = GetThreadCompressionContexts();
+            if (!contexts.decompressionContext) {
+                contexts.decompressionContext = ZSTD_createDCtx();
+                if (!contexts.decompressionContext) {
+                    RF_NETWORK_ERROR("PayloadCompressor: Failed to create a decompression context.");
+                    m_decompressionFailures.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                contexts.decompressedPayload.resize(PAYLOAD_COMPRESSION_MAX_DECOMPRESSED_SIZE);
+            }
+            const size_t payloadSize = m_dictionary
+                ? ZSTD_decompress_usingDDict(contexts.decompressionContext, contexts.decompressedPayload.data(),
+                    contexts.decompressedPayload.size(), data, size, m_dictionary->decompressionDictionary)
+                : ZSTD_decompressDCtx(contexts.decompressionContext, contexts.decompressedPayload.data(),
+                    contexts.decompressedPayload.size(), data, size);
+            if (ZSTD_isError(payloadSize)) {
+                RF_NETWORK_DEBUG("PayloadCompressor: Failed to decompress a {} byte frame: {}", size, ZSTD_getErrorName(payloadSize));
+                m_decompressionFailures.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            *out_data = contexts.decompressedPayload.data();
+            *out_size = static_cast<uint32_t>(payloadSize);
+            m_packetsDecompressed.fetch_add(1, std::memory_order_relaxed);
+            return true;
+#else
+            (void)data; (void)size; (void)out_data; (void)out_size;
+            m_decompressionFailures.fetch_add(1, std::memory_order_relaxed);
+            return false;
+#endif
+        }
+
+        CompressionStats PayloadCompressor::GetStats() const {
+            CompressionStats stats;
+            stats.packetsCompressed = m_packetsCompressed.load(std::memory_order_relaxed);
+            stats.packetsIncompressible = m_packetsIncompressible.load(std::memory_order_relaxed);
+            stats.packetsSkippedForBudget = m_packetsSkippedForBudget.load(std::memory_order_relaxed);
+            stats.bytesBeforeCompression = m_bytesBeforeCompression.load(std::memory_order_relaxed);
+            stats.bytesAfterCompression = m_bytesAfterCompression.load(std::memory_order_relaxed);
+            stats.packetsDecompressed = m_packetsDecompressed.load(std::memory_order_relaxed);
+            stats.decompressionFailures = m_decompressionFailures.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
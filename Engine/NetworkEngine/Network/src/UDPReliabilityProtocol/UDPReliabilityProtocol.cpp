@@ -3,43 +3,66 @@
 // Copyright (C) 2022-2028 RiftForged Team
 
 #include "UDPReliabilityProtocol.h"
-#include "../Utilities/Logger.h"       // For RF_NETWORK_... macros
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
 #include "GamePacketHeader.h"      // For GamePacketFlag, SequenceNumber, GetGamePacketHeaderSize, CURRENT_PROTOCOL_ID_VERSION
 #include <cstring>                 // For memcpy
+#include <cstdint>                 // For UINT16_MAX
 #include <vector>                  // For std::vector
-#include <list>                    // For std::list in ReliableConnectionState
 #include <chrono>                  // For time points
 #include <mutex>                   // For std::mutex
 #include <cmath>                   // For std::abs in RTT calculation
 #include <algorithm>               // For std::min and std::max in RTO clamping
 #include <functional>              // For std::function in TrySendAckOnlyPacket
+#include <cstddef>                 // For std::ptrdiff_t
 
 namespace RiftForged {
     namespace Networking {
 
         // Internal helper function to do the core work of PrepareOutgoingPacket without locking.
         // Assumes the caller (PrepareOutgoingPacket or TrySendAckOnlyPacket) holds the lock on connectionState.internalStateMutex.
-        static std::vector<uint8_t> PrepareOutgoingPacketUnlocked_Internal(
+        static OutgoingPacket PrepareOutgoingPacketUnlocked_Internal(
             ReliableConnectionState& connectionState,
-            const uint8_t* payloadData,
-            uint16_t payloadSize,
-            uint8_t packetFlags
+            const PacketBufferRef& payload,
+            uint8_t packetFlags,
+            DeliveryChannel channel,
+            PayloadEncoding payloadEncoding = PayloadEncoding::Raw
         ) {
-            if (!HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY) && payloadSize > 0 && payloadData == nullptr) {
-                RF_NETWORK_WARN("PrepareOutgoingPacketUnlocked: Payload data is null for a non-ACK-only packet with payload size > 0. Flags: 0x{:X}", packetFlags);
-                return {};
+            OutgoingPacket packet;
+            if (payload.Size() > UINT16_MAX) {
+                RF_NETWORK_WARN("PrepareOutgoingPacketUnlocked: Payload of {} bytes exceeds the {} byte packet limit. Flags: 0x{:X}", payload.Size(), UINT16_MAX, packetFlags);
+                return packet;
+            }
+            if (HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY)) {
+                // The only payload an ACK-only packet may carry is a selective ack block.
+                if (payload.Size() == sizeof(SelectiveAckBlock)) {
+                    packet.payload = payload;
+                }
+                else if (payload.Size() > 0) {
+                    RF_NETWORK_WARN("PrepareOutgoingPacketUnlocked: ACK-only packet should not have a payload. PayloadSize: {}. Ignoring payload.", payload.Size());
+                }
             }
-            if (HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY) && payloadSize > 0) {
-                RF_NETWORK_WARN("PrepareOutgoingPacketUnlocked: ACK-only packet should not have a payload. PayloadSize: {}. Ignoring payload.", payloadSize);
-                payloadSize = 0;
-                payloadData = nullptr;
+            else {
+                packet.payload = payload;
             }
 
-            GamePacketHeader header;
+            if (HasFlag(packetFlags, GamePacketFlag::IS_RELIABLE) &&
+                !connectionState.unacknowledgedSentPackets.CanInsert(connectionState.nextOutgoingSequenceNumber)) {
+                RF_NETWORK_WARN("PrepareOutgoingPacketUnlocked: Reliable send window full ({} packets awaiting ACK). Refusing Seq: {}.",
+                    connectionState.unacknowledgedSentPackets.Size(), connectionState.nextOutgoingSequenceNumber);
+                return packet;
+            }
+
+            GamePacketHeader& header = packet.header;
             header.protocolId = CURRENT_PROTOCOL_ID_VERSION;
             header.flags = packetFlags;
+            header.payloadEncoding = static_cast<uint8_t>(payloadEncoding);
+            header.connectionId = connectionState.connectionId;
             header.ackNumber = connectionState.highestReceivedSequenceNumberFromRemote;
             header.ackBitfield = connectionState.receivedSequenceBitfield;
+            if (IsChannelDataPacket(packetFlags)) {
+                header.channelId = static_cast<uint8_t>(channel);
+                header.channelSequence = connectionState.nextChannelSequence[static_cast<size_t>(channel)]++;
+            }
 
             if (HasFlag(packetFlags, GamePacketFlag::IS_RELIABLE)) {
                 header.sequenceNumber = connectionState.nextOutgoingSequenceNumber++;
@@ -52,21 +75,28 @@ namespace RiftForged {
                     header.ackNumber, header.ackBitfield, header.flags);
             }
 
-            std::vector<uint8_t> packetBuffer = SerializePacket(header, payloadData, payloadSize);
-
             if (HasFlag(packetFlags, GamePacketFlag::IS_RELIABLE)) {
-                connectionState.unacknowledgedSentPackets.emplace_back(
+                connectionState.unacknowledgedSentPackets.Insert(
                     header.sequenceNumber,
-                    packetBuffer,
+                    header,
+                    packet.payload,
                     HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY)
                 );
                 RF_NETWORK_TRACE("PrepareOutgoingPacketUnlocked: Queued reliable packet Seq: {} for ACK. Unacked count: {}",
-                    header.sequenceNumber, connectionState.unacknowledgedSentPackets.size());
+                    header.sequenceNumber, connectionState.unacknowledgedSentPackets.Size());
             }
 
+            const auto sendTime = std::chrono::steady_clock::now();
+            connectionState.congestionController.OnPacketSent(packet.TotalSize(), HasFlag(packetFlags, GamePacketFlag::IS_RELIABLE),
+                sendTime, connectionState.smoothedRTT_ms);
             connectionState.hasPendingAckToSend = false; // This packet carries ACKs or is fresh
-            connectionState.lastPacketSentTimeToRemote = std::chrono::steady_clock::now();
-            return packetBuffer;
+            if (HasFlag(packetFlags, GamePacketFlag::IS_ACK_ONLY) && packet.payload) {
+                connectionState.hasPendingSelectiveAck = false;
+            }
+            connectionState.lastPacketSentTimeToRemote = sendTime;
+            connectionState.telemetry.OnPacketSent(packet.TotalSize());
+            packet.valid = true;
+            return packet;
         }
 
         // Helper function to serialize the GamePacketHeader and payload into a byte vector.
@@ -93,14 +123,249 @@ namespace RiftForged {
         }
 
         // --- PrepareOutgoingPacket ---
-        std::vector<uint8_t> PrepareOutgoingPacket(
+        OutgoingPacket PrepareOutgoingPacket(
             ReliableConnectionState& connectionState,
-            const uint8_t* payloadData,
-            uint16_t payloadSize,
+            const PacketBufferRef& payload,
             uint8_t packetFlags
         ) {
             std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
-            return PrepareOutgoingPacketUnlocked_Internal(connectionState, payloadData, payloadSize, packetFlags);
+            return PrepareOutgoingPacketUnlocked_Internal(connectionState, payload, packetFlags, GetDefaultChannel(packetFlags));
+        }
+
+        // --- StageOutgoingMessage ---
+        bool StageOutgoingMessage(
+            ReliableConnectionState& connectionState,
+            const PacketBufferRef& payload,
+            uint8_t payloadType,
+            DeliveryChannel channel,
+            bool* out_needsAssembly
+        ) {
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            if (out_needsAssembly) *out_needsAssembly = false;
+            size_t stagedCount = 0;
+            for (const auto& pending : connectionState.pendingMessages) {
+                stagedCount += pending.size();
+            }
+            if (stagedCount >= MAX_PENDING_OUTBOUND_MESSAGES) {
+                RF_NETWORK_WARN("StageOutgoingMessage: {} messages already staged for connection 0x{:08X}. Refusing message.",
+                    MAX_PENDING_OUTBOUND_MESSAGES, connectionState.connectionId);
+                return false;
+            }
+            if (channel >= DeliveryChannel::Count) {
+                RF_NETWORK_ERROR("StageOutgoingMessage: Invalid delivery channel {}. Refusing message.", static_cast<uint32_t>(channel));
+                return false;
+            }
+            auto& pending = connectionState.pendingMessages[static_cast<size_t>(channel)];
+            pending.push_back(ReliableConnectionState::PendingOutboundMessage{ payload, payloadType });
+            if (!connectionState.outboundAssemblyQueued) {
+                connectionState.outboundAssemblyQueued = true;
+                if (out_needsAssembly) *out_needsAssembly = true;
+            }
+            return true;
+        }
+
+        // Asks the congestion controller whether a datagram carrying 'payloadSize' bytes may leave now.
+        // If not, lowers 'nextSendTime' to when the pacer will allow it.
+        static bool AdmitDatagramUnlocked(
+            ReliableConnectionState& connectionState,
+            uint32_t payloadSize,
+            bool reliable,
+            std::chrono::steady_clock::time_point currentTime,
+            std::chrono::steady_clock::time_point& nextSendTime
+        ) {
+            auto retryTime = std::chrono::steady_clock::time_point::max();
+            if (connectionState.congestionController.CanSend(static_cast<uint32_t>(GetGamePacketHeaderSize()) + payloadSize,
+                reliable, currentTime, connectionState.smoothedRTT_ms, &retryTime)) {
+                return true;
+            }
+            connectionState.congestionController.NoteSendDeferred();
+            nextSendTime = std::min(nextSendTime, retryTime);
+            return false;
+        }
+
+        // Replaces 'payload' with its zstd frame if the connection negotiated compression and the frame
+        // is smaller. Returns the encoding the datagram's header must carry.
+        static PayloadEncoding CompressDatagramPayloadUnlocked(
+            ReliableConnectionState& connectionState,
+            PacketBufferPool& payloadPool,
+            PacketBufferRef& payload
+        ) {
+            if ((connectionState.capabilities & CONNECTION_CAPABILITY_COMPRESSION) == 0 || !connectionState.payloadCompressor) {
+                return PayloadEncoding::Raw;
+            }
+            PacketBufferRef frame;
+            CompressionStats& stats = connectionState.compressionStats;
+            switch (connectionState.payloadCompressor->Compress(payload.Data(), payload.Size(), payloadPool, frame)) {
+            case CompressResult::Compressed:
+                stats.packetsCompressed++;
+                stats.bytesBeforeCompression += payload.Size();
+                stats.bytesAfterCompression += frame.Size();
+                payload = std::move(frame);
+                return PayloadEncoding::Zstd;
+            case CompressResult::Incompressible:
+                stats.packetsIncompressible++;
+                break;
+            case CompressResult::OverBudget:
+                stats.packetsSkippedForBudget++;
+                break;
+            default:
+                break;
+            }
+            return PayloadEncoding::Raw;
+        }
+
+        // Sends the remaining fragments of a reliable message too large for one datagram. Each fragment
+        // is a FragmentHeader plus the next slice of the message, copied into a pooled buffer.
+        // Returns false if the message is not finished yet (fragment, congestion or send window full).
+        static bool PackFragmentsUnlocked(
+            ReliableConnectionState& connectionState,
+            ReliableConnectionState::PendingOutboundMessage& message,
+            DeliveryChannel channel,
+            PacketBufferPool& payloadPool,
+            std::chrono::steady_clock::time_point currentTime,
+            std::chrono::steady_clock::time_point& nextSendTime,
+            std::vector<OutgoingPacket>& out_packets
+        ) {
+            const uint32_t messageSize = message.payload.Size();
+            const uint32_t fragmentCount = GetFragmentCount(messageSize);
+            if (message.nextFragmentIndex == 0) {
+                message.fragmentMessageId = connectionState.nextFragmentMessageId++;
+            }
+            while (message.nextFragmentIndex < fragmentCount) {
+                if (connectionState.unacknowledgedSentPackets.Span() >= FRAGMENT_SEND_WINDOW_SIZE) {
+                    return false;
+                }
+                FragmentHeader fragmentHeader;
+                fragmentHeader.messageId = message.fragmentMessageId;
+                fragmentHeader.fragmentIndex = message.nextFragmentIndex;
+                fragmentHeader.fragmentCount = static_cast<uint16_t>(fragmentCount);
+                fragmentHeader.messageSize = messageSize;
+                const uint32_t offset = static_cast<uint32_t>(message.nextFragmentIndex) * GetFragmentDataMaxSize();
+                const uint32_t dataSize = std::min(GetFragmentDataMaxSize(), messageSize - offset);
+                if (!AdmitDatagramUnlocked(connectionState, static_cast<uint32_t>(sizeof(FragmentHeader)) + dataSize, true, currentTime, nextSendTime)) {
+                    return false;
+                }
+
+                PacketBufferRef fragment = payloadPool.Acquire(static_cast<uint32_t>(sizeof(FragmentHeader)) + dataSize);
+                if (!fragment) {
+                    RF_NETWORK_ERROR("BuildCoalescedPackets: Failed to acquire a fragment buffer.");
+                    return false;
+                }
+                std::memcpy(fragment.MutableData(), &fragmentHeader, sizeof(FragmentHeader));
+                std::memcpy(fragment.MutableData() + sizeof(FragmentHeader), message.payload.Data() + offset, dataSize);
+
+                OutgoingPacket packet = PrepareOutgoingPacketUnlocked_Internal(connectionState, fragment,
+                    static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE) | static_cast<uint8_t>(GamePacketFlag::IS_FRAGMENT), channel);
+                if (!packet.valid) {
+                    return false;
+                }
+                out_packets.push_back(std::move(packet));
+                ++message.nextFragmentIndex;
+            }
+            RF_NETWORK_TRACE("BuildCoalescedPackets: Message {} ({} bytes) sent in {} fragments.",
+                message.fragmentMessageId, messageSize, fragmentCount);
+            return true;
+        }
+
+        // Packs the messages staged on 'channel' front to back into datagrams and removes what was sent.
+        // Stops early if the congestion controller defers the next datagram or it cannot be prepared
+        // (reliable window full); the rest stays staged.
+        static void PackPendingMessagesUnlocked(
+            ReliableConnectionState& connectionState,
+            DeliveryChannel channel,
+            PacketBufferPool& payloadPool,
+            std::chrono::steady_clock::time_point currentTime,
+            std::chrono::steady_clock::time_point& nextSendTime,
+            std::vector<OutgoingPacket>& out_packets
+        ) {
+            auto& pending = connectionState.pendingMessages[static_cast<size_t>(channel)];
+            const uint32_t maxPayloadSize = GetCoalescedPayloadMaxSize();
+            const bool reliable = IsReliableChannel(channel);
+            const uint8_t packetFlags = static_cast<uint8_t>(reliable ? GamePacketFlag::IS_RELIABLE : GamePacketFlag::NONE);
+            size_t consumed = 0;
+            while (consumed < pending.size()) {
+                if (reliable && NeedsFragmentation(pending[consumed].payload.Size())) {
+                    if (!PackFragmentsUnlocked(connectionState, pending[consumed], channel, payloadPool, currentTime, nextSendTime, out_packets)) {
+                        break;
+                    }
+                    ++consumed;
+                    continue;
+                }
+
+                // Take as many messages as fit one datagram.
+                size_t end = consumed;
+                uint32_t framedSize = 0;
+                while (end < pending.size()) {
+                    const uint32_t frameSize = GetCoalescedFrameSize(pending[end].payload.Size());
+                    if (framedSize + frameSize > maxPayloadSize) break;
+                    framedSize += frameSize;
+                    ++end;
+                }
+
+                const uint32_t datagramPayloadSize = end - consumed <= 1 ? pending[consumed].payload.Size() : framedSize;
+                if (!AdmitDatagramUnlocked(connectionState, datagramPayloadSize, reliable, currentTime, nextSendTime)) {
+                    break;
+                }
+
+                PacketBufferRef datagramPayload;
+                uint8_t datagramFlags = packetFlags;
+                if (end - consumed <= 1) {
+                    // Alone in its datagram (or too large to share one, e.g. unreliable): no framing, no copy.
+                    end = consumed + 1;
+                    datagramPayload = pending[consumed].payload;
+                }
+                else {
+                    datagramPayload = payloadPool.Acquire(framedSize);
+                    if (!datagramPayload) {
+                        RF_NETWORK_ERROR("BuildCoalescedPackets: Failed to acquire a {} byte payload buffer.", framedSize);
+                        break;
+                    }
+                    uint32_t offset = 0;
+                    for (size_t i = consumed; i < end; ++i) {
+                        const PacketBufferRef& message = pending[i].payload;
+                        AppendCoalescedFrame(datagramPayload.MutableData(), framedSize, offset,
+                            pending[i].payloadType, message.Data(), message.Size());
+                    }
+                    datagramFlags |= static_cast<uint8_t>(GamePacketFlag::IS_COALESCED);
+                }
+
+                // Fragments are left raw: a fragmented message is mostly bulk data sent rarely.
+                const PayloadEncoding payloadEncoding = CompressDatagramPayloadUnlocked(connectionState, payloadPool, datagramPayload);
+                OutgoingPacket packet = PrepareOutgoingPacketUnlocked_Internal(connectionState, datagramPayload, datagramFlags, channel, payloadEncoding);
+                if (!packet.valid) {
+                    break;
+                }
+                RF_NETWORK_TRACE("BuildCoalescedPackets: {} message(s) in one {} byte datagram. Flags: 0x{:X}",
+                    end - consumed, packet.TotalSize(), datagramFlags);
+                out_packets.push_back(std::move(packet));
+                consumed = end;
+            }
+            pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+        }
+
+        // --- BuildCoalescedPackets ---
+        bool BuildCoalescedPackets(
+            ReliableConnectionState& connectionState,
+            PacketBufferPool& payloadPool,
+            std::chrono::steady_clock::time_point currentTime,
+            std::vector<OutgoingPacket>& out_packets,
+            std::chrono::steady_clock::time_point* out_nextSendTime
+        ) {
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            auto nextSendTime = std::chrono::steady_clock::time_point::max();
+            bool messagesRemain = false;
+            for (uint32_t channel = 0; channel < DELIVERY_CHANNEL_COUNT; ++channel) {
+                if (connectionState.pendingMessages[channel].empty()) {
+                    continue;
+                }
+                PackPendingMessagesUnlocked(connectionState, static_cast<DeliveryChannel>(channel), payloadPool,
+                    currentTime, nextSendTime, out_packets);
+                messagesRemain = messagesRemain || !connectionState.pendingMessages[channel].empty();
+            }
+            if (out_nextSendTime) *out_nextSendTime = nextSendTime;
+
+            connectionState.outboundAssemblyQueued = messagesRemain;
+            return messagesRemain;
         }
 
         // --- ProcessIncomingPacketHeader ---
@@ -110,12 +375,93 @@ namespace RiftForged {
             const uint8_t* packetPayloadData,
             uint16_t packetPayloadLength,
             const uint8_t** out_payloadToProcess,
-            uint16_t* out_payloadSize
+            uint32_t* out_payloadSize
         ) {
             std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
 
             if (out_payloadToProcess) *out_payloadToProcess = nullptr;
             if (out_payloadSize) *out_payloadSize = 0;
+            connectionState.telemetry.OnPacketReceived(static_cast<uint32_t>(GetGamePacketHeaderSize()) + packetPayloadLength);
+
+            // A compressed payload is expanded first; everything below sees the original bytes. One that
+            // was not negotiated or does not decompress is dropped before it touches any state.
+            if (receivedHeader.payloadEncoding != static_cast<uint8_t>(PayloadEncoding::Raw)) {
+                const uint8_t* decompressedPayload = nullptr;
+                uint32_t decompressedSize = 0;
+                if (receivedHeader.payloadEncoding != static_cast<uint8_t>(PayloadEncoding::Zstd) ||
+                    (connectionState.capabilities & CONNECTION_CAPABILITY_COMPRESSION) == 0 || !connectionState.payloadCompressor ||
+                    !packetPayloadData ||
+                    !connectionState.payloadCompressor->Decompress(packetPayloadData, packetPayloadLength, &decompressedPayload, &decompressedSize) ||
+                    decompressedSize > UINT16_MAX) {
+                    // Counted rather than warned about: a peer can send these at line rate.
+                    RF_NETWORK_DEBUG("RECV: Undecodable payload (encoding {}, {} bytes). Dropping packet. Flags: 0x{:X}",
+                        receivedHeader.payloadEncoding, packetPayloadLength, receivedHeader.flags);
+                    connectionState.compressionStats.decompressionFailures++;
+                    return false;
+                }
+                packetPayloadData = decompressedPayload;
+                packetPayloadLength = static_cast<uint16_t>(decompressedSize);
+                connectionState.compressionStats.packetsDecompressed++;
+            }
+
+            // A malformed coalesced packet is dropped before it can acknowledge or advance anything.
+            if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_COALESCED) &&
+                !ValidateCoalescedPayload(packetPayloadData, packetPayloadLength)) {
+                RF_NETWORK_WARN("RECV: Malformed coalesced payload ({} bytes). Dropping packet. Flags: 0x{:X}", packetPayloadLength, receivedHeader.flags);
+                return false;
+            }
+
+            // Data packets name the channel they were sent on. One naming a channel that does not exist,
+            // or whose reliability does not match the channel's mode, is dropped the same way.
+            const bool isChannelData = IsChannelDataPacket(receivedHeader.flags);
+            const DeliveryChannel channel = static_cast<DeliveryChannel>(receivedHeader.channelId);
+            if (isChannelData && (channel >= DeliveryChannel::Count ||
+                IsReliableChannel(channel) != HasFlag(receivedHeader.flags, GamePacketFlag::IS_RELIABLE))) {
+                RF_NETWORK_WARN("RECV: Data packet on invalid channel {}. Dropping packet. Flags: 0x{:X}", receivedHeader.channelId, receivedHeader.flags);
+                return false;
+            }
+            const ChannelMode channelMode = isChannelData ? GetChannelMode(channel) : ChannelMode::Unreliable;
+            ChannelReceiveState* channelState = isChannelData ? &connectionState.channelReceiveStates[receivedHeader.channelId] : nullptr;
+            const OrderedArrival orderedArrival = channelMode == ChannelMode::ReliableOrdered ?
+                channelState->ordered.Classify(receivedHeader.channelSequence) : OrderedArrival::InOrder;
+
+            // Fragments are stored before their sequence is marked received: one the reassembler
+            // cannot take yet is left unacknowledged, so the sender retransmits it later. Ordered
+            // packets beyond the channel's reorder window, or that arrive early when the reorder
+            // buffer cannot be allocated, are held off the same way.
+            const bool isFragment = HasFlag(receivedHeader.flags, GamePacketFlag::IS_FRAGMENT);
+            FragmentHeader fragmentHeader;
+            if (isFragment) {
+                if (!HasFlag(receivedHeader.flags, GamePacketFlag::IS_RELIABLE) || HasFlag(receivedHeader.flags, GamePacketFlag::IS_COALESCED) ||
+                    !packetPayloadData || packetPayloadLength < sizeof(FragmentHeader)) {
+                    RF_NETWORK_WARN("RECV: Malformed fragment ({} bytes). Dropping packet. Flags: 0x{:X}", packetPayloadLength, receivedHeader.flags);
+                    return false;
+                }
+                std::memcpy(&fragmentHeader, packetPayloadData, sizeof(FragmentHeader));
+            }
+            const uint8_t* reassembledMessage = nullptr;
+            uint32_t reassembledMessageSize = 0;
+            auto acceptFragment = [&]() {
+                return connectionState.fragmentReassembler.Accept(fragmentHeader,
+                    packetPayloadData + sizeof(FragmentHeader),
+                    packetPayloadLength - static_cast<uint32_t>(sizeof(FragmentHeader)),
+                    std::chrono::steady_clock::now(),
+                    &reassembledMessage,
+                    &reassembledMessageSize) != FragmentAcceptResult::Rejected;
+            };
+            auto admitNewReliablePacket = [&]() {
+                if (orderedArrival == OrderedArrival::TooFarAhead) {
+                    RF_NETWORK_DEBUG("RECV RELIABLE: Seq={} is beyond the reorder window of channel {} (ChannelSeq={}). Leaving it unacknowledged.",
+                        receivedHeader.sequenceNumber, receivedHeader.channelId, receivedHeader.channelSequence);
+                    return false;
+                }
+                if (orderedArrival == OrderedArrival::Early && !channelState->ordered.Reserve()) {
+                    RF_NETWORK_ERROR("RECV RELIABLE: Failed to allocate the reorder buffer of channel {}. Leaving Seq={} unacknowledged.",
+                        receivedHeader.channelId, receivedHeader.sequenceNumber);
+                    return false;
+                }
+                return !isFragment || acceptFragment();
+            };
 
             connectionState.lastPacketReceivedTimeFromRemote = std::chrono::steady_clock::now();
 
@@ -124,80 +470,100 @@ namespace RiftForged {
 
             if (remoteAckNum > 0 || remoteAckBits > 0 || HasFlag(receivedHeader.flags, GamePacketFlag::IS_ACK_ONLY)) {
                 RF_NETWORK_TRACE("ACK RECV: Processing ACKs from remote: RemoteAckNum={}, RemoteAckBits=0x{:08X}. Our current unacked count: {}. HeaderFlags=0x{:02X}",
-                    remoteAckNum, remoteAckBits, connectionState.unacknowledgedSentPackets.size(), receivedHeader.flags);
+                    remoteAckNum, remoteAckBits, connectionState.unacknowledgedSentPackets.Size(), receivedHeader.flags);
             }
 
-            size_t preAckRemovalCount = connectionState.unacknowledgedSentPackets.size();
+            size_t preAckRemovalCount = connectionState.unacknowledgedSentPackets.Size();
             int actualAckedCountThisPass = 0;
 
-            connectionState.unacknowledgedSentPackets.remove_if(
-                [&](const ReliableConnectionState::SentPacketInfo& sentPacket) {
-                    bool acknowledged = false;
-                    if (sentPacket.sequenceNumber == remoteAckNum) {
-                        acknowledged = true;
-                        RF_NETWORK_INFO("ACK MATCH: Direct ACK for our_sent_seq={} by remote_ack_num={}. Marking for removal.",
-                            sentPacket.sequenceNumber, remoteAckNum);
-                    }
-                    else if (sentPacket.sequenceNumber < remoteAckNum) {
-                        uint32_t diff = remoteAckNum - sentPacket.sequenceNumber;
-                        if (diff > 0 && diff <= 32) {
-                            uint32_t bitIndex = diff - 1;
-                            if ((remoteAckBits >> bitIndex) & 1U) {
-                                acknowledged = true;
-                                RF_NETWORK_INFO("ACK MATCH: Bitfield ACK for our_sent_seq={} (diff={}, bitIndex={}) by remote_ack_num={}, remote_ack_bits=0x{:08X}. Marking for removal.",
-                                    sentPacket.sequenceNumber, diff, bitIndex, remoteAckNum, remoteAckBits);
-                            }
-                            else {
-                                RF_NETWORK_TRACE("ACK CHECK: Bitfield NO match for our_sent_seq={} (diff={}, bitIndex={}). Remote AckBits: 0x{:08X}, Bit to test: 0x{:08X}",
-                                    sentPacket.sequenceNumber, diff, bitIndex, remoteAckBits, (1U << bitIndex));
-                            }
-                        }
-                        else {
-                            RF_NETWORK_TRACE("ACK CHECK: our_sent_seq={} is too old (diff={}) to be in bitfield of remote_ack_num={}. Not acknowledged by this packet.",
-                                sentPacket.sequenceNumber, diff, remoteAckNum);
-                        }
+            // Acknowledges one of our sequence numbers if it is still in flight. Each probe is a
+            // single ring slot, so the whole header costs at most 33 probes.
+            const auto ackTime = std::chrono::steady_clock::now();
+            auto acknowledgeSequence = [&](SequenceNumber ackedSeq) {
+                ReliableConnectionState::SentPacketInfo* sentPacket = connectionState.unacknowledgedSentPackets.Find(ackedSeq);
+                if (!sentPacket) {
+                    return;
+                }
+                actualAckedCountThisPass++;
+                if (connectionState.largestAckedSequence == 0 || IsSequenceGreaterThan(ackedSeq, connectionState.largestAckedSequence)) {
+                    connectionState.largestAckedSequence = ackedSeq;
+                    connectionState.fastRetransmitCheckPending = true;
+                }
+                if (sentPacket->fastRetransmitted &&
+                    std::chrono::duration<float, std::milli>(ackTime - sentPacket->timeSent).count() < connectionState.smoothedRTT_ms / 2.0f) {
+                    connectionState.retransmitStats.spuriousFastRetransmits++;
+                }
+                if (sentPacket->retries == 0) {
+                    float rtt_sample_ms = static_cast<float>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            ackTime - sentPacket->timeSent
+                        ).count()
+                        );
+                    RF_NETWORK_TRACE("RTT Sample for Seq {}: {:.2f} ms", sentPacket->sequenceNumber, rtt_sample_ms);
+                    connectionState.ApplyRTTSampleUnlocked(rtt_sample_ms); // <<< USING UNLOCKED VERSION
+                    connectionState.telemetry.OnRttSample(rtt_sample_ms);
+                    RF_NETWORK_TRACE("RTO Updated for connection: {:.2f} ms (SRTT: {:.2f}, RTTVAR: {:.2f})",
+                        connectionState.retransmissionTimeout_ms,
+                        connectionState.smoothedRTT_ms,
+                        connectionState.rttVariance_ms);
+                }
+                else {
+                    RF_NETWORK_TRACE("RTT Sample Skipped for retransmitted packet Seq {} (retries={})",
+                        sentPacket->sequenceNumber, sentPacket->retries);
+                }
+                connectionState.congestionController.OnPacketAcked(
+                    static_cast<uint32_t>(GetGamePacketHeaderSize()) + sentPacket->payload.Size());
+                connectionState.unacknowledgedSentPackets.Remove(ackedSeq);
+            };
+
+            if (!connectionState.unacknowledgedSentPackets.Empty()) {
+                if (connectionState.unacknowledgedSentPackets.Find(remoteAckNum)) {
+                    RF_NETWORK_TRACE("ACK MATCH: Direct ACK for our_sent_seq={} by remote_ack_num={}. Marking for removal.",
+                        remoteAckNum, remoteAckNum);
+                    acknowledgeSequence(remoteAckNum);
+                }
+                for (uint32_t bitIndex = 0; remoteAckBits != 0 && bitIndex < 32; ++bitIndex) {
+                    if (!((remoteAckBits >> bitIndex) & 1U)) {
+                        continue;
                     }
-                    else {
-                        RF_NETWORK_TRACE("ACK CHECK: our_sent_seq={} > remote_ack_num={}. Not ACKed by this ack number or bitfield.",
-                            sentPacket.sequenceNumber, remoteAckNum);
+                    SequenceNumber ackedSeq = static_cast<SequenceNumber>(remoteAckNum - (bitIndex + 1));
+                    if (connectionState.unacknowledgedSentPackets.Find(ackedSeq)) {
+                        RF_NETWORK_TRACE("ACK MATCH: Bitfield ACK for our_sent_seq={} (diff={}, bitIndex={}) by remote_ack_num={}, remote_ack_bits=0x{:08X}. Marking for removal.",
+                            ackedSeq, bitIndex + 1, bitIndex, remoteAckNum, remoteAckBits);
+                        acknowledgeSequence(ackedSeq);
                     }
+                }
+            }
 
-                    if (acknowledged) {
-                        actualAckedCountThisPass++;
-                        if (sentPacket.retries == 0) {
-                            float rtt_sample_ms = static_cast<float>(
-                                std::chrono::duration_cast<std::chrono::milliseconds>(
-                                    std::chrono::steady_clock::now() - sentPacket.timeSent
-                                ).count()
-                                );
-                            RF_NETWORK_TRACE("RTT Sample for Seq {}: {:.2f} ms", sentPacket.sequenceNumber, rtt_sample_ms);
-                            connectionState.ApplyRTTSampleUnlocked(rtt_sample_ms); // <<< USING UNLOCKED VERSION
-                            RF_NETWORK_INFO("RTO Updated for connection: {:.2f} ms (SRTT: {:.2f}, RTTVAR: {:.2f})",
-                                connectionState.retransmissionTimeout_ms,
-                                connectionState.smoothedRTT_ms,
-                                connectionState.rttVariance_ms);
-                        }
-                        else {
-                            RF_NETWORK_TRACE("RTT Sample Skipped for retransmitted packet Seq {} (retries={})",
-                                sentPacket.sequenceNumber, sentPacket.retries);
-                        }
-                        return true;
+            // A selective ack block reaches back SELECTIVE_ACK_WINDOW_BITS sequences, so a burst loss
+            // is reported in one round trip instead of leaving the rest of the burst to time out.
+            if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_ACK_ONLY) &&
+                (connectionState.capabilities & CONNECTION_CAPABILITY_SELECTIVE_ACKS) != 0 &&
+                packetPayloadData && packetPayloadLength == sizeof(SelectiveAckBlock) &&
+                !connectionState.unacknowledgedSentPackets.Empty()) {
+                SelectiveAckBlock selectiveAck;
+                std::memcpy(&selectiveAck, packetPayloadData, sizeof(SelectiveAckBlock));
+                ForEachSelectivelyAcked(selectiveAck, [&](SequenceNumber ackedSeq) {
+                    if (connectionState.unacknowledgedSentPackets.Find(ackedSeq)) {
+                        RF_NETWORK_TRACE("ACK MATCH: Selective ACK for our_sent_seq={} (block base {}).", ackedSeq, selectiveAck.highestReceived);
+                        acknowledgeSequence(ackedSeq);
                     }
-                    return false;
-                }
-            );
+                });
+            }
 
             if (actualAckedCountThisPass > 0) {
                 RF_NETWORK_TRACE("Processed {} ACKs. Unacked packets remaining: {} (was {})",
-                    actualAckedCountThisPass, connectionState.unacknowledgedSentPackets.size(), preAckRemovalCount);
+                    actualAckedCountThisPass, connectionState.unacknowledgedSentPackets.Size(), preAckRemovalCount);
             }
             else if (preAckRemovalCount > 0 && (remoteAckNum > 0 || remoteAckBits > 0)) {
                 RF_NETWORK_TRACE("ACK PROC: No new packets ACKed this pass. RemoteAckNum={}, RemoteAckBits=0x{:08X}. Unacked count remains {}.",
-                    remoteAckNum, remoteAckBits, connectionState.unacknowledgedSentPackets.size());
+                    remoteAckNum, remoteAckBits, connectionState.unacknowledgedSentPackets.Size());
             }
 
             bool shouldRelayToGameLogic = false;
             bool ackStateForRemoteUpdated = false;
+            bool receivedDuplicate = false; // A reliable packet already inside the receive window...
+            uint32_t duplicateAge = 0;      // ...and how far behind the highest received it is.
 
             if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_RELIABLE)) {
                 SequenceNumber incomingSeqNum = receivedHeader.sequenceNumber;
@@ -205,55 +571,76 @@ namespace RiftForged {
                     incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote, connectionState.receivedSequenceBitfield);
 
                 if (IsSequenceGreaterThan(incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote)) {
-                    uint32_t diff = incomingSeqNum - connectionState.highestReceivedSequenceNumberFromRemote; // Careful with wrap-around if not using IsSequenceGreaterThan
-                    if (diff >= 32) { // If using proper sequence comparison, diff is direct for positive jumps
-                        connectionState.receivedSequenceBitfield = 0;
-                        RF_NETWORK_WARN("RECV RELIABLE: Large sequence number jump detected (Seq={}, prev_highest={}, diff={}). Resetting receivedSequenceBitfield.",
-                            incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote, diff);
+                    if (!admitNewReliablePacket()) {
+                        return false;
                     }
-                    else {
-                        connectionState.receivedSequenceBitfield <<= diff;
-                        // Bit for the *old* highest needs to be set before new highest is updated
-                        if (connectionState.highestReceivedSequenceNumberFromRemote > 0 || diff > 0) { // Only if old highest was valid or there's a diff
-                            connectionState.receivedSequenceBitfield |= (1U << (diff - 1));
-                        }
+                    uint32_t diff = incomingSeqNum - connectionState.highestReceivedSequenceNumberFromRemote; // Positive jump; IsSequenceGreaterThan handled wrap-around
+                    if (diff > SELECTIVE_ACK_WINDOW_BITS) {
+                        RF_NETWORK_WARN("RECV RELIABLE: Large sequence number jump detected (Seq={}, prev_highest={}, diff={}). Resetting receive window.",
+                            incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote, diff);
                     }
+                    // Shifts the window and records the old highest, now 'diff' behind the new one.
+                    connectionState.receivedSequenceWindow.Advance(diff, connectionState.highestReceivedSequenceNumberFromRemote);
+                    connectionState.receivedSequenceBitfield = connectionState.receivedSequenceWindow.Low32();
                     connectionState.highestReceivedSequenceNumberFromRemote = incomingSeqNum;
                     shouldRelayToGameLogic = true;
                     ackStateForRemoteUpdated = true;
-                    RF_NETWORK_INFO("RECV RELIABLE: New highest remote Seq={}. Our ACK state FOR THEM: highest_ack_to_send={}, bits_to_send=0x{:08X}. Will process payload.",
+                    RF_NETWORK_TRACE("RECV RELIABLE: New highest remote Seq={}. Our ACK state FOR THEM: highest_ack_to_send={}, bits_to_send=0x{:08X}. Will process payload.",
                         incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote, connectionState.receivedSequenceBitfield);
                 }
                 else if (IsSequenceLessThan(incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote)) {
                     uint32_t diff = connectionState.highestReceivedSequenceNumberFromRemote - incomingSeqNum; // Careful with wrap-around
-                    if (diff > 0 && diff <= 32) {
-                        uint32_t bitToSet = (1U << (diff - 1));
-                        if (!(connectionState.receivedSequenceBitfield & bitToSet)) {
-                            connectionState.receivedSequenceBitfield |= bitToSet;
+                    if (diff > 0 && diff <= SELECTIVE_ACK_WINDOW_BITS) {
+                        if (!connectionState.receivedSequenceWindow.Test(diff)) {
+                            if (!admitNewReliablePacket()) {
+                                return false;
+                            }
+                            connectionState.receivedSequenceWindow.Set(diff);
+                            connectionState.receivedSequenceBitfield = connectionState.receivedSequenceWindow.Low32();
                             shouldRelayToGameLogic = true;
                             ackStateForRemoteUpdated = true;
-                            RF_NETWORK_INFO("RECV RELIABLE: Accepted out-of-order remote Seq={} (diff={}). Our ACK state FOR THEM: highest_ack_to_send={}, bits_to_send=0x{:08X}. Will process payload.",
+                            connectionState.telemetry.OnOutOfOrderReceived();
+                            RF_NETWORK_TRACE("RECV RELIABLE: Accepted out-of-order remote Seq={} (diff={}). Our ACK state FOR THEM: highest_ack_to_send={}, bits_to_send=0x{:08X}. Will process payload.",
                                 incomingSeqNum, diff, connectionState.highestReceivedSequenceNumberFromRemote, connectionState.receivedSequenceBitfield);
                         }
                         else {
-                            RF_NETWORK_TRACE("RECV RELIABLE: Duplicate OLD reliable remote Seq={} (already in bitfield). Discarding payload.", incomingSeqNum);
+                            RF_NETWORK_TRACE("RECV RELIABLE: Duplicate OLD reliable remote Seq={} (already in receive window). Discarding payload.", incomingSeqNum);
+                            connectionState.telemetry.OnDuplicateReceived();
                             shouldRelayToGameLogic = false;
+                            receivedDuplicate = true;
+                            duplicateAge = diff;
                         }
                     }
                     else {
-                        RF_NETWORK_TRACE("RECV RELIABLE: Very OLD reliable remote Seq={} (older than highest_remote_seq {} - 32). Discarding payload.",
-                            incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote);
+                        RF_NETWORK_TRACE("RECV RELIABLE: Very OLD reliable remote Seq={} (older than highest_remote_seq {} - {}). Discarding payload.",
+                            incomingSeqNum, connectionState.highestReceivedSequenceNumberFromRemote, SELECTIVE_ACK_WINDOW_BITS);
+                        connectionState.telemetry.OnDuplicateReceived();
                         shouldRelayToGameLogic = false;
                     }
                 }
                 else { // incomingSeqNum == connectionState.highestReceivedSequenceNumberFromRemote
                     RF_NETWORK_TRACE("RECV RELIABLE: Duplicate of current highest remote Seq={}. Discarding payload.", incomingSeqNum);
+                    connectionState.telemetry.OnDuplicateReceived();
                     shouldRelayToGameLogic = false;
+                    receivedDuplicate = true;
                 }
             }
             else if (packetPayloadData && packetPayloadLength > 0 && !HasFlag(receivedHeader.flags, GamePacketFlag::IS_ACK_ONLY)) {
-                RF_NETWORK_TRACE("RECV UNRELIABLE: Received UNRELIABLE packet with payload. Flags: 0x{:X}. Will process payload.", receivedHeader.flags);
-                shouldRelayToGameLogic = true;
+                if (channelMode == ChannelMode::UnreliableSequenced && channelState->hasNewestSequence &&
+                    !IsChannelSequenceNewer(receivedHeader.channelSequence, channelState->newestSequence)) {
+                    RF_NETWORK_TRACE("RECV UNRELIABLE: Stale packet on sequenced channel {} (ChannelSeq={}, newest {}). Discarding payload.",
+                        receivedHeader.channelId, receivedHeader.channelSequence, channelState->newestSequence);
+                    connectionState.telemetry.OnOutOfOrderReceived();
+                    shouldRelayToGameLogic = false;
+                }
+                else {
+                    if (channelMode == ChannelMode::UnreliableSequenced) {
+                        channelState->newestSequence = receivedHeader.channelSequence;
+                        channelState->hasNewestSequence = true;
+                    }
+                    RF_NETWORK_TRACE("RECV UNRELIABLE: Received UNRELIABLE packet with payload. Flags: 0x{:X}. Will process payload.", receivedHeader.flags);
+                    shouldRelayToGameLogic = true;
+                }
             }
             else if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_ACK_ONLY)) {
                 RF_NETWORK_TRACE("RECV ACK_ONLY: Processed ACKs. No payload to relay. Flags: 0x{:X}", receivedHeader.flags);
@@ -267,6 +654,60 @@ namespace RiftForged {
             if (ackStateForRemoteUpdated) {
                 connectionState.hasPendingAckToSend = true;
                 RF_NETWORK_TRACE("ACK STATE UPDATE: Marking hasPendingAckToSend=true for remote (because we received new reliable data Seq={}).", receivedHeader.sequenceNumber);
+                if ((connectionState.capabilities & CONNECTION_CAPABILITY_SELECTIVE_ACKS) != 0 &&
+                    connectionState.receivedSequenceWindow.HasGap(connectionState.highestReceivedSequenceNumberFromRemote)) {
+                    connectionState.hasPendingSelectiveAck = true;
+                }
+            }
+            else if (receivedDuplicate) {
+                // A retransmission of a packet we already have means our ACK for it was lost; acknowledge
+                // it again. Beyond the header's 32 bits only a selective ack block can reach it.
+                connectionState.hasPendingAckToSend = true;
+                if ((connectionState.capabilities & CONNECTION_CAPABILITY_SELECTIVE_ACKS) != 0 && duplicateAge > 32) {
+                    connectionState.hasPendingSelectiveAck = true;
+                }
+            }
+
+            // ACK-only packets are sequenced so they can be acknowledged, but never carry
+            // application data; a payload is a selective ack block, handled above.
+            if (HasFlag(receivedHeader.flags, GamePacketFlag::IS_ACK_ONLY)) {
+                return false;
+            }
+
+            // On an ordered channel only the packet whose turn it is goes straight through. An early
+            // one is copied aside (freeing any reassembly space) for PopOrderedMessage().
+            if (shouldRelayToGameLogic && channelMode == ChannelMode::ReliableOrdered) {
+                const uint8_t* deliverable = isFragment ? reassembledMessage : packetPayloadData;
+                const uint32_t deliverableSize = isFragment ? reassembledMessageSize : packetPayloadLength;
+                if (orderedArrival != OrderedArrival::InOrder) {
+                    if (orderedArrival == OrderedArrival::Early) {
+                        // Reserved in admitNewReliablePacket before the sequence was acknowledged.
+                        channelState->ordered.Store(receivedHeader.channelSequence, deliverable, deliverableSize,
+                            HasFlag(receivedHeader.flags, GamePacketFlag::IS_COALESCED));
+                        RF_NETWORK_TRACE("RECV RELIABLE: Holding back ChannelSeq={} on ordered channel {} until earlier packets arrive.",
+                            receivedHeader.channelSequence, receivedHeader.channelId);
+                    }
+                    else {
+                        RF_NETWORK_TRACE("RECV RELIABLE: New Seq={} repeats ChannelSeq={} on ordered channel {}. Discarding payload.",
+                            receivedHeader.sequenceNumber, receivedHeader.channelSequence, receivedHeader.channelId);
+                        connectionState.telemetry.OnDuplicateReceived();
+                    }
+                    if (isFragment && reassembledMessage) {
+                        connectionState.fragmentReassembler.Release(reassembledMessage);
+                    }
+                    return false;
+                }
+                channelState->ordered.Advance();
+            }
+
+            if (shouldRelayToGameLogic && isFragment) {
+                if (reassembledMessage) {
+                    if (out_payloadToProcess) *out_payloadToProcess = reassembledMessage;
+                    if (out_payloadSize) *out_payloadSize = reassembledMessageSize;
+                    RF_NETWORK_TRACE("PAYLOAD TO PROCESS: Reassembled message {} ({} bytes).", fragmentHeader.messageId, reassembledMessageSize);
+                    return true;
+                }
+                return false; // Stored; more fragments to come.
             }
 
             if (shouldRelayToGameLogic) {
@@ -286,48 +727,97 @@ namespace RiftForged {
             return false;
         }
 
-        // --- GetPacketsForRetransmission ---
-        std::vector<std::vector<uint8_t>> GetPacketsForRetransmission(
+        // --- ReleaseReassembledMessage ---
+        void ReleaseReassembledMessage(ReliableConnectionState& connectionState, const uint8_t* message) {
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            connectionState.fragmentReassembler.Release(message);
+        }
+
+        // --- PopOrderedMessage ---
+        bool PopOrderedMessage(
             ReliableConnectionState& connectionState,
-            std::chrono::steady_clock::time_point currentTime
+            DeliveryChannel channel,
+            std::vector<uint8_t>& out_payload,
+            bool& out_coalesced
         ) {
-            std::vector<std::vector<uint8_t>> packetsToResend;
+            if (channel >= DeliveryChannel::Count || GetChannelMode(channel) != ChannelMode::ReliableOrdered) {
+                return false;
+            }
             std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
-            auto it = connectionState.unacknowledgedSentPackets.begin();
+            return connectionState.channelReceiveStates[static_cast<size_t>(channel)].ordered.PopReady(out_payload, out_coalesced);
+        }
 
-            while (it != connectionState.unacknowledgedSentPackets.end()) {
-                ReliableConnectionState::SentPacketInfo& sentPacket = *it;
+        // --- GetPacketsForRetransmission ---
+        std::vector<OutgoingPacket> GetPacketsForRetransmission(
+            ReliableConnectionState& connectionState,
+            std::chrono::steady_clock::time_point currentTime,
+            std::chrono::steady_clock::time_point* out_nextDeadline
+        ) {
+            std::vector<OutgoingPacket> packetsToResend;
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            std::vector<SequenceNumber> packetsToDrop;
+            // Every packet shares the connection RTO, so the next deadline follows the oldest send time.
+            auto earliestTimeSent = std::chrono::steady_clock::time_point::max();
+            // The timer backs off once per expiry, not once per packet: a burst that expires together
+            // would otherwise push the RTO straight to MAX_RTO_MS.
+            const float rtoThatTriggered = connectionState.retransmissionTimeout_ms;
+
+            connectionState.unacknowledgedSentPackets.ForEach([&](ReliableConnectionState::SentPacketInfo& sentPacket) {
                 auto timeSinceSent = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - sentPacket.timeSent);
+                if (timeSinceSent.count() < static_cast<long long>(rtoThatTriggered)) {
+                    earliestTimeSent = std::min(earliestTimeSent, sentPacket.timeSent);
+                    return;
+                }
 
-                if (timeSinceSent.count() >= static_cast<long long>(connectionState.retransmissionTimeout_ms)) {
-                    if (connectionState.ShouldDropPacket(sentPacket.retries)) {
-                        RF_NETWORK_ERROR("MAX RETRIES: Packet Seq={} EXCEEDED MAX RETRIES ({}). RTO used: {:.0f}ms. Dropping packet and flagging connection as lost.",
-                            sentPacket.sequenceNumber, MAX_PACKET_RETRIES, connectionState.retransmissionTimeout_ms);
-                        connectionState.connectionDroppedByMaxRetries = true;
-                        connectionState.isConnected = false;
-                        it = connectionState.unacknowledgedSentPackets.erase(it);
-                    }
-                    else {
-                        sentPacket.retries++;
-                        sentPacket.timeSent = currentTime;
-                        packetsToResend.push_back(sentPacket.packetData);
-
-                        // Store current RTO before doubling for logging
-                        float rtoThatTriggered = connectionState.retransmissionTimeout_ms;
-
-                        connectionState.retransmissionTimeout_ms = connectionState.retransmissionTimeout_ms * 2.0f;
-                        connectionState.retransmissionTimeout_ms = std::min(connectionState.retransmissionTimeout_ms, MAX_RTO_MS);
-                        connectionState.retransmissionTimeout_ms = std::max(connectionState.retransmissionTimeout_ms, MIN_RTO_MS);
-
-                        RF_NETWORK_WARN("RETRANSMIT: Packet Seq={} (Attempt #{}). RTO that triggered retransmit: {:.0f}ms. New connection RTO: {:.0f}ms",
-                            sentPacket.sequenceNumber, sentPacket.retries,
-                            rtoThatTriggered,
-                            connectionState.retransmissionTimeout_ms);
-                        it++;
-                    }
+                if (connectionState.ShouldDropPacket(sentPacket.retries)) {
+                    RF_NETWORK_ERROR("MAX RETRIES: Packet Seq={} EXCEEDED MAX RETRIES ({}). RTO used: {:.0f}ms. Dropping packet and flagging connection as lost.",
+                        sentPacket.sequenceNumber, MAX_PACKET_RETRIES, connectionState.retransmissionTimeout_ms);
+                    connectionState.connectionDroppedByMaxRetries = true;
+                    connectionState.isConnected = false;
+                    packetsToDrop.push_back(sentPacket.sequenceNumber);
+                    connectionState.telemetry.OnPacketAbandoned();
+                    connectionState.congestionController.OnPacketAbandoned(
+                        static_cast<uint32_t>(GetGamePacketHeaderSize()) + sentPacket.payload.Size());
+                    return;
                 }
-                else {
-                    it++;
+
+                sentPacket.retries++;
+                sentPacket.timeSent = currentTime;
+                earliestTimeSent = std::min(earliestTimeSent, currentTime);
+                // Only the header is rebuilt: it carries our current ACK state. The payload
+                // buffer is the one from the original send.
+                sentPacket.header.ackNumber = connectionState.highestReceivedSequenceNumberFromRemote;
+                sentPacket.header.ackBitfield = connectionState.receivedSequenceBitfield;
+                OutgoingPacket& resend = packetsToResend.emplace_back();
+                resend.header = sentPacket.header;
+                resend.payload = sentPacket.payload;
+                resend.valid = true;
+                // An RTO is the strongest congestion signal; the resend still spends pacer tokens, so
+                // a retransmission burst delays new data instead of adding to it.
+                connectionState.congestionController.OnPacketLost(sentPacket.sequenceNumber,
+                    connectionState.nextOutgoingSequenceNumber, true);
+                connectionState.congestionController.OnPacketSent(resend.TotalSize(), false, currentTime, connectionState.smoothedRTT_ms);
+                connectionState.retransmitStats.timeoutRetransmits++;
+                connectionState.telemetry.OnRetransmit();
+
+                RF_NETWORK_TRACE("RETRANSMIT: Packet Seq={} (Attempt #{}). RTO that triggered retransmit: {:.0f}ms.",
+                    sentPacket.sequenceNumber, sentPacket.retries,
+                    rtoThatTriggered);
+            });
+
+            if (!packetsToResend.empty()) {
+                connectionState.retransmissionTimeout_ms = std::min(rtoThatTriggered * 2.0f, MAX_RTO_MS);
+                connectionState.retransmissionTimeout_ms = std::max(connectionState.retransmissionTimeout_ms, MIN_RTO_MS);
+            }
+
+            for (SequenceNumber seq : packetsToDrop) {
+                connectionState.unacknowledgedSentPackets.Remove(seq);
+            }
+            if (out_nextDeadline) {
+                *out_nextDeadline = std::chrono::steady_clock::time_point::max();
+                if (earliestTimeSent != std::chrono::steady_clock::time_point::max() && !connectionState.unacknowledgedSentPackets.Empty()) {
+                    *out_nextDeadline = earliestTimeSent + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<float, std::milli>(connectionState.retransmissionTimeout_ms));
                 }
             }
             if (!packetsToResend.empty()) {
@@ -336,10 +826,72 @@ namespace RiftForged {
             return packetsToResend;
         }
 
+        // --- GetPacketsForFastRetransmission ---
+        std::vector<OutgoingPacket> GetPacketsForFastRetransmission(
+            ReliableConnectionState& connectionState,
+            std::chrono::steady_clock::time_point currentTime
+        ) {
+            std::vector<OutgoingPacket> packetsToResend;
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            if (!connectionState.fastRetransmitCheckPending) {
+                return packetsToResend;
+            }
+            connectionState.fastRetransmitCheckPending = false;
+
+            // Everything at least FAST_RETRANSMIT_PACKET_THRESHOLD behind the newest ACK is presumed lost.
+            const SequenceNumber lossBoundary = static_cast<SequenceNumber>(
+                connectionState.largestAckedSequence - (FAST_RETRANSMIT_PACKET_THRESHOLD - 1));
+            connectionState.unacknowledgedSentPackets.ForEachBefore(lossBoundary, [&](ReliableConnectionState::SentPacketInfo& sentPacket) {
+                // Each packet gets one fast retransmit; after that only its RTO can resend it, and the
+                // RTO path also decides when it has been retried too often.
+                if (sentPacket.fastRetransmitted || sentPacket.isAckOnly || connectionState.ShouldDropPacket(sentPacket.retries)) {
+                    return;
+                }
+                sentPacket.fastRetransmitted = true;
+                sentPacket.retries++;
+                sentPacket.timeSent = currentTime;
+                sentPacket.header.ackNumber = connectionState.highestReceivedSequenceNumberFromRemote;
+                sentPacket.header.ackBitfield = connectionState.receivedSequenceBitfield;
+                OutgoingPacket& resend = packetsToResend.emplace_back();
+                resend.header = sentPacket.header;
+                resend.payload = sentPacket.payload;
+                resend.valid = true;
+                connectionState.congestionController.OnPacketLost(sentPacket.sequenceNumber,
+                    connectionState.nextOutgoingSequenceNumber, false);
+                connectionState.congestionController.OnPacketSent(resend.TotalSize(), false, currentTime, connectionState.smoothedRTT_ms);
+                connectionState.retransmitStats.fastRetransmits++;
+                connectionState.telemetry.OnRetransmit();
+                RF_NETWORK_DEBUG("FAST RETRANSMIT: Packet Seq={} (largest acked {}).", sentPacket.sequenceNumber, connectionState.largestAckedSequence);
+            });
+            return packetsToResend;
+        }
+
+        // How long a pending ACK may wait for an outgoing packet to piggyback on. Caller holds the lock.
+        static float AckDelayThresholdMsUnlocked(const ReliableConnectionState& connectionState) {
+            float ackDelayThresholdMs = std::min(connectionState.smoothedRTT_ms / 4.0f, 20.0f); // e.g. RTT/4 or max 20ms
+            if (ackDelayThresholdMs < 5.0f) ackDelayThresholdMs = 5.0f; // Minimum 5ms delay
+            return ackDelayThresholdMs;
+        }
+
+        // --- GetAckFlushDeadline ---
+        std::chrono::steady_clock::time_point GetAckFlushDeadline(ReliableConnectionState& connectionState) {
+            std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+            if (!connectionState.hasPendingAckToSend && !connectionState.hasPendingSelectiveAck) {
+                return std::chrono::steady_clock::time_point::max();
+            }
+            if (connectionState.lastPacketSentTimeToRemote == std::chrono::steady_clock::time_point::min()) {
+                return std::chrono::steady_clock::now(); // Nothing sent yet; TrySendAckOnlyPacket sends immediately.
+            }
+            // TrySendAckOnlyPacket compares whole milliseconds, so round the threshold up to match.
+            return connectionState.lastPacketSentTimeToRemote +
+                std::chrono::milliseconds(static_cast<long long>(AckDelayThresholdMsUnlocked(connectionState)) + 1);
+        }
+
         // --- TrySendAckOnlyPacket ---
         bool TrySendAckOnlyPacket(ReliableConnectionState& connectionState,
+            PacketBufferPool& payloadPool,
             std::chrono::steady_clock::time_point currentTime,
-            std::function<void(const std::vector<uint8_t>&)> sendPacketFunc) {
+            std::function<void(const OutgoingPacket&)> sendPacketFunc) {
 
             // Temp store values needed outside lock to avoid holding lock during PrepareOutgoingPacketUnlocked_Internal
             bool needsToSendAck = false;
@@ -350,12 +902,11 @@ namespace RiftForged {
 
             { // Scope for the first lock
                 std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
-                if (!connectionState.hasPendingAckToSend) {
+                if (!connectionState.hasPendingAckToSend && !connectionState.hasPendingSelectiveAck) {
                     return false;
                 }
 
-                float ackDelayThresholdMs = std::min(connectionState.smoothedRTT_ms / 4.0f, 20.0f); // e.g. RTT/4 or max 20ms
-                if (ackDelayThresholdMs < 5.0f) ackDelayThresholdMs = 5.0f; // Minimum 5ms delay
+                float ackDelayThresholdMs = AckDelayThresholdMsUnlocked(connectionState);
 
                 calculatedTimeSinceLastSent = std::chrono::duration_cast<std::chrono::milliseconds>(
                     currentTime - connectionState.lastPacketSentTimeToRemote
@@ -383,22 +934,31 @@ namespace RiftForged {
                 // The original problem was TrySendAckOnlyPacket locking, then calling public PrepareOutgoingPacket which also locked.
                 // Now, TrySendAckOnlyPacket can lock, then call the internal PrepareOutgoingPacketUnlocked_Internal
 
-                std::vector<uint8_t> ackPacket;
+                OutgoingPacket ackPacket;
                 { // Scope for the lock needed by PrepareOutgoingPacketUnlocked_Internal
                     std::lock_guard<std::mutex> lock(connectionState.internalStateMutex);
+                    PacketBufferRef selectiveAck;
+                    if (connectionState.hasPendingSelectiveAck) {
+                        selectiveAck = payloadPool.Acquire(sizeof(SelectiveAckBlock));
+                        if (selectiveAck) {
+                            SelectiveAckBlock block;
+                            connectionState.receivedSequenceWindow.ToBlock(connectionState.highestReceivedSequenceNumberFromRemote, block);
+                            std::memcpy(selectiveAck.MutableData(), &block, sizeof(SelectiveAckBlock));
+                        }
+                    }
                     ackPacket = PrepareOutgoingPacketUnlocked_Internal( // Use the internal unlocked version
                         connectionState,
-                        nullptr,
-                        0,
-                        flags
+                        selectiveAck,
+                        flags,
+                        GetDefaultChannel(flags)
                     );
                 } // Lock for PrepareOutgoingPacketUnlocked_Internal released
 
-                if (!ackPacket.empty()) {
+                if (ackPacket.valid) {
                     sendPacketFunc(ackPacket); // Use the provided callback to send the packet.
                     // Note: hasPendingAckToSend is set to false inside PrepareOutgoingPacketUnlocked_Internal
                     RF_NETWORK_DEBUG("Sent ACK-only packet (Header Seq: {}, Acking Remote Seq: {}, Bits: 0x{:08X}) after {}ms delay.",
-                        reinterpret_cast<const GamePacketHeader*>(ackPacket.data())->sequenceNumber,
+                        ackPacket.header.sequenceNumber,
                         currentHighestRemoteSeq,
                         currentRemoteAckBits,
                         calculatedTimeSinceLastSent);
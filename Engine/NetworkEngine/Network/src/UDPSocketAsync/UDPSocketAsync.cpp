@@ -6,7 +6,8 @@
 #include "UDPSocketAsync.h"      // Should now include the refactored header
 #include "INetworkIOEvents.h"    // For m_eventHandler calls
 #include "OverlappedIOContext.h" // For IOOperationType and OverlappedIOContext struct
-#include "../Utilities/Logger.h"     // Ensure this path is correct for RF_... macros
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h> // For NetworkIO thread count and pinning
 #include <stdexcept>             // For std::system_error, std::invalid_argument
 #include <vector>
 #include <cstring>               // For ZeroMemory, memcpy
@@ -15,19 +16,13 @@
 #include <ws2tcpip.h>            // For inet_pton, etc.
 #include <system_error>          // For std::system_error
 
-// DetermineNumWorkerThreads: A helper function to decide how many IOCP worker threads to create.
-// This is currently a static function. If thread count needs to be dynamically configurable per instance,
-// this logic would become a member function or configuration parameter.
+// DetermineNumWorkerThreads: One IOCP worker per CPU of the NetworkIO thread group. Evaluated in
+// Start() rather than at static-init time so the placement configured by main() is honoured.
 static unsigned int DetermineNumWorkerThreads() {
-    // It's common to use a number of threads equal to the number of CPU cores
-    // or (2 * num_cores + 1) for IOCP. Here, a simple 4 is chosen as a fallback
-    // if hardware_concurrency is 0 or for simplicity.
-    unsigned int num_threads = std::thread::hardware_concurrency();
-    if (num_threads == 0) num_threads = 4; // Fallback for systems where hardware_concurrency returns 0.
-    return num_threads;
+    using RiftForged::Utilities::Threading::ThreadGroup;
+    using RiftForged::Utilities::Threading::ThreadPlacement;
+    return ThreadPlacement::GetThreadCount(ThreadGroup::NetworkIO);
 }
-// This constant determines the actual number of worker threads used by this instance.
-static const unsigned int NUM_WORKER_THREADS_TO_CREATE = DetermineNumWorkerThreads();
 
 
 namespace RiftForged {
@@ -150,19 +145,18 @@ namespace RiftForged {
             }
             RF_NETWORK_DEBUG("UDPSocketAsync: Socket associated with IOCP successfully.");
 
-            // Pre-allocate and initialize a pool of OverlappedIOContext objects for receive operations.
-            // This avoids dynamic allocations during high-frequency receive events.
-            try {
-                m_receiveContextPool.reserve(MAX_PENDING_RECEIVES_IOCP);
-                for (int i = 0; i < MAX_PENDING_RECEIVES_IOCP; ++i) {
-                    m_receiveContextPool.emplace_back(std::make_unique<OverlappedIOContext>(IOOperationType::Recv, DEFAULT_UDP_BUFFER_SIZE_IOCP));
-                    m_freeReceiveContexts.push_back(m_receiveContextPool.back().get());
-                }
-                RF_NETWORK_INFO("UDPSocketAsync: Receive context pool initialized with %zu contexts.", m_freeReceiveContexts.size());
+            // Pre-allocate pools of OverlappedIOContext objects for receive and send operations.
+            // This avoids dynamic allocations during high-frequency receive and send events.
+            if (m_receiveContextPool.Initialize(IOOperationType::Recv, MAX_PENDING_RECEIVES_IOCP, DEFAULT_UDP_BUFFER_SIZE_IOCP) &&
+                m_sendContextPool.Initialize(IOOperationType::Send, MAX_PENDING_SENDS_IOCP, DEFAULT_UDP_BUFFER_SIZE_IOCP)) {
+                RF_NETWORK_INFO("UDPSocketAsync: Context pools initialized with %u receive and %u send contexts.",
+                    m_receiveContextPool.GetCapacity(), m_sendContextPool.GetCapacity());
             }
-            catch (const std::bad_alloc& e) {
-                RF_NETWORK_CRITICAL("UDPSocketAsync: Failed to allocate memory for receive context pool: %s", e.what());
-                m_eventHandler->OnNetworkError("Failed to allocate receive context pool", 0);
+            else {
+                RF_NETWORK_CRITICAL("UDPSocketAsync: Failed to allocate memory for context pools.");
+                m_eventHandler->OnNetworkError("Failed to allocate context pools", 0);
+                m_receiveContextPool.Clear();
+                m_sendContextPool.Clear();
                 if (m_iocpHandle) { CloseHandle(m_iocpHandle); m_iocpHandle = NULL; }
                 if (m_socket != INVALID_SOCKET) { closesocket(m_socket); m_socket = INVALID_SOCKET; }
                 WSACleanup();
@@ -193,10 +187,11 @@ namespace RiftForged {
             m_isRunning = true;
 
             // Create worker threads to process IOCP completions.
-            m_workerThreads.reserve(NUM_WORKER_THREADS_TO_CREATE);
-            for (unsigned int i = 0; i < NUM_WORKER_THREADS_TO_CREATE; ++i) {
+            const unsigned int numWorkerThreads = DetermineNumWorkerThreads();
+            m_workerThreads.reserve(numWorkerThreads);
+            for (unsigned int i = 0; i < numWorkerThreads; ++i) {
                 try {
-                    m_workerThreads.emplace_back(&UDPSocketAsync::WorkerThread, this);
+                    m_workerThreads.emplace_back(&UDPSocketAsync::WorkerThread, this, i);
                 }
                 catch (const std::system_error& e) {
                     RF_NETWORK_CRITICAL("UDPSocketAsync: Failed to create worker thread %u: %s", i, e.what());
@@ -281,13 +276,10 @@ namespace RiftForged {
                 RF_NETWORK_INFO("UDPSocketAsync: IOCP handle closed.");
             }
 
-            // Clear the receive context pool. unique_ptr's destructor will free memory.
-            {
-                std::lock_guard<std::mutex> lock(m_receiveContextMutex);
-                m_freeReceiveContexts.clear(); // Clear deque of raw pointers.
-            }
-            m_receiveContextPool.clear(); // unique_ptrs automatically delete owned objects.
-            RF_NETWORK_DEBUG("UDPSocketAsync: Receive context pool cleared.");
+            // Release the context pools. The IOCP is closed, so no operation can still reference them.
+            m_receiveContextPool.Clear();
+            m_sendContextPool.Clear();
+            RF_NETWORK_DEBUG("UDPSocketAsync: Context pools cleared.");
 
             // Clean up Winsock.
             WSACleanup();
@@ -297,21 +289,17 @@ namespace RiftForged {
 
         // GetFreeReceiveContextInternal: Retrieves a context from the pool for a receive operation.
         OverlappedIOContext* UDPSocketAsync::GetFreeReceiveContextInternal() {
-            std::lock_guard<std::mutex> lock(m_receiveContextMutex);
-            if (m_freeReceiveContexts.empty()) {
+            OverlappedIOContext* pContext = m_receiveContextPool.Acquire();
+            if (!pContext) {
                 RF_NETWORK_WARN("UDPSocketAsync: No free receive contexts available in pool. Consider increasing MAX_PENDING_RECEIVES_IOCP.");
-                return nullptr;
             }
-            OverlappedIOContext* pContext = m_freeReceiveContexts.front();
-            m_freeReceiveContexts.pop_front();
             return pContext;
         }
 
         // ReturnReceiveContextInternal: Returns a context to the pool.
         void UDPSocketAsync::ReturnReceiveContextInternal(OverlappedIOContext* pContext) {
             if (!pContext) return; // Prevent null pointer issues.
-            std::lock_guard<std::mutex> lock(m_receiveContextMutex);
-            m_freeReceiveContexts.push_back(pContext); // Add back to the end of the deque.
+            m_receiveContextPool.Return(pContext);
         }
 
         // PostReceiveInternal: Initiates an asynchronous receive operation.
@@ -361,133 +349,126 @@ namespace RiftForged {
 
         // WorkerThread: The main loop for each IOCP worker thread.
         // It continuously waits for completed I/O operations and dispatches them.
-        void UDPSocketAsync::WorkerThread() {
+        void UDPSocketAsync::WorkerThread(unsigned int workerIndex) {
             std::ostringstream oss_thread_id_start;
             oss_thread_id_start << std::this_thread::get_id();
-            RF_NETWORK_INFO("UDPSocketAsync: Worker thread started (ID: %s)", oss_thread_id_start.str().c_str());
+            RF_NETWORK_INFO("UDPSocketAsync: Worker thread %u started (ID: %s)", workerIndex, oss_thread_id_start.str().c_str());
+            RiftForged::Utilities::Threading::ThreadPlacement::PinCurrentThread(
+                RiftForged::Utilities::Threading::ThreadGroup::NetworkIO, workerIndex);
 
-            OverlappedIOContext* pIoContext = nullptr;
-            DWORD bytesTransferred = 0;
-            ULONG_PTR completionKey = 0; // Not heavily used for single-socket IOCP, but necessary parameter.
+            OVERLAPPED_ENTRY completionEntries[IOCP_COMPLETION_BATCH_SIZE];
+            std::vector<ReceivedDatagram> deliveryBatch;       // Datagrams from one GQCSEx wakeup.
+            std::vector<OverlappedIOContext*> contextsToRepost; // Recv contexts to re-post after delivery.
+            deliveryBatch.reserve(IOCP_COMPLETION_BATCH_SIZE);
+            contextsToRepost.reserve(IOCP_COMPLETION_BATCH_SIZE);
 
             while (m_isRunning.load(std::memory_order_acquire)) { // Loop while the socket is running.
-                pIoContext = nullptr; // Reset for each iteration.
-                bytesTransferred = 0;
+                ULONG numEntriesRemoved = 0;
 
-                // Wait for a completed I/O operation from the IOCP.
+                // Dequeue up to IOCP_COMPLETION_BATCH_SIZE completed operations in one call.
                 // A timeout allows the loop to periodically check `m_isRunning`.
-                BOOL bSuccess = GetQueuedCompletionStatus(
+                BOOL bSuccess = GetQueuedCompletionStatusEx(
                     m_iocpHandle,                  // Handle to the IOCP.
-                    &bytesTransferred,             // Number of bytes transferred.
-                    &completionKey,                // Completion key (the value passed to CreateIoCompletionPort).
-                    (LPOVERLAPPED*)&pIoContext,    // Pointer to the OVERLAPPED structure of the completed operation.
-                    100                            // Timeout in milliseconds.
+                    completionEntries,             // Receives the completed operations.
+                    IOCP_COMPLETION_BATCH_SIZE,    // Maximum number of entries to remove.
+                    &numEntriesRemoved,            // Number of entries actually removed.
+                    100,                           // Timeout in milliseconds.
+                    FALSE                          // Not alertable.
                 );
 
-                if (!bSuccess) { // GetQueuedCompletionStatus returned FALSE (error or timeout).
+                if (!bSuccess) { // GetQueuedCompletionStatusEx returned FALSE (error or timeout).
                     DWORD errorCode = GetLastError();
                     if (errorCode == WAIT_TIMEOUT) {
                         continue; // Expected timeout, loop to check `m_isRunning` again.
                     }
+                    // Unlike GQCS, GQCSEx only fails as a whole (no entries removed), e.g. IOCP handle closed.
+                    RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - GetQueuedCompletionStatusEx failed. WinError: %d. Assuming shutdown.", errorCode);
+                    if (m_eventHandler) m_eventHandler->OnNetworkError("GQCSEx failed", errorCode);
+                    // If the IOCP handle is invalid or abandoned, the thread should exit.
+                    if (!m_isRunning.load(std::memory_order_relaxed) || errorCode == ERROR_ABANDONED_WAIT_0 || errorCode == ERROR_INVALID_HANDLE) {
+                        break; // Exit loop if server is stopping or critical error occurred.
+                    }
+                    continue;
+                }
 
-                    // An actual error occurred on GetQueuedCompletionStatus.
-                    RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - GetQueuedCompletionStatus returned FALSE. WinError: %d. Context: %p, OpType: %d",
-                        errorCode, (void*)pIoContext, (pIoContext ? static_cast<int>(pIoContext->operationType) : -1));
-
-                    if (pIoContext != NULL) { // If a context is associated with the error (operation failed).
-                        if (pIoContext->operationType == IOOperationType::Recv) {
-                            RF_NETWORK_WARN("WorkerThread: Failed Recv Op in GQCS. Error: %d. Context %p.", errorCode, (void*)pIoContext);
-                            // Attempt to re-post the receive operation if the server is still running.
-                            if (m_isRunning.load(std::memory_order_relaxed)) {
-                                if (!PostReceiveInternal(pIoContext)) { // PostReceiveInternal handles returning context on its own failure.
-                                    RF_NETWORK_CRITICAL("WorkerThread: CRITICAL - Failed to re-post Recv context %p after I/O error %d or server stopping. Returning to pool.", (void*)pIoContext, errorCode);
-                                }
-                                else {
-                                    // Successfully re-posted, context is back in use.
-                                }
+                bool shutdownSignaled = false;
+                for (ULONG i = 0; i < numEntriesRemoved; ++i) {
+                    OverlappedIOContext* pIoContext = reinterpret_cast<OverlappedIOContext*>(completionEntries[i].lpOverlapped);
+                    if (pIoContext == NULL) {
+                        // This is an explicit shutdown signal (PostQueuedCompletionStatus with NULL context).
+                        shutdownSignaled = true;
+                        continue;
+                    }
+                    DWORD bytesTransferred = completionEntries[i].dwNumberOfBytesTransferred;
+                    // Per-operation status lives in OVERLAPPED::Internal (an NTSTATUS; 0 == STATUS_SUCCESS).
+                    const bool opSucceeded = (pIoContext->overlapped.Internal == 0);
+
+                    switch (pIoContext->operationType) {
+                    case IOOperationType::Recv:
+                    {
+                        if (!opSucceeded) {
+                            // e.g. ICMP port unreachable surfacing as a failed receive; just re-post.
+                            RF_NETWORK_WARN("WorkerThread: Failed Recv Op. Status: 0x%llX. Context %p.",
+                                static_cast<unsigned long long>(pIoContext->overlapped.Internal), (void*)pIoContext);
+                        }
+                        else {
+                            // Binary endpoint straight from the socket address; no text conversion.
+                            ReceivedDatagram& datagram = deliveryBatch.emplace_back();
+                            datagram.sender = NetworkEndpoint::FromIPv4(pIoContext->remoteAddrNative.sin_addr.s_addr,
+                                ntohs(pIoContext->remoteAddrNative.sin_port));
+                            datagram.size = bytesTransferred;
+                            datagram.context = pIoContext; // Pass context for informational purposes.
+                            if (bytesTransferred > 0) {
+                                datagram.data = reinterpret_cast<const uint8_t*>(pIoContext->buffer.data());
                             }
-                            else { // Server is stopping, return context to pool.
-                                ReturnReceiveContextInternal(pIoContext);
+                            else {
+                                // For UDP, receiving 0 bytes means an empty datagram was sent.
+                                RF_NETWORK_WARN("UDPSocketAsync: WorkerThread - Received 0 bytes on a Recv operation (UDP). Context: %p.", (void*)pIoContext);
+                                datagram.data = nullptr;
                             }
                         }
-                        else if (pIoContext->operationType == IOOperationType::Send) {
-                            RF_NETWORK_ERROR("WorkerThread: Failed Send Op in GQCS. Error: %d. Context %p.", errorCode, (void*)pIoContext);
-                            // Notify event handler about failed send.
-                            if (m_eventHandler) m_eventHandler->OnSendCompleted(pIoContext, false, 0);
-                            delete pIoContext; // Send contexts are dynamically allocated.
-                        }
-                        else {
-                            RF_NETWORK_ERROR("WorkerThread: Unknown operation type in failed GQCS. Context %p.", (void*)pIoContext);
-                            // Fallback cleanup for unknown types; assume dynamic allocation for safety.
-                            delete pIoContext;
+                        // Re-post only after the batch is delivered: the batch points into this context's buffer.
+                        contextsToRepost.push_back(pIoContext);
+                        break;
+                    } // End of case IOOperationType::Recv
+
+                    case IOOperationType::Send:
+                    {
+                        if (!opSucceeded) {
+                            RF_NETWORK_ERROR("WorkerThread: Failed Send Op. Status: 0x%llX. Context %p.",
+                                static_cast<unsigned long long>(pIoContext->overlapped.Internal), (void*)pIoContext);
                         }
-                        pIoContext = nullptr; // Context has been handled.
-                    }
-                    else { // pIoContext is NULL - GQCS failed without a context (e.g., IOCP handle closed).
-                        RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - GetQueuedCompletionStatus failed without a context. WinError: %d. Assuming shutdown.", errorCode);
-                        if (m_eventHandler) m_eventHandler->OnNetworkError("GQCS failed without context", errorCode);
-                        // If the IOCP handle is invalid or abandoned, the thread should exit.
-                        if (!m_isRunning.load(std::memory_order_relaxed) || errorCode == ERROR_ABANDONED_WAIT_0 || errorCode == ERROR_INVALID_HANDLE) {
-                            break; // Exit loop if server is stopping or critical error occurred.
+                        // Notify the event handler about the send completion.
+                        if (m_eventHandler) {
+                            m_eventHandler->OnSendCompleted(pIoContext, opSucceeded, opSucceeded ? bytesTransferred : 0);
                         }
-                    }
-                    continue; // Continue to next iteration after handling error.
+                        m_sendContextPool.Return(pIoContext); // Send contexts come from the send pool.
+                        break;
+                    } // End of case IOOperationType::Send
+
+                    default:
+                        // This case should ideally not be reached if `operationType` is always correctly set.
+                        RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - Dequeued completed op with Unknown/None type. Context: %p, OpType: %d",
+                            (void*)pIoContext, static_cast<int>(pIoContext->operationType));
+                        if (m_eventHandler) m_eventHandler->OnNetworkError("Unknown operation type dequeued", static_cast<int>(pIoContext->operationType));
+                        // Hand the context back to whichever pool owns it.
+                        if (m_sendContextPool.Owns(pIoContext)) m_sendContextPool.Return(pIoContext);
+                        else if (m_receiveContextPool.Owns(pIoContext)) m_receiveContextPool.Return(pIoContext);
+                        break;
+                    } // End switch on operationType
                 }
 
-                // GetQueuedCompletionStatus succeeded (bSuccess is TRUE).
-                if (pIoContext == NULL) {
-                    // This is an explicit shutdown signal (PostQueuedCompletionStatus with NULL context).
-                    RF_NETWORK_INFO("UDPSocketAsync: WorkerThread received NULL context (explicit shutdown signal). Exiting.");
-                    break; // Exit the while loop.
-                }
-
-                // A successful I/O operation has completed.
-                switch (pIoContext->operationType) {
-                case IOOperationType::Recv:
-                {
-                    if (bytesTransferred > 0) {
-                        NetworkEndpoint sender_endpoint;
-                        char senderIpBuffer[INET_ADDRSTRLEN]; // Standard buffer size for IPv4 addresses.
-
-                        // Convert binary address to string IP and port.
-                        if (inet_ntop(AF_INET, &(pIoContext->remoteAddrNative.sin_addr), senderIpBuffer, INET_ADDRSTRLEN)) {
-                            sender_endpoint.ipAddress = senderIpBuffer;
-                            sender_endpoint.port = ntohs(pIoContext->remoteAddrNative.sin_port);
-
-                            // Hand off the received raw data to the INetworkIOEvents handler.
-                            if (m_eventHandler) {
-                                m_eventHandler->OnRawDataReceived(sender_endpoint,
-                                    reinterpret_cast<const uint8_t*>(pIoContext->buffer.data()),
-                                    bytesTransferred,
-                                    pIoContext); // Pass context for informational purposes.
-                            }
-                        }
-                        else { // inet_ntop failed.
-                            int ntopErrorCode = WSAGetLastError();
-                            RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - inet_ntop failed for received packet. Error: %d.", ntopErrorCode);
-                            if (m_eventHandler) m_eventHandler->OnNetworkError("inet_ntop failed", ntopErrorCode);
-                        }
-                    }
-                    else if (bytesTransferred == 0) {
-                        // For UDP, receiving 0 bytes means an empty datagram was sent.
-                        RF_NETWORK_WARN("UDPSocketAsync: WorkerThread - Received 0 bytes on a Recv operation (UDP). Context: %p.", (void*)pIoContext);
-                        // Still, identify the sender and potentially pass a 0-byte payload.
-                        NetworkEndpoint sender_endpoint;
-                        char senderIpBuffer[INET_ADDRSTRLEN];
-                        if (inet_ntop(AF_INET, &(pIoContext->remoteAddrNative.sin_addr), senderIpBuffer, INET_ADDRSTRLEN)) {
-                            sender_endpoint.ipAddress = senderIpBuffer;
-                            sender_endpoint.port = ntohs(pIoContext->remoteAddrNative.sin_port);
-                            if (m_eventHandler) {
-                                m_eventHandler->OnRawDataReceived(sender_endpoint, nullptr, 0, pIoContext);
-                            }
-                        }
-                        else {
-                            int ntopErrorCode = WSAGetLastError();
-                            RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - inet_ntop failed for 0-byte received packet. Error: %d.", ntopErrorCode);
-                            if (m_eventHandler) m_eventHandler->OnNetworkError("inet_ntop failed for 0-byte packet", ntopErrorCode);
-                        }
+                // Hand everything this wakeup produced to the event handler in one call.
+                if (!deliveryBatch.empty()) {
+                    m_receiveWakeups.fetch_add(1, std::memory_order_relaxed);
+                    m_datagramsReceived.fetch_add(deliveryBatch.size(), std::memory_order_relaxed);
+                    if (m_eventHandler) {
+                        m_eventHandler->OnRawDataBatchReceived(std::span<const ReceivedDatagram>(deliveryBatch));
                     }
+                    deliveryBatch.clear();
+                }
 
+                for (OverlappedIOContext* pIoContext : contextsToRepost) {
                     // Always re-post the receive context if the server is still running.
                     if (m_isRunning.load(std::memory_order_relaxed)) {
                         if (!PostReceiveInternal(pIoContext)) {
@@ -495,40 +476,17 @@ namespace RiftForged {
                                 (void*)pIoContext, WSAGetLastError());
                             // If PostReceiveInternal fails, it returns the context to the pool.
                         }
-                        else {
-                            // RF_NETWORK_TRACE("WorkerThread: Successfully re-posted Recv context %p.", (void*)pIoContext);
-                        }
                     }
                     else { // Server is stopping, return context to pool.
                         ReturnReceiveContextInternal(pIoContext);
                     }
-                    pIoContext = nullptr; // Context has been handled (re-posted or returned).
-                    break;
-                } // End of case IOOperationType::Recv
+                }
+                contextsToRepost.clear();
 
-                case IOOperationType::Send:
-                {
-                    // Notify the event handler about the send completion.
-                    if (m_eventHandler) {
-                        m_eventHandler->OnSendCompleted(pIoContext, true, bytesTransferred); // true for success (bSuccess was true).
-                    }
-                    delete pIoContext; // Send contexts are dynamically allocated with `new`, so delete them here.
-                    pIoContext = nullptr; // Context has been handled.
-                    break;
-                } // End of case IOOperationType::Send
-
-                default:
-                    // This case should ideally not be reached if `operationType` is always correctly set.
-                    RF_NETWORK_ERROR("UDPSocketAsync: WorkerThread - Dequeued completed op with Unknown/None type. Context: %p, OpType: %d",
-                        (void*)pIoContext, (pIoContext ? static_cast<int>(pIoContext->operationType) : -1));
-                    if (m_eventHandler) m_eventHandler->OnNetworkError("Unknown operation type dequeued", (pIoContext ? static_cast<int>(pIoContext->operationType) : -1));
-                    if (pIoContext) { // Attempt to clean up unexpected context types.
-                        RF_NETWORK_ERROR("WorkerThread: Deleting unexpected context %p due to unknown type.", (void*)pIoContext);
-                        delete pIoContext; // Assume dynamically allocated for safety.
-                        pIoContext = nullptr;
-                    }
-                    break;
-                } // End switch on operationType
+                if (shutdownSignaled) {
+                    RF_NETWORK_INFO("UDPSocketAsync: WorkerThread received NULL context (explicit shutdown signal). Exiting.");
+                    break; // Exit the while loop.
+                }
             } // End while(m_isRunning) loop
 
             std::ostringstream exit_tid_oss;
@@ -538,6 +496,21 @@ namespace RiftForged {
 
         // SendData: Sends raw data asynchronously to a specified recipient.
         bool UDPSocketAsync::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            return SendGatherInternal(recipient, data, size, nullptr, 0);
+        }
+
+        // QueueSendGather: Header and shared payload are copied straight into one pooled send
+        // context, so a gathered datagram costs no more than SendData and needs no scratch buffer.
+        bool UDPSocketAsync::QueueSendGather(const NetworkEndpoint& recipient, const uint8_t* header, uint32_t headerSize, const PacketBufferRef& payload) {
+            return SendGatherInternal(recipient, header, headerSize, payload.Data(), payload.Size());
+        }
+
+        bool UDPSocketAsync::SendGatherInternal(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t dataSize, const uint8_t* tail, uint32_t tailSize) {
+            const uint32_t size = dataSize + tailSize;
+            if (tail == nullptr && tailSize > 0) {
+                RF_NETWORK_ERROR("UDPSocketAsync::SendData: Payload is null but size %u > 0 for sending to %s.", tailSize, recipient.ToString().c_str());
+                return false;
+            }
             if (m_socket == INVALID_SOCKET) {
                 RF_NETWORK_ERROR("UDPSocketAsync::SendData: Socket not valid. Cannot send to %s.", recipient.ToString().c_str());
                 return false;
@@ -546,38 +519,42 @@ namespace RiftForged {
             if (size == 0 && data != nullptr) { // 0-byte datagrams are valid UDP, but check if data is null.
                 RF_NETWORK_WARN("UDPSocketAsync::SendData: Attempting to send 0 bytes to %s. Proceeding.", recipient.ToString().c_str());
             }
-            else if (data == nullptr && size > 0) { // Data pointer null but size > 0 is an error.
-                RF_NETWORK_ERROR("UDPSocketAsync::SendData: Data is null but size %u > 0 for sending to %s.", size, recipient.ToString().c_str());
+            else if (data == nullptr && dataSize > 0) { // Data pointer null but size > 0 is an error.
+                RF_NETWORK_ERROR("UDPSocketAsync::SendData: Data is null but size %u > 0 for sending to %s.", dataSize, recipient.ToString().c_str());
                 return false;
             }
 
-            // Create a new OverlappedIOContext for each send operation.
-            // This context is dynamically allocated and will be deleted by the worker thread
-            // when the send operation completes via `OnSendCompleted`.
-            OverlappedIOContext* sendContext = nullptr;
-            try {
-                sendContext = new OverlappedIOContext(IOOperationType::Send, static_cast<size_t>(size));
+            if (size > m_sendContextPool.GetBufferSize()) {
+                RF_NETWORK_ERROR("UDPSocketAsync::SendData: %u bytes to %s exceeds the %u byte send buffer.", size, recipient.ToString().c_str(), m_sendContextPool.GetBufferSize());
+                return false;
             }
-            catch (const std::bad_alloc& e) {
-                RF_NETWORK_CRITICAL("UDPSocketAsync::SendData: Failed to allocate memory for send context to %s: %s", recipient.ToString().c_str(), e.what());
+
+            // Take a preallocated context from the send pool. The worker thread returns it
+            // to the pool when the send operation completes via `OnSendCompleted`.
+            OverlappedIOContext* sendContext = m_sendContextPool.Acquire();
+            if (!sendContext) {
+                RF_NETWORK_WARN("UDPSocketAsync::SendData: Send context pool exhausted. Dropping %u bytes to %s. Consider increasing MAX_PENDING_SENDS_IOCP.", size, recipient.ToString().c_str());
                 return false;
             }
 
             // Copy the data into the context's buffer.
-            if (size > 0 && data != nullptr) { // Only copy if there's data and a valid pointer.
-                std::memcpy(sendContext->buffer.data(), data, size);
+            if (dataSize > 0 && data != nullptr) { // Only copy if there's data and a valid pointer.
+                std::memcpy(sendContext->buffer.data(), data, dataSize);
+            }
+            if (tailSize > 0) { // Shared payload of a gathered send follows the header.
+                std::memcpy(sendContext->buffer.data() + dataSize, tail, tailSize);
             }
-            sendContext->wsaBuf.len = size; // Set the buffer length for WSASendTo.
+            sendContext->ResetForSend(size); // Reset OVERLAPPED and set the buffer length for WSASendTo.
 
             // Set up recipient address.
             sendContext->remoteAddrNative.sin_family = AF_INET;
-            sendContext->remoteAddrNative.sin_port = htons(recipient.port);
-            // Convert recipient IP string to binary.
-            if (inet_pton(AF_INET, recipient.ipAddress.c_str(), &(sendContext->remoteAddrNative.sin_addr)) != 1) {
-                RF_NETWORK_ERROR("UDPSocketAsync::SendData: inet_pton failed for IP %s to %s. Error: %d", recipient.ipAddress.c_str(), recipient.ToString().c_str(), WSAGetLastError());
-                delete sendContext; // Clean up context on failure.
+            sendContext->remoteAddrNative.sin_port = htons(recipient.GetPort());
+            if (!recipient.IsIPv4()) {
+                RF_NETWORK_ERROR("UDPSocketAsync::SendData: Recipient %s is not an IPv4 endpoint.", recipient.ToString().c_str());
+                m_sendContextPool.Return(sendContext); // Return context on failure.
                 return false;
             }
+            sendContext->remoteAddrNative.sin_addr.s_addr = recipient.GetIPv4NetworkOrder();
             sendContext->remoteAddrNativeLen = sizeof(sockaddr_in); // Set size of address structure.
 
             RF_NETWORK_TRACE("UDPSocketAsync::SendData: Attempting WSASendTo %u bytes to %s.", size, recipient.ToString().c_str());
@@ -593,6 +570,7 @@ namespace RiftForged {
                 sendContext->remoteAddrNativeLen,           // Size of destination address.
                 &(sendContext->overlapped), // The OVERLAPPED structure.
                 NULL);                      // lpCompletionRoutine (NULL for IOCP).
+            m_sendSyscalls.fetch_add(1, std::memory_order_relaxed);
 
             if (result == SOCKET_ERROR) {
                 int errorCode = WSAGetLastError();
@@ -600,7 +578,7 @@ namespace RiftForged {
                     RF_NETWORK_ERROR("UDPSocketAsync::SendData: WSASendTo failed immediately to %s with error: %d.", recipient.ToString().c_str(), errorCode);
                     // Notify handler of failed send attempt.
                     if (m_eventHandler) m_eventHandler->OnSendCompleted(sendContext, false, 0);
-                    delete sendContext; // Clean up context on failure.
+                    m_sendContextPool.Return(sendContext); // Return context on failure.
                     return false;
                 }
                 // If WSA_IO_PENDING, the operation will eventually complete via IOCP.
@@ -610,8 +588,21 @@ namespace RiftForged {
                 // Operation completed immediately. A completion packet is still queued to the IOCP.
                 RF_NETWORK_TRACE("UDPSocketAsync::SendData: WSASendTo completed immediately for %s.", recipient.ToString().c_str());
             }
+            m_datagramsSent.fetch_add(1, std::memory_order_relaxed);
             return true;
         }
 
+        // GetIOStats: Snapshot of the batching counters.
+        NetworkIOStats UDPSocketAsync::GetIOStats() const {
+            NetworkIOStats stats;
+            stats.receiveSyscalls = m_receiveWakeups.load(std::memory_order_relaxed);
+            stats.datagramsReceived = m_datagramsReceived.load(std::memory_order_relaxed);
+            stats.sendSyscalls = m_sendSyscalls.load(std::memory_order_relaxed);
+            stats.datagramsSent = m_datagramsSent.load(std::memory_order_relaxed);
+            stats.receiveContextExhaustions = m_receiveContextPool.GetStats().exhaustions;
+            stats.sendContextExhaustions = m_sendContextPool.GetStats().exhaustions;
+            return stats;
+        }
+
     } // namespace Networking
 } // namespace RiftForged
\ No newline at end of file
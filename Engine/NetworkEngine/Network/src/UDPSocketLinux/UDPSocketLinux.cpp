@@ -0,0 +1,839 @@
+﻿// File: UDPSocketLinux.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Implements INetworkIO for Linux using io_uring, with an epoll fallback.
+
+#include "UDPSocketLinux.h"
+#include "INetworkIOEvents.h"    // For m_eventHandler calls
+#include "OverlappedIOContext.h" // For IOOperationType and OverlappedIOContext struct
+#include <RiftForged/Utilities/Logger/Logger.h> // For RF_NETWORK_... macros
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h> // For NetworkIO thread count and pinning
+#include <cstring>               // For memset, strerror
+#include <cerrno>                // For errno
+#include <algorithm>             // For std::min
+#include <chrono>                // For std::chrono::steady_clock (send error log interval)
+#include <sstream>               // For std::ostringstream
+#include <system_error>          // For std::system_error
+#include <unistd.h>              // For close
+#include <fcntl.h>               // For O_NONBLOCK
+#include <sys/socket.h>          // For socket, bind, sendmsg, recvmsg
+#include <sys/epoll.h>           // For epoll_*
+#include <sys/eventfd.h>         // For eventfd
+#include <netinet/in.h>          // For sockaddr_in
+#include <arpa/inet.h>           // For inet_pton, inet_ntop, htons
+
+// Socket buffer sizes requested from the kernel. The kernel may clamp these to net.core.rmem_max/wmem_max.
+static const int LINUX_SOCKET_RCVBUF_BYTES = 4 * 1024 * 1024;
+static const int LINUX_SOCKET_SNDBUF_BYTES = 4 * 1024 * 1024;
+
+// How long a worker waits for completions/readiness before re-checking m_isRunning.
+static const int LINUX_WORKER_WAIT_TIMEOUT_MS = 100;
+
+// Maximum epoll events pulled per epoll_wait call.
+static const int LINUX_EPOLL_MAX_EVENTS = 16;
+
+// Failed sends are counted every time but logged at most once per interval.
+static const int64_t LINUX_SEND_ERROR_LOG_INTERVAL_MS = 1000;
+
+// errno values meaning the socket send buffer is full rather than that the datagram is bad.
+static bool IsSendBackpressure(int errorCode) {
+    return errorCode == EAGAIN || errorCode == EWOULDBLOCK || errorCode == ENOBUFS;
+}
+
+// DetermineNumWorkerThreads: same policy as the IOCP path, one worker per CPU of the NetworkIO thread group.
+static unsigned int DetermineNumWorkerThreads() {
+    using RiftForged::Utilities::Threading::ThreadGroup;
+    using RiftForged::Utilities::Threading::ThreadPlacement;
+    return ThreadPlacement::GetThreadCount(ThreadGroup::NetworkIO);
+}
+
+
+namespace RiftForged {
+    namespace Networking {
+
+        UDPSocketLinux::UDPSocketLinux(LinuxIOBackend preferredBackend, unsigned int reusePortShards)
+            : m_listenIp(""),
+            m_listenPort(0),
+            m_eventHandler(nullptr), // Must be set via Init() before use.
+            m_socket(-1),
+            m_wakeEventFd(-1),
+            m_reusePortShards(reusePortShards),
+            m_preferredBackend(preferredBackend),
+            m_activeBackend(LinuxIOBackend::Epoll),
+            m_isRunning(false)
+        {
+#ifndef RF_NETWORK_HAS_LIBURING
+            if (m_preferredBackend == LinuxIOBackend::IoUring) {
+                RF_NETWORK_INFO("UDPSocketLinux: Built without liburing. io_uring backend unavailable, epoll will be used.");
+                m_preferredBackend = LinuxIOBackend::Epoll;
+            }
+#endif
+            RF_NETWORK_INFO("UDPSocketLinux: Constructor called.");
+        }
+
+        UDPSocketLinux::~UDPSocketLinux() {
+            RF_NETWORK_INFO("UDPSocketLinux: Destructor called. Attempting to stop...");
+            Stop();
+            CloseSockets();
+        }
+
+        bool UDPSocketLinux::IsRunning() const {
+            return m_isRunning.load(std::memory_order_acquire);
+        }
+
+        bool UDPSocketLinux::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+            RF_NETWORK_INFO("UDPSocketLinux: Initializing for {}:{}...", listenIp, listenPort);
+
+            if (m_isRunning.load(std::memory_order_relaxed)) {
+                RF_NETWORK_WARN("UDPSocketLinux: Already initialized and potentially running. Please call Stop() first.");
+                return false;
+            }
+            if (!eventHandler) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: Initialization failed - INetworkIOEvents handler is null.");
+                return false;
+            }
+
+            m_eventHandler = eventHandler;
+            m_listenIp = listenIp;
+            m_listenPort = listenPort;
+
+            sockaddr_in serverAddr;
+            std::memset(&serverAddr, 0, sizeof(serverAddr));
+            serverAddr.sin_family = AF_INET;
+            serverAddr.sin_port = htons(m_listenPort);
+            if (inet_pton(AF_INET, m_listenIp.c_str(), &serverAddr.sin_addr) != 1) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: inet_pton failed for IP {}.", m_listenIp);
+                m_eventHandler->OnNetworkError("inet_pton failed for listen IP", EINVAL);
+                return false;
+            }
+
+            const bool sharded = m_reusePortShards > 0;
+            const unsigned int socketCount = sharded ? m_reusePortShards : 1;
+            for (unsigned int i = 0; i < socketCount; ++i) {
+                int fd = CreateBoundSocket(serverAddr, sharded);
+                if (fd < 0) {
+                    CloseSockets();
+                    return false;
+                }
+                m_sockets.push_back(fd);
+            }
+            m_socket = m_sockets.front();
+            RF_NETWORK_INFO("UDPSocketLinux: {} socket(s) bound successfully to {}:{}{}.", m_sockets.size(), m_listenIp, m_listenPort,
+                sharded ? " with SO_REUSEPORT" : "");
+
+            // Pre-allocate every receive context up front; Start() deals them out to the workers.
+            if (!m_receiveContextPool.Initialize(IOOperationType::Recv, MAX_PENDING_RECEIVES_LINUX, DEFAULT_UDP_BUFFER_SIZE_LINUX)) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: Failed to allocate memory for receive context pool.");
+                m_eventHandler->OnNetworkError("Failed to allocate receive context pool", 0);
+                CloseSockets();
+                return false;
+            }
+            RF_NETWORK_INFO("UDPSocketLinux: Receive context pool initialized with {} contexts.", m_receiveContextPool.GetCapacity());
+
+            RF_NETWORK_INFO("UDPSocketLinux: Initialization successful.");
+            return true;
+        }
+
+        bool UDPSocketLinux::Start() {
+            if (m_socket < 0) {
+                RF_NETWORK_ERROR("UDPSocketLinux: Cannot start. Socket not initialized.");
+                return false;
+            }
+            if (!m_eventHandler) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: Cannot start. Event handler is null (was Init called and successful?).");
+                return false;
+            }
+            if (m_isRunning.load(std::memory_order_relaxed)) {
+                RF_NETWORK_WARN("UDPSocketLinux: Already running.");
+                return true;
+            }
+
+            m_wakeEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_wakeEventFd < 0) {
+                int errorCode = errno;
+                RF_NETWORK_CRITICAL("UDPSocketLinux: eventfd() failed: {}", std::strerror(errorCode));
+                m_eventHandler->OnNetworkError("eventfd failed", errorCode);
+                return false;
+            }
+
+            // Deal the receive contexts out round-robin so every worker has its own private slice.
+            // Sharded mode runs exactly one worker per socket; otherwise every worker shares m_socket.
+            const bool sharded = m_reusePortShards > 0;
+            const unsigned int numWorkers = sharded ? static_cast<unsigned int>(m_sockets.size()) : DetermineNumWorkerThreads();
+            m_workers.clear();
+            for (unsigned int i = 0; i < numWorkers; ++i) {
+                auto worker = std::make_unique<WorkerState>();
+                worker->socketFd = sharded ? m_sockets[i] : m_socket;
+                worker->shardIndex = sharded ? i : 0;
+                worker->workerIndex = i;
+                m_workers.emplace_back(std::move(worker));
+            }
+            for (uint32_t i = 0; i < m_receiveContextPool.GetCapacity(); ++i) {
+                m_workers[i % numWorkers]->receiveContexts.push_back(m_receiveContextPool.Acquire());
+            }
+            for (auto& worker : m_workers) {
+                const size_t batchSize = std::min(worker->receiveContexts.size(), static_cast<size_t>(LINUX_RECV_BATCH_SIZE));
+                worker->recvBatchHeaders.resize(batchSize);
+                worker->deliveryBatch.reserve(worker->receiveContexts.size());
+                worker->rearmList.reserve(worker->receiveContexts.size());
+            }
+
+            // Pick the backend. A ring that fails to come up on any worker drops everyone to epoll.
+            m_activeBackend = LinuxIOBackend::Epoll;
+#ifdef RF_NETWORK_HAS_LIBURING
+            if (m_preferredBackend == LinuxIOBackend::IoUring) {
+                bool allRingsReady = true;
+                for (auto& worker : m_workers) {
+                    if (!SetupWorkerIoUring(*worker)) {
+                        allRingsReady = false;
+                        break;
+                    }
+                }
+                if (allRingsReady) {
+                    m_activeBackend = LinuxIOBackend::IoUring;
+                }
+                else {
+                    RF_NETWORK_WARN("UDPSocketLinux: io_uring setup failed. Falling back to epoll.");
+                    for (auto& worker : m_workers) {
+                        TeardownWorker(*worker);
+                    }
+                }
+            }
+#endif
+            if (m_activeBackend == LinuxIOBackend::Epoll) {
+                for (auto& worker : m_workers) {
+                    if (!SetupWorkerEpoll(*worker)) {
+                        m_eventHandler->OnNetworkError("epoll setup failed", errno);
+                        for (auto& w : m_workers) TeardownWorker(*w);
+                        m_workers.clear();
+                        close(m_wakeEventFd); m_wakeEventFd = -1;
+                        return false;
+                    }
+                }
+            }
+
+            RF_NETWORK_INFO("UDPSocketLinux: Starting network operations with {} backend...",
+                m_activeBackend == LinuxIOBackend::IoUring ? "io_uring" : "epoll");
+            m_isRunning = true;
+
+            for (size_t i = 0; i < m_workers.size(); ++i) {
+                WorkerState* worker = m_workers[i].get();
+                try {
+                    if (m_activeBackend == LinuxIOBackend::IoUring) {
+                        worker->thread = std::thread(&UDPSocketLinux::IoUringWorkerThread, this, worker);
+                    }
+                    else {
+                        worker->thread = std::thread(&UDPSocketLinux::EpollWorkerThread, this, worker);
+                    }
+                }
+                catch (const std::system_error& e) {
+                    RF_NETWORK_CRITICAL("UDPSocketLinux: Failed to create worker thread {}: {}", i, e.what());
+                    m_eventHandler->OnNetworkError("Failed to create worker thread", static_cast<int>(i));
+                    Stop();
+                    return false;
+                }
+            }
+            RF_NETWORK_INFO("UDPSocketLinux: {} worker threads created. Server is listening.", m_workers.size());
+            return true;
+        }
+
+        void UDPSocketLinux::Stop() {
+            if (!m_isRunning.exchange(false, std::memory_order_acq_rel)) {
+                RF_NETWORK_INFO("UDPSocketLinux: Stop called but already not running or stop initiated.");
+                return;
+            }
+            RF_NETWORK_INFO("UDPSocketLinux: Stopping network operations...");
+
+            // The eventfd is never drained, so it stays readable and wakes every epoll worker.
+            // io_uring workers notice m_isRunning within LINUX_WORKER_WAIT_TIMEOUT_MS.
+            if (m_wakeEventFd >= 0) {
+                uint64_t one = 1;
+                ssize_t written = write(m_wakeEventFd, &one, sizeof(one));
+                (void)written;
+            }
+
+            RF_NETWORK_INFO("UDPSocketLinux: Joining worker threads...");
+            for (auto& worker : m_workers) {
+                if (worker->thread.joinable()) {
+                    worker->thread.join();
+                }
+            }
+            RF_NETWORK_INFO("UDPSocketLinux: All worker threads joined.");
+
+            // Push out anything still queued while the socket is open.
+            FlushSendQueue();
+
+            // Tearing down a ring cancels its outstanding recvmsg operations before the
+            // contexts they reference are released below.
+            for (auto& worker : m_workers) {
+                TeardownWorker(*worker);
+            }
+            m_workers.clear();
+
+            if (m_wakeEventFd >= 0) {
+                close(m_wakeEventFd);
+                m_wakeEventFd = -1;
+            }
+            CloseSockets();
+
+            m_receiveContextPool.Clear();
+            RF_NETWORK_DEBUG("UDPSocketLinux: Receive context pool cleared.");
+            RF_NETWORK_INFO("UDPSocketLinux: Network operations stopped successfully.");
+        }
+
+        int UDPSocketLinux::CreateBoundSocket(const sockaddr_in& address, bool reusePort) {
+            int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+            if (fd < 0) {
+                int errorCode = errno;
+                RF_NETWORK_CRITICAL("UDPSocketLinux: socket() failed: {} ({})", std::strerror(errorCode), errorCode);
+                m_eventHandler->OnNetworkError("socket failed", errorCode);
+                return -1;
+            }
+
+            // Must be set on every socket of the group before bind(); the kernel then spreads
+            // flows across the group by 4-tuple hash.
+            if (reusePort) {
+                int enable = 1;
+                if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0) {
+                    int errorCode = errno;
+                    RF_NETWORK_CRITICAL("UDPSocketLinux: setsockopt(SO_REUSEPORT) failed: {} ({})", std::strerror(errorCode), errorCode);
+                    m_eventHandler->OnNetworkError("setsockopt SO_REUSEPORT failed", errorCode);
+                    close(fd);
+                    return -1;
+                }
+            }
+
+            // Larger kernel buffers absorb bursts between worker wakeups.
+            if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &LINUX_SOCKET_RCVBUF_BYTES, sizeof(LINUX_SOCKET_RCVBUF_BYTES)) != 0) {
+                RF_NETWORK_WARN("UDPSocketLinux: setsockopt(SO_RCVBUF) failed: {}", std::strerror(errno));
+            }
+            if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &LINUX_SOCKET_SNDBUF_BYTES, sizeof(LINUX_SOCKET_SNDBUF_BYTES)) != 0) {
+                RF_NETWORK_WARN("UDPSocketLinux: setsockopt(SO_SNDBUF) failed: {}", std::strerror(errno));
+            }
+
+            if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                int errorCode = errno;
+                RF_NETWORK_CRITICAL("UDPSocketLinux: bind() failed: {} ({})", std::strerror(errorCode), errorCode);
+                m_eventHandler->OnNetworkError("bind failed", errorCode);
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        void UDPSocketLinux::CloseSockets() {
+            for (int fd : m_sockets) {
+                shutdown(fd, SHUT_RDWR);
+                close(fd);
+            }
+            if (!m_sockets.empty()) {
+                RF_NETWORK_INFO("UDPSocketLinux: {} socket(s) closed.", m_sockets.size());
+            }
+            m_sockets.clear();
+            m_socket = -1;
+        }
+
+        uint32_t UDPSocketLinux::GetIOShardCount() const {
+            return m_reusePortShards > 0 ? static_cast<uint32_t>(m_reusePortShards) : 1u;
+        }
+
+        bool UDPSocketLinux::SetupWorkerIoUring(WorkerState& worker) {
+#ifdef RF_NETWORK_HAS_LIBURING
+            // Room for every receive this worker keeps in flight plus headroom for re-arms
+            // queued while a batch of completions is being processed.
+            unsigned int entries = 64;
+            while (entries < worker.receiveContexts.size() * 2) entries <<= 1;
+
+            int ret = io_uring_queue_init(entries, &worker.ring, 0);
+            if (ret < 0) {
+                RF_NETWORK_WARN("UDPSocketLinux: io_uring_queue_init({}) failed: {}", entries, std::strerror(-ret));
+                return false;
+            }
+            worker.ringInitialized = true;
+
+            for (OverlappedIOContext* pContext : worker.receiveContexts) {
+                if (!PostReceiveInternal(worker, pContext)) {
+                    return false;
+                }
+            }
+            ret = io_uring_submit(&worker.ring);
+            if (ret < 0) {
+                RF_NETWORK_WARN("UDPSocketLinux: Initial io_uring_submit failed: {}", std::strerror(-ret));
+                return false;
+            }
+            return true;
+#else
+            (void)worker;
+            return false;
+#endif
+        }
+
+        bool UDPSocketLinux::SetupWorkerEpoll(WorkerState& worker) {
+            worker.epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (worker.epollFd < 0) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: epoll_create1 failed: {}", std::strerror(errno));
+                return false;
+            }
+
+            // EPOLLEXCLUSIVE: a datagram arrival wakes one worker instead of the whole herd.
+            epoll_event socketEvent{};
+            socketEvent.events = EPOLLIN | EPOLLEXCLUSIVE;
+            socketEvent.data.fd = worker.socketFd;
+            if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, worker.socketFd, &socketEvent) != 0) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: epoll_ctl(socket) failed: {}", std::strerror(errno));
+                return false;
+            }
+
+            epoll_event wakeEvent{};
+            wakeEvent.events = EPOLLIN;
+            wakeEvent.data.fd = m_wakeEventFd;
+            if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, m_wakeEventFd, &wakeEvent) != 0) {
+                RF_NETWORK_CRITICAL("UDPSocketLinux: epoll_ctl(eventfd) failed: {}", std::strerror(errno));
+                return false;
+            }
+            return true;
+        }
+
+        void UDPSocketLinux::TeardownWorker(WorkerState& worker) {
+#ifdef RF_NETWORK_HAS_LIBURING
+            if (worker.ringInitialized) {
+                io_uring_queue_exit(&worker.ring);
+                worker.ringInitialized = false;
+            }
+#endif
+            if (worker.epollFd >= 0) {
+                close(worker.epollFd);
+                worker.epollFd = -1;
+            }
+        }
+
+#ifdef RF_NETWORK_HAS_LIBURING
+        bool UDPSocketLinux::PostReceiveInternal(WorkerState& worker, OverlappedIOContext* pRecvContext) {
+            io_uring_sqe* sqe = io_uring_get_sqe(&worker.ring);
+            if (!sqe) {
+                // Submission queue is full; flush it to the kernel and try once more.
+                io_uring_submit(&worker.ring);
+                sqe = io_uring_get_sqe(&worker.ring);
+                if (!sqe) {
+                    RF_NETWORK_ERROR("UDPSocketLinux::PostReceiveInternal: No SQE available for context {}.", static_cast<void*>(pRecvContext));
+                    return false;
+                }
+            }
+            pRecvContext->ResetForReceive();
+            io_uring_prep_recvmsg(sqe, worker.socketFd, &pRecvContext->msgHeader, 0);
+            io_uring_sqe_set_data(sqe, pRecvContext);
+            return true;
+        }
+#endif
+
+        void UDPSocketLinux::IoUringWorkerThread(WorkerState* worker) {
+            std::ostringstream oss_thread_id_start;
+            oss_thread_id_start << std::this_thread::get_id();
+            RF_NETWORK_INFO("UDPSocketLinux: io_uring worker thread started (ID: {}, shard {})", oss_thread_id_start.str(), worker->shardIndex);
+            RiftForged::Utilities::Threading::ThreadPlacement::PinCurrentThread(
+                RiftForged::Utilities::Threading::ThreadGroup::NetworkIO, worker->workerIndex);
+
+#ifdef RF_NETWORK_HAS_LIBURING
+            __kernel_timespec waitTimeout{};
+            waitTimeout.tv_sec = 0;
+            waitTimeout.tv_nsec = static_cast<long long>(LINUX_WORKER_WAIT_TIMEOUT_MS) * 1000000LL;
+
+            while (m_isRunning.load(std::memory_order_acquire)) {
+                io_uring_cqe* cqe = nullptr;
+                int ret = io_uring_wait_cqe_timeout(&worker->ring, &cqe, &waitTimeout);
+                if (ret == -ETIME || ret == -EINTR) {
+                    continue;
+                }
+                if (ret < 0) {
+                    RF_NETWORK_ERROR("UDPSocketLinux: io_uring_wait_cqe_timeout failed: {}", std::strerror(-ret));
+                    if (m_eventHandler) m_eventHandler->OnNetworkError("io_uring_wait_cqe_timeout failed", -ret);
+                    break;
+                }
+
+                // Reap every completion that is already available before going back to the kernel,
+                // so one wakeup turns into one OnRawDataBatchReceived call.
+                unsigned int head = 0;
+                unsigned int reaped = 0;
+                io_uring_for_each_cqe(&worker->ring, head, cqe) {
+                    ++reaped;
+                    OverlappedIOContext* pIoContext = static_cast<OverlappedIOContext*>(io_uring_cqe_get_data(cqe));
+                    if (!pIoContext) {
+                        continue; // Internal timeout SQEs on older kernels carry no context.
+                    }
+
+                    if (cqe->res >= 0) {
+                        AppendReceivedDatagram(*worker, pIoContext, static_cast<uint32_t>(cqe->res));
+                    }
+                    else if (cqe->res != -ECANCELED) {
+                        RF_NETWORK_WARN("UDPSocketLinux: recvmsg completion failed: {} ({}). Context {}.",
+                            std::strerror(-cqe->res), -cqe->res, static_cast<void*>(pIoContext));
+                    }
+                    worker->rearmList.push_back(pIoContext);
+                }
+                io_uring_cq_advance(&worker->ring, reaped);
+
+                if (!worker->deliveryBatch.empty()) {
+                    m_receiveSyscalls.fetch_add(1, std::memory_order_relaxed);
+                }
+                DeliverBatch(*worker);
+
+                // Re-arm only after delivery: the batch points into these contexts' buffers.
+                // Always re-arm while running so the in-flight receive count stays constant.
+                if (m_isRunning.load(std::memory_order_relaxed)) {
+                    for (OverlappedIOContext* pIoContext : worker->rearmList) {
+                        if (!PostReceiveInternal(*worker, pIoContext)) {
+                            RF_NETWORK_CRITICAL("UDPSocketLinux: CRITICAL - Failed to re-post recvmsg for context {}.", static_cast<void*>(pIoContext));
+                        }
+                    }
+                }
+                worker->rearmList.clear();
+
+                ret = io_uring_submit(&worker->ring);
+                if (ret < 0 && ret != -EBUSY && ret != -EAGAIN) {
+                    RF_NETWORK_ERROR("UDPSocketLinux: io_uring_submit failed: {}", std::strerror(-ret));
+                }
+            }
+#else
+            (void)worker;
+#endif
+
+            std::ostringstream exit_tid_oss;
+            exit_tid_oss << std::this_thread::get_id();
+            RF_NETWORK_INFO("UDPSocketLinux: io_uring worker thread {} exiting gracefully.", exit_tid_oss.str());
+        }
+
+        void UDPSocketLinux::EpollWorkerThread(WorkerState* worker) {
+            std::ostringstream oss_thread_id_start;
+            oss_thread_id_start << std::this_thread::get_id();
+            RF_NETWORK_INFO("UDPSocketLinux: epoll worker thread started (ID: {}, shard {})", oss_thread_id_start.str(), worker->shardIndex);
+            RiftForged::Utilities::Threading::ThreadPlacement::PinCurrentThread(
+                RiftForged::Utilities::Threading::ThreadGroup::NetworkIO, worker->workerIndex);
+
+            if (worker->recvBatchHeaders.empty()) {
+                RF_NETWORK_ERROR("UDPSocketLinux: epoll worker has no receive context. Exiting.");
+                return;
+            }
+            // The first recvBatchHeaders.size() contexts of the slice back one recvmmsg call.
+            const unsigned int batchSize = static_cast<unsigned int>(worker->recvBatchHeaders.size());
+            epoll_event events[LINUX_EPOLL_MAX_EVENTS];
+
+            while (m_isRunning.load(std::memory_order_acquire)) {
+                int numEvents = epoll_wait(worker->epollFd, events, LINUX_EPOLL_MAX_EVENTS, LINUX_WORKER_WAIT_TIMEOUT_MS);
+                if (numEvents < 0) {
+                    if (errno == EINTR) continue;
+                    int errorCode = errno;
+                    RF_NETWORK_ERROR("UDPSocketLinux: epoll_wait failed: {}", std::strerror(errorCode));
+                    if (m_eventHandler) m_eventHandler->OnNetworkError("epoll_wait failed", errorCode);
+                    break;
+                }
+
+                for (int i = 0; i < numEvents; ++i) {
+                    if (events[i].data.fd != worker->socketFd) {
+                        continue; // Wake-up eventfd; the loop condition handles shutdown.
+                    }
+                    // Drain until the kernel queue is empty, up to batchSize datagrams per syscall.
+                    // Another worker may race us for the same datagrams, which simply ends our
+                    // drain early with EAGAIN.
+                    while (m_isRunning.load(std::memory_order_relaxed)) {
+                        for (unsigned int b = 0; b < batchSize; ++b) {
+                            OverlappedIOContext* pIoContext = worker->receiveContexts[b];
+                            pIoContext->ResetForReceive();
+                            worker->recvBatchHeaders[b].msg_hdr = pIoContext->msgHeader;
+                            worker->recvBatchHeaders[b].msg_len = 0;
+                        }
+                        int received = recvmmsg(worker->socketFd, worker->recvBatchHeaders.data(), batchSize, MSG_DONTWAIT, nullptr);
+                        if (received < 0) {
+                            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                            if (errno == EINTR) continue;
+                            RF_NETWORK_WARN("UDPSocketLinux: recvmmsg failed: {} ({})", std::strerror(errno), errno);
+                            break;
+                        }
+                        m_receiveSyscalls.fetch_add(1, std::memory_order_relaxed);
+
+                        for (int b = 0; b < received; ++b) {
+                            OverlappedIOContext* pIoContext = worker->receiveContexts[b];
+                            // recvmmsg wrote flags/namelen into the batch copy of the header.
+                            pIoContext->msgHeader.msg_flags = worker->recvBatchHeaders[b].msg_hdr.msg_flags;
+                            pIoContext->msgHeader.msg_namelen = worker->recvBatchHeaders[b].msg_hdr.msg_namelen;
+                            AppendReceivedDatagram(*worker, pIoContext, worker->recvBatchHeaders[b].msg_len);
+                        }
+                        DeliverBatch(*worker);
+
+                        if (static_cast<unsigned int>(received) < batchSize) break; // Queue drained.
+                    }
+                }
+            }
+
+            std::ostringstream exit_tid_oss;
+            exit_tid_oss << std::this_thread::get_id();
+            RF_NETWORK_INFO("UDPSocketLinux: epoll worker thread {} exiting gracefully.", exit_tid_oss.str());
+        }
+
+        bool UDPSocketLinux::AppendReceivedDatagram(WorkerState& worker, OverlappedIOContext* pContext, uint32_t bytesReceived) {
+            if (pContext->msgHeader.msg_flags & MSG_TRUNC) {
+                RF_NETWORK_WARN("UDPSocketLinux: Datagram larger than the {} byte receive buffer was truncated. Discarding.", pContext->buffer.size());
+                return false;
+            }
+
+            ReceivedDatagram& datagram = worker.deliveryBatch.emplace_back();
+            datagram.sender = NetworkEndpoint::FromIPv4(pContext->remoteAddrNative.sin_addr.s_addr,
+                ntohs(pContext->remoteAddrNative.sin_port));
+            datagram.context = pContext;
+            datagram.ioShard = worker.shardIndex;
+            datagram.size = bytesReceived;
+            if (bytesReceived > 0) {
+                datagram.data = reinterpret_cast<const uint8_t*>(pContext->buffer.data());
+            }
+            else {
+                // For UDP, receiving 0 bytes means an empty datagram was sent.
+                RF_NETWORK_WARN("UDPSocketLinux: Received 0 bytes from {}.", datagram.sender.ToString());
+                datagram.data = nullptr;
+            }
+            return true;
+        }
+
+        void UDPSocketLinux::DeliverBatch(WorkerState& worker) {
+            if (worker.deliveryBatch.empty()) {
+                return;
+            }
+            m_datagramsReceived.fetch_add(worker.deliveryBatch.size(), std::memory_order_relaxed);
+            if (m_eventHandler) {
+                m_eventHandler->OnRawDataBatchReceived(std::span<const ReceivedDatagram>(worker.deliveryBatch));
+            }
+            worker.deliveryBatch.clear();
+        }
+
+        bool UDPSocketLinux::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            if (m_socket < 0) {
+                RF_NETWORK_ERROR("UDPSocketLinux::SendData: Socket not valid. Cannot send to {}.", recipient.ToString());
+                return false;
+            }
+            if (data == nullptr && size > 0) {
+                RF_NETWORK_ERROR("UDPSocketLinux::SendData: Data is null but size {} > 0 for sending to {}.", size, recipient.ToString());
+                return false;
+            }
+
+            // The send completes (or fails) synchronously, so the context can live on the stack
+            // and point straight at the caller's buffer; no copy and no allocation.
+            OverlappedIOContext sendContext(IOOperationType::Send);
+            sendContext.remoteAddrNative.sin_family = AF_INET;
+            sendContext.remoteAddrNative.sin_port = htons(recipient.GetPort());
+            if (!recipient.IsIPv4()) {
+                RF_NETWORK_ERROR("UDPSocketLinux::SendData: Recipient {} is not an IPv4 endpoint.", recipient.ToString());
+                return false;
+            }
+            sendContext.remoteAddrNative.sin_addr.s_addr = recipient.GetIPv4NetworkOrder();
+            sendContext.BindMessageHeader(size);
+            sendContext.ioVec.iov_base = const_cast<uint8_t*>(data);
+
+            ssize_t sent;
+            do {
+                sent = sendmsg(m_socket, &sendContext.msgHeader, MSG_DONTWAIT | MSG_NOSIGNAL);
+            } while (sent < 0 && errno == EINTR);
+
+            m_sendSyscalls.fetch_add(1, std::memory_order_relaxed);
+            if (sent < 0) {
+                int errorCode = errno;
+                if (IsSendBackpressure(errorCode)) {
+                    m_sendBackpressureStalls.fetch_add(1, std::memory_order_relaxed);
+                }
+                else {
+                    ReportSendError(errorCode, sendContext.remoteAddrNative);
+                }
+                if (m_eventHandler) m_eventHandler->OnSendCompleted(&sendContext, false, 0);
+                return false;
+            }
+
+            m_datagramsSent.fetch_add(1, std::memory_order_relaxed);
+            RF_NETWORK_TRACE("UDPSocketLinux::SendData: Sent {} bytes to {}.", sent, recipient.ToString());
+            if (m_eventHandler) m_eventHandler->OnSendCompleted(&sendContext, true, static_cast<uint32_t>(sent));
+            return true;
+        }
+
+        bool UDPSocketLinux::QueueSendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+            return QueueSendInternal(recipient, data, size, PacketBufferRef());
+        }
+
+        bool UDPSocketLinux::QueueSendGather(const NetworkEndpoint& recipient, const uint8_t* header, uint32_t headerSize, const PacketBufferRef& payload) {
+            return QueueSendInternal(recipient, header, headerSize, payload);
+        }
+
+        bool UDPSocketLinux::QueueSendInternal(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size, const PacketBufferRef& payload) {
+            if (m_socket < 0) {
+                RF_NETWORK_ERROR("UDPSocketLinux::QueueSendData: Socket not valid. Cannot send to {}.", recipient.ToString());
+                return false;
+            }
+            if (data == nullptr && size > 0) {
+                RF_NETWORK_ERROR("UDPSocketLinux::QueueSendData: Data is null but size {} > 0 for sending to {}.", size, recipient.ToString());
+                return false;
+            }
+
+            PendingSend pending;
+            std::memset(&pending.address, 0, sizeof(pending.address));
+            pending.address.sin_family = AF_INET;
+            pending.address.sin_port = htons(recipient.GetPort());
+            if (!recipient.IsIPv4()) {
+                RF_NETWORK_ERROR("UDPSocketLinux::QueueSendData: Recipient {} is not an IPv4 endpoint.", recipient.ToString());
+                return false;
+            }
+            pending.address.sin_addr.s_addr = recipient.GetIPv4NetworkOrder();
+            pending.size = size;
+            pending.payload = payload; // Shared, not copied; released once the flush has sent it.
+
+            size_t queuedCount = 0;
+            {
+                std::lock_guard<std::mutex> lock(m_sendQueueMutex);
+                // Only reachable while the socket buffer stays full across many flushes.
+                if (m_pendingSends.size() >= static_cast<size_t>(LINUX_SEND_QUEUE_MAX_BACKLOG)) {
+                    m_sendQueueOverflows.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                pending.offset = static_cast<uint32_t>(m_pendingSendBytes.size());
+                if (size > 0) {
+                    m_pendingSendBytes.insert(m_pendingSendBytes.end(), data, data + size);
+                }
+                m_pendingSends.push_back(std::move(pending));
+                queuedCount = m_pendingSends.size();
+            }
+
+            // Every LINUX_SEND_QUEUE_AUTO_FLUSH datagrams rather than on each one past it, so a
+            // backlog behind a full socket buffer does not cost a failed syscall per queued send.
+            if (queuedCount % static_cast<size_t>(LINUX_SEND_QUEUE_AUTO_FLUSH) == 0) {
+                FlushSendQueue();
+            }
+            return true;
+        }
+
+        void UDPSocketLinux::FlushSendQueue() {
+            std::lock_guard<std::mutex> flushLock(m_flushMutex);
+            if (m_socket < 0) {
+                std::lock_guard<std::mutex> lock(m_sendQueueMutex);
+                const size_t dropped = (m_flushingSends.size() - m_flushResumeIndex) + m_pendingSends.size();
+                if (dropped > 0) {
+                    RF_NETWORK_WARN("UDPSocketLinux::FlushSendQueue: Socket closed. Dropping {} queued datagrams.", dropped);
+                }
+                m_flushingSends.clear();
+                m_flushingSendBytes.clear();
+                m_flushResumeIndex = 0;
+                m_pendingSends.clear();
+                m_pendingSendBytes.clear();
+                return;
+            }
+
+            // Whatever a full socket buffer held back last time goes out before anything newer,
+            // so datagrams to one recipient keep their order. If it still does not fit, wait.
+            if (m_flushResumeIndex < m_flushingSends.size() && !SendFlushingSends()) {
+                return;
+            }
+            {
+                // Swap out the queue; the (now empty, but still allocated) flushing buffers become
+                // the new queue so steady-state queuing does not reallocate.
+                std::lock_guard<std::mutex> lock(m_sendQueueMutex);
+                if (m_pendingSends.empty()) {
+                    return;
+                }
+                m_flushingSends.swap(m_pendingSends);
+                m_flushingSendBytes.swap(m_pendingSendBytes);
+            }
+            SendFlushingSends();
+        }
+
+        bool UDPSocketLinux::SendFlushingSends() {
+            m_sendBatchHeaders.resize(LINUX_SEND_BATCH_SIZE);
+            m_sendBatchIovecs.resize(static_cast<size_t>(LINUX_SEND_BATCH_SIZE) * 2); // Queued bytes + shared payload.
+            OverlappedIOContext reportContext(IOOperationType::Send); // Recipient info for OnSendCompleted.
+
+            const size_t total = m_flushingSends.size();
+            size_t next = m_flushResumeIndex;
+            while (next < total) {
+                const unsigned int count = static_cast<unsigned int>(std::min(total - next, static_cast<size_t>(LINUX_SEND_BATCH_SIZE)));
+                for (unsigned int b = 0; b < count; ++b) {
+                    PendingSend& pending = m_flushingSends[next + b];
+                    iovec* iov = &m_sendBatchIovecs[static_cast<size_t>(b) * 2];
+                    size_t iovCount = 0;
+                    if (pending.size > 0 || !pending.payload) {
+                        iov[iovCount].iov_base = m_flushingSendBytes.data() + pending.offset;
+                        iov[iovCount].iov_len = pending.size;
+                        ++iovCount;
+                    }
+                    if (pending.payload && pending.payload.Size() > 0) {
+                        iov[iovCount].iov_base = const_cast<uint8_t*>(pending.payload.Data());
+                        iov[iovCount].iov_len = pending.payload.Size();
+                        ++iovCount;
+                    }
+                    mmsghdr& header = m_sendBatchHeaders[b];
+                    std::memset(&header, 0, sizeof(header));
+                    header.msg_hdr.msg_name = &pending.address;
+                    header.msg_hdr.msg_namelen = sizeof(sockaddr_in);
+                    header.msg_hdr.msg_iov = iov;
+                    header.msg_hdr.msg_iovlen = iovCount;
+                }
+
+                int sent = sendmmsg(m_socket, m_sendBatchHeaders.data(), count, MSG_DONTWAIT | MSG_NOSIGNAL);
+                m_sendSyscalls.fetch_add(1, std::memory_order_relaxed);
+                if (sent < 0) {
+                    const int errorCode = errno;
+                    if (errorCode == EINTR) continue;
+                    if (IsSendBackpressure(errorCode)) {
+                        // The socket buffer is full. Nothing is lost: the rest stays queued for the
+                        // next flush, by which time the kernel has drained some of it.
+                        m_sendBackpressureStalls.fetch_add(1, std::memory_order_relaxed);
+                        m_flushResumeIndex = next;
+                        RF_NETWORK_TRACE("UDPSocketLinux::FlushSendQueue: Send buffer full; {} datagrams held for the next flush.", total - next);
+                        return false;
+                    }
+                    // Any other error belongs to the first datagram of the batch (e.g. no route to
+                    // its recipient); drop that one and carry on with the rest.
+                    ReportSendError(errorCode, m_flushingSends[next].address);
+                    reportContext.remoteAddrNative = m_flushingSends[next].address;
+                    if (m_eventHandler) m_eventHandler->OnSendCompleted(&reportContext, false, 0);
+                    ++next;
+                    continue;
+                }
+
+                m_datagramsSent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+                if (m_eventHandler) {
+                    for (int b = 0; b < sent; ++b) {
+                        reportContext.remoteAddrNative = m_flushingSends[next + b].address;
+                        m_eventHandler->OnSendCompleted(&reportContext, true, m_sendBatchHeaders[b].msg_len);
+                    }
+                }
+                next += static_cast<size_t>(sent);
+            }
+
+            RF_NETWORK_TRACE("UDPSocketLinux::FlushSendQueue: Flushed {} datagrams.", total - m_flushResumeIndex);
+            m_flushingSends.clear();
+            m_flushingSendBytes.clear();
+            m_flushResumeIndex = 0;
+            return true;
+        }
+
+        void UDPSocketLinux::ReportSendError(int errorCode, const sockaddr_in& address) {
+            const uint64_t errors = m_sendErrors.fetch_add(1, std::memory_order_relaxed) + 1;
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t nextLog = m_nextSendErrorLogNanos.load(std::memory_order_relaxed);
+            if (now < nextLog || !m_nextSendErrorLogNanos.compare_exchange_strong(nextLog,
+                now + LINUX_SEND_ERROR_LOG_INTERVAL_MS * 1000000, std::memory_order_relaxed)) {
+                return;
+            }
+            char ipString[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &address.sin_addr, ipString, sizeof(ipString));
+            RF_NETWORK_ERROR("UDPSocketLinux: Send to {}:{} failed: {} ({}). {} send errors since start.",
+                ipString, ntohs(address.sin_port), std::strerror(errorCode), errorCode, errors);
+        }
+
+        NetworkIOStats UDPSocketLinux::GetIOStats() const {
+            NetworkIOStats stats;
+            stats.receiveSyscalls = m_receiveSyscalls.load(std::memory_order_relaxed);
+            stats.datagramsReceived = m_datagramsReceived.load(std::memory_order_relaxed);
+            stats.sendSyscalls = m_sendSyscalls.load(std::memory_order_relaxed);
+            stats.datagramsSent = m_datagramsSent.load(std::memory_order_relaxed);
+            stats.sendBackpressureStalls = m_sendBackpressureStalls.load(std::memory_order_relaxed);
+            stats.sendQueueOverflows = m_sendQueueOverflows.load(std::memory_order_relaxed);
+            stats.sendErrors = m_sendErrors.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -0,0 +1,32 @@
+﻿// File: VerifiedC2SMessage.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: The single verification point for client FlatBuffer messages.
+
+#include "VerifiedC2SMessage.h"
+
+namespace RiftForged {
+    namespace Networking {
+
+        bool VerifyC2SMessage(const uint8_t* data, uint32_t size, VerifiedC2SMessage& out_message) {
+            // A root table needs at least its root offset and vtable offset.
+            if (!data || size < sizeof(flatbuffers::uoffset_t) * 2) {
+                return false;
+            }
+            flatbuffers::Verifier verifier(data, size);
+            if (!UDP::C2S::VerifyRoot_C2S_UDP_MessageBuffer(verifier)) {
+                return false;
+            }
+            const UDP::C2S::Root_C2S_UDP_Message* root = UDP::C2S::GetRoot_C2S_UDP_Message(data);
+            if (!root->payload() || root->payload_type() == UDP::C2S::C2S_UDP_Payload_NONE) {
+                return false;
+            }
+            out_message.root = root;
+            out_message.payloadType = root->payload_type();
+            out_message.data = data;
+            out_message.size = size;
+            return true;
+        }
+
+    } // namespace Networking
+} // namespace RiftForged
@@ -1,5 +1,6 @@
 ﻿#include <RiftForged/Physics/PhysicsEngine/PhysicsEngine.h>
 #include <RiftForged/Utilities/Logger/Logger.h> // Simplified include path
+#include <RiftForged/Utilities/ThreadPlacement/ThreadPlacement.h> // For the Physics thread group
 
 // PhysX headers needed for initialization and lifecycle management
 #include <extensions/PxDefaultErrorCallback.h>
@@ -133,22 +134,29 @@ namespace RiftForged {
                 RF_PHYSICS_WARN("PhysicsEngine: PxCreateCudaContextManager failed. GPU acceleration disabled.");
             }
 
-            // Use std::thread::hardware_concurrency() if available, otherwise fallback
-            // uint32_t num_hardware_threads = std::thread::hardware_concurrency(); 
-            uint32_t num_hardware_threads = 4; // Original hardcoded value
-            uint32_t num_threads_for_dispatcher = (num_hardware_threads > 1) ? num_hardware_threads - 1 : 1; // Ensure at least 1 thread
-            if (num_hardware_threads == 0) { // Should not happen with a fixed value, but good check if using hardware_concurrency()
-                RF_PHYSICS_WARN("PhysicsEngine: Could not determine hardware concurrency or 0 reported, defaulting CPU dispatcher to 1 thread.");
-                num_threads_for_dispatcher = 1;
+            // Dispatcher size and core affinity come from the Physics thread group so PhysX workers
+            // do not compete with the network IO and task pool threads.
+            using RiftForged::Utilities::Threading::ThreadGroup;
+            using RiftForged::Utilities::Threading::ThreadPlacement;
+            const std::vector<RiftForged::Utilities::Threading::LogicalProcessor> physics_cpus = ThreadPlacement::GetCpus(ThreadGroup::Physics);
+            uint32_t num_threads_for_dispatcher = ThreadPlacement::GetThreadCount(ThreadGroup::Physics);
+
+            // PxDefaultCpuDispatcher takes one 32-bit mask per worker; CPUs it cannot express
+            // (index >= 32, or outside processor group 0) get a 0 mask, i.e. no affinity.
+            std::vector<physx::PxU32> dispatcher_affinity_masks(num_threads_for_dispatcher, 0);
+            for (uint32_t i = 0; i < num_threads_for_dispatcher && i < physics_cpus.size(); ++i) {
+                if (physics_cpus[i].processorGroup == 0 && physics_cpus[i].groupBit < 32) {
+                    dispatcher_affinity_masks[i] = physx::PxU32(1) << physics_cpus[i].groupBit;
+                }
             }
-            m_dispatcher = physx::PxDefaultCpuDispatcherCreate(num_threads_for_dispatcher);
+            m_dispatcher = physx::PxDefaultCpuDispatcherCreate(num_threads_for_dispatcher, dispatcher_affinity_masks.data());
             if (!m_dispatcher) {
                 RF_PHYSICS_CRITICAL("PhysicsEngine: PxDefaultCpuDispatcherCreate failed!");
                 Shutdown();
                 return false;
             }
-            RF_PHYSICS_INFO("PhysicsEngine: PxDefaultCpuDispatcher created with {} threads (Hardware reported/used: {}).",
-                num_threads_for_dispatcher, num_hardware_threads);
+            RF_PHYSICS_INFO("PhysicsEngine: PxDefaultCpuDispatcher created with {} threads (Physics thread group).",
+                num_threads_for_dispatcher);
 
             physx::PxSceneDesc scene_desc(m_physics->getTolerancesScale());
             scene_desc.gravity = ToPxVec3(gravityVec); // ToPxVec3 is from PhysicsEngine.h, takes SharedVec3 (glm::vec3)
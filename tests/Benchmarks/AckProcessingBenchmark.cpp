@@ -0,0 +1,99 @@
+﻿// File: AckProcessingBenchmark.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Measures what ProcessIncomingPacketHeader spends on one ACK as the number of
+// unacknowledged reliable packets grows. The sender keeps a fixed number of packets in flight:
+// each step acknowledges the oldest (ackNumber plus a full 32-bit ackBitfield) and sends one
+// more. SentPacketRing makes every ACK 33 slot probes, so the cost per ACK should stay flat from
+// a handful of packets in flight up to a full RELIABLE_SEND_WINDOW_SIZE. Timings depend on the
+// machine, so the ratio is printed against the expected bound rather than checked.
+
+#include "TestSupport.h"
+#include "UDPReliabilityProtocol.h"
+#include <RiftForged/Utilities/Logger/Logger.h>
+
+#include <algorithm> // For std::min
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstdio>    // For std::printf
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint32_t ACKS_PER_RUN = 200000;
+    const int RUNS = 5;
+    // ACK cost at a full window is expected to stay under this multiple of the cost at a small
+    // one. A search proportional to the packets in flight would be ~30x here.
+    const double EXPECTED_MAX_COST_RATIO = 3.0;
+
+    // Best-of-RUNS nanoseconds per ACK with 'inFlight' reliable packets outstanding.
+    double MeasureAckCost(uint32_t inFlight) {
+        PacketBufferPool pool;
+        PacketBufferRef payload = pool.Acquire(64);
+        const uint8_t reliableFlag = static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE);
+
+        double bestNanosecondsPerAck = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            ReliableConnectionState sender;
+            for (uint32_t i = 0; i < inFlight; ++i) {
+                RF_TEST_CHECK(PrepareOutgoingPacket(sender, payload, reliableFlag).valid);
+            }
+
+            GamePacketHeader ack;
+            ack.flags = static_cast<uint8_t>(GamePacketFlag::IS_ACK_ONLY);
+            ack.ackBitfield = 0xFFFFFFFFu; // The 32 before ackNumber: already acknowledged, still probed.
+
+            Clock::duration elapsed{};
+            for (uint32_t i = 0; i < ACKS_PER_RUN; ++i) {
+                ack.ackNumber = static_cast<SequenceNumber>(sender.nextOutgoingSequenceNumber - inFlight);
+
+                const uint8_t* released = nullptr;
+                uint32_t releasedSize = 0;
+                const Clock::time_point start = Clock::now();
+                ProcessIncomingPacketHeader(sender, ack, nullptr, 0, &released, &releasedSize);
+                elapsed += Clock::now() - start;
+
+                const bool sent = PrepareOutgoingPacket(sender, payload, reliableFlag).valid;
+                RF_TEST_CHECK(sent);
+                if (!sent) {
+                    return 0.0;
+                }
+            }
+            RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == inFlight);
+
+            const double nanosecondsPerAck =
+                std::chrono::duration<double, std::nano>(elapsed).count() / ACKS_PER_RUN;
+            bestNanosecondsPerAck = run == 0 ? nanosecondsPerAck : std::min(bestNanosecondsPerAck, nanosecondsPerAck);
+        }
+        return bestNanosecondsPerAck;
+    }
+
+    void BenchmarkAckCostIsFlatInFlight() {
+        const uint32_t smallWindow = 32;
+        const uint32_t fullWindow = RELIABLE_SEND_WINDOW_SIZE;
+
+        const double smallCost = MeasureAckCost(smallWindow);
+        const double mediumCost = MeasureAckCost(fullWindow / 4);
+        const double fullCost = MeasureAckCost(fullWindow);
+
+        std::printf("  %5u in flight: %8.1f ns/ACK\n", smallWindow, smallCost);
+        std::printf("  %5u in flight: %8.1f ns/ACK\n", fullWindow / 4, mediumCost);
+        std::printf("  %5u in flight: %8.1f ns/ACK (%.2fx the %u cost; expected under %.1fx)\n", fullWindow, fullCost,
+            smallCost > 0.0 ? fullCost / smallCost : 0.0, smallWindow, EXPECTED_MAX_COST_RATIO);
+
+        RF_TEST_CHECK(smallCost > 0.0);
+    }
+
+} // namespace
+
+int main() {
+    // The network logger is created at trace level; per-ACK trace lines would be all we measured.
+    RiftForged::Utilities::Logger::Init(spdlog::level::warn, spdlog::level::warn);
+    RiftForged::Utilities::Logger::GetNetworkLogger()->set_level(spdlog::level::warn);
+
+    RunTest("ACK cost from a few packets in flight to a full send window", BenchmarkAckCostIsFlatInFlight);
+    return RiftForged::Tests::TestExitCode();
+}
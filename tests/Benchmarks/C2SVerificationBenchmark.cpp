@@ -0,0 +1,150 @@
+﻿// File: C2SVerificationBenchmark.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Measures the per-packet cost of taking a client message from raw bytes to its
+// handler, verifying the FlatBuffer once (VerifyC2SMessage, then C2SDispatchTable) against the
+// earlier pipeline, where UDPPacketHandler verified the buffer to read its payload type and
+// MessageDispatcher verified it again before routing. The messages are the hot-path input types
+// (movement, turn, ability) built with the generated builders. Timings depend on the machine, so
+// the ratio is printed against the expected bound rather than checked.
+
+#include "TestSupport.h"
+#include "VerifiedC2SMessage.h"
+#include "C2SDispatchTable.h"
+
+#include <algorithm> // For std::min
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstdio>    // For std::printf
+#include <optional>  // For std::optional
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint32_t MESSAGES_PER_RUN = 200000;
+    const int RUNS = 5;
+    // Verifying once is expected to cost under this fraction of verifying in both stages.
+    // Verification is most of the work on either path, so the ratio should be close to one half.
+    const double EXPECTED_MAX_COST_RATIO = 0.75;
+
+    // Counts what reaches the handlers and reads a field of each, so neither path can skip the work.
+    struct CountingHandler {
+        std::optional<S2C_Response> Process(const NetworkEndpoint&, RiftForged::GameLogic::ActivePlayer*, const UDP::C2S::C2S_MovementInputMsg* message) {
+            checksum += message->client_timestamp_ms();
+            ++handled;
+            return std::nullopt;
+        }
+        std::optional<S2C_Response> Process(const NetworkEndpoint&, RiftForged::GameLogic::ActivePlayer*, const UDP::C2S::C2S_TurnIntentMsg* message) {
+            checksum += message->client_timestamp_ms();
+            ++handled;
+            return std::nullopt;
+        }
+        std::optional<S2C_Response> Process(const NetworkEndpoint&, RiftForged::GameLogic::ActivePlayer*, const UDP::C2S::C2S_UseAbilityMsg* message) {
+            checksum += message->ability_id();
+            ++handled;
+            return std::nullopt;
+        }
+
+        uint64_t checksum = 0;
+        uint64_t handled = 0;
+    };
+
+    std::vector<flatbuffers::DetachedBuffer> BuildInputMessages() {
+        using namespace UDP::C2S;
+        const RiftForged::Networking::Shared::Vec3 direction(0.0f, 1.0f, 0.0f);
+        std::vector<flatbuffers::DetachedBuffer> messages;
+
+        flatbuffers::FlatBufferBuilder movement;
+        auto movementMessage = CreateC2S_MovementInputMsg(movement, 1000, &direction, true);
+        FinishRoot_C2S_UDP_MessageBuffer(movement, CreateRoot_C2S_UDP_Message(movement, C2S_UDP_Payload_MovementInput, movementMessage.Union()));
+        messages.push_back(movement.Release());
+
+        flatbuffers::FlatBufferBuilder turn;
+        auto turnMessage = CreateC2S_TurnIntentMsg(turn, 1001, 15.0f);
+        FinishRoot_C2S_UDP_MessageBuffer(turn, CreateRoot_C2S_UDP_Message(turn, C2S_UDP_Payload_TurnIntent, turnMessage.Union()));
+        messages.push_back(turn.Release());
+
+        flatbuffers::FlatBufferBuilder ability;
+        auto abilityMessage = CreateC2S_UseAbilityMsg(ability, 1002, 7, 42, &direction);
+        FinishRoot_C2S_UDP_MessageBuffer(ability, CreateRoot_C2S_UDP_Message(ability, C2S_UDP_Payload_UseAbility, abilityMessage.Union()));
+        messages.push_back(ability.Release());
+        return messages;
+    }
+
+    // The current receive path: one verification, then the table.
+    bool DispatchVerifiedOnce(const C2SDispatchTable& table, const flatbuffers::DetachedBuffer& buffer) {
+        VerifiedC2SMessage message;
+        if (!VerifyC2SMessage(buffer.data(), static_cast<uint32_t>(buffer.size()), message)) {
+            return false;
+        }
+        C2SDispatchStatus status;
+        table.Dispatch(message, nullptr, status);
+        return status == C2SDispatchStatus::Dispatched;
+    }
+
+    // The earlier receive path: the packet handler and the dispatcher each ran a Verifier.
+    bool DispatchVerifiedPerStage(const C2SDispatchTable& table, const flatbuffers::DetachedBuffer& buffer) {
+        flatbuffers::Verifier handlerVerifier(buffer.data(), buffer.size());
+        if (!UDP::C2S::VerifyRoot_C2S_UDP_MessageBuffer(handlerVerifier)) {
+            return false;
+        }
+        VerifiedC2SMessage message;
+        if (!VerifyC2SMessage(buffer.data(), static_cast<uint32_t>(buffer.size()), message)) {
+            return false;
+        }
+        C2SDispatchStatus status;
+        table.Dispatch(message, nullptr, status);
+        return status == C2SDispatchStatus::Dispatched;
+    }
+
+    // Best-of-RUNS nanoseconds per message through 'dispatch'.
+    template<typename DispatchFn>
+    double MeasureDispatchCost(const std::vector<flatbuffers::DetachedBuffer>& messages, DispatchFn dispatch) {
+        CountingHandler handler;
+        C2SDispatchTable table;
+        table.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(handler, false);
+        table.RegisterHandler<UDP::C2S::C2S_TurnIntentMsg>(handler, false);
+        table.RegisterHandler<UDP::C2S::C2S_UseAbilityMsg>(handler, false);
+
+        double bestNanosecondsPerMessage = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            bool allDispatched = true;
+            const Clock::time_point start = Clock::now();
+            for (uint32_t i = 0; i < MESSAGES_PER_RUN; ++i) {
+                allDispatched &= dispatch(table, messages[i % messages.size()]);
+            }
+            const Clock::duration elapsed = Clock::now() - start;
+            RF_TEST_CHECK(allDispatched);
+
+            const double nanosecondsPerMessage =
+                std::chrono::duration<double, std::nano>(elapsed).count() / MESSAGES_PER_RUN;
+            bestNanosecondsPerMessage = run == 0 ? nanosecondsPerMessage : std::min(bestNanosecondsPerMessage, nanosecondsPerMessage);
+        }
+        RF_TEST_CHECK(handler.handled == static_cast<uint64_t>(MESSAGES_PER_RUN) * RUNS);
+        RF_TEST_CHECK(handler.checksum != 0);
+        return bestNanosecondsPerMessage;
+    }
+
+    void BenchmarkVerifyOnceAgainstPerStage() {
+        const std::vector<flatbuffers::DetachedBuffer> messages = BuildInputMessages();
+
+        const double perStageCost = MeasureDispatchCost(messages, DispatchVerifiedPerStage);
+        const double onceCost = MeasureDispatchCost(messages, DispatchVerifiedOnce);
+
+        std::printf("  verified per stage: %8.1f ns/message\n", perStageCost);
+        std::printf("  verified once:      %8.1f ns/message (%.1f ns saved, %.2fx; expected under %.2fx)\n", onceCost,
+            perStageCost - onceCost, perStageCost > 0.0 ? onceCost / perStageCost : 0.0, EXPECTED_MAX_COST_RATIO);
+
+        RF_TEST_CHECK(onceCost > 0.0);
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Verifying a client message once saves a verifier pass", BenchmarkVerifyOnceAgainstPerStage);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,176 @@
+﻿// File: LoopbackThroughputBenchmark.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Measures how many datagrams per second a ConnectionManager takes in end to end
+// over LoopbackNetworkIO. Joined clients fill the server's inbound ring with small unreliable
+// datagrams; the server drains it through the whole receive path (ring, session lookup, datagram
+// rate limiter, header processing, dispatch, batch flush). Prints the receive rate alone and with
+// the senders' copies into the ring; it only checks that every datagram reached the application.
+
+#include "TestSupport.h"
+#include "LoopbackNetworkIO.h"
+#include "ConnectionManager.h"
+#include "UDPReliabilityProtocol.h"
+#include <RiftForged/Utilities/Logger/Logger.h>
+
+#include <algorithm> // For std::max
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstdio>    // For std::printf
+#include <cstring>   // For std::memcpy
+#include <memory>    // For std::make_shared, std::unique_ptr
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint32_t CLIENTS = 64;
+    const uint32_t MESSAGE_SIZE = 32;              // A movement input is about this size
+    const uint32_t SERVER_QUEUE_CAPACITY = 16384;  // Datagrams queued per fill
+    const uint64_t DATAGRAMS_PER_RUN = 1000000;
+    const int RUNS = 5;
+
+    // Counts the messages it is handed and does nothing else.
+    class SinkServer : public ConnectionManager {
+    public:
+        explicit SinkServer(INetworkIO* networkIO)
+            : ConnectionManager(networkIO) {}
+
+        ~SinkServer() override {
+            Stop();
+        }
+
+        uint64_t messagesReceived = 0; // Receive path only; Poll() runs on the benchmark thread
+
+    protected:
+        void DispatchApplicationPayload(const NetworkEndpoint&, ConnectionSession&, const uint8_t*, uint32_t, bool) override {
+            ++messagesReceived;
+        }
+    };
+
+    void SendHandshake(INetworkIO& io, const NetworkEndpoint& to, GamePacketFlag flag, uint32_t connectionId,
+        const uint8_t* payload, uint32_t payloadSize) {
+        GamePacketHeader header;
+        header.flags = static_cast<uint8_t>(flag);
+        header.connectionId = connectionId;
+        std::vector<uint8_t> datagram(GetGamePacketHeaderSize() + payloadSize);
+        std::memcpy(datagram.data(), &header, GetGamePacketHeaderSize());
+        std::memcpy(datagram.data() + GetGamePacketHeaderSize(), payload, payloadSize);
+        io.SendData(to, datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+
+    // Joins with the cookie handshake and nothing more; the benchmark sends on its behalf.
+    class JoiningClient : public INetworkIOEvents {
+    public:
+        explicit JoiningClient(std::shared_ptr<LoopbackNetworkHub> hub)
+            : io(std::move(hub), LoopbackDeliveryMode::Manual) {}
+
+        void OnRawDataReceived(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size, OverlappedIOContext*) override {
+            if (size < GetGamePacketHeaderSize()) return;
+            GamePacketHeader header;
+            std::memcpy(&header, data, GetGamePacketHeaderSize());
+            const uint8_t* payload = data + GetGamePacketHeaderSize();
+            const uint32_t payloadSize = size - static_cast<uint32_t>(GetGamePacketHeaderSize());
+            if (HasFlag(header.flags, GamePacketFlag::IS_CONNECT_CHALLENGE) && payloadSize >= HANDSHAKE_COOKIE_SIZE) {
+                SendHandshake(io, sender, GamePacketFlag::IS_CONNECT_RESPONSE, INVALID_CONNECTION_ID, payload, HANDSHAKE_COOKIE_SIZE);
+            }
+            else if (HasFlag(header.flags, GamePacketFlag::IS_CONNECT_RESPONSE)) {
+                state.connectionId = header.connectionId;
+            }
+        }
+
+        void OnSendCompleted(OverlappedIOContext*, bool, uint32_t) override {}
+        void OnNetworkError(const std::string&, int) override {}
+
+        LoopbackNetworkIO io;
+        ReliableConnectionState state;
+        std::vector<uint8_t> datagram; // One unreliable message, replayed
+    };
+
+    void BenchmarkReceiveThroughput() {
+        auto hub = std::make_shared<LoopbackNetworkHub>();
+        LoopbackNetworkIO serverIO(hub, LoopbackDeliveryMode::Manual, SERVER_QUEUE_CAPACITY);
+        SinkServer server(&serverIO);
+        const NetworkEndpoint serverEndpoint("127.0.0.1", 7777);
+        // Measure the path, not the per-client limit.
+        server.SetInboundRateLimit(InboundRateClass::Datagram, InboundRateLimit{ 0, 1 });
+        RF_TEST_CHECK(serverIO.Init("127.0.0.1", 7777, &server) && serverIO.Start());
+        RF_TEST_CHECK(server.Start());
+
+        PacketBufferPool pool;
+        PacketBufferRef message = pool.Acquire(MESSAGE_SIZE);
+        std::vector<std::unique_ptr<JoiningClient>> clients;
+        for (uint32_t i = 0; i < CLIENTS; ++i) {
+            auto client = std::make_unique<JoiningClient>(hub);
+            const std::string ip = "10.0." + std::to_string(i / 250) + "." + std::to_string(i % 250 + 1);
+            RF_TEST_CHECK(client->io.Init(ip, 5000, client.get()) && client->io.Start());
+            const uint8_t padding[HANDSHAKE_CHALLENGE_SIZE] = {};
+            SendHandshake(client->io, serverEndpoint, GamePacketFlag::IS_CONNECT_REQUEST, INVALID_CONNECTION_ID,
+                padding, HANDSHAKE_CHALLENGE_SIZE);
+            while (serverIO.Poll() + client->io.Poll() > 0) {}
+            RF_TEST_CHECK(client->state.connectionId != INVALID_CONNECTION_ID);
+
+            const OutgoingPacket packet = PrepareOutgoingPacket(client->state, message, 0);
+            RF_TEST_CHECK(packet.valid);
+            client->datagram = SerializePacket(packet.header, packet.payload.Data(), static_cast<uint16_t>(packet.payload.Size()));
+            clients.push_back(std::move(client));
+        }
+        RF_TEST_CHECK(server.GetSessionCount() == CLIENTS);
+
+        double bestReceiveSeconds = 0.0;
+        double bestTotalSeconds = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            server.messagesReceived = 0;
+            Clock::duration receiveTime{};
+            const Clock::time_point runStart = Clock::now();
+            uint64_t sent = 0;
+            uint32_t nextClient = 0;
+            while (sent < DATAGRAMS_PER_RUN) {
+                const uint64_t fill = std::min<uint64_t>(SERVER_QUEUE_CAPACITY, DATAGRAMS_PER_RUN - sent);
+                for (uint64_t i = 0; i < fill; ++i) {
+                    JoiningClient& client = *clients[nextClient];
+                    nextClient = (nextClient + 1) % CLIENTS;
+                    client.io.SendData(serverEndpoint, client.datagram.data(), static_cast<uint32_t>(client.datagram.size()));
+                }
+                sent += fill;
+                const Clock::time_point start = Clock::now();
+                while (serverIO.Poll() > 0) {}
+                receiveTime += Clock::now() - start;
+            }
+            const double totalSeconds = std::chrono::duration<double>(Clock::now() - runStart).count();
+            const double receiveSeconds = std::chrono::duration<double>(receiveTime).count();
+            RF_TEST_CHECK(server.messagesReceived == DATAGRAMS_PER_RUN);
+            bestReceiveSeconds = run == 0 ? receiveSeconds : std::min(bestReceiveSeconds, receiveSeconds);
+            bestTotalSeconds = run == 0 ? totalSeconds : std::min(bestTotalSeconds, totalSeconds);
+        }
+        RF_TEST_CHECK(serverIO.GetQueueFullDrops() == 0);
+        RF_TEST_CHECK(server.GetHandshakeStats().unknownSourceDrops == 0);
+
+        const double datagrams = static_cast<double>(DATAGRAMS_PER_RUN);
+        std::printf("  %u clients, %u byte messages, best of %d runs of %llu datagrams:\n",
+            CLIENTS, MESSAGE_SIZE, RUNS, static_cast<unsigned long long>(DATAGRAMS_PER_RUN));
+        std::printf("  receive path:       %6.2f M datagrams/s (%6.1f ns each)\n",
+            datagrams / bestReceiveSeconds / 1e6, bestReceiveSeconds * 1e9 / datagrams);
+        std::printf("  send + receive:     %6.2f M datagrams/s (%6.1f ns each)\n",
+            datagrams / bestTotalSeconds / 1e6, bestTotalSeconds * 1e9 / datagrams);
+
+        for (auto& client : clients) {
+            client->io.Stop();
+        }
+        server.Stop();
+        serverIO.Stop();
+    }
+
+} // namespace
+
+int main() {
+    // The network logger is created at trace level; per-datagram trace lines would be all we measured.
+    RiftForged::Utilities::Logger::Init(spdlog::level::warn, spdlog::level::warn);
+    RiftForged::Utilities::Logger::GetNetworkLogger()->set_level(spdlog::level::warn);
+
+    RunTest("Datagrams per second through the receive path", BenchmarkReceiveThroughput);
+    return RiftForged::Tests::TestExitCode();
+}
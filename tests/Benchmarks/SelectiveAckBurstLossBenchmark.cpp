@@ -0,0 +1,235 @@
+﻿// File: SelectiveAckBurstLossBenchmark.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Sends a fixed stream of reliable messages over LoopbackNetworkIO behind an
+// ImpairedNetworkIO with Gilbert-Elliott burst loss (data and ACKs) and reports completion time and
+// retransmit counts with selective acknowledgements on and off, for a send window the header ACK
+// covers (32) and one it does not (128). Every run uses the same impairment seed.
+//
+// The header acknowledges the newest sequence and the 32 before it. When an ACK is lost with more
+// than that in flight, the packets it covered can only be acknowledged by a SelectiveAckBlock;
+// without one they are retransmitted until MAX_PACKET_RETRIES gives up on them, and a packet that
+// falls SELECTIVE_ACK_WINDOW_BITS behind before it arrives is never delivered.
+
+#include "TestSupport.h"
+#include "LoopbackNetworkIO.h"
+#include "ImpairedNetworkIO.h"
+#include "UDPReliabilityProtocol.h"
+#include <RiftForged/Utilities/Logger/Logger.h>
+
+#include <atomic>   // For std::atomic
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdio>   // For std::printf, std::snprintf
+#include <cstring>  // For std::memcpy
+#include <memory>   // For std::make_shared
+#include <thread>   // For std::this_thread::sleep_for
+#include <vector>   // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint32_t MESSAGE_COUNT = 5000;
+    const uint32_t MESSAGE_SIZE = 200;
+    const uint32_t HEADER_ACK_WINDOW = 33;        // ackNumber plus the 32-bit ackBitfield
+    const uint32_t MESSAGES_PER_TICK = 64;
+    const auto TICK_INTERVAL = std::chrono::milliseconds(1);
+    const auto RUN_TIMEOUT = std::chrono::seconds(10);
+
+    // One end of the connection. Datagrams arrive on the transport's threads; the protocol
+    // functions lock the connection state themselves.
+    class BenchmarkPeer : public INetworkIOEvents {
+    public:
+        void OnRawDataReceived(const NetworkEndpoint&, const uint8_t* data, uint32_t size, OverlappedIOContext*) override {
+            if (size < GetGamePacketHeaderSize()) return;
+            GamePacketHeader header;
+            std::memcpy(&header, data, GetGamePacketHeaderSize());
+            const uint8_t* message = nullptr;
+            uint32_t messageSize = 0;
+            if (ProcessIncomingPacketHeader(state, header, data + GetGamePacketHeaderSize(),
+                static_cast<uint16_t>(size - GetGamePacketHeaderSize()), &message, &messageSize)) {
+                delivered.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void OnSendCompleted(OverlappedIOContext*, bool, uint32_t) override {}
+        void OnNetworkError(const std::string&, int) override {}
+
+        void Send(const OutgoingPacket& packet) {
+            const std::vector<uint8_t> datagram = SerializePacket(packet.header, packet.payload.Data(),
+                static_cast<uint16_t>(packet.payload.Size()));
+            io->SendData(remote, datagram.data(), static_cast<uint32_t>(datagram.size()));
+        }
+
+        // Retransmissions and ACKs, as the packet handler runs them for every connection. The
+        // receiver's ACK-only packets are reliable too, so both ends need the whole tick.
+        void Tick(Clock::time_point now) {
+            for (const OutgoingPacket& packet : GetPacketsForFastRetransmission(state, now)) {
+                Send(packet);
+            }
+            for (const OutgoingPacket& packet : GetPacketsForRetransmission(state, now)) {
+                Send(packet);
+            }
+            TrySendAckOnlyPacket(state, pool, now, [this](const OutgoingPacket& ack) { Send(ack); });
+        }
+
+        // Unacknowledged data packets. The two ends acknowledge each other's ACK-only packets
+        // indefinitely, so a few of those are always in flight.
+        size_t DataInFlight() {
+            std::lock_guard<std::mutex> lock(state.internalStateMutex);
+            size_t dataPackets = 0;
+            state.unacknowledgedSentPackets.ForEach([&](ReliableConnectionState::SentPacketInfo& sentPacket) {
+                if (!HasFlag(sentPacket.header.flags, GamePacketFlag::IS_ACK_ONLY)) {
+                    ++dataPackets;
+                }
+            });
+            return dataPackets;
+        }
+
+        // Sequences from the oldest unacknowledged packet to the newest sent.
+        uint32_t InFlightSpan() {
+            std::lock_guard<std::mutex> lock(state.internalStateMutex);
+            return state.unacknowledgedSentPackets.Span();
+        }
+
+        ReliableConnectionState state;
+        PacketBufferPool pool;
+        INetworkIO* io = nullptr;
+        NetworkEndpoint remote;
+        std::atomic<uint64_t> delivered{ 0 };
+    };
+
+    struct RunResult {
+        bool completed = false;
+        double completionMs = 0.0;
+        uint64_t delivered = 0;
+        size_t stillInFlight = 0;
+        RetransmitStats retransmits;
+        ImpairmentStats impairment;
+    };
+
+    // 5 ms each way; bursts average 5 packets and start on ~0.5% of packets. ACKs see the same model.
+    NetworkImpairmentConfig MakeBurstLossConfig() {
+        NetworkImpairmentProfile burstLoss;
+        burstLoss.baseDelayMs = 5.0;
+        burstLoss.lossProbabilityGood = 0.002;
+        burstLoss.lossProbabilityBad = 0.75;
+        burstLoss.goodToBadProbability = 0.005;
+        burstLoss.badToGoodProbability = 0.2;
+
+        NetworkImpairmentConfig config;
+        config.outbound = burstLoss;
+        config.inbound = burstLoss;
+        config.seed = 0xB0257ull;
+        return config;
+    }
+
+    RunResult RunTransfer(uint32_t sendWindow, bool selectiveAcks) {
+        auto hub = std::make_shared<LoopbackNetworkHub>();
+        LoopbackNetworkIO senderLink(hub);
+        LoopbackNetworkIO receiverLink(hub);
+        ImpairedNetworkIO impairedLink(&senderLink, MakeBurstLossConfig());
+
+        BenchmarkPeer sender, receiver;
+        sender.io = &impairedLink;
+        sender.remote = NetworkEndpoint("10.0.0.2", 6000);
+        receiver.io = &receiverLink;
+        receiver.remote = NetworkEndpoint("10.0.0.1", 5000);
+        const uint8_t capabilities = selectiveAcks ? CONNECTION_CAPABILITY_SELECTIVE_ACKS : 0;
+        sender.state.SetCapabilities(capabilities);
+        receiver.state.SetCapabilities(capabilities);
+
+        RunResult result;
+        const bool started = impairedLink.Init("10.0.0.1", 5000, &sender) && receiverLink.Init("10.0.0.2", 6000, &receiver) &&
+            impairedLink.Start() && receiverLink.Start();
+        RF_TEST_CHECK(started);
+        if (!started) {
+            return result;
+        }
+
+        std::vector<uint8_t> message(MESSAGE_SIZE);
+        uint32_t sentMessages = 0;
+        const Clock::time_point start = Clock::now();
+        while (Clock::now() - start < RUN_TIMEOUT) {
+            const Clock::time_point now = Clock::now();
+
+            for (uint32_t i = 0; i < MESSAGES_PER_TICK && sentMessages < MESSAGE_COUNT && sender.InFlightSpan() < sendWindow; ++i) {
+                std::memcpy(message.data(), &sentMessages, sizeof(sentMessages));
+                const OutgoingPacket packet = PrepareOutgoingPacket(sender.state,
+                    sender.pool.CopyFrom(message.data(), MESSAGE_SIZE), static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE));
+                if (!packet.valid) break;
+                sender.Send(packet);
+                ++sentMessages;
+            }
+            sender.Tick(now);
+            receiver.Tick(now);
+
+            if (sentMessages == MESSAGE_COUNT && sender.DataInFlight() == 0) {
+                result.completed = true;
+                break;
+            }
+            std::this_thread::sleep_for(TICK_INTERVAL);
+        }
+        result.completionMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        receiverLink.Stop();
+        impairedLink.Stop();
+        result.delivered = receiver.delivered.load(std::memory_order_relaxed);
+        result.stillInFlight = sender.DataInFlight();
+        result.retransmits = sender.state.GetRetransmitStats();
+        result.impairment = impairedLink.GetImpairmentStats();
+        return result;
+    }
+
+    void PrintResult(const char* label, const RunResult& result) {
+        char completion[48];
+        if (result.completed) {
+            std::snprintf(completion, sizeof(completion), "%8.0f ms", result.completionMs);
+        }
+        else {
+            std::snprintf(completion, sizeof(completion), "incomplete, %zu unacked", result.stillInFlight);
+        }
+        std::printf("  %-10s %-22s timeout retransmits %5llu  fast retransmits %5llu  data lost %4llu  ACKs lost %4llu\n",
+            label, completion,
+            static_cast<unsigned long long>(result.retransmits.timeoutRetransmits),
+            static_cast<unsigned long long>(result.retransmits.fastRetransmits),
+            static_cast<unsigned long long>(result.impairment.outbound.dropped),
+            static_cast<unsigned long long>(result.impairment.inbound.dropped));
+    }
+
+    void BenchmarkSelectiveAcksUnderBurstLoss() {
+        std::printf("  %u reliable messages of %u bytes, 5 ms each way, burst loss on data and ACKs:\n",
+            MESSAGE_COUNT, MESSAGE_SIZE);
+        // The window counts sequences, and ACK-only packets use them too; half the selective ack
+        // window leaves room for those while a retransmission is outstanding.
+        for (const uint32_t sendWindow : { HEADER_ACK_WINDOW - 1, SELECTIVE_ACK_WINDOW_BITS / 2 }) {
+            const RunResult withoutSack = RunTransfer(sendWindow, false);
+            const RunResult withSack = RunTransfer(sendWindow, true);
+            std::printf("  send window %u:\n", sendWindow);
+            PrintResult("SACK off", withoutSack);
+            PrintResult("SACK on", withSack);
+
+            RF_TEST_CHECK(withSack.completed && withSack.delivered == MESSAGE_COUNT);
+            if (sendWindow < HEADER_ACK_WINDOW) {
+                RF_TEST_CHECK(withoutSack.completed && withoutSack.delivered == MESSAGE_COUNT);
+            }
+            else {
+                // Only the selective ack block reaches the packets behind a lost ACK.
+                RF_TEST_CHECK(withSack.retransmits.timeoutRetransmits < withoutSack.retransmits.timeoutRetransmits);
+            }
+        }
+    }
+
+} // namespace
+
+int main() {
+    // The network logger is created at trace level; keep per-packet lines out of the timing.
+    RiftForged::Utilities::Logger::Init(spdlog::level::warn, spdlog::level::warn);
+    RiftForged::Utilities::Logger::GetNetworkLogger()->set_level(spdlog::level::warn);
+
+    RunTest("Burst loss completes with selective acks beyond the header ACK", BenchmarkSelectiveAcksUnderBurstLoss);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,136 @@
+﻿// File: UDPSocketThroughputBenchmark.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Measures datagrams per second through UDPSocketLinux over 127.0.0.1, once with one
+// sendmsg per datagram (SendData) and once through the send queue that FlushSendQueue pushes out
+// with sendmmsg (QueueSendData). The receiver runs the preferred backend (io_uring when the build
+// and kernel allow it, epoll otherwise). Prints rates and datagrams per syscall on both sides;
+// checks only that every datagram arrived.
+
+#include "TestSupport.h"
+#include "UDPSocketLinux.h"
+#include <RiftForged/Utilities/Logger/Logger.h>
+
+#include <algorithm> // For std::min
+#include <atomic>    // For std::atomic
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstdio>    // For std::printf
+#include <thread>    // For std::this_thread::yield
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint16_t RECEIVER_PORT = 47777;
+    const uint16_t SENDER_PORT = 47778;
+    const uint32_t DATAGRAM_SIZE = 64;
+    const uint64_t DATAGRAMS_PER_RUN = 200000;
+    // Datagrams the sender may run ahead of the receiver. Well inside the 4 MiB receive buffer, so
+    // a lost datagram means a bug rather than an overrun on a busy core.
+    const uint64_t MAX_IN_FLIGHT = 4096;
+    const auto DRAIN_TIMEOUT = std::chrono::seconds(5);
+    const int RUNS = 3;
+
+    class CountingSink : public INetworkIOEvents {
+    public:
+        void OnRawDataReceived(const NetworkEndpoint&, const uint8_t*, uint32_t, OverlappedIOContext*) override {
+            received.fetch_add(1, std::memory_order_relaxed);
+        }
+        void OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) override {
+            received.fetch_add(datagrams.size(), std::memory_order_relaxed);
+        }
+        void OnSendCompleted(OverlappedIOContext*, bool, uint32_t) override {}
+        void OnNetworkError(const std::string&, int) override {}
+
+        std::atomic<uint64_t> received{ 0 };
+    };
+
+    // Waits until the receiver has caught up to within 'slack' datagrams of 'target'.
+    bool WaitForReceiver(const CountingSink& sink, uint64_t target, uint64_t slack) {
+        const Clock::time_point deadline = Clock::now() + DRAIN_TIMEOUT;
+        while (sink.received.load(std::memory_order_relaxed) + slack < target) {
+            if (Clock::now() > deadline) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    enum class SendMode { PerDatagram, Queued };
+
+    void Measure(const char* label, SendMode mode) {
+        CountingSink receiverSink;
+        CountingSink senderSink;
+        UDPSocketLinux receiver(LinuxIOBackend::IoUring);
+        UDPSocketLinux sender(LinuxIOBackend::Epoll);
+        if (!receiver.Init("127.0.0.1", RECEIVER_PORT, &receiverSink) || !receiver.Start() ||
+            !sender.Init("127.0.0.1", SENDER_PORT, &senderSink) || !sender.Start()) {
+            std::printf("  %s: could not open UDP sockets on 127.0.0.1; skipped.\n", label);
+            return;
+        }
+
+        const NetworkEndpoint receiverEndpoint("127.0.0.1", RECEIVER_PORT);
+        const std::vector<uint8_t> datagram(DATAGRAM_SIZE, 0x5A);
+        double bestSeconds = 0.0;
+        for (int run = 0; run < RUNS; ++run) {
+            const uint64_t receivedBefore = receiverSink.received.load();
+            const Clock::time_point start = Clock::now();
+            uint64_t sent = 0;
+            bool delivered = true;
+            while (sent < DATAGRAMS_PER_RUN && delivered) {
+                const uint64_t chunk = std::min<uint64_t>(LINUX_SEND_BATCH_SIZE, DATAGRAMS_PER_RUN - sent);
+                for (uint64_t i = 0; i < chunk; ++i) {
+                    if (mode == SendMode::PerDatagram) {
+                        sender.SendData(receiverEndpoint, datagram.data(), DATAGRAM_SIZE);
+                    }
+                    else {
+                        sender.QueueSendData(receiverEndpoint, datagram.data(), DATAGRAM_SIZE);
+                    }
+                }
+                if (mode == SendMode::Queued) {
+                    sender.FlushSendQueue();
+                }
+                sent += chunk;
+                delivered = WaitForReceiver(receiverSink, receivedBefore + sent, MAX_IN_FLIGHT);
+            }
+            delivered = delivered && WaitForReceiver(receiverSink, receivedBefore + sent, 0);
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            RF_TEST_CHECK(delivered);
+            RF_TEST_CHECK(receiverSink.received.load() - receivedBefore == DATAGRAMS_PER_RUN);
+            bestSeconds = run == 0 ? seconds : std::min(bestSeconds, seconds);
+        }
+
+        const NetworkIOStats sendStats = sender.GetIOStats();
+        const NetworkIOStats receiveStats = receiver.GetIOStats();
+        std::printf("  %-22s %6.2f M datagrams/s (%6.1f ns each); %5.1f datagrams per send syscall, %5.1f per receive wakeup (%s)\n",
+            label,
+            static_cast<double>(DATAGRAMS_PER_RUN) / bestSeconds / 1e6,
+            bestSeconds * 1e9 / static_cast<double>(DATAGRAMS_PER_RUN),
+            sendStats.DatagramsPerSendSyscall(),
+            receiveStats.DatagramsPerReceiveSyscall(),
+            receiver.GetActiveBackend() == LinuxIOBackend::IoUring ? "io_uring" : "epoll");
+        RF_TEST_CHECK(sendStats.sendErrors == 0);
+
+        sender.Stop();
+        receiver.Stop();
+    }
+
+    void BenchmarkSocketThroughput() {
+        std::printf("  %u byte datagrams, best of %d runs of %llu:\n",
+            DATAGRAM_SIZE, RUNS, static_cast<unsigned long long>(DATAGRAMS_PER_RUN));
+        Measure("sendmsg per datagram:", SendMode::PerDatagram);
+        Measure("queued, sendmmsg:", SendMode::Queued);
+    }
+
+} // namespace
+
+int main() {
+    RiftForged::Utilities::Logger::Init(spdlog::level::warn, spdlog::level::warn);
+    RiftForged::Utilities::Logger::GetNetworkLogger()->set_level(spdlog::level::warn);
+
+    RunTest("Datagrams per second through UDPSocketLinux", BenchmarkSocketThroughput);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,183 @@
+﻿// File: C2SDispatchTableTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of C2SDispatchTable: a verified message reaches the handler registered for its
+// payload type with its fields intact, and the table reports instead of calling when no handler is
+// registered, the payload type is newer than this build, or the handler needs a player the session
+// does not have yet. Messages are built with the generated FlatBuffers builders.
+
+#include "TestSupport.h"
+#include "VerifiedC2SMessage.h"
+#include "C2SDispatchTable.h"
+
+#include <optional>  // For std::optional
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    // Records which message it was handed last, and for which player.
+    struct RecordingHandler {
+        std::optional<S2C_Response> Process(const NetworkEndpoint& sender, RiftForged::GameLogic::ActivePlayer* player, const UDP::C2S::C2S_MovementInputMsg* message) {
+            lastSender = sender;
+            lastPlayer = player;
+            lastTimestamp = message->client_timestamp_ms();
+            ++movementCalls;
+            return std::nullopt;
+        }
+        std::optional<S2C_Response> Process(const NetworkEndpoint& sender, RiftForged::GameLogic::ActivePlayer* player, const UDP::C2S::C2S_UseAbilityMsg* message) {
+            lastSender = sender;
+            lastPlayer = player;
+            lastAbilityId = message->ability_id();
+            ++abilityCalls;
+            return std::nullopt;
+        }
+
+        NetworkEndpoint lastSender;
+        RiftForged::GameLogic::ActivePlayer* lastPlayer = nullptr;
+        uint64_t lastTimestamp = 0;
+        uint32_t lastAbilityId = 0;
+        int movementCalls = 0;
+        int abilityCalls = 0;
+    };
+
+    flatbuffers::DetachedBuffer BuildMovement(uint64_t timestamp) {
+        using namespace UDP::C2S;
+        const RiftForged::Networking::Shared::Vec3 direction(0.0f, 1.0f, 0.0f);
+        flatbuffers::FlatBufferBuilder builder;
+        auto message = CreateC2S_MovementInputMsg(builder, timestamp, &direction, false);
+        FinishRoot_C2S_UDP_MessageBuffer(builder, CreateRoot_C2S_UDP_Message(builder, C2S_UDP_Payload_MovementInput, message.Union()));
+        return builder.Release();
+    }
+
+    flatbuffers::DetachedBuffer BuildUseAbility(uint32_t abilityId) {
+        using namespace UDP::C2S;
+        const RiftForged::Networking::Shared::Vec3 target(1.0f, 2.0f, 3.0f);
+        flatbuffers::FlatBufferBuilder builder;
+        auto message = CreateC2S_UseAbilityMsg(builder, 1000, abilityId, 42, &target);
+        FinishRoot_C2S_UDP_MessageBuffer(builder, CreateRoot_C2S_UDP_Message(builder, C2S_UDP_Payload_UseAbility, message.Union()));
+        return builder.Release();
+    }
+
+    bool Verify(const flatbuffers::DetachedBuffer& buffer, VerifiedC2SMessage& out_message) {
+        if (!VerifyC2SMessage(buffer.data(), static_cast<uint32_t>(buffer.size()), out_message)) {
+            return false;
+        }
+        out_message.sender = NetworkEndpoint("10.0.0.7", 5000);
+        return true;
+    }
+
+    // The table never dereferences the player; any non-null pointer stands for "has one".
+    RiftForged::GameLogic::ActivePlayer* SomePlayer() {
+        static int placeholder = 0;
+        return reinterpret_cast<RiftForged::GameLogic::ActivePlayer*>(&placeholder);
+    }
+
+    void TestMessageReachesItsHandler() {
+        RecordingHandler handler;
+        C2SDispatchTable table;
+        table.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(handler);
+        table.RegisterHandler<UDP::C2S::C2S_UseAbilityMsg>(handler);
+        RF_TEST_CHECK(table.IsRegistered(UDP::C2S::C2S_UDP_Payload_MovementInput));
+        RF_TEST_CHECK(table.IsRegistered(UDP::C2S::C2S_UDP_Payload_UseAbility));
+
+        const flatbuffers::DetachedBuffer movement = BuildMovement(123456);
+        VerifiedC2SMessage message;
+        RF_TEST_CHECK(Verify(movement, message));
+        RF_TEST_CHECK(message.payloadType == UDP::C2S::C2S_UDP_Payload_MovementInput);
+        C2SDispatchStatus status = C2SDispatchStatus::NoHandler;
+        table.Dispatch(message, SomePlayer(), status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::Dispatched);
+        RF_TEST_CHECK(handler.movementCalls == 1 && handler.abilityCalls == 0);
+        RF_TEST_CHECK(handler.lastTimestamp == 123456);
+        RF_TEST_CHECK(handler.lastSender == NetworkEndpoint("10.0.0.7", 5000));
+        RF_TEST_CHECK(handler.lastPlayer == SomePlayer());
+
+        const flatbuffers::DetachedBuffer ability = BuildUseAbility(77);
+        RF_TEST_CHECK(Verify(ability, message));
+        table.Dispatch(message, SomePlayer(), status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::Dispatched);
+        RF_TEST_CHECK(handler.abilityCalls == 1 && handler.lastAbilityId == 77);
+    }
+
+    void TestUnregisteredTypeIsReported() {
+        RecordingHandler handler;
+        C2SDispatchTable table;
+        table.RegisterHandler<UDP::C2S::C2S_UseAbilityMsg>(handler);
+        RF_TEST_CHECK(!table.IsRegistered(UDP::C2S::C2S_UDP_Payload_MovementInput));
+
+        const flatbuffers::DetachedBuffer movement = BuildMovement(1);
+        VerifiedC2SMessage message;
+        RF_TEST_CHECK(Verify(movement, message));
+        C2SDispatchStatus status = C2SDispatchStatus::Dispatched;
+        RF_TEST_CHECK(!table.Dispatch(message, SomePlayer(), status).has_value());
+        RF_TEST_CHECK(status == C2SDispatchStatus::NoHandler);
+
+        // A type added to the schema after this build passes the verifier but has no table slot.
+        message.payloadType = static_cast<UDP::C2S::C2S_UDP_Payload>(UDP::C2S::C2S_UDP_Payload_MAX + 1);
+        RF_TEST_CHECK(!table.IsRegistered(message.payloadType));
+        table.Dispatch(message, SomePlayer(), status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::NoHandler);
+        RF_TEST_CHECK(handler.movementCalls == 0 && handler.abilityCalls == 0);
+    }
+
+    void TestPlayerRequirement() {
+        RecordingHandler handler;
+        C2SDispatchTable table;
+        table.RegisterHandler<UDP::C2S::C2S_UseAbilityMsg>(handler);
+        table.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(handler, false);
+
+        const flatbuffers::DetachedBuffer ability = BuildUseAbility(5);
+        VerifiedC2SMessage message;
+        RF_TEST_CHECK(Verify(ability, message));
+        C2SDispatchStatus status = C2SDispatchStatus::Dispatched;
+        table.Dispatch(message, nullptr, status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::PlayerRequired);
+        RF_TEST_CHECK(handler.abilityCalls == 0);
+
+        // Registered without the requirement: dispatched with no player.
+        const flatbuffers::DetachedBuffer movement = BuildMovement(9);
+        RF_TEST_CHECK(Verify(movement, message));
+        table.Dispatch(message, nullptr, status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::Dispatched);
+        RF_TEST_CHECK(handler.movementCalls == 1 && handler.lastPlayer == nullptr);
+    }
+
+    void TestRegistrationReplacesEarlierHandler() {
+        RecordingHandler first;
+        RecordingHandler second;
+        C2SDispatchTable table;
+        table.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(first);
+        table.RegisterHandler<UDP::C2S::C2S_MovementInputMsg>(second);
+
+        const flatbuffers::DetachedBuffer movement = BuildMovement(3);
+        VerifiedC2SMessage message;
+        RF_TEST_CHECK(Verify(movement, message));
+        C2SDispatchStatus status = C2SDispatchStatus::NoHandler;
+        table.Dispatch(message, SomePlayer(), status);
+        RF_TEST_CHECK(status == C2SDispatchStatus::Dispatched);
+        RF_TEST_CHECK(first.movementCalls == 0 && second.movementCalls == 1);
+    }
+
+    void TestInvalidBuffersAreNotVerified() {
+        const flatbuffers::DetachedBuffer movement = BuildMovement(1);
+        VerifiedC2SMessage message;
+        RF_TEST_CHECK(!VerifyC2SMessage(movement.data(), static_cast<uint32_t>(movement.size() / 2), message));
+
+        std::vector<uint8_t> garbage(movement.size(), 0xFF);
+        RF_TEST_CHECK(!VerifyC2SMessage(garbage.data(), static_cast<uint32_t>(garbage.size()), message));
+        RF_TEST_CHECK(!VerifyC2SMessage(nullptr, 0, message));
+    }
+
+} // namespace
+
+int main() {
+    RunTest("A verified message reaches the handler for its type", TestMessageReachesItsHandler);
+    RunTest("Unregistered and unknown payload types are reported", TestUnregisteredTypeIsReported);
+    RunTest("Handlers that need a player are not called without one", TestPlayerRequirement);
+    RunTest("Registering a type again replaces its handler", TestRegistrationReplacesEarlierHandler);
+    RunTest("Truncated and garbage buffers do not verify", TestInvalidBuffersAreNotVerified);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,188 @@
+﻿// File: CongestionControllerTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of the per-connection congestion window and pacer: slow start, congestion
+// avoidance, one reduction per loss epoch, RTO collapse, token-bucket spacing, and the assembler
+// holding staged data back until the window and pacer allow it. Time is passed in explicitly, so
+// every case is exact.
+
+#include "TestSupport.h"
+#include "CongestionController.h"
+#include "UDPReliabilityProtocol.h"
+
+#include <chrono>  // For std::chrono::steady_clock
+#include <cmath>   // For std::abs
+#include <vector>  // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const uint32_t DATAGRAM = CONGESTION_MAX_DATAGRAM_SIZE;
+    const float SRTT_MS = 100.0f;
+
+    // Sends (and counts in flight) 'count' full datagrams at 'now', ignoring the pacer.
+    void SendInFlight(CongestionController& controller, uint32_t count, Clock::time_point now) {
+        for (uint32_t i = 0; i < count; ++i) {
+            controller.OnPacketSent(DATAGRAM, true, now, SRTT_MS);
+        }
+    }
+
+    void TestSlowStartThenAvoidance() {
+        CongestionController controller;
+        const Clock::time_point now = Clock::now();
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == CONGESTION_INITIAL_WINDOW_BYTES);
+
+        // Slow start: a window's worth of ACKs doubles the window.
+        SendInFlight(controller, 10, now);
+        for (int i = 0; i < 10; ++i) controller.OnPacketAcked(DATAGRAM);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == 2 * CONGESTION_INITIAL_WINDOW_BYTES);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).bytesInFlight == 0);
+
+        // After a loss the window sits at ssthresh and grows one datagram per window acknowledged.
+        controller.OnPacketLost(1, 2, false);
+        const uint32_t window = controller.GetStats(SRTT_MS).congestionWindowBytes;
+        RF_TEST_CHECK(window == CONGESTION_INITIAL_WINDOW_BYTES);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).slowStartThresholdBytes == window);
+        for (uint32_t acked = 0; acked + DATAGRAM < window; acked += DATAGRAM) controller.OnPacketAcked(DATAGRAM);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == window);
+        controller.OnPacketAcked(DATAGRAM);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == window + DATAGRAM);
+    }
+
+    void TestLossReducesOncePerEpoch() {
+        CongestionController controller;
+        controller.OnPacketLost(5, 20, false);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == CONGESTION_INITIAL_WINDOW_BYTES / 2);
+
+        // Losses of packets sent before the reduction belong to the same event.
+        controller.OnPacketLost(10, 22, false);
+        controller.OnPacketLost(19, 22, false);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == CONGESTION_INITIAL_WINDOW_BYTES / 2);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).lossEvents == 1);
+
+        // A packet sent after it starts a new one.
+        controller.OnPacketLost(20, 30, false);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == CONGESTION_INITIAL_WINDOW_BYTES / 4);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).lossEvents == 2);
+
+        // An RTO collapses the window to the minimum.
+        controller.OnPacketLost(40, 50, true);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).congestionWindowBytes == CONGESTION_MIN_WINDOW_BYTES);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).timeoutEvents == 1);
+    }
+
+    void TestWindowLimitsReliableDataOnly() {
+        CongestionController controller;
+        const Clock::time_point now = Clock::now();
+        Clock::time_point retry{};
+
+        SendInFlight(controller, 10, now); // A full initial window
+        const Clock::time_point later = now + std::chrono::seconds(1); // Pacer refilled
+        RF_TEST_CHECK(!controller.CanSend(DATAGRAM, true, later, SRTT_MS, &retry));
+        RF_TEST_CHECK(retry == Clock::time_point::max()); // Only an ACK can open it
+        RF_TEST_CHECK(controller.CanSend(DATAGRAM, false, later, SRTT_MS, &retry)); // Unreliable data is not windowed
+
+        controller.OnPacketAcked(DATAGRAM);
+        RF_TEST_CHECK(controller.CanSend(DATAGRAM, true, later, SRTT_MS, &retry));
+
+        // A given-up packet frees its share of the window too.
+        controller.OnPacketAbandoned(DATAGRAM);
+        RF_TEST_CHECK(controller.GetStats(SRTT_MS).bytesInFlight == 8 * DATAGRAM);
+    }
+
+    void TestPacerSpreadsDatagrams() {
+        CongestionController controller;
+        const float rate = controller.GetStats(SRTT_MS).pacingRateBytesPerSecond;
+        RF_TEST_CHECK(std::abs(rate - CONGESTION_PACING_GAIN * CONGESTION_INITIAL_WINDOW_BYTES / (SRTT_MS / 1000.0f)) < 1.0f);
+
+        // The burst goes out back to back; after that the pacer hands out retry times.
+        const Clock::time_point start = Clock::now();
+        Clock::time_point now = start;
+        Clock::time_point retry{};
+        const uint32_t burst = CONGESTION_PACING_BURST_BYTES / DATAGRAM;
+        const uint32_t total = 40;
+        uint32_t sentAtStart = 0;
+        for (uint32_t sent = 0; sent < total;) {
+            if (controller.CanSend(DATAGRAM, false, now, SRTT_MS, &retry)) {
+                controller.OnPacketSent(DATAGRAM, false, now, SRTT_MS);
+                if (now == start) ++sentAtStart;
+                ++sent;
+                continue;
+            }
+            RF_TEST_CHECK(retry > now && retry != Clock::time_point::max());
+            now = retry;
+        }
+        RF_TEST_CHECK(sentAtStart == burst);
+
+        // The rest left at the pacing rate.
+        const double expectedSeconds = static_cast<double>(total - burst) * DATAGRAM / rate;
+        const double elapsedSeconds = std::chrono::duration<double>(now - start).count();
+        RF_TEST_CHECK(elapsedSeconds > expectedSeconds * 0.9 && elapsedSeconds < expectedSeconds * 1.1);
+    }
+
+    void TestAssemblerWaitsForWindowAndPacer() {
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        PacketBufferPool pool;
+        // Each message fills a datagram on its own, so datagrams == messages.
+        const uint32_t messageSize = GetCoalescedPayloadMaxSize() - 50;
+        const std::vector<uint8_t> bytes(messageSize, 0x42);
+        const uint32_t messages = 40;
+        bool needsAssembly = false;
+        for (uint32_t i = 0; i < messages; ++i) {
+            RF_TEST_CHECK(StageOutgoingMessage(sender, pool.CopyFrom(bytes.data(), messageSize), 1, DeliveryChannel::Reliable, &needsAssembly));
+        }
+
+        // Follow the pacer until only the window holds data back.
+        Clock::time_point now = Clock::now();
+        std::vector<OutgoingPacket> packets;
+        Clock::time_point next{};
+        int builds = 0;
+        while (BuildCoalescedPackets(sender, pool, now, packets, &next) && next != Clock::time_point::max() && ++builds < 1000) {
+            RF_TEST_CHECK(next > now);
+            now = next;
+        }
+        const CongestionStats stats = sender.GetCongestionStats();
+        RF_TEST_CHECK(packets.size() >= CONGESTION_INITIAL_WINDOW_BYTES / CONGESTION_MAX_DATAGRAM_SIZE);
+        RF_TEST_CHECK(packets.size() < messages);
+        RF_TEST_CHECK(stats.bytesInFlight <= stats.congestionWindowBytes + CONGESTION_MAX_DATAGRAM_SIZE);
+        RF_TEST_CHECK(stats.sendsDeferred > 0);
+
+        // Acknowledging what went out lets the rest follow, all of it delivered.
+        size_t delivered = 0;
+        for (int round = 0; round < 100 && delivered < messages; ++round) {
+            for (const OutgoingPacket& packet : packets) {
+                const uint8_t* payload = nullptr;
+                uint32_t payloadSize = 0;
+                if (ProcessIncomingPacketHeader(receiver, packet.header, packet.payload.Data(),
+                    static_cast<uint16_t>(packet.payload.Size()), &payload, &payloadSize)) {
+                    ++delivered;
+                }
+            }
+            packets.clear();
+            now += std::chrono::milliseconds(100);
+            TrySendAckOnlyPacket(receiver, pool, now, [&](const OutgoingPacket& ack) {
+                ProcessIncomingPacketHeader(sender, ack.header, nullptr, 0, nullptr, nullptr);
+            });
+            while (BuildCoalescedPackets(sender, pool, now, packets, &next) && next != Clock::time_point::max()) {
+                now = next;
+            }
+        }
+        RF_TEST_CHECK(delivered == messages);
+        RF_TEST_CHECK(sender.GetCongestionStats().congestionWindowBytes > CONGESTION_INITIAL_WINDOW_BYTES); // Slow start grew it
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Slow start, then one datagram per window", TestSlowStartThenAvoidance);
+    RunTest("A loss reduces the window once per epoch", TestLossReducesOncePerEpoch);
+    RunTest("The window limits reliable data only", TestWindowLimitsReliableDataOnly);
+    RunTest("The pacer spreads datagrams at its rate", TestPacerSpreadsDatagrams);
+    RunTest("The assembler waits for the window and the pacer", TestAssemblerWaitsForWindowAndPacer);
+    return RiftForged::Tests::TestExitCode();
+}
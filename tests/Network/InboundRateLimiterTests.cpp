@@ -0,0 +1,141 @@
+﻿// File: InboundRateLimiterTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of the per-connection inbound token buckets: a full bucket admits its burst
+// and then one message per emission interval, an idle bucket refills to its burst and no further,
+// a zero rate is unlimited, and drops are counted per class without touching the other classes.
+// Time is passed in explicitly, so every case is exact.
+
+#include "TestSupport.h"
+#include "InboundRateLimiter.h"
+
+#include <array>   // For std::array
+#include <atomic>  // For std::atomic
+#include <chrono>  // For std::chrono::steady_clock
+#include <thread>  // For std::thread
+#include <vector>  // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Tokens 'bucket' hands out at 'now' before it refuses one.
+    uint32_t Drain(TokenBucket& bucket, Clock::time_point now) {
+        uint32_t taken = 0;
+        while (bucket.TryConsume(now) && taken < 100000) ++taken;
+        return taken;
+    }
+
+    void TestBurstThenRate() {
+        TokenBucket bucket;
+        bucket.Configure(InboundRateLimit{ 10, 5 }); // One token per 100 ms
+        const Clock::time_point start = Clock::now();
+        RF_TEST_CHECK(Drain(bucket, start) == 5);
+
+        // Refused until a whole interval has passed, then one token per interval.
+        RF_TEST_CHECK(!bucket.TryConsume(start + std::chrono::milliseconds(99)));
+        RF_TEST_CHECK(Drain(bucket, start + std::chrono::milliseconds(100)) == 1);
+        RF_TEST_CHECK(Drain(bucket, start + std::chrono::milliseconds(350)) == 2);
+
+        // A steady stream at the rate is never refused.
+        Clock::time_point now = start + std::chrono::seconds(10);
+        Drain(bucket, now);
+        for (int i = 0; i < 100; ++i) {
+            now += std::chrono::milliseconds(100);
+            RF_TEST_CHECK(bucket.TryConsume(now));
+        }
+    }
+
+    void TestIdleBucketRefillsToBurstOnly() {
+        TokenBucket bucket;
+        bucket.Configure(InboundRateLimit{ 100, 8 });
+        const Clock::time_point start = Clock::now();
+        RF_TEST_CHECK(Drain(bucket, start) == 8);
+        // An hour of silence buys one burst, not an hour of tokens.
+        RF_TEST_CHECK(Drain(bucket, start + std::chrono::hours(1)) == 8);
+
+        // A burst of 0 behaves as 1.
+        TokenBucket strict;
+        strict.Configure(InboundRateLimit{ 100, 0 });
+        RF_TEST_CHECK(Drain(strict, start) == 1);
+    }
+
+    void TestZeroRateIsUnlimited() {
+        TokenBucket bucket;
+        bucket.Configure(InboundRateLimit{ 0, 1 });
+        const Clock::time_point now = Clock::now();
+        for (int i = 0; i < 10000; ++i) {
+            RF_TEST_CHECK(bucket.TryConsume(now));
+        }
+    }
+
+    void TestDropsAreCountedPerClass() {
+        InboundRateLimiter limiter;
+        std::array<InboundRateLimit, INBOUND_RATE_CLASS_COUNT> limits{};
+        limits[static_cast<size_t>(InboundRateClass::Datagram)] = { 0, 1 };
+        limits[static_cast<size_t>(InboundRateClass::Movement)] = { 60, 4 };
+        limits[static_cast<size_t>(InboundRateClass::Action)] = { 10, 2 };
+        limits[static_cast<size_t>(InboundRateClass::Control)] = { 1, 1 };
+        limiter.Configure(limits);
+
+        const Clock::time_point now = Clock::now();
+        for (int i = 0; i < 10; ++i) {
+            limiter.Admit(InboundRateClass::Datagram, now);
+            limiter.Admit(InboundRateClass::Movement, now);
+            limiter.Admit(InboundRateClass::Action, now);
+        }
+        // Spending one class does not touch another.
+        RF_TEST_CHECK(limiter.Admit(InboundRateClass::Control, now));
+        RF_TEST_CHECK(!limiter.Admit(InboundRateClass::Control, now));
+        RF_TEST_CHECK(!limiter.Admit(InboundRateClass::Count, now)); // Not a class
+
+        const InboundRateLimitStats stats = limiter.GetStats();
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Datagram)] == 0);
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Movement)] == 6);
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Action)] == 8);
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Control)] == 1);
+    }
+
+    void TestDefaultsMatchTheConstants() {
+        InboundRateLimiter limiter;
+        const Clock::time_point now = Clock::now();
+        uint32_t admitted = 0;
+        while (limiter.Admit(InboundRateClass::Movement, now) && admitted < 100000) ++admitted;
+        RF_TEST_CHECK(admitted == INBOUND_MOVEMENT_BURST);
+        admitted = 0;
+        while (limiter.Admit(InboundRateClass::Datagram, now) && admitted < 100000) ++admitted;
+        RF_TEST_CHECK(admitted == INBOUND_DATAGRAM_BURST);
+    }
+
+    void TestConcurrentConsumersShareOneBurst() {
+        TokenBucket bucket;
+        const uint32_t burst = 1000;
+        bucket.Configure(InboundRateLimit{ 1, burst }); // No refill within the test
+        const Clock::time_point now = Clock::now();
+        std::atomic<uint32_t> taken{ 0 };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&]() {
+                for (uint32_t i = 0; i < burst; ++i) {
+                    if (bucket.TryConsume(now)) taken.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        RF_TEST_CHECK(taken.load() == burst);
+    }
+
+} // namespace
+
+int main() {
+    RunTest("A bucket admits its burst, then its rate", TestBurstThenRate);
+    RunTest("An idle bucket refills to its burst only", TestIdleBucketRefillsToBurstOnly);
+    RunTest("A zero rate is unlimited", TestZeroRateIsUnlimited);
+    RunTest("Drops are counted per class", TestDropsAreCountedPerClass);
+    RunTest("Default limits match the constants", TestDefaultsMatchTheConstants);
+    RunTest("Concurrent consumers share one burst", TestConcurrentConsumersShareOneBurst);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,414 @@
+﻿// File: LoopbackRoundTripTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: End-to-end tests over LoopbackNetworkIO: a client and a server exchange real
+// datagrams through a LoopbackNetworkHub, join with the cookie handshake, then trade reliable
+// messages and ACKs. Both sides use Manual delivery, so every run takes the same steps.
+//
+// The server is a ConnectionManager, the transport UDPPacketHandler is built on, running its
+// reliability thread; it echoes every message it is given. The client is a minimal peer written
+// against the protocol functions.
+
+#include "TestSupport.h"
+#include "LoopbackNetworkIO.h"
+#include "ConnectionManager.h"
+#include "HandshakeCookie.h"
+#include "MessageCoalescing.h"
+#include "UDPReliabilityProtocol.h"
+
+#include <atomic>     // For std::atomic
+#include <chrono>     // For std::chrono::steady_clock
+#include <cstring>    // For std::memcpy, std::memcmp
+#include <functional> // For std::function
+#include <memory>     // For std::make_shared
+#include <vector>     // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    const auto ACK_DELAY_PASSED = std::chrono::seconds(1);
+    const uint8_t ECHO_PAYLOAD_TYPE = 1;
+
+    void SendPacket(INetworkIO& io, const NetworkEndpoint& to, const OutgoingPacket& packet) {
+        std::vector<uint8_t> datagram = SerializePacket(packet.header, packet.payload.Data(), static_cast<uint16_t>(packet.payload.Size()));
+        io.SendData(to, datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+
+    void SendHandshake(INetworkIO& io, const NetworkEndpoint& to, GamePacketFlag flag, uint32_t connectionId,
+        const uint8_t* payload, uint32_t payloadSize) {
+        GamePacketHeader header;
+        header.flags = static_cast<uint8_t>(flag);
+        header.connectionId = connectionId;
+        std::vector<uint8_t> datagram(GetGamePacketHeaderSize() + payloadSize);
+        std::memcpy(datagram.data(), &header, GetGamePacketHeaderSize());
+        if (payloadSize > 0) {
+            std::memcpy(datagram.data() + GetGamePacketHeaderSize(), payload, payloadSize);
+        }
+        io.SendData(to, datagram.data(), static_cast<uint32_t>(datagram.size()));
+    }
+
+    // Echoes every application message back reliably to the address the client joined from. Every
+    // message is charged to the Control class, so rate limits can be tested without FlatBuffers.
+    class EchoServer : public ConnectionManager {
+    public:
+        explicit EchoServer(INetworkIO* networkIO)
+            : ConnectionManager(networkIO) {}
+
+        ~EchoServer() override {
+            Stop();
+        }
+
+        std::atomic<size_t> messagesReceived{ 0 };
+
+    protected:
+        void DispatchApplicationPayload(const NetworkEndpoint&, ConnectionSession& session,
+            const uint8_t* payload, uint32_t payloadSize, bool reliable) override {
+            if (!AdmitInboundMessage(session, InboundRateClass::Control, reliable)) {
+                return;
+            }
+            ++messagesReceived;
+            SendReliablePacket(session.joinEndpoint, ECHO_PAYLOAD_TYPE, AcquirePayloadBuffer(payload, payloadSize));
+        }
+    };
+
+    // Runs the client side of the handshake and collects the server's echoes.
+    class LoopbackClient : public INetworkIOEvents {
+    public:
+        explicit LoopbackClient(std::shared_ptr<LoopbackNetworkHub> hub)
+            : io(std::move(hub), LoopbackDeliveryMode::Manual) {}
+
+        void OnRawDataReceived(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size, OverlappedIOContext*) override {
+            if (size < GetGamePacketHeaderSize()) return;
+            GamePacketHeader header;
+            std::memcpy(&header, data, GetGamePacketHeaderSize());
+            const uint8_t* payload = data + GetGamePacketHeaderSize();
+            const uint32_t payloadSize = size - static_cast<uint32_t>(GetGamePacketHeaderSize());
+
+            if (HasFlag(header.flags, GamePacketFlag::IS_CONNECT_CHALLENGE)) {
+                if (payloadSize >= HANDSHAKE_COOKIE_SIZE) {
+                    lastCookie.assign(payload, payload + HANDSHAKE_COOKIE_SIZE);
+                }
+                if (!answerChallenges) return;
+                // cookie | requested capabilities | rebind proof when keeping a session from before.
+                NetworkEndpoint observed;
+                if (payloadSize < HANDSHAKE_CHALLENGE_SIZE ||
+                    !ReadObservedEndpoint(payload + HANDSHAKE_COOKIE_SIZE, payloadSize - HANDSHAKE_COOKIE_SIZE, observed)) {
+                    return;
+                }
+                uint8_t response[HANDSHAKE_COOKIE_SIZE + 1 + SESSION_REBIND_PROOF_SIZE] = {};
+                std::memcpy(response, payload, HANDSHAKE_COOKIE_SIZE);
+                response[HANDSHAKE_COOKIE_SIZE] = requestedCapabilities;
+                uint32_t responseSize = HANDSHAKE_COOKIE_SIZE + 1;
+                if (connectionId != INVALID_CONNECTION_ID) {
+                    const SessionRebindProof proof = ComputeSessionRebindProof(secret, connectionId, observed, payload);
+                    std::memcpy(response + HANDSHAKE_COOKIE_SIZE + 1, proof.data(), proof.size());
+                    responseSize = sizeof(response);
+                }
+                SendHandshake(io, sender, GamePacketFlag::IS_CONNECT_RESPONSE, connectionId, response, responseSize);
+                return;
+            }
+            if (HasFlag(header.flags, GamePacketFlag::IS_CONNECT_RESPONSE)) {
+                if (payloadSize < 1 + SESSION_SECRET_SIZE) return;
+                connectionId = header.connectionId;
+                grantedCapabilities = payload[0];
+                state.connectionId = connectionId; // Echoed in every header from now on
+                std::memcpy(secret.data(), payload + 1, SESSION_SECRET_SIZE);
+                return;
+            }
+            const uint8_t* message = nullptr;
+            uint32_t messageSize = 0;
+            if (!ProcessIncomingPacketHeader(state, header, payload, static_cast<uint16_t>(payloadSize), &message, &messageSize)) {
+                return;
+            }
+            if (!HasFlag(header.flags, GamePacketFlag::IS_COALESCED)) {
+                echoes.emplace_back(message, message + messageSize);
+                return;
+            }
+            CoalescedFrameReader reader(message, messageSize);
+            uint8_t frameType = 0;
+            const uint8_t* frame = nullptr;
+            uint32_t frameSize = 0;
+            while (reader.Next(frameType, frame, frameSize)) {
+                echoes.emplace_back(frame, frame + frameSize);
+            }
+        }
+
+        void OnSendCompleted(OverlappedIOContext*, bool, uint32_t) override {}
+        void OnNetworkError(const std::string&, int) override {}
+
+        void RequestJoin(const NetworkEndpoint& server) {
+            const uint8_t padding[HANDSHAKE_CHALLENGE_SIZE] = {};
+            SendHandshake(io, server, GamePacketFlag::IS_CONNECT_REQUEST, INVALID_CONNECTION_ID, padding, HANDSHAKE_CHALLENGE_SIZE);
+        }
+
+        LoopbackNetworkIO io;
+        ReliableConnectionState state;
+        PacketBufferPool pool;
+        uint32_t connectionId = INVALID_CONNECTION_ID;
+        SessionSecret secret{};
+        uint8_t requestedCapabilities = 0;
+        uint8_t grantedCapabilities = 0;
+        bool answerChallenges = true;
+        std::vector<uint8_t> lastCookie;
+        std::vector<std::vector<uint8_t>> echoes;
+    };
+
+    struct LoopbackFixture {
+        std::shared_ptr<LoopbackNetworkHub> hub = std::make_shared<LoopbackNetworkHub>();
+        LoopbackNetworkIO serverIO{ hub, LoopbackDeliveryMode::Manual };
+        EchoServer server{ &serverIO };
+        LoopbackClient client{ hub };
+        const NetworkEndpoint serverEndpoint{ "127.0.0.1", 7777 };
+
+        // 'configure' runs before the server starts, for settings that must be made by then.
+        explicit LoopbackFixture(const std::function<void(EchoServer&)>& configure = nullptr) {
+            if (configure) configure(server);
+            RF_TEST_CHECK(serverIO.Init("127.0.0.1", 7777, &server) && serverIO.Start());
+            RF_TEST_CHECK(server.Start());
+            RF_TEST_CHECK(client.io.Init("10.0.0.1", 5000, &client) && client.io.Start());
+        }
+
+        ~LoopbackFixture() {
+            client.io.Stop();
+            server.Stop();
+            serverIO.Stop();
+        }
+
+        // Delivers everything in flight, in both directions, until both queues are empty.
+        void Pump() {
+            while (serverIO.Poll() + client.io.Poll() > 0) {}
+        }
+
+        NetworkEndpoint ServerSideEndpoint(uint32_t connectionId) {
+            NetworkEndpoint endpoint;
+            server.GetConnectionEndpoint(connectionId, endpoint);
+            return endpoint;
+        }
+
+        bool Join() {
+            client.RequestJoin(serverEndpoint);
+            Pump();
+            return client.connectionId != INVALID_CONNECTION_ID;
+        }
+    };
+
+    void TestHandshakeAssignsConnectionId() {
+        LoopbackFixture fixture;
+        RF_TEST_CHECK(fixture.server.GetSessionCount() == 0);
+        RF_TEST_CHECK(fixture.Join());
+
+        RF_TEST_CHECK(fixture.ServerSideEndpoint(fixture.client.connectionId) == fixture.client.io.GetLocalEndpoint());
+        RF_TEST_CHECK(fixture.server.GetSessionCount() == 1);
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().handshakesAccepted == 1);
+
+        // Repeating step 3 keeps the same session.
+        const uint32_t firstId = fixture.client.connectionId;
+        RF_TEST_CHECK(fixture.Join());
+        RF_TEST_CHECK(fixture.client.connectionId == firstId && fixture.server.GetSessionCount() == 1);
+    }
+
+    void TestCapabilitiesAreNegotiatedOnce() {
+        LoopbackFixture fixture;
+        fixture.client.requestedCapabilities = CONNECTION_CAPABILITY_SELECTIVE_ACKS;
+        RF_TEST_CHECK(fixture.Join());
+        RF_TEST_CHECK(fixture.client.grantedCapabilities == CONNECTION_CAPABILITY_SELECTIVE_ACKS);
+
+        // A repeated step 3 is answered with what the session was granted, whatever it asks for.
+        fixture.client.requestedCapabilities = 0;
+        RF_TEST_CHECK(fixture.Join());
+        RF_TEST_CHECK(fixture.client.grantedCapabilities == CONNECTION_CAPABILITY_SELECTIVE_ACKS);
+        RF_TEST_CHECK(fixture.server.GetSessionCount() == 1);
+    }
+
+    void TestReliableMessagesRoundTrip() {
+        LoopbackFixture fixture;
+        RF_TEST_CHECK(fixture.Join());
+        LoopbackClient& client = fixture.client;
+
+        std::vector<std::vector<uint8_t>> sent;
+        for (int i = 0; i < 100; ++i) {
+            std::vector<uint8_t> message(16 + i * 7);
+            for (size_t b = 0; b < message.size(); ++b) message[b] = static_cast<uint8_t>(i * 13 + b);
+            const OutgoingPacket packet = PrepareOutgoingPacket(client.state, client.pool.CopyFrom(message.data(), static_cast<uint32_t>(message.size())),
+                static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE));
+            RF_TEST_CHECK(packet.valid && packet.header.connectionId == client.connectionId);
+            SendPacket(client.io, fixture.serverEndpoint, packet);
+            sent.push_back(std::move(message));
+            fixture.Pump(); // The next message carries the ACK of this one's echo.
+        }
+
+        RF_TEST_CHECK(fixture.server.messagesReceived.load() == sent.size());
+        RF_TEST_CHECK(client.echoes == sent);
+
+        // Each echo piggybacked the server's ACKs; the client's pending ACK goes out on its own.
+        // The server's reliability thread may have sent ACK-only packets of its own meanwhile, so
+        // acknowledge until nothing the server sent is in flight.
+        RF_TEST_CHECK(client.state.unacknowledgedSentPackets.Empty());
+        CongestionStats serverStats;
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            TrySendAckOnlyPacket(client.state, client.pool, Clock::now() + ACK_DELAY_PASSED,
+                [&](const OutgoingPacket& ack) { SendPacket(client.io, fixture.serverEndpoint, ack); });
+            fixture.Pump();
+            RF_TEST_CHECK(fixture.server.GetConnectionCongestionStats(client.io.GetLocalEndpoint(), serverStats));
+            if (serverStats.bytesInFlight == 0) break;
+        }
+        RF_TEST_CHECK(serverStats.bytesInFlight == 0);
+    }
+
+    void TestClassLimitDropsOnlyUnreliableMessages() {
+        const uint32_t burst = 3;
+        LoopbackFixture fixture([&](EchoServer& server) {
+            server.SetInboundRateLimit(InboundRateClass::Control, InboundRateLimit{ 1, burst });
+        });
+        RF_TEST_CHECK(fixture.Join());
+        LoopbackClient& client = fixture.client;
+        const uint8_t message[32] = { 7 };
+
+        // Reliable messages were acknowledged before dispatch, so a burst far over the class limit
+        // is delivered whole; dropping any would lose it for good.
+        const size_t reliableCount = 20;
+        for (size_t i = 0; i < reliableCount; ++i) {
+            SendPacket(client.io, fixture.serverEndpoint, PrepareOutgoingPacket(client.state,
+                client.pool.CopyFrom(message, sizeof(message)), static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE)));
+        }
+        fixture.Pump();
+        RF_TEST_CHECK(fixture.server.messagesReceived.load() == reliableCount);
+
+        // Unreliable ones over the limit are dropped and counted.
+        const size_t unreliableCount = 20;
+        for (size_t i = 0; i < unreliableCount; ++i) {
+            SendPacket(client.io, fixture.serverEndpoint, PrepareOutgoingPacket(client.state,
+                client.pool.CopyFrom(message, sizeof(message)), 0));
+        }
+        fixture.Pump();
+        const size_t admitted = fixture.server.messagesReceived.load() - reliableCount;
+        RF_TEST_CHECK(admitted >= burst && admitted <= burst + 1); // One more if a second passed
+        InboundRateLimitStats stats;
+        RF_TEST_CHECK(fixture.server.GetConnectionRateLimitStats(client.io.GetLocalEndpoint(), stats));
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Control)] == unreliableCount - admitted);
+        RF_TEST_CHECK(stats.dropped[static_cast<size_t>(InboundRateClass::Datagram)] == 0);
+    }
+
+    void TestCookieFromAnotherAddressIsRejected() {
+        LoopbackFixture fixture;
+        LoopbackClient attacker(fixture.hub);
+        RF_TEST_CHECK(attacker.io.Init("10.0.0.66", 5000, &attacker) && attacker.io.Start());
+
+        // The attacker replays a cookie the server issued to the real client.
+        fixture.client.answerChallenges = false;
+        fixture.client.RequestJoin(fixture.serverEndpoint);
+        fixture.Pump();
+        RF_TEST_CHECK(fixture.client.lastCookie.size() == HANDSHAKE_COOKIE_SIZE);
+        SendHandshake(attacker.io, fixture.serverEndpoint, GamePacketFlag::IS_CONNECT_RESPONSE, INVALID_CONNECTION_ID,
+            fixture.client.lastCookie.data(), HANDSHAKE_COOKIE_SIZE);
+        fixture.Pump();
+        attacker.io.Poll();
+
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().cookiesRejected == 1);
+        RF_TEST_CHECK(fixture.server.GetSessionCount() == 0);
+        RF_TEST_CHECK(attacker.connectionId == INVALID_CONNECTION_ID);
+        attacker.io.Stop();
+    }
+
+    void TestRebindNeedsSessionSecret() {
+        LoopbackFixture fixture;
+        RF_TEST_CHECK(fixture.Join());
+        const uint32_t victimId = fixture.client.connectionId;
+        const NetworkEndpoint victimEndpoint = fixture.client.io.GetLocalEndpoint();
+
+        // An attacker who has seen the connection ID (but not the secret) claims it.
+        LoopbackClient attacker(fixture.hub);
+        RF_TEST_CHECK(attacker.io.Init("10.0.0.66", 5000, &attacker) && attacker.io.Start());
+        attacker.connectionId = victimId;
+        attacker.RequestJoin(fixture.serverEndpoint);
+        while (fixture.serverIO.Poll() + attacker.io.Poll() > 0) {}
+
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().rebindsRejected == 1);
+        RF_TEST_CHECK(fixture.ServerSideEndpoint(victimId) == victimEndpoint);
+        RF_TEST_CHECK(attacker.connectionId != victimId && fixture.server.GetSessionCount() == 2); // A session of its own
+        attacker.io.Stop();
+
+        // The real client moves to a new address (NAT rebinding) and proves the secret.
+        LoopbackClient moved(fixture.hub);
+        RF_TEST_CHECK(moved.io.Init("10.0.0.2", 6000, &moved) && moved.io.Start());
+        moved.connectionId = victimId;
+        moved.secret = fixture.client.secret;
+        moved.RequestJoin(fixture.serverEndpoint);
+        while (fixture.serverIO.Poll() + moved.io.Poll() > 0) {}
+
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().rebindsRejected == 1);
+        RF_TEST_CHECK(fixture.ServerSideEndpoint(victimId) == moved.io.GetLocalEndpoint());
+        RF_TEST_CHECK(moved.connectionId == victimId);
+        moved.io.Stop();
+    }
+
+    void TestRebindRetiresPreviousAddress() {
+        LoopbackFixture fixture;
+        RF_TEST_CHECK(fixture.Join());
+        LoopbackClient& client = fixture.client;
+        const uint32_t connectionId = client.connectionId;
+
+        LoopbackClient moved(fixture.hub);
+        RF_TEST_CHECK(moved.io.Init("10.0.0.2", 6000, &moved) && moved.io.Start());
+        moved.connectionId = connectionId;
+        moved.secret = client.secret;
+        moved.RequestJoin(fixture.serverEndpoint);
+        while (fixture.serverIO.Poll() + moved.io.Poll() > 0) {}
+        RF_TEST_CHECK(fixture.ServerSideEndpoint(connectionId) == moved.io.GetLocalEndpoint());
+
+        // The address the client left no longer reaches the session, with or without the ID.
+        const uint64_t dropsBefore = fixture.server.GetHandshakeStats().unknownSourceDrops;
+        ReliableConnectionState anonymous;
+        SendPacket(client.io, fixture.serverEndpoint,
+            PrepareOutgoingPacket(anonymous, client.pool.CopyFrom(reinterpret_cast<const uint8_t*>("stale"), 5), 0));
+        SendPacket(client.io, fixture.serverEndpoint,
+            PrepareOutgoingPacket(client.state, client.pool.CopyFrom(reinterpret_cast<const uint8_t*>("stale"), 5), 0));
+        fixture.Pump();
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().unknownSourceDrops == dropsBefore + 2);
+        RF_TEST_CHECK(fixture.server.messagesReceived.load() == 0);
+
+        // Nor can it start a new session while the moved one still answers to it as its join address.
+        client.connectionId = INVALID_CONNECTION_ID;
+        client.RequestJoin(fixture.serverEndpoint);
+        fixture.Pump();
+        RF_TEST_CHECK(client.connectionId == INVALID_CONNECTION_ID && fixture.server.GetSessionCount() == 1);
+
+        // The new address is served, and sends the game addresses to the join endpoint follow the move.
+        SendPacket(moved.io, fixture.serverEndpoint,
+            PrepareOutgoingPacket(moved.state, moved.pool.CopyFrom(reinterpret_cast<const uint8_t*>("moved"), 5), 0));
+        while (fixture.serverIO.Poll() + moved.io.Poll() > 0) {}
+        RF_TEST_CHECK(fixture.server.messagesReceived.load() == 1);
+        RF_TEST_CHECK(moved.echoes.size() == 1 && client.echoes.empty());
+        moved.io.Stop();
+    }
+
+    void TestTrafficWithoutSessionIsDropped() {
+        LoopbackFixture fixture;
+        LoopbackClient& client = fixture.client;
+        const OutgoingPacket packet = PrepareOutgoingPacket(client.state, client.pool.CopyFrom(reinterpret_cast<const uint8_t*>("hello"), 5),
+            static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE));
+        SendPacket(client.io, fixture.serverEndpoint, packet);
+        fixture.Pump();
+
+        RF_TEST_CHECK(fixture.server.GetHandshakeStats().unknownSourceDrops == 1);
+        RF_TEST_CHECK(fixture.server.messagesReceived.load() == 0);
+        RF_TEST_CHECK(fixture.server.GetSessionCount() == 0);
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Handshake assigns a connection ID", TestHandshakeAssignsConnectionId);
+    RunTest("Capabilities are negotiated once per session", TestCapabilitiesAreNegotiatedOnce);
+    RunTest("Reliable messages round-trip", TestReliableMessagesRoundTrip);
+    RunTest("Class limits drop only unreliable messages", TestClassLimitDropsOnlyUnreliableMessages);
+    RunTest("Cookie from another address is rejected", TestCookieFromAnotherAddressIsRejected);
+    RunTest("Rebind needs the session secret", TestRebindNeedsSessionSecret);
+    RunTest("Rebind retires the previous address", TestRebindRetiresPreviousAddress);
+    RunTest("Traffic without a session is dropped", TestTrafficWithoutSessionIsDropped);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,223 @@
+﻿// File: MessageCoalescingTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of outbound message coalescing: the frame format on its own, then staged
+// messages packed by BuildCoalescedPackets and unpacked on a second connection state by
+// ProcessIncomingPacketHeader, as if they had crossed the wire.
+
+#include "TestSupport.h"
+#include "MessageCoalescing.h"
+#include "UDPReliabilityProtocol.h"
+
+#include <chrono>  // For std::chrono::steady_clock
+#include <vector>  // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Message {
+        uint8_t payloadType = 0;
+        std::vector<uint8_t> bytes;
+
+        bool operator==(const Message& other) const {
+            return payloadType == other.payloadType && bytes == other.bytes;
+        }
+    };
+
+    std::vector<uint8_t> MakeBytes(uint32_t size, uint8_t seed) {
+        std::vector<uint8_t> bytes(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<uint8_t>(seed + i * 11);
+        }
+        return bytes;
+    }
+
+    // Hands 'packet' to 'receiver' and appends the messages it carried: every frame of a coalesced
+    // payload, or the payload itself. Returns false if the receiver dropped the packet.
+    bool DeliverMessages(ReliableConnectionState& receiver, const OutgoingPacket& packet, uint8_t unframedType,
+        std::vector<Message>& out_messages) {
+        const uint8_t* payload = nullptr;
+        uint32_t payloadSize = 0;
+        if (!ProcessIncomingPacketHeader(receiver, packet.header, packet.payload.Data(),
+            static_cast<uint16_t>(packet.payload.Size()), &payload, &payloadSize)) {
+            return false;
+        }
+        if (!HasFlag(packet.header.flags, GamePacketFlag::IS_COALESCED)) {
+            out_messages.push_back(Message{ unframedType, std::vector<uint8_t>(payload, payload + payloadSize) });
+            return true;
+        }
+        CoalescedFrameReader reader(payload, payloadSize);
+        uint8_t payloadType = 0;
+        const uint8_t* message = nullptr;
+        uint32_t messageSize = 0;
+        while (reader.Next(payloadType, message, messageSize)) {
+            out_messages.push_back(Message{ payloadType, std::vector<uint8_t>(message, message + messageSize) });
+        }
+        return reader.AtEnd();
+    }
+
+    void TestFramesReadBackInOrder() {
+        uint8_t buffer[256];
+        uint32_t offset = 0;
+        const std::vector<uint8_t> first = MakeBytes(10, 1);
+        const std::vector<uint8_t> second = MakeBytes(200, 2);
+        RF_TEST_CHECK(AppendCoalescedFrame(buffer, sizeof(buffer), offset, 7, first.data(), 10));
+        RF_TEST_CHECK(AppendCoalescedFrame(buffer, sizeof(buffer), offset, 9, second.data(), 200));
+        RF_TEST_CHECK(offset == GetCoalescedFrameSize(10) + GetCoalescedFrameSize(200));
+
+        // A frame that does not fit is refused and leaves the offset alone.
+        RF_TEST_CHECK(!AppendCoalescedFrame(buffer, sizeof(buffer), offset, 3, second.data(), 200));
+        RF_TEST_CHECK(offset == GetCoalescedFrameSize(10) + GetCoalescedFrameSize(200));
+
+        CoalescedFrameReader reader(buffer, offset);
+        uint8_t payloadType = 0;
+        const uint8_t* message = nullptr;
+        uint32_t messageSize = 0;
+        RF_TEST_CHECK(reader.Next(payloadType, message, messageSize));
+        RF_TEST_CHECK(payloadType == 7 && messageSize == 10 && std::vector<uint8_t>(message, message + messageSize) == first);
+        RF_TEST_CHECK(reader.Next(payloadType, message, messageSize));
+        RF_TEST_CHECK(payloadType == 9 && messageSize == 200 && std::vector<uint8_t>(message, message + messageSize) == second);
+        RF_TEST_CHECK(!reader.Next(payloadType, message, messageSize) && reader.AtEnd());
+        RF_TEST_CHECK(ValidateCoalescedPayload(buffer, offset));
+    }
+
+    void TestMalformedFramingIsRejected() {
+        uint8_t buffer[64];
+        uint32_t offset = 0;
+        const std::vector<uint8_t> bytes = MakeBytes(20, 3);
+        RF_TEST_CHECK(AppendCoalescedFrame(buffer, sizeof(buffer), offset, 1, bytes.data(), 20));
+
+        RF_TEST_CHECK(!ValidateCoalescedPayload(buffer, offset - 1));  // Last frame cut short
+        RF_TEST_CHECK(!ValidateCoalescedPayload(buffer, offset + 1));  // Trailing byte
+        RF_TEST_CHECK(!ValidateCoalescedPayload(buffer, 0));
+        RF_TEST_CHECK(!ValidateCoalescedPayload(nullptr, offset));
+
+        uint32_t emptyOffset = 0;
+        RF_TEST_CHECK(AppendCoalescedFrame(buffer, sizeof(buffer), emptyOffset, 1, nullptr, 0));
+        RF_TEST_CHECK(!ValidateCoalescedPayload(buffer, emptyOffset)); // Empty frames are not messages
+    }
+
+    void TestStagedMessagesRoundTripInFewerDatagrams() {
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        PacketBufferPool pool;
+
+        std::vector<Message> staged;
+        for (uint32_t i = 0; i < 60; ++i) {
+            Message message{ static_cast<uint8_t>(1 + i % 5), MakeBytes(20 + (i * 37) % 90, static_cast<uint8_t>(i)) };
+            bool needsAssembly = false;
+            RF_TEST_CHECK(StageOutgoingMessage(sender, pool.CopyFrom(message.bytes.data(), static_cast<uint32_t>(message.bytes.size())),
+                message.payloadType, DeliveryChannel::Reliable, &needsAssembly));
+            RF_TEST_CHECK(needsAssembly == (i == 0)); // Only the first message puts the connection on the list
+            staged.push_back(std::move(message));
+        }
+
+        std::vector<OutgoingPacket> packets;
+        RF_TEST_CHECK(!BuildCoalescedPackets(sender, pool, Clock::now(), packets));
+        uint32_t stagedBytes = 0;
+        for (const Message& message : staged) stagedBytes += GetCoalescedFrameSize(static_cast<uint32_t>(message.bytes.size()));
+        const size_t fewestDatagrams = (stagedBytes + GetCoalescedPayloadMaxSize() - 1) / GetCoalescedPayloadMaxSize();
+        RF_TEST_CHECK(packets.size() >= fewestDatagrams && packets.size() <= fewestDatagrams + 1);
+
+        std::vector<Message> received;
+        for (const OutgoingPacket& packet : packets) {
+            RF_TEST_CHECK(packet.valid && packet.TotalSize() <= COALESCED_DATAGRAM_MAX_SIZE);
+            RF_TEST_CHECK(HasFlag(packet.header.flags, GamePacketFlag::IS_COALESCED));
+            RF_TEST_CHECK(HasFlag(packet.header.flags, GamePacketFlag::IS_RELIABLE));
+            RF_TEST_CHECK(DeliverMessages(receiver, packet, 0, received));
+        }
+        RF_TEST_CHECK(received == staged);
+
+        // Every datagram was one reliable packet, acknowledged as one.
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == packets.size());
+        std::vector<OutgoingPacket> acks;
+        TrySendAckOnlyPacket(receiver, pool, Clock::now() + std::chrono::seconds(1), [&](const OutgoingPacket& ack) { acks.push_back(ack); });
+        for (const OutgoingPacket& ack : acks) {
+            ProcessIncomingPacketHeader(sender, ack.header, nullptr, 0, nullptr, nullptr);
+        }
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Empty());
+    }
+
+    void TestLoneMessageIsSentUnframed() {
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        PacketBufferPool pool;
+        const std::vector<uint8_t> bytes = MakeBytes(48, 5);
+        const PacketBufferRef payload = pool.CopyFrom(bytes.data(), static_cast<uint32_t>(bytes.size()));
+        bool needsAssembly = false;
+        RF_TEST_CHECK(StageOutgoingMessage(sender, payload, 4, DeliveryChannel::Unreliable, &needsAssembly));
+
+        std::vector<OutgoingPacket> packets;
+        RF_TEST_CHECK(!BuildCoalescedPackets(sender, pool, Clock::now(), packets));
+        RF_TEST_CHECK(packets.size() == 1);
+        if (packets.size() != 1) return;
+        RF_TEST_CHECK(!HasFlag(packets[0].header.flags, GamePacketFlag::IS_COALESCED));
+        RF_TEST_CHECK(packets[0].payload.Data() == payload.Data()); // Its own buffer, not a copy
+
+        std::vector<Message> received;
+        RF_TEST_CHECK(DeliverMessages(receiver, packets[0], 4, received));
+        RF_TEST_CHECK((received == std::vector<Message>{ Message{ 4, bytes } }));
+    }
+
+    void TestChannelsAreNotMixed() {
+        ReliableConnectionState sender;
+        PacketBufferPool pool;
+        const std::vector<uint8_t> bytes = MakeBytes(30, 6);
+        bool needsAssembly = false;
+        for (int i = 0; i < 3; ++i) {
+            RF_TEST_CHECK(StageOutgoingMessage(sender, pool.CopyFrom(bytes.data(), 30), 1, DeliveryChannel::Reliable, &needsAssembly));
+            RF_TEST_CHECK(StageOutgoingMessage(sender, pool.CopyFrom(bytes.data(), 30), 2, DeliveryChannel::EntityState, &needsAssembly));
+        }
+
+        std::vector<OutgoingPacket> packets;
+        RF_TEST_CHECK(!BuildCoalescedPackets(sender, pool, Clock::now(), packets));
+        RF_TEST_CHECK(packets.size() == 2);
+        if (packets.size() != 2) return;
+        RF_TEST_CHECK(packets[0].header.channelId == static_cast<uint8_t>(DeliveryChannel::Reliable));
+        RF_TEST_CHECK(packets[1].header.channelId == static_cast<uint8_t>(DeliveryChannel::EntityState));
+        RF_TEST_CHECK(HasFlag(packets[0].header.flags, GamePacketFlag::IS_RELIABLE));
+        RF_TEST_CHECK(!HasFlag(packets[1].header.flags, GamePacketFlag::IS_RELIABLE));
+    }
+
+    void TestMalformedCoalescedPacketTouchesNothing() {
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        PacketBufferPool pool;
+        bool needsAssembly = false;
+        for (int i = 0; i < 2; ++i) {
+            const std::vector<uint8_t> bytes = MakeBytes(30, static_cast<uint8_t>(i));
+            RF_TEST_CHECK(StageOutgoingMessage(sender, pool.CopyFrom(bytes.data(), 30), 1, DeliveryChannel::Reliable, &needsAssembly));
+        }
+        std::vector<OutgoingPacket> packets;
+        BuildCoalescedPackets(sender, pool, Clock::now(), packets);
+        RF_TEST_CHECK(packets.size() == 1);
+        if (packets.size() != 1) return;
+
+        // The same header with its last byte cut off: framing no longer adds up.
+        const uint8_t* payload = nullptr;
+        uint32_t payloadSize = 0;
+        RF_TEST_CHECK(!ProcessIncomingPacketHeader(receiver, packets[0].header, packets[0].payload.Data(),
+            static_cast<uint16_t>(packets[0].payload.Size() - 1), &payload, &payloadSize));
+        RF_TEST_CHECK(receiver.highestReceivedSequenceNumberFromRemote == 0 && !receiver.hasPendingAckToSend);
+
+        // The intact packet is still new to the receiver.
+        std::vector<Message> received;
+        RF_TEST_CHECK(DeliverMessages(receiver, packets[0], 0, received));
+        RF_TEST_CHECK(received.size() == 2);
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Frames read back in order", TestFramesReadBackInOrder);
+    RunTest("Malformed framing is rejected", TestMalformedFramingIsRejected);
+    RunTest("Staged messages round-trip in fewer datagrams", TestStagedMessagesRoundTripInFewerDatagrams);
+    RunTest("A lone message is sent unframed", TestLoneMessageIsSentUnframed);
+    RunTest("Channels are not mixed in one datagram", TestChannelsAreNotMixed);
+    RunTest("A malformed coalesced packet touches nothing", TestMalformedCoalescedPacketTouchesNothing);
+    return RiftForged::Tests::TestExitCode();
+}
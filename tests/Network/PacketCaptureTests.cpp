@@ -0,0 +1,250 @@
+﻿// File: PacketCaptureTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Capture -> replay round trips. Datagrams written by PacketCaptureWriter, directly
+// or from a live ConnectionManager over LoopbackNetworkIO, must come back out of
+// PacketCaptureReplayer with the same senders, bytes and order. Also covers the file format edges:
+// a record cut short by a crash, a file that is not a capture, and version 1 captures.
+
+#include "TestSupport.h"
+#include "PacketCapture.h"
+#include "LoopbackNetworkIO.h"
+#include "ConnectionManager.h"
+
+#include <cstdio>      // For std::remove
+#include <filesystem>  // For std::filesystem::temp_directory_path
+#include <fstream>     // For std::ofstream
+#include <memory>      // For std::make_shared
+#include <string>      // For std::string
+#include <vector>      // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    struct Datagram {
+        NetworkEndpoint sender;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::string CapturePath(const char* name) {
+        return (std::filesystem::temp_directory_path() / (std::string("rf_capture_") + name + ".rfpc")).string();
+    }
+
+    std::vector<uint8_t> MakePayload(uint32_t size, uint8_t seed) {
+        std::vector<uint8_t> payload(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<uint8_t>(seed + i * 7);
+        }
+        return payload;
+    }
+
+    // Keeps every replayed datagram and the size of every batch it arrived in.
+    class RecordingSink : public INetworkIOEvents {
+    public:
+        void OnRawDataReceived(const NetworkEndpoint& sender, const uint8_t* data, uint32_t size, OverlappedIOContext* context) override {
+            if (context != nullptr) ++nonNullContexts;
+            received.push_back(Datagram{ sender, std::vector<uint8_t>(data, data + size) });
+        }
+        void OnRawDataBatchReceived(std::span<const ReceivedDatagram> datagrams) override {
+            batchSizes.push_back(datagrams.size());
+            INetworkIOEvents::OnRawDataBatchReceived(datagrams);
+        }
+        void OnSendCompleted(OverlappedIOContext*, bool, uint32_t) override {}
+        void OnNetworkError(const std::string&, int) override {}
+
+        std::vector<Datagram> received;
+        std::vector<size_t> batchSizes;
+        size_t nonNullContexts = 0;
+    };
+
+    bool SameDatagrams(const std::vector<Datagram>& a, const std::vector<Datagram>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (!(a[i].sender == b[i].sender) || a[i].bytes != b[i].bytes) return false;
+        }
+        return true;
+    }
+
+    // A server that only has to exist: capture happens before any datagram is processed.
+    class IdleServer : public ConnectionManager {
+    public:
+        explicit IdleServer(INetworkIO* networkIO)
+            : ConnectionManager(networkIO) {}
+
+        ~IdleServer() override {
+            Stop();
+        }
+
+    protected:
+        void DispatchApplicationPayload(const NetworkEndpoint&, ConnectionSession&, const uint8_t*, uint32_t, bool) override {}
+    };
+
+    void TestWrittenDatagramsReplayUnchanged() {
+        const std::string path = CapturePath("roundtrip");
+        const std::vector<Datagram> written = {
+            { NetworkEndpoint("10.0.0.1", 5000), MakePayload(64, 1) },
+            { NetworkEndpoint("2001:db8::17", 6000), MakePayload(1, 2) },
+            { NetworkEndpoint("10.0.0.2", 5001), MakePayload(0, 3) },
+            { NetworkEndpoint("192.168.1.9", 65535), MakePayload(1400, 4) },
+            { NetworkEndpoint("::1", 7000), MakePayload(300, 5) },
+        };
+
+        PacketCaptureWriter writer;
+        RF_TEST_CHECK(writer.Open(path));
+        // The first two one at a time, the rest as one receive batch.
+        writer.Record(written[0].sender, written[0].bytes.data(), static_cast<uint32_t>(written[0].bytes.size()));
+        writer.Record(written[1].sender, written[1].bytes.data(), static_cast<uint32_t>(written[1].bytes.size()));
+        std::vector<ReceivedDatagram> batch;
+        for (size_t i = 2; i < written.size(); ++i) {
+            ReceivedDatagram datagram;
+            datagram.sender = written[i].sender;
+            datagram.data = written[i].bytes.data();
+            datagram.size = static_cast<uint32_t>(written[i].bytes.size());
+            batch.push_back(datagram);
+        }
+        writer.RecordBatch(batch);
+        RF_TEST_CHECK(writer.GetRecordCount() == written.size());
+        writer.Close();
+
+        PacketCaptureReplayer replayer;
+        RF_TEST_CHECK(replayer.Load(path));
+        RF_TEST_CHECK(replayer.GetRecordCount() == written.size());
+        RF_TEST_CHECK(replayer.FormatRecord(0).find("10.0.0.1:5000") != std::string::npos);
+        RF_TEST_CHECK(replayer.FormatRecord(0).find("64 bytes") != std::string::npos);
+
+        RecordingSink sink;
+        RF_TEST_CHECK(replayer.Replay(&sink, PacketReplayMode::AsFastAsPossible, 2) == written.size());
+        RF_TEST_CHECK(SameDatagrams(sink.received, written));
+        RF_TEST_CHECK(sink.nonNullContexts == 0);
+        RF_TEST_CHECK((sink.batchSizes == std::vector<size_t>{ 2, 2, 1 }));
+
+        // Recorded speed keeps the datagrams; only their spacing changes.
+        RecordingSink pacedSink;
+        RF_TEST_CHECK(replayer.Replay(&pacedSink, PacketReplayMode::RecordedSpeed) == written.size());
+        RF_TEST_CHECK(SameDatagrams(pacedSink.received, written));
+
+        std::remove(path.c_str());
+    }
+
+    void TestLiveServerTrafficReplaysUnchanged() {
+        const std::string path = CapturePath("live");
+        auto hub = std::make_shared<LoopbackNetworkHub>();
+        LoopbackNetworkIO serverIO(hub, LoopbackDeliveryMode::Manual);
+        IdleServer server(&serverIO);
+        RecordingSink clientSink;
+        LoopbackNetworkIO clientIO(hub, LoopbackDeliveryMode::Manual);
+        RF_TEST_CHECK(serverIO.Init("127.0.0.1", 7777, &server) && serverIO.Start());
+        RF_TEST_CHECK(server.Start());
+        RF_TEST_CHECK(clientIO.Init("10.0.0.5", 5000, &clientSink) && clientIO.Start());
+
+        PacketCaptureWriter writer;
+        RF_TEST_CHECK(writer.Open(path));
+        server.SetPacketCaptureWriter(&writer);
+
+        // Join requests, junk and packets for sessions that do not exist: capture takes them all,
+        // before the server decides what to do with them.
+        const NetworkEndpoint serverEndpoint("127.0.0.1", 7777);
+        std::vector<Datagram> sent;
+        for (uint32_t i = 0; i < 40; ++i) {
+            Datagram datagram{ clientIO.GetLocalEndpoint(), MakePayload(8 + i * 13, static_cast<uint8_t>(i)) };
+            clientIO.SendData(serverEndpoint, datagram.bytes.data(), static_cast<uint32_t>(datagram.bytes.size()));
+            sent.push_back(std::move(datagram));
+        }
+        while (serverIO.Poll() > 0) {}
+        server.SetPacketCaptureWriter(nullptr);
+        writer.Close();
+
+        PacketCaptureReplayer replayer;
+        RF_TEST_CHECK(replayer.Load(path));
+        RecordingSink sink;
+        RF_TEST_CHECK(replayer.Replay(&sink, PacketReplayMode::AsFastAsPossible) == sent.size());
+        RF_TEST_CHECK(SameDatagrams(sink.received, sent));
+
+        clientIO.Stop();
+        server.Stop();
+        serverIO.Stop();
+        std::remove(path.c_str());
+    }
+
+    void TestTruncatedRecordIsIgnored() {
+        const std::string path = CapturePath("truncated");
+        const std::vector<uint8_t> payload = MakePayload(100, 9);
+        PacketCaptureWriter writer;
+        RF_TEST_CHECK(writer.Open(path));
+        for (int i = 0; i < 3; ++i) {
+            writer.Record(NetworkEndpoint("10.0.0.1", 5000), payload.data(), static_cast<uint32_t>(payload.size()));
+        }
+        writer.Close();
+
+        // Half a record header, as a crash mid-write would leave it.
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::app);
+            const uint8_t partial[6] = { 1, 2, 3, 4, 5, 6 };
+            file.write(reinterpret_cast<const char*>(partial), sizeof(partial));
+        }
+
+        PacketCaptureReplayer replayer;
+        RF_TEST_CHECK(replayer.Load(path));
+        RF_TEST_CHECK(replayer.GetRecordCount() == 3);
+        std::remove(path.c_str());
+    }
+
+    void TestNonCaptureFileIsRejected() {
+        const std::string path = CapturePath("garbage");
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << "this is not a packet capture at all";
+        }
+        PacketCaptureReplayer replayer;
+        RF_TEST_CHECK(!replayer.Load(path));
+        RF_TEST_CHECK(!replayer.Load(CapturePath("missing")));
+        std::remove(path.c_str());
+    }
+
+    void TestVersionOneCaptureIsReadable() {
+        const std::string path = CapturePath("v1");
+        {
+            // Header, then one record with the sender as text: u64 offset | u16 port | u8 length | ip | u32 size | payload.
+            std::vector<uint8_t> bytes;
+            auto put = [&bytes](uint64_t value, int width) {
+                for (int i = 0; i < width; ++i) bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+            };
+            put(PACKET_CAPTURE_MAGIC, 4);
+            put(1, 2);
+            put(0, 2);
+            put(0, 8);
+            const std::string ip = "10.1.2.3";
+            put(1000, 8);
+            put(4242, 2);
+            put(ip.size(), 1);
+            bytes.insert(bytes.end(), ip.begin(), ip.end());
+            put(3, 4);
+            bytes.insert(bytes.end(), { 0xAA, 0xBB, 0xCC });
+            std::ofstream file(path, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        PacketCaptureReplayer replayer;
+        RF_TEST_CHECK(replayer.Load(path));
+        RecordingSink sink;
+        RF_TEST_CHECK(replayer.Replay(&sink, PacketReplayMode::AsFastAsPossible) == 1);
+        RF_TEST_CHECK(sink.received.size() == 1);
+        if (sink.received.size() == 1) {
+            RF_TEST_CHECK(sink.received[0].sender == NetworkEndpoint("10.1.2.3", 4242));
+            RF_TEST_CHECK((sink.received[0].bytes == std::vector<uint8_t>{ 0xAA, 0xBB, 0xCC }));
+        }
+        std::remove(path.c_str());
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Written datagrams replay with the same senders, bytes and order", TestWrittenDatagramsReplayUnchanged);
+    RunTest("Traffic captured from a live server replays unchanged", TestLiveServerTrafficReplaysUnchanged);
+    RunTest("A record cut short by a crash is ignored on load", TestTruncatedRecordIsIgnored);
+    RunTest("A file that is not a capture is rejected", TestNonCaptureFileIsRejected);
+    RunTest("Version 1 captures are still readable", TestVersionOneCaptureIsReadable);
+    return RiftForged::Tests::TestExitCode();
+}
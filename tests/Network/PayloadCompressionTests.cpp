@@ -0,0 +1,235 @@
+﻿// File: PayloadCompressionTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of PayloadCompressor and of compressed datagrams between two connection
+// states: payloads round-trip, small and random ones are sent raw, corrupt, truncated and
+// oversized frames are refused and counted, the CPU budget falls back to raw payloads, and a
+// connection that did not negotiate compression drops a compressed datagram. Built without zstd,
+// only the unavailable path is checked.
+
+#include "TestSupport.h"
+#include "PayloadCompression.h"
+#include "UDPReliabilityProtocol.h"
+
+#include <chrono>   // For std::chrono::steady_clock
+#include <cstdio>   // For std::printf
+#include <random>   // For std::mt19937
+#include <vector>   // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Repetitive, like a run of entity snapshots: compresses well.
+    std::vector<uint8_t> MakeCompressible(uint32_t size) {
+        std::vector<uint8_t> bytes(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            bytes[i] = static_cast<uint8_t>((i % 24) < 8 ? i / 24 : i % 7);
+        }
+        return bytes;
+    }
+
+    std::vector<uint8_t> MakeRandom(uint32_t size, uint32_t seed) {
+        std::mt19937 random(seed);
+        std::vector<uint8_t> bytes(size);
+        for (uint8_t& byte : bytes) byte = static_cast<uint8_t>(random());
+        return bytes;
+    }
+
+    bool Decompresses(PayloadCompressor& compressor, const std::vector<uint8_t>& frame, std::vector<uint8_t>& out_bytes) {
+        const uint8_t* data = nullptr;
+        uint32_t size = 0;
+        if (!compressor.Decompress(frame.data(), static_cast<uint32_t>(frame.size()), &data, &size)) {
+            return false;
+        }
+        out_bytes.assign(data, data + size);
+        return true;
+    }
+
+    void TestRoundTrip() {
+        PayloadCompressor compressor;
+        PacketBufferPool pool;
+        for (uint32_t size : { PAYLOAD_COMPRESSION_MIN_SIZE, 500u, 1200u, 20000u }) {
+            const std::vector<uint8_t> bytes = MakeCompressible(size);
+            PacketBufferRef frame;
+            RF_TEST_CHECK(compressor.Compress(bytes.data(), size, pool, frame) == CompressResult::Compressed);
+            RF_TEST_CHECK(frame && frame.Size() < size);
+            if (!frame) continue;
+
+            std::vector<uint8_t> decompressed;
+            RF_TEST_CHECK(Decompresses(compressor, std::vector<uint8_t>(frame.Data(), frame.Data() + frame.Size()), decompressed));
+            RF_TEST_CHECK(decompressed == bytes);
+        }
+        const CompressionStats stats = compressor.GetStats();
+        RF_TEST_CHECK(stats.packetsCompressed == 4 && stats.packetsDecompressed == 4);
+        RF_TEST_CHECK(stats.bytesAfterCompression < stats.bytesBeforeCompression);
+        RF_TEST_CHECK(stats.decompressionFailures == 0);
+    }
+
+    void TestSmallAndRandomPayloadsAreSentRaw() {
+        PayloadCompressor compressor;
+        PacketBufferPool pool;
+        PacketBufferRef frame;
+        const std::vector<uint8_t> small = MakeCompressible(PAYLOAD_COMPRESSION_MIN_SIZE - 1);
+        RF_TEST_CHECK(compressor.Compress(small.data(), static_cast<uint32_t>(small.size()), pool, frame) == CompressResult::TooSmall);
+        RF_TEST_CHECK(compressor.Compress(nullptr, 500, pool, frame) == CompressResult::TooSmall);
+
+        // Random bytes do not shrink, so the frame is refused rather than sent larger.
+        const std::vector<uint8_t> random = MakeRandom(1200, 7);
+        RF_TEST_CHECK(compressor.Compress(random.data(), static_cast<uint32_t>(random.size()), pool, frame) == CompressResult::Incompressible);
+        RF_TEST_CHECK(!frame);
+        RF_TEST_CHECK(compressor.GetStats().packetsIncompressible == 1);
+        RF_TEST_CHECK(compressor.GetStats().packetsCompressed == 0);
+    }
+
+    void TestBadFramesAreRefusedAndCounted() {
+        PayloadCompressor compressor;
+        PacketBufferPool pool;
+        const std::vector<uint8_t> bytes = MakeCompressible(1200);
+        PacketBufferRef frame;
+        RF_TEST_CHECK(compressor.Compress(bytes.data(), static_cast<uint32_t>(bytes.size()), pool, frame) == CompressResult::Compressed);
+        if (!frame) return;
+        const std::vector<uint8_t> good(frame.Data(), frame.Data() + frame.Size());
+        std::vector<uint8_t> decompressed;
+
+        std::vector<uint8_t> truncated(good.begin(), good.begin() + good.size() / 2);
+        RF_TEST_CHECK(!Decompresses(compressor, truncated, decompressed));
+
+        std::vector<uint8_t> badMagic = good;
+        badMagic[0] ^= 0xFF;
+        RF_TEST_CHECK(!Decompresses(compressor, badMagic, decompressed));
+
+        RF_TEST_CHECK(!Decompresses(compressor, MakeRandom(300, 11), decompressed));
+        RF_TEST_CHECK(!Decompresses(compressor, std::vector<uint8_t>(1, 0), decompressed));
+
+        // A valid frame that expands past the largest payload a datagram can carry.
+        const std::vector<uint8_t> oversized = MakeCompressible(PAYLOAD_COMPRESSION_MAX_DECOMPRESSED_SIZE + 1000);
+        PacketBufferRef oversizedFrame;
+        RF_TEST_CHECK(compressor.Compress(oversized.data(), static_cast<uint32_t>(oversized.size()), pool, oversizedFrame) == CompressResult::Compressed);
+        if (oversizedFrame) {
+            RF_TEST_CHECK(!Decompresses(compressor, std::vector<uint8_t>(oversizedFrame.Data(), oversizedFrame.Data() + oversizedFrame.Size()), decompressed));
+        }
+
+        RF_TEST_CHECK(compressor.GetStats().decompressionFailures == 5);
+        RF_TEST_CHECK(compressor.GetStats().packetsDecompressed == 0);
+        // The failures left the thread's context usable.
+        RF_TEST_CHECK(Decompresses(compressor, good, decompressed) && decompressed == bytes);
+    }
+
+    void TestBudgetFallsBackToRaw() {
+        PayloadCompressor compressor;
+        PacketBufferPool pool;
+        const std::vector<uint8_t> bytes = MakeCompressible(20000);
+        PacketBufferRef frame;
+
+        // One microsecond a second is spent by the first payload; the rest of the second goes raw.
+        compressor.SetCpuBudget(1);
+        RF_TEST_CHECK(compressor.Compress(bytes.data(), static_cast<uint32_t>(bytes.size()), pool, frame) == CompressResult::Compressed);
+        frame = PacketBufferRef();
+        RF_TEST_CHECK(compressor.Compress(bytes.data(), static_cast<uint32_t>(bytes.size()), pool, frame) == CompressResult::OverBudget);
+        RF_TEST_CHECK(!frame);
+        RF_TEST_CHECK(compressor.GetStats().packetsSkippedForBudget == 1);
+
+        // A zero budget turns compression off; decompression still works.
+        compressor.SetCpuBudget(0);
+        RF_TEST_CHECK(compressor.Compress(bytes.data(), static_cast<uint32_t>(bytes.size()), pool, frame) == CompressResult::Unavailable);
+        RF_TEST_CHECK(!compressor.IsAvailable());
+    }
+
+    // Stages one message on 'sender' and returns the datagram it went out in.
+    bool SendOne(ReliableConnectionState& sender, PacketBufferPool& pool, const std::vector<uint8_t>& bytes, OutgoingPacket& out_packet) {
+        bool needsAssembly = false;
+        if (!StageOutgoingMessage(sender, pool.CopyFrom(bytes.data(), static_cast<uint32_t>(bytes.size())), 4, DeliveryChannel::Unreliable, &needsAssembly)) {
+            return false;
+        }
+        std::vector<OutgoingPacket> packets;
+        BuildCoalescedPackets(sender, pool, Clock::now(), packets);
+        if (packets.size() != 1) return false;
+        out_packet = packets[0];
+        return true;
+    }
+
+    void TestCompressedDatagramsBetweenConnections() {
+        PayloadCompressor compressor;
+        PacketBufferPool pool;
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        sender.payloadCompressor = &compressor;
+        receiver.payloadCompressor = &compressor;
+        sender.SetCapabilities(CONNECTION_CAPABILITY_COMPRESSION);
+        receiver.SetCapabilities(CONNECTION_CAPABILITY_COMPRESSION);
+
+        const std::vector<uint8_t> bytes = MakeCompressible(900);
+        OutgoingPacket packet;
+        RF_TEST_CHECK(SendOne(sender, pool, bytes, packet));
+        RF_TEST_CHECK(packet.header.payloadEncoding == static_cast<uint8_t>(PayloadEncoding::Zstd));
+        RF_TEST_CHECK(packet.payload.Size() < bytes.size());
+
+        const uint8_t* payload = nullptr;
+        uint32_t payloadSize = 0;
+        RF_TEST_CHECK(ProcessIncomingPacketHeader(receiver, packet.header, packet.payload.Data(),
+            static_cast<uint16_t>(packet.payload.Size()), &payload, &payloadSize));
+        RF_TEST_CHECK(payload && std::vector<uint8_t>(payload, payload + payloadSize) == bytes);
+        RF_TEST_CHECK(sender.GetCompressionStats().packetsCompressed == 1);
+        RF_TEST_CHECK(receiver.GetCompressionStats().packetsDecompressed == 1);
+
+        // Random bytes go out raw on the same connection.
+        const std::vector<uint8_t> random = MakeRandom(900, 3);
+        RF_TEST_CHECK(SendOne(sender, pool, random, packet));
+        RF_TEST_CHECK(packet.header.payloadEncoding == static_cast<uint8_t>(PayloadEncoding::Raw));
+        RF_TEST_CHECK(sender.GetCompressionStats().packetsIncompressible == 1);
+
+        // A peer that did not negotiate compression drops the datagram and counts it.
+        ReliableConnectionState plainReceiver;
+        plainReceiver.payloadCompressor = &compressor;
+        RF_TEST_CHECK(SendOne(sender, pool, bytes, packet));
+        RF_TEST_CHECK(!ProcessIncomingPacketHeader(plainReceiver, packet.header, packet.payload.Data(),
+            static_cast<uint16_t>(packet.payload.Size()), &payload, &payloadSize));
+        RF_TEST_CHECK(plainReceiver.GetCompressionStats().decompressionFailures == 1);
+
+        // So does one that did, when the frame is corrupt.
+        std::vector<uint8_t> corrupt(packet.payload.Data(), packet.payload.Data() + packet.payload.Size());
+        corrupt[0] ^= 0xFF;
+        RF_TEST_CHECK(!ProcessIncomingPacketHeader(receiver, packet.header, corrupt.data(),
+            static_cast<uint16_t>(corrupt.size()), &payload, &payloadSize));
+        RF_TEST_CHECK(receiver.GetCompressionStats().decompressionFailures == 1);
+    }
+
+    void TestUnavailableCompressorSendsRaw() {
+        PayloadCompressor compressor;
+        compressor.SetCpuBudget(0);
+        PacketBufferPool pool;
+        ReliableConnectionState sender;
+        sender.payloadCompressor = &compressor;
+        sender.SetCapabilities(CONNECTION_CAPABILITY_COMPRESSION);
+
+        const std::vector<uint8_t> bytes = MakeCompressible(900);
+        OutgoingPacket packet;
+        RF_TEST_CHECK(SendOne(sender, pool, bytes, packet));
+        RF_TEST_CHECK(packet.header.payloadEncoding == static_cast<uint8_t>(PayloadEncoding::Raw));
+        RF_TEST_CHECK(packet.payload.Size() == bytes.size());
+
+        std::vector<uint8_t> decompressed;
+        if (!PayloadCompressor().IsAvailable()) {
+            RF_TEST_CHECK(!Decompresses(compressor, bytes, decompressed)); // Built without zstd
+        }
+    }
+
+} // namespace
+
+int main() {
+    RunTest("An unavailable compressor sends payloads raw", TestUnavailableCompressorSendsRaw);
+    if (!PayloadCompressor().IsAvailable()) {
+        std::printf("Built without zstd; skipping the compression tests.\n");
+        return RiftForged::Tests::TestExitCode();
+    }
+    RunTest("Payloads round-trip through a frame", TestRoundTrip);
+    RunTest("Small and random payloads are sent raw", TestSmallAndRandomPayloadsAreSentRaw);
+    RunTest("Corrupt, truncated and oversized frames are refused", TestBadFramesAreRefusedAndCounted);
+    RunTest("A spent CPU budget falls back to raw payloads", TestBudgetFallsBackToRaw);
+    RunTest("Compressed datagrams cross between connections", TestCompressedDatagramsBetweenConnections);
+    return RiftForged::Tests::TestExitCode();
+}
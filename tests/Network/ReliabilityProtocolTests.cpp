@@ -0,0 +1,444 @@
+﻿// File: ReliabilityProtocolTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of the join cookie, the rebind proof and of the reliability protocol between two connection
+// states: acknowledgement, RTO and fast retransmission, giving up after MAX_PACKET_RETRIES and
+// fragment reassembly. Packets are handed across directly, so loss and reordering are exact.
+
+#include "TestSupport.h"
+#include "HandshakeCookie.h"
+#include "UDPReliabilityProtocol.h"
+#include "FragmentReassembly.h"
+
+#include <algorithm> // For std::reverse
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstring>   // For std::memcmp
+#include <memory>    // For std::unique_ptr
+#include <new>       // For std::nothrow_t
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+    // While set, nothrow array allocations fail, as they would with memory exhausted.
+    bool g_failNothrowArrayAllocations = false;
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    if (g_failNothrowArrayAllocations) {
+        return nullptr;
+    }
+    try {
+        return ::operator new[](size);
+    }
+    catch (...) {
+        return nullptr;
+    }
+}
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Long enough for any RTO to expire, and past every ACK delay.
+    const auto RTO_EXPIRY = std::chrono::milliseconds(static_cast<int>(MAX_RTO_MS) + 1);
+
+    // Hands 'packet' to 'receiver' as if it had crossed the wire. Returns true if the protocol
+    // released an application payload; a reassembled message is copied out and released.
+    bool Deliver(ReliableConnectionState& receiver, const OutgoingPacket& packet, std::vector<uint8_t>* out_payload = nullptr) {
+        const uint8_t* payload = nullptr;
+        uint32_t payloadSize = 0;
+        if (!ProcessIncomingPacketHeader(receiver, packet.header, packet.payload.Data(),
+            static_cast<uint16_t>(packet.payload.Size()), &payload, &payloadSize)) {
+            return false;
+        }
+        if (out_payload) {
+            out_payload->assign(payload, payload + payloadSize);
+        }
+        if (HasFlag(packet.header.flags, GamePacketFlag::IS_FRAGMENT)) {
+            ReleaseReassembledMessage(receiver, payload);
+        }
+        return true;
+    }
+
+    // Sends the receiver's pending ACK back to the sender.
+    bool ReturnAck(ReliableConnectionState& receiver, ReliableConnectionState& sender, PacketBufferPool& pool, Clock::time_point now) {
+        std::vector<OutgoingPacket> acks;
+        TrySendAckOnlyPacket(receiver, pool, now, [&](const OutgoingPacket& ack) { acks.push_back(ack); });
+        for (const OutgoingPacket& ack : acks) {
+            Deliver(sender, ack);
+        }
+        return !acks.empty();
+    }
+
+    PacketBufferRef MakePayload(PacketBufferPool& pool, uint32_t size, uint8_t seed) {
+        PacketBufferRef payload = pool.Acquire(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            payload.MutableData()[i] = static_cast<uint8_t>(seed + i * 31);
+        }
+        return payload;
+    }
+
+    OutgoingPacket SendReliable(ReliableConnectionState& sender, const PacketBufferRef& payload) {
+        return PrepareOutgoingPacket(sender, payload, static_cast<uint8_t>(GamePacketFlag::IS_RELIABLE));
+    }
+
+    void TestCookieIsBoundToAddressAndLifetime() {
+        HandshakeCookieGenerator generator;
+        const Clock::time_point now = Clock::now();
+        const NetworkEndpoint client("10.0.0.1", 5000);
+        const HandshakeCookieGenerator::Cookie cookie = generator.Generate(client, now);
+
+        RF_TEST_CHECK(generator.Validate(client, cookie.data(), HANDSHAKE_COOKIE_SIZE, now));
+        RF_TEST_CHECK(!generator.Validate(NetworkEndpoint("10.0.0.1", 5001), cookie.data(), HANDSHAKE_COOKIE_SIZE, now));
+        RF_TEST_CHECK(!generator.Validate(NetworkEndpoint("10.0.0.2", 5000), cookie.data(), HANDSHAKE_COOKIE_SIZE, now));
+        RF_TEST_CHECK(!generator.Validate(client, cookie.data(), HANDSHAKE_COOKIE_SIZE - 1, now));
+        RF_TEST_CHECK(!generator.Validate(client, cookie.data(), HANDSHAKE_COOKIE_SIZE,
+            now + std::chrono::seconds(HANDSHAKE_COOKIE_LIFETIME_SECONDS + 1)));
+
+        HandshakeCookieGenerator::Cookie tampered = cookie;
+        tampered[HANDSHAKE_COOKIE_SIZE - 1] ^= 0x01;
+        RF_TEST_CHECK(!generator.Validate(client, tampered.data(), HANDSHAKE_COOKIE_SIZE, now));
+
+        HandshakeCookieGenerator otherServer; // Different key
+        RF_TEST_CHECK(!otherServer.Validate(client, cookie.data(), HANDSHAKE_COOKIE_SIZE, now));
+    }
+
+    void TestRebindProofIsBoundToSessionAddressAndCookie() {
+        HandshakeCookieGenerator generator;
+        const Clock::time_point now = Clock::now();
+        const NetworkEndpoint newAddress("10.0.0.2", 6000);
+        const HandshakeCookieGenerator::Cookie cookie = generator.Generate(newAddress, now);
+        const SessionSecret secret = GenerateSessionSecret();
+        const uint32_t connectionId = 0x12340005;
+        const SessionRebindProof proof = ComputeSessionRebindProof(secret, connectionId, newAddress, cookie.data());
+
+        RF_TEST_CHECK(ValidateSessionRebindProof(secret, connectionId, newAddress, cookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE));
+        RF_TEST_CHECK(!ValidateSessionRebindProof(secret, connectionId, newAddress, cookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE - 1));
+        RF_TEST_CHECK(!ValidateSessionRebindProof(secret, connectionId + 1, newAddress, cookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE));
+        RF_TEST_CHECK(!ValidateSessionRebindProof(secret, connectionId, NetworkEndpoint("10.0.0.2", 6001), cookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE));
+        RF_TEST_CHECK(!ValidateSessionRebindProof(GenerateSessionSecret(), connectionId, newAddress, cookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE));
+
+        HandshakeCookieGenerator::Cookie otherCookie = cookie;
+        otherCookie[0] ^= 0x01;
+        RF_TEST_CHECK(!ValidateSessionRebindProof(secret, connectionId, newAddress, otherCookie.data(), proof.data(), SESSION_REBIND_PROOF_SIZE));
+
+        // The challenge's observed address reads back as the same endpoint, for both families.
+        for (const NetworkEndpoint& endpoint : { newAddress, NetworkEndpoint("2001:db8::7", 443) }) {
+            uint8_t observed[HANDSHAKE_OBSERVED_ENDPOINT_SIZE];
+            WriteObservedEndpoint(endpoint, observed);
+            NetworkEndpoint decoded;
+            RF_TEST_CHECK(ReadObservedEndpoint(observed, sizeof(observed), decoded) && decoded == endpoint);
+            RF_TEST_CHECK(!ReadObservedEndpoint(observed, sizeof(observed) - 1, decoded));
+        }
+    }
+
+    void TestAckClearsDeliveredPacketsOnly() {
+        ReliableConnectionState sender, receiver;
+        PacketBufferPool pool;
+        const PacketBufferRef payload = MakePayload(pool, 64, 1);
+
+        for (int i = 0; i < 16; ++i) {
+            const OutgoingPacket packet = SendReliable(sender, payload);
+            RF_TEST_CHECK(packet.valid);
+            if (i % 2 == 0) {
+                std::vector<uint8_t> received;
+                RF_TEST_CHECK(Deliver(receiver, packet, &received));
+                RF_TEST_CHECK(received.size() == payload.Size() && std::memcmp(received.data(), payload.Data(), received.size()) == 0);
+            }
+        }
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == 16);
+
+        RF_TEST_CHECK(ReturnAck(receiver, sender, pool, Clock::now() + RTO_EXPIRY));
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == 8);
+        sender.unacknowledgedSentPackets.ForEach([](const SentPacketInfo& info) {
+            RF_TEST_CHECK(info.sequenceNumber % 2 == 0); // Sequences start at 1, so the odd ones arrived.
+        });
+    }
+
+    void TestDuplicateIsNotDeliveredTwice() {
+        ReliableConnectionState sender, receiver;
+        PacketBufferPool pool;
+        const OutgoingPacket packet = SendReliable(sender, MakePayload(pool, 32, 2));
+        RF_TEST_CHECK(Deliver(receiver, packet));
+        RF_TEST_CHECK(!Deliver(receiver, packet));
+    }
+
+    void TestLostPacketIsRetransmittedAfterRto() {
+        ReliableConnectionState sender, receiver;
+        PacketBufferPool pool;
+        const PacketBufferRef payload = MakePayload(pool, 100, 3);
+
+        const OutgoingPacket first = SendReliable(sender, payload);
+        const OutgoingPacket lost = SendReliable(sender, payload);
+        const OutgoingPacket third = SendReliable(sender, payload);
+        const Clock::time_point sentAt = Clock::now();
+        RF_TEST_CHECK(Deliver(receiver, first));
+        RF_TEST_CHECK(Deliver(receiver, third));
+        RF_TEST_CHECK(ReturnAck(receiver, sender, pool, sentAt + RTO_EXPIRY));
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == 1);
+
+        RF_TEST_CHECK(GetPacketsForRetransmission(sender, sentAt).empty());
+
+        const std::vector<OutgoingPacket> resent = GetPacketsForRetransmission(sender, sentAt + RTO_EXPIRY);
+        RF_TEST_CHECK(resent.size() == 1);
+        if (resent.size() != 1) {
+            return;
+        }
+        RF_TEST_CHECK(resent[0].header.sequenceNumber == lost.header.sequenceNumber);
+        RF_TEST_CHECK(resent[0].payload.Data() == lost.payload.Data()); // Same buffer, not a copy
+        RF_TEST_CHECK(sender.GetRetransmitStats().timeoutRetransmits == 1);
+
+        RF_TEST_CHECK(Deliver(receiver, resent[0]));
+        RF_TEST_CHECK(ReturnAck(receiver, sender, pool, sentAt + RTO_EXPIRY * 2));
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Empty());
+    }
+
+    void TestLaterAcksTriggerFastRetransmit() {
+        ReliableConnectionState sender, receiver;
+        PacketBufferPool pool;
+        const PacketBufferRef payload = MakePayload(pool, 100, 4);
+
+        const OutgoingPacket lost = SendReliable(sender, payload);
+        for (uint32_t i = 0; i < FAST_RETRANSMIT_PACKET_THRESHOLD + 1; ++i) {
+            RF_TEST_CHECK(Deliver(receiver, SendReliable(sender, payload)));
+        }
+        const Clock::time_point now = Clock::now();
+        RF_TEST_CHECK(ReturnAck(receiver, sender, pool, now + RTO_EXPIRY));
+
+        const std::vector<OutgoingPacket> resent = GetPacketsForFastRetransmission(sender, now);
+        RF_TEST_CHECK(resent.size() == 1);
+        RF_TEST_CHECK(!resent.empty() && resent[0].header.sequenceNumber == lost.header.sequenceNumber);
+        RF_TEST_CHECK(sender.GetRetransmitStats().fastRetransmits == 1);
+        RF_TEST_CHECK(GetPacketsForFastRetransmission(sender, now).empty()); // At most once per packet
+    }
+
+    void TestRetransmitGivesUpAfterMaxRetries() {
+        ReliableConnectionState sender;
+        PacketBufferPool pool;
+        SendReliable(sender, MakePayload(pool, 10, 5));
+
+        Clock::time_point now = Clock::now();
+        size_t resends = 0;
+        for (int attempt = 0; attempt <= MAX_PACKET_RETRIES; ++attempt) {
+            now += RTO_EXPIRY;
+            resends += GetPacketsForRetransmission(sender, now).size();
+        }
+        RF_TEST_CHECK(resends == static_cast<size_t>(MAX_PACKET_RETRIES));
+        RF_TEST_CHECK(sender.connectionDroppedByMaxRetries);
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Empty());
+    }
+
+    void TestFragmentedMessageIsReassembled() {
+        ReliableConnectionState sender, receiver;
+        PacketBufferPool pool;
+        const PacketBufferRef message = MakePayload(pool, GetFragmentDataMaxSize() * 12 + 77, 6);
+        bool needsAssembly = false;
+        RF_TEST_CHECK(StageOutgoingMessage(sender, message, 1, DeliveryChannel::Reliable, &needsAssembly));
+
+        // Every other round loses the first datagram; the rest arrive in reverse order.
+        std::vector<std::vector<uint8_t>> delivered;
+        Clock::time_point now = Clock::now();
+        for (int round = 0; round < 64 && delivered.empty(); ++round) {
+            now += RTO_EXPIRY;
+            std::vector<OutgoingPacket> packets;
+            BuildCoalescedPackets(sender, pool, now, packets);
+            for (const OutgoingPacket& resend : GetPacketsForRetransmission(sender, now)) {
+                packets.push_back(resend);
+            }
+            std::reverse(packets.begin(), packets.end());
+            for (size_t i = (round % 2 == 0 && !packets.empty()) ? 1 : 0; i < packets.size(); ++i) {
+                RF_TEST_CHECK(HasFlag(packets[i].header.flags, GamePacketFlag::IS_FRAGMENT));
+                std::vector<uint8_t> payload;
+                if (Deliver(receiver, packets[i], &payload)) {
+                    delivered.push_back(std::move(payload));
+                }
+            }
+            ReturnAck(receiver, sender, pool, now + RTO_EXPIRY);
+        }
+
+        RF_TEST_CHECK(delivered.size() == 1);
+        RF_TEST_CHECK(!delivered.empty() && delivered[0].size() == message.Size() &&
+            std::memcmp(delivered[0].data(), message.Data(), message.Size()) == 0);
+    }
+
+    void TestMalformedFragmentsAreRejected() {
+        FragmentReassembler reassembler;
+        const Clock::time_point now = Clock::now();
+        std::vector<uint8_t> data(GetFragmentDataMaxSize());
+        const uint8_t* message = nullptr;
+        uint32_t messageSize = 0;
+
+        FragmentHeader tooSmall; // Two fragments cannot make a message one fragment could carry.
+        tooSmall.fragmentCount = 2;
+        tooSmall.messageSize = 100;
+        RF_TEST_CHECK(reassembler.Accept(tooSmall, data.data(), 100, now, &message, &messageSize) == FragmentAcceptResult::Rejected);
+
+        FragmentHeader wrongLength; // The last fragment must carry exactly the remaining bytes.
+        wrongLength.fragmentCount = 2;
+        wrongLength.fragmentIndex = 1;
+        wrongLength.messageSize = GetFragmentDataMaxSize() + 5;
+        RF_TEST_CHECK(reassembler.Accept(wrongLength, data.data(), 4, now, &message, &messageSize) == FragmentAcceptResult::Rejected);
+        RF_TEST_CHECK(reassembler.Accept(wrongLength, data.data(), 5, now, &message, &messageSize) == FragmentAcceptResult::Stored);
+
+        FragmentHeader outOfRange;
+        outOfRange.fragmentCount = 2;
+        outOfRange.fragmentIndex = 2;
+        outOfRange.messageSize = GetFragmentDataMaxSize() + 5;
+        RF_TEST_CHECK(reassembler.Accept(outOfRange, data.data(), 5, now, &message, &messageSize) == FragmentAcceptResult::Rejected);
+    }
+
+    void TestOrderedPacketIsNotAcknowledgedUntilItCanBeHeld() {
+        ReliableConnectionState sender;
+        ReliableConnectionState receiver;
+        PacketBufferPool pool;
+        const Clock::time_point now = Clock::now();
+        std::vector<OutgoingPacket> packets;
+        for (uint16_t i = 0; i < 5; ++i) {
+            OutgoingPacket packet = SendReliable(sender, MakePayload(pool, 32, static_cast<uint8_t>(i)));
+            packet.header.channelId = static_cast<uint8_t>(DeliveryChannel::GameplayEvents);
+            packet.header.channelSequence = i;
+            packets.push_back(packet);
+        }
+        auto samePayload = [&](const std::vector<uint8_t>& bytes, size_t index) {
+            return bytes.size() == packets[index].payload.Size() &&
+                std::memcmp(bytes.data(), packets[index].payload.Data(), bytes.size()) == 0;
+        };
+
+        // The third arrives first, when its reorder buffer cannot be allocated: it must stay
+        // unacknowledged so the sender retransmits it, rather than be lost with its turn.
+        g_failNothrowArrayAllocations = true;
+        RF_TEST_CHECK(!Deliver(receiver, packets[2]));
+        g_failNothrowArrayAllocations = false;
+        RF_TEST_CHECK(!ReturnAck(receiver, sender, pool, now + RTO_EXPIRY));
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Size() == packets.size());
+
+        std::vector<uint8_t> payload;
+        RF_TEST_CHECK(Deliver(receiver, packets[0], &payload) && samePayload(payload, 0));
+        RF_TEST_CHECK(Deliver(receiver, packets[1], &payload) && samePayload(payload, 1));
+        RF_TEST_CHECK(Deliver(receiver, packets[2], &payload) && samePayload(payload, 2)); // The retransmission
+
+        // With the buffer available an early packet is acknowledged and held for its turn.
+        RF_TEST_CHECK(!Deliver(receiver, packets[4]));
+        RF_TEST_CHECK(Deliver(receiver, packets[3], &payload) && samePayload(payload, 3));
+        bool coalesced = false;
+        RF_TEST_CHECK(PopOrderedMessage(receiver, DeliveryChannel::GameplayEvents, payload, coalesced) && samePayload(payload, 4));
+        RF_TEST_CHECK(!PopOrderedMessage(receiver, DeliveryChannel::GameplayEvents, payload, coalesced));
+
+        RF_TEST_CHECK(ReturnAck(receiver, sender, pool, now + RTO_EXPIRY));
+        RF_TEST_CHECK(sender.unacknowledgedSentPackets.Empty());
+    }
+
+    void TestReassemblyArenaIsHeldOnlyDuringReassembly() {
+        const uint64_t baseline = FragmentReassembler::GetTotalArenaBytes();
+        const Clock::time_point now = Clock::now();
+        std::vector<uint8_t> data(GetFragmentDataMaxSize());
+        const uint8_t* message = nullptr;
+        uint32_t messageSize = 0;
+        FragmentHeader header;
+        header.fragmentCount = 2;
+        header.messageSize = 2 * GetFragmentDataMaxSize();
+
+        FragmentReassembler reassembler;
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline); // Nothing until a fragment arrives
+        header.messageId = 1;
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Stored);
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline + REASSEMBLY_ARENA_SIZE);
+        header.fragmentIndex = 1;
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Completed);
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline + REASSEMBLY_ARENA_SIZE); // Still being dispatched
+        reassembler.Release(message);
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline);
+
+        // A message that times out gives its share back too.
+        header.messageId = 2;
+        header.fragmentIndex = 0;
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Stored);
+        header.messageId = 3;
+        const Clock::time_point later = now + std::chrono::seconds(REASSEMBLY_TIMEOUT_SECONDS + 1);
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), later, &message, &messageSize) == FragmentAcceptResult::Stored);
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline + REASSEMBLY_ARENA_SIZE);
+        reassembler.Clear();
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline);
+
+        // At the cap, connections mid-reassembly refuse new messages until one finishes.
+        const size_t arenasUnderCap = static_cast<size_t>((REASSEMBLY_TOTAL_MEMORY_CAP - baseline) / REASSEMBLY_ARENA_SIZE);
+        std::vector<std::unique_ptr<FragmentReassembler>> busy;
+        header.messageId = 4;
+        for (size_t i = 0; i < arenasUnderCap; ++i) {
+            busy.push_back(std::make_unique<FragmentReassembler>());
+            RF_TEST_CHECK(busy.back()->Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Stored);
+        }
+        const uint64_t refusals = FragmentReassembler::GetCapRefusalCount();
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Rejected);
+        RF_TEST_CHECK(FragmentReassembler::GetCapRefusalCount() == refusals + 1);
+        busy.back()->Clear();
+        RF_TEST_CHECK(reassembler.Accept(header, data.data(), GetFragmentDataMaxSize(), now, &message, &messageSize) == FragmentAcceptResult::Stored);
+        busy.clear();
+        reassembler.Clear();
+        RF_TEST_CHECK(FragmentReassembler::GetTotalArenaBytes() == baseline);
+    }
+
+    void TestSentPacketRingGrowsWithInFlightSpan() {
+        ReliableConnectionState state;
+        SentPacketRing& ring = state.unacknowledgedSentPackets;
+        RF_TEST_CHECK(ring.AllocatedSlots() == 0);
+        RF_TEST_CHECK(ring.Find(1) == nullptr);
+        RF_TEST_CHECK(!ring.Remove(1));
+
+        PacketBufferPool pool;
+        const PacketBufferRef payload = MakePayload(pool, 16, 1);
+        GamePacketHeader header;
+        RF_TEST_CHECK(ring.Insert(1, header, payload, false) != nullptr);
+        RF_TEST_CHECK(ring.AllocatedSlots() == SENT_PACKET_RING_INITIAL_CAPACITY);
+
+        // Acknowledged as fast as sent: the span never outgrows the first allocation.
+        for (SequenceNumber seq = 2; seq < 500; ++seq) {
+            RF_TEST_CHECK(ring.Insert(seq, header, payload, false) != nullptr);
+            RF_TEST_CHECK(ring.Remove(static_cast<SequenceNumber>(seq - 1)));
+        }
+        RF_TEST_CHECK(ring.AllocatedSlots() == SENT_PACKET_RING_INITIAL_CAPACITY);
+
+        // Nothing acknowledged: the ring doubles, and every packet is still found after each move.
+        for (SequenceNumber seq = 500; seq < 499 + SentPacketRing::CAPACITY; ++seq) {
+            RF_TEST_CHECK(ring.Insert(seq, header, payload, false) != nullptr);
+        }
+        RF_TEST_CHECK(ring.AllocatedSlots() == SentPacketRing::CAPACITY);
+        RF_TEST_CHECK(ring.Size() == SentPacketRing::CAPACITY);
+        RF_TEST_CHECK(!ring.CanInsert(static_cast<SequenceNumber>(499 + SentPacketRing::CAPACITY)));
+        size_t found = 0;
+        SequenceNumber expected = 499;
+        bool inOrder = true;
+        ring.ForEach([&](const SentPacketInfo& info) {
+            inOrder = inOrder && info.sequenceNumber == expected;
+            expected = static_cast<SequenceNumber>(expected + 1);
+            ++found;
+        });
+        RF_TEST_CHECK(found == SentPacketRing::CAPACITY && inOrder);
+        for (SequenceNumber seq = 499; seq < 499 + SentPacketRing::CAPACITY; ++seq) {
+            const SentPacketInfo* info = ring.Find(seq);
+            RF_TEST_CHECK(info != nullptr && info->sequenceNumber == seq);
+        }
+
+        state.Reset();
+        RF_TEST_CHECK(ring.AllocatedSlots() == 0 && ring.Empty());
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Cookie is bound to address and lifetime", TestCookieIsBoundToAddressAndLifetime);
+    RunTest("Rebind proof is bound to session, address and cookie", TestRebindProofIsBoundToSessionAddressAndCookie);
+    RunTest("ACK clears delivered packets only", TestAckClearsDeliveredPacketsOnly);
+    RunTest("Duplicate is not delivered twice", TestDuplicateIsNotDeliveredTwice);
+    RunTest("Lost packet is retransmitted after RTO", TestLostPacketIsRetransmittedAfterRto);
+    RunTest("Later ACKs trigger fast retransmit", TestLaterAcksTriggerFastRetransmit);
+    RunTest("Retransmit gives up after MAX_PACKET_RETRIES", TestRetransmitGivesUpAfterMaxRetries);
+    RunTest("Fragmented message is reassembled", TestFragmentedMessageIsReassembled);
+    RunTest("Malformed fragments are rejected", TestMalformedFragmentsAreRejected);
+    RunTest("Ordered packet is not acknowledged until it can be held", TestOrderedPacketIsNotAcknowledgedUntilItCanBeHeld);
+    RunTest("Reassembly arena is held only during reassembly", TestReassemblyArenaIsHeldOnlyDuringReassembly);
+    RunTest("Sent packet ring grows with the in-flight span", TestSentPacketRingGrowsWithInFlightSpan);
+    return RiftForged::Tests::TestExitCode();
+}
@@ -0,0 +1,188 @@
+﻿// File: TimerWheelTests.cpp
+// RiftForged Game Development Team
+// Copyright (c) 2023-2025 RiftForged Game Development Team
+// Description: Tests of TimerWheel: timers expire on their millisecond and never early, survive
+// cascading down from every level, come back around when filed beyond the top level's range, and
+// agree with a brute-force scan under a random schedule. Time is passed in explicitly.
+
+#include "TestSupport.h"
+#include "TimerWheel.h"
+
+#include <algorithm> // For std::count_if
+#include <chrono>    // For std::chrono::steady_clock
+#include <cstdint>   // For uint32_t, uint64_t
+#include <random>    // For std::mt19937
+#include <vector>    // For std::vector
+
+using namespace RiftForged::Networking;
+using RiftForged::Tests::RunTest;
+
+namespace {
+
+    using Wheel = TimerWheel<uint32_t>;
+    using Clock = Wheel::Clock;
+
+    Clock::time_point AtMs(Clock::time_point epoch, uint64_t ms) {
+        return epoch + std::chrono::milliseconds(ms);
+    }
+
+    // Advances one millisecond at a time and records the tick each payload expired on.
+    std::vector<uint64_t> ExpiryTicks(Wheel& wheel, Clock::time_point epoch, uint64_t untilMs, size_t payloads) {
+        std::vector<uint64_t> ticks(payloads, UINT64_MAX);
+        std::vector<uint32_t> expired;
+        for (uint64_t ms = 0; ms <= untilMs; ++ms) {
+            expired.clear();
+            wheel.Advance(AtMs(epoch, ms), expired);
+            for (uint32_t payload : expired) {
+                RF_TEST_CHECK(ticks[payload] == UINT64_MAX); // Exactly once
+                ticks[payload] = ms;
+            }
+        }
+        return ticks;
+    }
+
+    void TestTimersExpireOnTheirMillisecond() {
+        const Clock::time_point epoch = Clock::now();
+        Wheel wheel(epoch);
+        const std::vector<uint64_t> deadlines = { 0, 1, 2, 17, 63, 64, 65, 127, 128, 200 };
+        for (uint32_t i = 0; i < deadlines.size(); ++i) {
+            wheel.Schedule(AtMs(epoch, deadlines[i]), i);
+        }
+        // A deadline between ticks rounds up rather than firing early.
+        wheel.Schedule(AtMs(epoch, 30) + std::chrono::microseconds(1), static_cast<uint32_t>(deadlines.size()));
+        RF_TEST_CHECK(wheel.Size() == deadlines.size() + 1);
+
+        const std::vector<uint64_t> ticks = ExpiryTicks(wheel, epoch, 250, deadlines.size() + 1);
+        for (uint32_t i = 0; i < deadlines.size(); ++i) {
+            RF_TEST_CHECK(ticks[i] == deadlines[i]);
+        }
+        RF_TEST_CHECK(ticks[deadlines.size()] == 31);
+        RF_TEST_CHECK(wheel.Empty());
+    }
+
+    void TestTimersCascadeFromEveryLevel() {
+        const Clock::time_point epoch = Clock::now();
+        // Either side of each level boundary, and an offset start so slots do not line up with zero.
+        const uint64_t start = 37;
+        const std::vector<uint64_t> deadlines = {
+            start + 63, start + 64, start + 4095, start + 4096, start + 4097,
+            start + 262143, start + 262144, start + 262145, start + 1000000,
+        };
+        Wheel wheel(epoch);
+        std::vector<uint32_t> expired;
+        wheel.Advance(AtMs(epoch, start), expired);
+        for (uint32_t i = 0; i < deadlines.size(); ++i) {
+            wheel.Schedule(AtMs(epoch, deadlines[i]), i);
+        }
+        const std::vector<uint64_t> ticks = ExpiryTicks(wheel, epoch, deadlines.back() + 1, deadlines.size());
+        for (uint32_t i = 0; i < deadlines.size(); ++i) {
+            RF_TEST_CHECK(ticks[i] == deadlines[i]);
+        }
+
+        // One large step expires the lot at once, whatever level each timer sat in.
+        Wheel jumped(epoch);
+        jumped.Advance(AtMs(epoch, start), expired);
+        for (uint32_t i = 0; i < deadlines.size(); ++i) {
+            jumped.Schedule(AtMs(epoch, deadlines[i]), i);
+        }
+        expired.clear();
+        RF_TEST_CHECK(jumped.Advance(AtMs(epoch, deadlines[4]), expired) == 5);
+        RF_TEST_CHECK(jumped.Advance(AtMs(epoch, deadlines.back()), expired) == deadlines.size() - 5);
+        RF_TEST_CHECK(jumped.Empty());
+    }
+
+    void TestDeadlineBeyondTopLevelComesBack() {
+        const Clock::time_point epoch = Clock::now();
+        Wheel wheel(epoch);
+        const uint64_t range = uint64_t{ 1 } << (Wheel::SLOT_BITS * Wheel::LEVELS);
+        const uint64_t deadline = range + 5000;
+        wheel.Schedule(AtMs(epoch, deadline), 7);
+
+        std::vector<uint32_t> expired;
+        RF_TEST_CHECK(wheel.Advance(AtMs(epoch, range - 1), expired) == 0);
+        RF_TEST_CHECK(wheel.Advance(AtMs(epoch, deadline - 1), expired) == 0);
+        RF_TEST_CHECK(wheel.Advance(AtMs(epoch, deadline), expired) == 1);
+        RF_TEST_CHECK(expired.size() == 1 && expired[0] == 7);
+    }
+
+    void TestPastDeadlinesExpireOnNextAdvance() {
+        const Clock::time_point epoch = Clock::now();
+        Wheel wheel(epoch);
+        std::vector<uint32_t> expired;
+        wheel.Advance(AtMs(epoch, 500), expired);
+        wheel.Schedule(AtMs(epoch, 100), 1);
+        wheel.Schedule(epoch - std::chrono::seconds(1), 2);
+        RF_TEST_CHECK(wheel.Advance(AtMs(epoch, 500), expired) == 2);
+        RF_TEST_CHECK(wheel.Empty());
+    }
+
+    void TestNextWakeTimeIsNeverLate() {
+        const Clock::time_point epoch = Clock::now();
+        Wheel wheel(epoch);
+        RF_TEST_CHECK(wheel.NextWakeTime() == Clock::time_point::max());
+
+        wheel.Schedule(AtMs(epoch, 10), 1);
+        RF_TEST_CHECK(wheel.NextWakeTime() == AtMs(epoch, 10)); // Exact within the first level
+
+        // Further out it may wake early to cascade, but sleeping until it always arrives in time.
+        Wheel far(epoch);
+        const uint64_t deadline = 100000;
+        far.Schedule(AtMs(epoch, deadline), 2);
+        std::vector<uint32_t> expired;
+        // At worst one wakeup per level-0 lap.
+        const uint64_t maxWakeups = deadline / Wheel::SLOTS + 1;
+        uint64_t wakeups = 0;
+        while (expired.empty() && wakeups <= maxWakeups) {
+            const Clock::time_point wake = far.NextWakeTime();
+            RF_TEST_CHECK(wake <= AtMs(epoch, deadline));
+            far.Advance(wake, expired);
+            ++wakeups;
+        }
+        RF_TEST_CHECK(expired.size() == 1);
+        RF_TEST_CHECK(wakeups <= maxWakeups);
+        RF_TEST_CHECK(far.NextWakeTime() == Clock::time_point::max());
+    }
+
+    void TestRandomScheduleMatchesScan() {
+        const Clock::time_point epoch = Clock::now();
+        Wheel wheel(epoch);
+        std::mt19937 random(12345);
+        std::vector<uint64_t> deadlines; // Indexed by payload
+        std::vector<uint32_t> expired;
+        uint64_t nowMs = 0;
+        for (int round = 0; round < 2000; ++round) {
+            const uint32_t toSchedule = random() % 8;
+            for (uint32_t i = 0; i < toSchedule; ++i) {
+                // Mostly short timers (ACK delays, RTOs), some long ones (idle timeouts).
+                const uint64_t delay = (random() % 10 == 0) ? random() % 600000 : random() % 2000;
+                deadlines.push_back(nowMs + delay);
+                wheel.Schedule(AtMs(epoch, nowMs + delay), static_cast<uint32_t>(deadlines.size() - 1));
+            }
+            nowMs += random() % 500;
+            expired.clear();
+            wheel.Advance(AtMs(epoch, nowMs), expired);
+            for (uint32_t payload : expired) {
+                RF_TEST_CHECK(deadlines[payload] <= nowMs);
+                deadlines[payload] = UINT64_MAX; // Marks it expired
+            }
+            // Everything due has gone.
+            for (uint64_t deadline : deadlines) {
+                RF_TEST_CHECK(deadline == UINT64_MAX || deadline > nowMs);
+            }
+        }
+        const size_t pending = static_cast<size_t>(std::count_if(deadlines.begin(), deadlines.end(),
+            [](uint64_t deadline) { return deadline != UINT64_MAX; }));
+        RF_TEST_CHECK(wheel.Size() == pending);
+    }
+
+} // namespace
+
+int main() {
+    RunTest("Timers expire on their millisecond, never early", TestTimersExpireOnTheirMillisecond);
+    RunTest("Timers cascade down from every level on time", TestTimersCascadeFromEveryLevel);
+    RunTest("A deadline beyond the top level comes back around", TestDeadlineBeyondTopLevelComesBack);
+    RunTest("Deadlines in the past expire on the next advance", TestPastDeadlinesExpireOnNextAdvance);
+    RunTest("Sleeping until NextWakeTime is never late", TestNextWakeTimeIsNeverLate);
+    RunTest("A random schedule matches a brute-force scan", TestRandomScheduleMatchesScan);
+    return RiftForged::Tests::TestExitCode();
+}
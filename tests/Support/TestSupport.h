@@ -0,0 +1,44 @@
+﻿// File: TestSupport.h
+// RiftForged Game Engine
+// Copyright (C) 2023 RiftForged Team
+// Description: Minimal check macros for the test executables. A failed RF_TEST_CHECK is reported
+// and counted without stopping the test, RunTest() prints one PASS/FAIL line per case and main
+// returns TestExitCode() for CTest.
+
+#pragma once
+
+#include <cstdio>  // For std::printf, std::fprintf
+
+namespace RiftForged {
+    namespace Tests {
+
+        inline int& FailureCount() {
+            static int failures = 0;
+            return failures;
+        }
+
+        inline void ReportFailure(const char* expression, const char* file, int line) {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+            ++FailureCount();
+        }
+
+        template <typename Fn>
+        void RunTest(const char* name, Fn&& test) {
+            const int failuresBefore = FailureCount();
+            test();
+            std::printf("[%s] %s\n", FailureCount() == failuresBefore ? "PASS" : "FAIL", name);
+        }
+
+        inline int TestExitCode() {
+            return FailureCount() == 0 ? 0 : 1;
+        }
+
+    } // namespace Tests
+} // namespace RiftForged
+
+#define RF_TEST_CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            ::RiftForged::Tests::ReportFailure(#condition, __FILE__, __LINE__); \
+        } \
+    } while (0)